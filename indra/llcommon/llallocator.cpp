@@ -38,6 +38,7 @@ DECLARE_bool(heap_profile_use_stack_trace);
 // static
 void LLAllocator::pushMemType(S32 type)
 {
+    LLAllocatorSampler::pushMemType(type);
     if(isProfiling())
     {
     	PushMemType(type);
@@ -47,6 +48,7 @@ void LLAllocator::pushMemType(S32 type)
 // static
 S32 LLAllocator::popMemType()
 {
+    LLAllocatorSampler::popMemType();
     if (isProfiling())
     {
     	return PopMemType();
@@ -97,11 +99,13 @@ std::string LLAllocator::getRawProfile()
 // static
 void LLAllocator::pushMemType(S32 type)
 {
+    LLAllocatorSampler::pushMemType(type);
 }
 
 // static
 S32 LLAllocator::popMemType()
 {
+    LLAllocatorSampler::popMemType();
     return -1;
 }
 
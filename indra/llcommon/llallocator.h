@@ -31,6 +31,7 @@
 
 #include "llmemtype.h"
 #include "llallocator_heap_profile.h"
+#include "llallocator_sampler.h"
 
 class LL_COMMON_API LLAllocator {
     friend class LLMemoryView;
@@ -0,0 +1,549 @@
+/**
+ * @file llallocator_sampler.cpp
+ * @brief Implementation of the sampling heap profiler.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llallocator_sampler.h"
+
+#include "llmemtype.h"
+#include "llstacktrace.h"
+#include "llthread.h"
+
+#include <algorithm>
+
+#include "apr_atomic.h"
+
+U32 LLAllocatorSampler::sInterval = 0;
+S64 LLAllocatorSampler::sCountdown = 0;
+volatile U32 LLAllocatorSampler::sLiveSamples = 0;
+U8 LLAllocatorSampler::sFilter[LLAllocatorSampler::FILTER_SIZE];
+
+namespace
+{
+	// All of the state below lives in malloc()ed memory, so that taking a
+	// sample never calls back into the hooks.
+	struct SiteRecord
+	{
+		U32 mHash;
+		S32 mMemType;
+		U32 mDepth;
+		void* mFrames[LLAllocatorSampler::MAX_FRAMES];
+		U64 mLiveSize;
+		U64 mBaseline;
+		U64 mTotalSize;
+		U32 mLiveCount;
+	};
+
+	struct SampleRecord
+	{
+		void* mPtr;
+		U64 mWeight;
+		U32 mSite;
+	};
+
+	const U32 MAX_MEMTYPE_DEPTH = 64;
+	const U8 FILTER_SATURATED = 255;
+
+	volatile U32 sLock = 0;
+	U32 sOwnerThread = 0;
+	S64 sLastInterval = 0;
+	U32 sSeed = 1;
+	U64 sLiveSize = 0;
+
+	S32 sMemTypes[MAX_MEMTYPE_DEPTH];
+	U32 sMemTypeDepth = 0;
+
+	// sites in creation order, with an open addressed index of (site + 1)
+	SiteRecord* sSites = NULL;
+	U32 sSiteCount = 0;
+	U32* sSiteIndex = NULL;
+	U32 sSiteIndexSize = 0;
+
+	// live samples, open addressed by pointer
+	SampleRecord* sSamples = NULL;
+	U32 sSampleCount = 0;
+	U32 sSampleCapacity = 0;
+
+	class SamplerLock
+	{
+	public:
+		SamplerLock()
+		{
+			while (apr_atomic_cas32(&sLock, 1, 0) != 0)
+			{
+				apr_thread_yield();
+			}
+		}
+		~SamplerLock()
+		{
+			apr_atomic_xchg32(&sLock, 0);
+		}
+	};
+
+	U32 hash_pointer(const void* ptr)
+	{
+		uintptr_t bits = (uintptr_t)ptr >> 4;
+		return (U32)(bits ^ (bits >> 15) ^ (bits >> 29)) * 2654435761U;
+	}
+
+	U32 hash_site(S32 mem_type, void* const* frames, U32 depth)
+	{
+		// FNV-1a over the memory type and frame addresses
+		U32 hash = 2166136261U ^ (U32)mem_type;
+		for (U32 i = 0; i < depth; i++)
+		{
+			hash = (hash ^ (U32)((uintptr_t)frames[i] >> 2)) * 16777619U;
+		}
+		return hash;
+	}
+
+	// Next countdown, uniform over [interval / 2, interval * 3 / 2) so that
+	// allocation patterns with a fixed period don't alias with the sampling.
+	S64 next_interval(U32 interval)
+	{
+		sSeed = sSeed * 1103515245 + 12345;
+		return interval / 2 + (S64)((U64)(sSeed >> 8) * interval >> 24);
+	}
+
+	// keeps the index at most half full, with room in sSites for that many
+	bool grow_sites()
+	{
+		U32 index_size = sSiteIndexSize ? sSiteIndexSize * 2 : 512;
+		SiteRecord* sites = (SiteRecord*)realloc(sSites, index_size / 2 * sizeof(SiteRecord));
+		if (!sites)
+		{
+			return false;
+		}
+		sSites = sites;
+
+		U32* index = (U32*)calloc(index_size, sizeof(U32));
+		if (!index)
+		{
+			return false;
+		}
+		for (U32 i = 0; i < sSiteCount; i++)
+		{
+			U32 slot = sSites[i].mHash & (index_size - 1);
+			while (index[slot])
+			{
+				slot = (slot + 1) & (index_size - 1);
+			}
+			index[slot] = i + 1;
+		}
+		free(sSiteIndex);
+		sSiteIndex = index;
+		sSiteIndexSize = index_size;
+		return true;
+	}
+
+	// returns sSiteCount on failure
+	U32 find_or_add_site(S32 mem_type, void* const* frames, U32 depth)
+	{
+		U32 hash = hash_site(mem_type, frames, depth);
+		if (sSiteIndexSize)
+		{
+			U32 slot = hash & (sSiteIndexSize - 1);
+			while (sSiteIndex[slot])
+			{
+				U32 i = sSiteIndex[slot] - 1;
+				SiteRecord& site = sSites[i];
+				if (site.mHash == hash && site.mMemType == mem_type && site.mDepth == depth
+					&& !memcmp(site.mFrames, frames, depth * sizeof(void*)))
+				{
+					return i;
+				}
+				slot = (slot + 1) & (sSiteIndexSize - 1);
+			}
+		}
+
+		if (sSiteCount * 2 >= sSiteIndexSize && !grow_sites())
+		{
+			return sSiteCount;
+		}
+		U32 i = sSiteCount++;
+		SiteRecord& site = sSites[i];
+		memset(&site, 0, sizeof(SiteRecord));
+		site.mHash = hash;
+		site.mMemType = mem_type;
+		site.mDepth = depth;
+		memcpy(site.mFrames, frames, depth * sizeof(void*));	/* Flawfinder: ignore */
+
+		U32 slot = hash & (sSiteIndexSize - 1);
+		while (sSiteIndex[slot])
+		{
+			slot = (slot + 1) & (sSiteIndexSize - 1);
+		}
+		sSiteIndex[slot] = i + 1;
+		return i;
+	}
+
+	U32 find_sample(void* ptr)
+	{
+		U32 slot = hash_pointer(ptr) & (sSampleCapacity - 1);
+		while (sSamples[slot].mPtr && sSamples[slot].mPtr != ptr)
+		{
+			slot = (slot + 1) & (sSampleCapacity - 1);
+		}
+		return slot;
+	}
+
+	bool grow_samples()
+	{
+		U32 capacity = sSampleCapacity ? sSampleCapacity * 2 : 1024;
+		SampleRecord* samples = (SampleRecord*)calloc(capacity, sizeof(SampleRecord));
+		if (!samples)
+		{
+			return false;
+		}
+		SampleRecord* old_samples = sSamples;
+		U32 old_capacity = sSampleCapacity;
+		sSamples = samples;
+		sSampleCapacity = capacity;
+		for (U32 i = 0; i < old_capacity; i++)
+		{
+			if (old_samples[i].mPtr)
+			{
+				sSamples[find_sample(old_samples[i].mPtr)] = old_samples[i];
+			}
+		}
+		free(old_samples);
+		return true;
+	}
+
+	void remove_sample(U32 slot)
+	{
+		// backward shift deletion keeps every probe run unbroken
+		U32 mask = sSampleCapacity - 1;
+		U32 hole = slot;
+		U32 next = (hole + 1) & mask;
+		while (sSamples[next].mPtr)
+		{
+			U32 home = hash_pointer(sSamples[next].mPtr) & mask;
+			if (((next - home) & mask) >= ((next - hole) & mask))
+			{
+				sSamples[hole] = sSamples[next];
+				hole = next;
+			}
+			next = (next + 1) & mask;
+		}
+		sSamples[hole].mPtr = NULL;
+		sSampleCount--;
+	}
+
+	void clear_all()
+	{
+		free(sSites);
+		free(sSiteIndex);
+		free(sSamples);
+		sSites = NULL;
+		sSiteIndex = NULL;
+		sSamples = NULL;
+		sSiteCount = sSiteIndexSize = 0;
+		sSampleCount = sSampleCapacity = 0;
+		sLiveSize = 0;
+	}
+
+	// Copies the sites out so they can be reported without holding the lock.
+	SiteRecord* copy_sites(U32& count)
+	{
+		SamplerLock lock;
+		count = sSiteCount;
+		SiteRecord* sites = count ? (SiteRecord*)malloc(count * sizeof(SiteRecord)) : NULL;
+		if (sites)
+		{
+			memcpy(sites, sSites, count * sizeof(SiteRecord));	/* Flawfinder: ignore */
+		}
+		else
+		{
+			count = 0;
+		}
+		return sites;
+	}
+
+	bool site_growth_greater(const SiteRecord& a, const SiteRecord& b)
+	{
+		return (S64)(a.mLiveSize - a.mBaseline) > (S64)(b.mLiveSize - b.mBaseline);
+	}
+
+	void fill_site(const SiteRecord& record, LLAllocatorSampler::site& site)
+	{
+		site.mMemType = record.mMemType;
+		site.mLiveSize = record.mLiveSize;
+		site.mGrowth = (S64)(record.mLiveSize - record.mBaseline);
+		site.mTotalSize = record.mTotalSize;
+		site.mLiveCount = record.mLiveCount;
+		site.mTrace.clear();
+		ll_get_stack_frame_names(record.mFrames, record.mDepth, site.mTrace);
+	}
+
+	std::string mem_type_name(S32 mem_type)
+	{
+		return mem_type < 0 ? std::string("Unknown") : std::string(LLMemType::getNameFromID(mem_type));
+	}
+
+	std::string site_key(const LLAllocatorSampler::site& site)
+	{
+		std::string key = mem_type_name(site.mMemType);
+		for (size_t i = 0; i < site.mTrace.size(); i++)
+		{
+			key += '\t';
+			key += site.mTrace[i];
+		}
+		return key;
+	}
+
+	bool site_key_less(const LLAllocatorSampler::site& a, const LLAllocatorSampler::site& b)
+	{
+		return site_key(a) < site_key(b);
+	}
+}
+
+// static
+void LLAllocatorSampler::setSampleInterval(U32 bytes)
+{
+	SamplerLock lock;
+	if (bytes == sInterval)
+	{
+		return;
+	}
+	clear_all();
+	memset(sFilter, 0, sizeof(sFilter));
+	sLiveSamples = 0;
+	sMemTypeDepth = 0;
+	if (bytes)
+	{
+		sOwnerThread = LLThread::currentID();
+		sLastInterval = next_interval(bytes);
+		sCountdown = sLastInterval;
+	}
+	sInterval = bytes;
+}
+
+// static
+void LLAllocatorSampler::pushMemType(S32 type)
+{
+	if (sInterval && LLThread::currentID() == sOwnerThread)
+	{
+		if (sMemTypeDepth < MAX_MEMTYPE_DEPTH)
+		{
+			sMemTypes[sMemTypeDepth] = type;
+		}
+		sMemTypeDepth++;
+	}
+}
+
+// static
+void LLAllocatorSampler::popMemType()
+{
+	if (sInterval && sMemTypeDepth && LLThread::currentID() == sOwnerThread)
+	{
+		sMemTypeDepth--;
+	}
+}
+
+// static
+void LLAllocatorSampler::sample(void* ptr, size_t size)
+{
+	// the sample stands for everything allocated since the last one
+	S64 weight = sLastInterval - sCountdown;
+	if (weight < (S64)size)
+	{
+		weight = size;
+	}
+	sLastInterval = next_interval(sInterval);
+	sCountdown = sLastInterval;
+	if (!ptr)
+	{
+		return;
+	}
+
+	void* frames[MAX_FRAMES];
+	U32 depth = (U32)llmax(ll_get_stack_frames(frames, MAX_FRAMES, 1), 0);
+
+	S32 mem_type = -1;
+	if (LLThread::currentID() == sOwnerThread && sMemTypeDepth)
+	{
+		mem_type = sMemTypes[llmin(sMemTypeDepth, MAX_MEMTYPE_DEPTH) - 1];
+	}
+
+	SamplerLock lock;
+	if (!sInterval)
+	{
+		return;
+	}
+	if ((sSampleCount + 1) * 4 > sSampleCapacity * 3 && !grow_samples())
+	{
+		return;
+	}
+	U32 site_index = find_or_add_site(mem_type, frames, depth);
+	if (site_index == sSiteCount)
+	{
+		return;
+	}
+
+	SampleRecord& record = sSamples[find_sample(ptr)];
+	if (record.mPtr)
+	{
+		// freed behind our back, e.g. by a deallocator we don't hook
+		SiteRecord& old_site = sSites[record.mSite];
+		old_site.mLiveSize -= record.mWeight;
+		old_site.mLiveCount--;
+		sLiveSize -= record.mWeight;
+	}
+	else
+	{
+		sSampleCount++;
+		U8& filter = sFilter[filterIndex(ptr)];
+		if (filter != FILTER_SATURATED)
+		{
+			filter++;
+		}
+		sLiveSamples++;
+	}
+	record.mPtr = ptr;
+	record.mWeight = (U64)weight;
+	record.mSite = site_index;
+
+	SiteRecord& site = sSites[site_index];
+	site.mLiveSize += record.mWeight;
+	site.mTotalSize += record.mWeight;
+	site.mLiveCount++;
+	sLiveSize += record.mWeight;
+}
+
+// static
+void LLAllocatorSampler::unsample(void* ptr)
+{
+	SamplerLock lock;
+	if (!sSampleCount)
+	{
+		return;
+	}
+	U32 slot = find_sample(ptr);
+	SampleRecord& record = sSamples[slot];
+	if (!record.mPtr)
+	{
+		// another pointer in the same filter bucket
+		return;
+	}
+
+	SiteRecord& site = sSites[record.mSite];
+	site.mLiveSize -= record.mWeight;
+	site.mLiveCount--;
+	sLiveSize -= record.mWeight;
+
+	U8& filter = sFilter[filterIndex(ptr)];
+	if (filter != FILTER_SATURATED)
+	{
+		filter--;
+	}
+	sLiveSamples--;
+	remove_sample(slot);
+}
+
+// static
+void LLAllocatorSampler::markBaseline()
+{
+	SamplerLock lock;
+	for (U32 i = 0; i < sSiteCount; i++)
+	{
+		sSites[i].mBaseline = sSites[i].mLiveSize;
+	}
+}
+
+// static
+U64 LLAllocatorSampler::getLiveSize()
+{
+	SamplerLock lock;
+	return sLiveSize;
+}
+
+// static
+U32 LLAllocatorSampler::getSiteCount()
+{
+	SamplerLock lock;
+	return sSiteCount;
+}
+
+// static
+void LLAllocatorSampler::getSites(sites_t& sites, U32 max_sites)
+{
+	sites.clear();
+
+	U32 count = 0;
+	SiteRecord* records = copy_sites(count);
+	std::sort(records, records + count, site_growth_greater);
+	if (max_sites && max_sites < count)
+	{
+		count = max_sites;
+	}
+
+	sites.resize(count);
+	for (U32 i = 0; i < count; i++)
+	{
+		fill_site(records[i], sites[i]);
+	}
+	free(records);
+}
+
+// static
+bool LLAllocatorSampler::writeSnapshot(const std::string& filename)
+{
+	sites_t sites;
+	U32 count = 0;
+	SiteRecord* records = copy_sites(count);
+	sites.resize(count);
+	for (U32 i = 0; i < count; i++)
+	{
+		fill_site(records[i], sites[i]);
+	}
+	free(records);
+	std::sort(sites.begin(), sites.end(), site_key_less);
+
+	llofstream out(filename);
+	if (!out.is_open())
+	{
+		llwarns << "Unable to write heap samples to " << filename << llendl;
+		return false;
+	}
+
+	out << "# sample interval " << sInterval << " bytes, " << count << " sites\n";
+	out << "# live_bytes\tlive_samples\ttotal_bytes\tmem_type\tstack\n";
+	for (U32 i = 0; i < count; i++)
+	{
+		const site& s = sites[i];
+		out << s.mLiveSize << '\t' << s.mLiveCount << '\t' << s.mTotalSize << '\t'
+			<< mem_type_name(s.mMemType);
+		for (size_t k = 0; k < s.mTrace.size(); k++)
+		{
+			out << (k ? " | " : "\t") << s.mTrace[k];
+		}
+		out << '\n';
+	}
+	out.close();
+
+	llinfos << "Wrote " << count << " heap sample sites to " << filename << llendl;
+	return true;
+}
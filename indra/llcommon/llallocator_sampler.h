@@ -0,0 +1,116 @@
+/**
+ * @file llallocator_sampler.h
+ * @brief Declaration of the sampling heap profiler.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLALLOCATOR_SAMPLER_H
+#define LL_LLALLOCATOR_SAMPLER_H
+
+#include "stdtypes.h"
+
+#include <string>
+#include <vector>
+
+// Sampling heap profiler.  Roughly one allocation per getSampleInterval()
+// bytes is recorded with its call stack and the innermost LLMemType of the
+// thread that enabled sampling.  Each sample stands for all the bytes
+// allocated since the previous one, so per site sizes are estimates of the
+// real totals.  A sample is dropped when its memory is freed, so live sizes
+// follow what is still allocated, and markBaseline() sets the point that
+// site growth is measured from.
+//
+// The allocation hooks call recordAlloc() and recordFree(), which cost a
+// counter update and a filter lookup unless a sample is taken or dropped.
+// Nothing in here may use operator new while holding the lock, since the
+// hooks would come straight back in.
+class LL_COMMON_API LLAllocatorSampler
+{
+public:
+	enum { MAX_FRAMES = 16 };
+
+	struct site
+	{
+		S32 mMemType;						// -1 if unknown, as on other threads
+		U64 mLiveSize;
+		S64 mGrowth;						// mLiveSize change since markBaseline()
+		U64 mTotalSize;
+		U32 mLiveCount;						// live samples
+		std::vector<std::string> mTrace;	// innermost frame first
+	};
+	typedef std::vector<site> sites_t;
+
+	// 0 stops sampling and forgets all samples.
+	static void setSampleInterval(U32 bytes);
+	static U32 getSampleInterval() { return sInterval; }
+	static bool isSampling() { return sInterval != 0; }
+
+	static inline void recordAlloc(void* ptr, size_t size)
+	{
+		if (sInterval && (sCountdown -= (S64)size) <= 0)
+		{
+			sample(ptr, size);
+		}
+	}
+
+	static inline void recordFree(void* ptr)
+	{
+		if (sLiveSamples && sFilter[filterIndex(ptr)])
+		{
+			unsample(ptr);
+		}
+	}
+
+	static void pushMemType(S32 type);
+	static void popMemType();
+
+	static void markBaseline();
+
+	// Sites with the largest growth first, at most max_sites if non-zero.
+	static void getSites(sites_t& sites, U32 max_sites = 0);
+	static U64 getLiveSize();
+	static U32 getSiteCount();
+
+	// Writes every site ordered by memory type and trace rather than size,
+	// so two snapshots of one session can be compared with diff.
+	static bool writeSnapshot(const std::string& filename);
+
+private:
+	enum { FILTER_SIZE = 1 << 16 };
+
+	static U32 filterIndex(const void* ptr)
+	{
+		uintptr_t bits = (uintptr_t)ptr >> 4;
+		return (U32)(bits ^ (bits >> 16)) & (FILTER_SIZE - 1);
+	}
+
+	static void sample(void* ptr, size_t size);
+	static void unsample(void* ptr);
+
+	static U32 sInterval;
+	static S64 sCountdown;				// not atomic, a lost update only moves the next sample
+	static volatile U32 sLiveSamples;
+	static U8 sFilter[FILTER_SIZE];		// live samples per address bucket, saturating
+};
+
+#endif // LL_LLALLOCATOR_SAMPLER_H
@@ -166,7 +166,10 @@ public:
 	void operator -=(Type x) { apr_atomic_sub32(&mData, apr_uint32_t(x)); }
 	void operator +=(Type x) { apr_atomic_add32(&mData, apr_uint32_t(x)); }
 	Type operator ++(int) { return apr_atomic_inc32(&mData); } // Type++
-	Type operator --(int) { return apr_atomic_dec32(&mData); } // Type--
+	Type operator --(int) { return apr_atomic_dec32(&mData); } // approximately --Type (0 if final is 0, non-zero otherwise)
+	Type FetchAndSub(Type x) { return Type(apr_atomic_add32(&mData, apr_uint32_t(-x))); } // returns the value before the subtraction
+
+	Type CurrentValue() const { return Type(apr_atomic_read32(const_cast< volatile apr_uint32_t* >(&mData))); }
 	
 private:
 	apr_uint32_t mData;
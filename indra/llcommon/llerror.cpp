@@ -48,6 +48,7 @@
 #include "llsd.h"
 #include "llsdserialize.h"
 #include "llstl.h"
+#include "llthread.h"
 #include "lltimer.h"
 
 namespace {
@@ -343,6 +344,13 @@ namespace
 		std::ostringstream messageStream;
 		bool messageStreamInUse;
 
+		// Streams for messages logged while messageStream is in use,
+		// usually from other threads, kept so they aren't reallocated.
+		std::vector<std::ostringstream*> freeStreams;
+
+		std::ostringstream* getStream();
+		void releaseStream(std::ostringstream* out);
+
 		void addCallSite(LLError::CallSite&);
 		void invalidateCallSites();
 		
@@ -358,6 +366,42 @@ namespace
 		
 	};
 
+	std::ostringstream* Globals::getStream()
+	{
+		if (!messageStreamInUse)
+		{
+			messageStreamInUse = true;
+			return &messageStream;
+		}
+		if (freeStreams.empty())
+		{
+			return new std::ostringstream;
+		}
+		std::ostringstream* out = freeStreams.back();
+		freeStreams.pop_back();
+		return out;
+	}
+
+	void Globals::releaseStream(std::ostringstream* out)
+	{
+		const size_t MAX_FREE_STREAMS = 16;
+		if (out == &messageStream)
+		{
+			messageStreamInUse = false;
+		}
+		else if (freeStreams.size() >= MAX_FREE_STREAMS)
+		{
+			delete out;
+			return;
+		}
+		else
+		{
+			freeStreams.push_back(out);
+		}
+		out->clear();
+		out->str("");
+	}
+
 	void Globals::addCallSite(LLError::CallSite& site)
 	{
 		callSites.push_back(&site);
@@ -720,6 +764,182 @@ namespace LLError
 }
 
 
+namespace
+{
+	void writeToRecorders(LLError::ELevel level, const std::string& message)
+	{
+		LLError::Settings& s = LLError::Settings::get();
+	
+		std::string messageWithTime;
+		
+		for (Recorders::const_iterator i = s.recorders.begin();
+			i != s.recorders.end();
+			++i)
+		{
+			LLError::Recorder* r = *i;
+			
+			if (r->wantsTime()  &&  s.timeFunction != NULL)
+			{
+				if (messageWithTime.empty())
+				{
+					messageWithTime = s.timeFunction() + " " + message;
+				}
+				
+				r->recordMessage(level, messageWithTime);
+			}
+			else
+			{
+				r->recordMessage(level, message);
+			}
+		}
+	}
+
+	// Passes formatted messages to the recorders on a background thread.
+	// Messages are only pushed while holding gLogMutexp, so the queue has a
+	// single producer and a single consumer and needs no lock.  Queue slots
+	// keep their string capacity, so steady logging doesn't allocate here.
+	class LogWriter : public LLThread
+	{
+	public:
+		LogWriter();
+
+		// Caller must hold the log lock.  Returns false if the queue is full.
+		bool push(LLError::ELevel level, const std::string& message);
+
+		// Writes everything queued, then message, on the calling thread.
+		// Caller must hold the log lock.
+		void writeNow(LLError::ELevel level, const std::string& message);
+
+		// Writes everything queued so far, from any thread.
+		void drain();
+
+		LLMutex* getRecorderMutex() { return &mRecorderMutex; }
+
+	private:
+		/*virtual*/ void run();
+		/*virtual*/ bool runCondition();
+
+		void drainLocked();
+
+		enum { QUEUE_SIZE = 1024 };	// must be a power of 2
+		struct Record
+		{
+			LLError::ELevel	mLevel;
+			std::string		mMessage;
+		};
+		Record			mQueue[QUEUE_SIZE];
+		LLAtomicU32		mHead;	// next record to write
+		LLAtomicU32		mTail;	// next free record
+		LLMutex			mRecorderMutex;	// held while calling the recorders
+	};
+
+	LogWriter* gLogWriter = NULL;
+
+	LogWriter::LogWriter()
+	:	LLThread("LogWriter"),
+		mHead(0),
+		mTail(0),
+		mRecorderMutex(NULL)
+	{
+	}
+
+	bool LogWriter::push(LLError::ELevel level, const std::string& message)
+	{
+		U32 tail = mTail.CurrentValue();
+		if (tail - mHead.CurrentValue() >= QUEUE_SIZE)
+		{
+			return false;
+		}
+		Record& record = mQueue[tail & (QUEUE_SIZE - 1)];
+		record.mLevel = level;
+		record.mMessage.assign(message);
+		mTail++;
+		// Only wake the writer if it may have seen an empty queue.
+		if (mHead.CurrentValue() == tail)
+		{
+			wake();
+		}
+		return true;
+	}
+
+	void LogWriter::writeNow(LLError::ELevel level, const std::string& message)
+	{
+		LLMutexLock lock(&mRecorderMutex);
+		drainLocked();
+		writeToRecorders(level, message);
+	}
+
+	void LogWriter::drain()
+	{
+		LLMutexLock lock(&mRecorderMutex);
+		drainLocked();
+	}
+
+	void LogWriter::drainLocked()
+	{
+		U32 head = mHead.CurrentValue();
+		while (head != mTail.CurrentValue())
+		{
+			Record& record = mQueue[head & (QUEUE_SIZE - 1)];
+			writeToRecorders(record.mLevel, record.mMessage);
+			mHead++;
+			head++;
+		}
+	}
+
+	//virtual
+	bool LogWriter::runCondition()
+	{
+		return mHead.CurrentValue() != mTail.CurrentValue();
+	}
+
+	//virtual
+	void LogWriter::run()
+	{
+		while (!isQuitting())
+		{
+			checkPause();
+			drain();
+		}
+	}
+
+	// Holds off the writer thread while the recorders are changed.
+	class RecorderLock
+	{
+	public:
+		RecorderLock()
+		:	mMutex(gLogWriter ? gLogWriter->getRecorderMutex() : NULL)
+		{
+			if (mMutex)
+			{
+				mMutex->lock();
+			}
+		}
+		~RecorderLock()
+		{
+			if (mMutex)
+			{
+				mMutex->unlock();
+			}
+		}
+	private:
+		LLMutex* mMutex;
+	};
+
+	// Caller must hold the log lock.
+	void sendToRecorders(LLError::ELevel level, const std::string& message)
+	{
+		if (!gLogWriter)
+		{
+			writeToRecorders(level, message);
+		}
+		else if (level == LLError::LEVEL_ERROR || !gLogWriter->push(level, message))
+		{
+			gLogWriter->writeNow(level, message);
+		}
+	}
+}
+
 namespace LLError
 {
 	Recorder::~Recorder()
@@ -737,6 +957,7 @@ namespace LLError
 		{
 			return;
 		}
+		RecorderLock lock;
 		Settings& s = Settings::get();
 		s.recorders.push_back(recorder);
 	}
@@ -747,6 +968,7 @@ namespace LLError
 		{
 			return;
 		}
+		RecorderLock lock;
 		Settings& s = Settings::get();
 		s.recorders.erase(
 			std::remove(s.recorders.begin(), s.recorders.end(), recorder),
@@ -806,36 +1028,6 @@ namespace LLError
 	}
 }
 
-namespace
-{
-	void writeToRecorders(LLError::ELevel level, const std::string& message)
-	{
-		LLError::Settings& s = LLError::Settings::get();
-	
-		std::string messageWithTime;
-		
-		for (Recorders::const_iterator i = s.recorders.begin();
-			i != s.recorders.end();
-			++i)
-		{
-			LLError::Recorder* r = *i;
-			
-			if (r->wantsTime()  &&  s.timeFunction != NULL)
-			{
-				if (messageWithTime.empty())
-				{
-					messageWithTime = s.timeFunction() + " " + message;
-				}
-				
-				r->recordMessage(level, messageWithTime);
-			}
-			else
-			{
-				r->recordMessage(level, message);
-			}
-		}
-	}
-}
 
 
 /*
@@ -981,13 +1173,7 @@ namespace LLError
 		LogLock lock;
 		if (lock.ok())
 		{
-			Globals& g = Globals::get();
-
-			if (!g.messageStreamInUse)
-			{
-				g.messageStreamInUse = true;
-				return &g.messageStream;
-			}
+			return Globals::get().getStream();
 		}
 		
 		return new std::ostringstream;
@@ -1011,17 +1197,7 @@ namespace LLError
 		   message[127] = '\0' ;
 	   }
 	   
-	   Globals& g = Globals::get();
-       if (out == &g.messageStream)
-       {
-           g.messageStream.clear();
-           g.messageStream.str("");
-           g.messageStreamInUse = false;
-       }
-       else
-       {
-           delete out;
-       }
+	   Globals::get().releaseStream(out);
 	   return ;
     }
 
@@ -1037,16 +1213,7 @@ namespace LLError
 		Settings& s = Settings::get();
 
 		std::string message = out->str();
-		if (out == &g.messageStream)
-		{
-			g.messageStream.clear();
-			g.messageStream.str("");
-			g.messageStreamInUse = false;
-		}
-		else
-		{
-			delete out;
-		}
+		g.releaseStream(out);
 
 		if (site.mLevel == LEVEL_ERROR)
 		{
@@ -1054,7 +1221,7 @@ namespace LLError
 			fatalMessage << abbreviateFile(site.mFile)
 						<< "(" << site.mLine << ") : error";
 			
-			writeToRecorders(site.mLevel, fatalMessage.str());
+			sendToRecorders(site.mLevel, fatalMessage.str());
 		}
 		
 		
@@ -1116,7 +1283,7 @@ namespace LLError
 		prefix << message;
 		message = prefix.str();
 		
-		writeToRecorders(site.mLevel, message);
+		sendToRecorders(site.mLevel, message);
 		
 		if (site.mLevel == LEVEL_ERROR  &&  s.crashFunction)
 		{
@@ -1128,6 +1295,42 @@ namespace LLError
 
 
 
+namespace LLError
+{
+	void setAsyncLogging(bool async)
+	{
+		if (async && !gLogWriter)
+		{
+			LogWriter* writer = new LogWriter;
+			writer->start();
+			LogLock lock;
+			gLogWriter = writer;
+		}
+		else if (!async && gLogWriter)
+		{
+			LogWriter* writer = gLogWriter;
+			{
+				// Write out the queue before anything can be logged
+				// synchronously again, to keep messages in order.
+				LogLock lock;
+				writer->drain();
+				gLogWriter = NULL;
+			}
+			writer->shutdown();
+			delete writer;
+		}
+	}
+
+	void flushAsyncLog()
+	{
+		LogLock lock;
+		if (gLogWriter)
+		{
+			gLogWriter->drain();
+		}
+	}
+}
+
 namespace LLError
 {
 	Settings* saveAndResetSettings()
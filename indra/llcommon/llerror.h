@@ -96,9 +96,10 @@
 	
 	Lastly, logging is now very efficient in both compiled code and execution
 	when skipped.  There is no need to wrap messages, even debugging ones, in
-	#ifdef _DEBUG constructs.  LL_DEBUGS("StringTag") messages are compiled into all builds,
-	even release.  Which means you can use them to help debug even when deployed
-	to a real grid.
+	#ifdef _DEBUG constructs.  Call sites below LL_MIN_LOG_LEVEL are compiled
+	out entirely; by default that strips LL_DEBUGS("StringTag") messages from
+	release-for-download builds only, so they are still available in the
+	builds used to debug on a real grid.
 */
 
 namespace LLError
@@ -232,8 +233,20 @@ typedef LLError::NoClassInfo _LL_CLASS_TO_LOG;
 	See top of file for common usage.	
 */
 
+// Messages below this level are removed at compile time, including the
+// formatting of their arguments.  LEVEL_ERROR messages are always kept.
+#ifndef LL_MIN_LOG_LEVEL
+# if LL_RELEASE_FOR_DOWNLOAD
+#  define LL_MIN_LOG_LEVEL LLError::LEVEL_INFO
+# else
+#  define LL_MIN_LOG_LEVEL LLError::LEVEL_ALL
+# endif
+#endif
+
 #define lllog(level, broadTag, narrowTag, once) \
 	do { \
+	if ((level) >= (LL_MIN_LOG_LEVEL) || (level) == LLError::LEVEL_ERROR) \
+	{ \
 		static LLError::CallSite _site( \
 			level, __FILE__, __LINE__, typeid(_LL_CLASS_TO_LOG), __FUNCTION__, broadTag, narrowTag, once);\
 		if (LL_UNLIKELY(_site.shouldLog()))			\
@@ -246,6 +259,7 @@ typedef LLError::NoClassInfo _LL_CLASS_TO_LOG;
 			LLError::End(); \
 			LLError::Log::flush(_out, _site); \
 		} \
+	} \
 	} while(0)
 
 // DEPRECATED: Use the new macros that allow tags and *look* like macros.
@@ -157,6 +157,16 @@ namespace LLError
 	LL_COMMON_API std::string logFileName();
 		// returns name of current logging file, empty string if none
 
+	LL_COMMON_API void setAsyncLogging(bool async);
+		// When on, formatted messages are queued for a background thread
+		// that passes them to the recorders, so logging threads don't wait
+		// on file or console output.  LEVEL_ERROR messages, and messages
+		// logged while the queue is full, are written synchronously after
+		// everything already queued.  Requires APR to be initialized;
+		// turn it off again before APR is cleaned up.
+	LL_COMMON_API void flushAsyncLog();
+		// writes any queued messages before returning
+
 
 	/*
 		Utilities for use by the unit tests of LLError itself.
@@ -38,15 +38,17 @@
 //////////////////////////////////////////////////////////////////////////////
 
 LLEventTimer::LLEventTimer(F32 period)
-: mEventTimer()
+: mEventTimer(this)
 {
 	mPeriod = period;
+	schedule();
 }
 
 LLEventTimer::LLEventTimer(const LLDate& time)
-: mEventTimer()
+: mEventTimer(this)
 {
 	mPeriod = (F32)(time.secondsSinceEpoch() - LLDate::now().secondsSinceEpoch());
+	schedule();
 }
 
 
@@ -54,25 +56,72 @@ LLEventTimer::~LLEventTimer()
 {
 }
 
+void LLEventTimer::setPeriod(F32 period)
+{
+	mPeriod = period;
+	schedule();
+}
+
+void LLEventTimer::schedule()
+{
+	if (!mEventTimer.getStarted())
+	{
+		getWheel().unschedule(this);
+		return;
+	}
+	// Round up, so the timer is never early.  If it is late by a tick, or
+	// mEventTimer was reset behind our back, updateClass() checks the real
+	// elapsed time and puts it back.
+	F64 remaining = (F64)mPeriod - mEventTimer.getElapsedTimeF64();
+	U64 ticks = remaining > 0.0 ? (U64)(remaining * 1000.0) + 1 : 0;
+	getWheel().schedule(this, getCurrentTick() + ticks);
+}
+
+//static
+LLTimingWheel& LLEventTimer::getWheel()
+{
+	// function static, timers may be created during static initialization
+	static LLTimingWheel sWheel(getCurrentTick());
+	return sWheel;
+}
+
+//static
+U64 LLEventTimer::getCurrentTick()
+{
+	// milliseconds
+	return LLTimer::getTotalTime() / 1000;
+}
+
 //static
 void LLEventTimer::updateClass() 
 {
 	std::list<LLEventTimer*> completed_timers;
 
+	LLTimingWheel::EntryList expired;
+	getWheel().advance(getCurrentTick(), expired);
+	// A tick() may delete other timers; destroying one takes it out of
+	// expired, so only the ones still there are visited.
+	while (!expired.empty())
 	{
-		LLInstanceTrackerScopedGuard guard;
-		for (instance_iter iter = guard.beginInstances(); iter != guard.endInstances(); ) 
+		LLEventTimer& timer = *static_cast<LLEventTimer*>(expired.popFront());
+		if (!timer.mEventTimer.getStarted())
+		{
+			continue;
+		}
+		F32 et = timer.mEventTimer.getElapsedTimeF32();
+		if (et > timer.mPeriod)
 		{
-			LLEventTimer& timer = *iter++;
-			F32 et = timer.mEventTimer.getElapsedTimeF32();
-			if (timer.mEventTimer.getStarted() && et > timer.mPeriod) {
-				timer.mEventTimer.reset();
-				if ( timer.tick() )
-				{
-					completed_timers.push_back( &timer );
-				}
+			// reschedules it for the next period
+			timer.mEventTimer.reset();
+			if ( timer.tick() )
+			{
+				completed_timers.push_back( &timer );
 			}
 		}
+		else
+		{
+			timer.schedule();
+		}
 	}
 
 	if ( completed_timers.size() > 0 )
@@ -86,4 +135,31 @@ void LLEventTimer::updateClass()
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//		LLEventTimer::EventTimer Implementation
+//
+//////////////////////////////////////////////////////////////////////////////
+
+LLEventTimer::EventTimer::EventTimer(LLEventTimer* owner)
+:	mOwner(owner)
+{
+}
+
+void LLEventTimer::EventTimer::start()
+{
+	LLTimer::start();
+	mOwner->schedule();
+}
 
+void LLEventTimer::EventTimer::stop()
+{
+	LLTimer::stop();
+	mOwner->schedule();
+}
+
+void LLEventTimer::EventTimer::reset()
+{
+	LLTimer::reset();
+	mOwner->schedule();
+}
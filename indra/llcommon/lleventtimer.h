@@ -31,9 +31,15 @@
 #include "lldate.h"
 #include "llinstancetracker.h"
 #include "lltimer.h"
+#include "lltimingwheel.h"
 
 // class for scheduling a function to be called at a given frequency (approximate, inprecise)
-class LL_COMMON_API LLEventTimer : public LLInstanceTracker<LLEventTimer>
+//
+// Timers wait in a timing wheel keyed on when they are next due, so
+// updateClass() only visits the timers that are about to tick.  Stopping,
+// starting or resetting mEventTimer reschedules the timer; change the period
+// with setPeriod() rather than by assigning mPeriod.
+class LL_COMMON_API LLEventTimer : public LLInstanceTracker<LLEventTimer>, private LLTimingWheel::Entry
 {
 public:
 	LLEventTimer(F32 period);	// period is the amount of time between each call to tick() in seconds
@@ -47,8 +53,32 @@ public:
 	static void updateClass();
 
 protected:
-	LLTimer mEventTimer;
+	// LLTimer that tells its LLEventTimer when it is restarted or stopped
+	class LL_COMMON_API EventTimer : public LLTimer
+	{
+	public:
+		EventTimer(LLEventTimer* owner);
+
+		void start();
+		void stop();
+		void reset();
+
+	private:
+		LLEventTimer* mOwner;
+	};
+
+	void setPeriod(F32 period);
+
+	EventTimer mEventTimer;
 	F32 mPeriod;
+
+private:
+	// Puts the timer in the wheel at the time it next becomes due, or takes
+	// it out if it is stopped.
+	void schedule();
+
+	static LLTimingWheel& getWheel();
+	static U64 getCurrentTick();
 };
 
 #endif //LL_EVENTTIMER_H
@@ -71,6 +71,12 @@ std::vector<LLFastTimer::FrameState>* LLFastTimer::sTimerInfos = NULL;
 U64				LLFastTimer::sTimerCycles = 0;
 U32				LLFastTimer::sTimerCalls = 0;
 
+bool			LLFastTimer::sTraceCapture = false;
+LLFastTimer::TraceEvent* LLFastTimer::sTraceBuffer = NULL;
+U32				LLFastTimer::sTraceHead = 0;
+F32				LLFastTimer::sTraceSlowFrameMS = 0.f;
+std::string		LLFastTimer::sTraceFileName;
+
 
 // FIXME: move these declarations to the relevant modules
 
@@ -685,6 +691,27 @@ void LLFastTimer::nextFrame()
 		sLastFrameIndex = sCurFrameIndex++;
 	}
 	
+	if (sTraceCapture)
+	{
+		// record the frame itself so that traces show frame boundaries
+		U32 duration = (U32)((frame_time - sLastFrameTime) >> 8);
+		recordTraceEvent(NamedTimerFactory::instance().getActiveRootTimer(), (U32)(sLastFrameTime >> 8), duration);
+
+		static U64 sLastTraceDumpTime = 0;
+		const U64 MIN_DUMP_INTERVAL = 10; // seconds
+		F64 frame_ms = (F64)duration * 1000.0 / (F64)countsPerSecond();
+		if (sTraceSlowFrameMS > 0.f
+			&& frame_ms > sTraceSlowFrameMS
+			&& !sTraceFileName.empty()
+			&& ((frame_time - sLastTraceDumpTime) >> 8) > countsPerSecond() * MIN_DUMP_INTERVAL)
+		{
+			static S32 sSlowFrameCount = 0;
+			llinfos << "Slow frame (" << frame_ms << " ms), writing fast timer trace" << llendl;
+			writeTrace(llformat("%s_%d.json", sTraceFileName.c_str(), ++sSlowFrameCount));
+			sLastTraceDumpTime = frame_time;
+		}
+	}
+
 	// get ready for next frame
 	NamedTimer::resetFrame();
 	sLastFrameTime = frame_time;
@@ -743,6 +770,99 @@ void LLFastTimer::writeLog(std::ostream& os)
 	}
 }
 
+//static
+void LLFastTimer::setTraceCapture(bool capture)
+{
+	if (capture && !sTraceBuffer)
+	{
+		// allocated once and kept, so that the last capture can still be written after it is stopped
+		sTraceBuffer = new TraceEvent[TRACE_BUFFER_SIZE];
+	}
+	if (capture && !sTraceCapture)
+	{
+		sTraceHead = 0;
+	}
+	sTraceCapture = capture;
+}
+
+static void write_json_string(std::ostream& os, const std::string& str)
+{
+	os << '"';
+	for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+	{
+		char c = *it;
+		if (c == '"' || c == '\\')
+		{
+			os << '\\' << c;
+		}
+		else if ((U8)c < 0x20)
+		{
+			os << llformat("\\u%04x", (U32)(U8)c);
+		}
+		else
+		{
+			os << c;
+		}
+	}
+	os << '"';
+}
+
+//static
+void LLFastTimer::writeTrace(std::ostream& os)
+{
+	U32 count = sTraceBuffer ? llmin(sTraceHead, (U32)TRACE_BUFFER_SIZE) : 0;
+	U32 first = sTraceHead - count;
+
+	// 32-bit clock counts wrap after a few minutes, so rebuild 64-bit end
+	// times from the deltas between consecutive events (which are recorded
+	// in end time order), then make start times relative to the earliest one
+	std::vector<U64> end_times(count);
+	U64 end_time = (U64)1 << 32; // larger than any duration
+	U64 min_start_time = end_time;
+	U32 prev_end = 0;
+	for (U32 i = 0; i < count; i++)
+	{
+		const TraceEvent& event = sTraceBuffer[(first + i) & (TRACE_BUFFER_SIZE - 1)];
+		U32 end = event.mStartTime + event.mDuration;
+		if (i)
+		{
+			end_time += (S32)(end - prev_end);
+		}
+		prev_end = end;
+		end_times[i] = end_time;
+		min_start_time = llmin(min_start_time, end_time - event.mDuration);
+	}
+
+	F64 usec_per_count = 1000000.0 / (F64)countsPerSecond();
+	os << "{\"traceEvents\":[\n";
+	os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Main\"}}";
+	os << std::fixed << std::setprecision(3);
+	for (U32 i = 0; i < count; i++)
+	{
+		const TraceEvent& event = sTraceBuffer[(first + i) & (TRACE_BUFFER_SIZE - 1)];
+		os << ",\n{\"name\":";
+		write_json_string(os, event.mTimer->getName());
+		os << ",\"cat\":\"fasttimer\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+		   << ",\"ts\":" << (F64)(end_times[i] - event.mDuration - min_start_time) * usec_per_count
+		   << ",\"dur\":" << (F64)event.mDuration * usec_per_count << "}";
+	}
+	os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+//static
+bool LLFastTimer::writeTrace(const std::string& filename)
+{
+	llofstream file(filename);
+	if (!file.is_open())
+	{
+		llwarns << "Unable to write fast timer trace to " << filename << llendl;
+		return false;
+	}
+	writeTrace(file);
+	llinfos << "Wrote fast timer trace to " << filename << llendl;
+	return true;
+}
+
 //static
 const LLFastTimer::NamedTimer* LLFastTimer::getTimerByName(const std::string& name)
 {
@@ -198,6 +198,11 @@ public:
 		mLastTimerData.mChildTime += total_time;
 
 		LLFastTimer::sCurTimerData = mLastTimerData;
+
+		if (LL_UNLIKELY(sTraceCapture))
+		{
+			recordTraceEvent(frame_state->mTimer, mStartTime, total_time);
+		}
 #endif
 #if TIME_FAST_TIMERS
 		U64 timer_end = getCPUClockCount64();
@@ -238,6 +243,35 @@ public:
 	static void writeLog(std::ostream& os);
 	static const NamedTimer* getTimerByName(const std::string& name);
 
+	// Trace capture: while capturing, every timer records its begin and end
+	// into a preallocated ring buffer holding the last TRACE_BUFFER_SIZE
+	// events, which can be written out as Chrome/Perfetto trace event JSON.
+	struct TraceEvent
+	{
+		const NamedTimer* mTimer;
+		U32			mStartTime;	// 32-bit clock counts, see countsPerSecond()
+		U32			mDuration;
+	};
+	enum { TRACE_BUFFER_SIZE = 1 << 18 }; // must be a power of 2
+
+	static void setTraceCapture(bool capture);
+	static bool getTraceCapture() { return sTraceCapture; }
+	// adds an event to the ring buffer, only while capturing
+	LL_FORCE_INLINE static void recordTraceEvent(const NamedTimer* timer, U32 start_time, U32 duration)
+	{
+		TraceEvent& event = sTraceBuffer[sTraceHead++ & (TRACE_BUFFER_SIZE - 1)];
+		event.mTimer = timer;
+		event.mStartTime = start_time;
+		event.mDuration = duration;
+	}
+	static void writeTrace(std::ostream& os);
+	static bool writeTrace(const std::string& filename);
+
+	// When non-zero, a frame longer than this writes the trace to
+	// sTraceFileName (with a sequence number appended) while capturing.
+	static F32				sTraceSlowFrameMS;
+	static std::string		sTraceFileName;
+
 	struct CurTimerData
 	{
 		LLFastTimer*	mCurTimer;
@@ -256,6 +290,10 @@ private:
 	static U64				sLastFrameTime;
 	static info_list_t*		sTimerInfos;
 
+	static bool				sTraceCapture;
+	static TraceEvent*		sTraceBuffer;
+	static U32				sTraceHead;	// total events recorded, wraps
+
 	U32							mStartTime;
 	LLFastTimer::FrameState*	mFrameState;
 	LLFastTimer::CurTimerData	mLastTimerData;
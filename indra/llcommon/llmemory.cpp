@@ -67,6 +67,104 @@ void LLMemory::freeReserve()
 	reserveMem = NULL;
 }
 
+//----------------------------------------------------------------------------
+
+LLFrameArena gFrameArena;
+
+LLFrameArena::LLFrameArena(U32 chunk_size)
+:	mChunkSize(chunk_size),
+	mChunks(NULL),
+	mCur(NULL),
+	mEnd(NULL),
+	mAllocationCount(0),
+	mBytesUsed(0),
+	mHeapAllocationCount(0),
+	mLastAllocationCount(0),
+	mLastBytesUsed(0),
+	mLastHeapAllocationCount(0)
+{
+}
+
+LLFrameArena::~LLFrameArena()
+{
+	while (mChunks)
+	{
+		Chunk* next = mChunks->mNext;
+		ll_release(mChunks);
+		mChunks = next;
+	}
+}
+
+void LLFrameArena::addChunk(size_t min_size)
+{
+	size_t size = llmax(mChunkSize, min_size);
+	Chunk* chunk = (Chunk*)ll_allocate(headerSize() + size);
+	chunk->mNext = mChunks;
+	chunk->mSize = size;
+	mChunks = chunk;
+	mCur = chunkData(chunk);
+	mEnd = mCur + size;
+	mHeapAllocationCount++;
+}
+
+void* LLFrameArena::allocate(size_t size, size_t alignment)
+{
+	char* p = (char*)(((uintptr_t)mCur + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	if (!mChunks || p + size > mEnd)
+	{
+		addChunk(size + alignment);
+		p = (char*)(((uintptr_t)mCur + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	}
+	mCur = p + size;
+	mAllocationCount++;
+	mBytesUsed += size;
+	return p;
+}
+
+void LLFrameArena::reset()
+{
+	if (mChunks && mChunks->mNext)
+	{
+		// This frame didn't fit in one chunk, replace them all with one
+		// that would have held the whole frame.
+		size_t total = 0;
+		while (mChunks)
+		{
+			Chunk* next = mChunks->mNext;
+			total += mChunks->mSize;
+			ll_release(mChunks);
+			mChunks = next;
+		}
+		addChunk(total);
+	}
+	if (mChunks)
+	{
+		mCur = chunkData(mChunks);
+		mEnd = mCur + mChunks->mSize;
+#if LL_DEBUG
+		// catch containers that outlive their frame
+		memset(mCur, 0xcd, mChunks->mSize);
+#endif
+	}
+
+	mLastAllocationCount = mAllocationCount;
+	mLastBytesUsed = mBytesUsed;
+	mLastHeapAllocationCount = mHeapAllocationCount;
+	mAllocationCount = 0;
+	mBytesUsed = 0;
+	mHeapAllocationCount = 0;
+}
+
+U32 LLFrameArena::getReservedBytes() const
+{
+	size_t total = 0;
+	for (Chunk* chunk = mChunks; chunk; chunk = chunk->mNext)
+	{
+		total += chunk->mSize;
+	}
+	return (U32)total;
+}
+
 void* ll_allocate (size_t size)
 {
 	if (size == 0)
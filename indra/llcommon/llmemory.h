@@ -26,7 +26,12 @@
 #ifndef LLMEMORY_H
 #define LLMEMORY_H
 
-
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#if LL_WINDOWS
+#include <malloc.h>
+#endif
 
 extern S32 gTotalDAlloc;
 extern S32 gTotalDAUse;
@@ -48,6 +53,127 @@ private:
 	static char* reserveMem;
 };
 
+//----------------------------------------------------------------------------
+// LLFrameArena
+//
+// Linear allocator for data that only lives until the end of the frame.
+// allocate() bumps a pointer through a chunk, deallocate is a no-op and
+// reset() at the top of the frame makes everything available again.  If a
+// frame needs more than one chunk, reset() replaces them with a single chunk
+// big enough for the whole frame, so after the first few frames the arena
+// no longer touches the heap.  Not thread safe, main thread only.
+
+class LL_COMMON_API LLFrameArena
+{
+public:
+	LLFrameArena(U32 chunk_size = 256 * 1024);
+	~LLFrameArena();
+
+	void* allocate(size_t size, size_t alignment = 16);
+	void reset();
+
+	// Counts for the frame in progress
+	U32 getAllocationCount() const		{ return mAllocationCount; }
+	U32 getHeapAllocationCount() const	{ return mHeapAllocationCount; }
+
+	// Counts for the last complete frame, for display
+	U32 getLastAllocationCount() const		{ return mLastAllocationCount; }
+	U32 getLastBytesUsed() const			{ return mLastBytesUsed; }
+	U32 getLastHeapAllocationCount() const	{ return mLastHeapAllocationCount; }
+	U32 getReservedBytes() const;
+
+private:
+	struct Chunk
+	{
+		Chunk*	mNext;
+		size_t	mSize;
+	};
+
+	void addChunk(size_t min_size);
+	static size_t headerSize() { return (sizeof(Chunk) + 15) & ~15; }
+	static char* chunkData(Chunk* chunk) { return (char*)chunk + headerSize(); }
+
+	size_t	mChunkSize;
+	Chunk*	mChunks;	// the one in use first
+	char*	mCur;
+	char*	mEnd;
+
+	U32		mAllocationCount;
+	U32		mBytesUsed;
+	U32		mHeapAllocationCount;
+	U32		mLastAllocationCount;
+	U32		mLastBytesUsed;
+	U32		mLastHeapAllocationCount;
+};
+
+// Cleared by the main loop at the start of every frame.
+extern LL_COMMON_API LLFrameArena gFrameArena;
+
+// STL allocator over gFrameArena, for containers that don't outlive the
+// frame they are filled in, e.g.
+//   std::vector<LLVector3, LLFrameAllocator<LLVector3> > points;
+template <class T>
+class LLFrameAllocator
+{
+public:
+	typedef T			value_type;
+	typedef T*			pointer;
+	typedef const T*	const_pointer;
+	typedef T&			reference;
+	typedef const T&	const_reference;
+	typedef size_t		size_type;
+	typedef ptrdiff_t	difference_type;
+
+	template <class U> struct rebind { typedef LLFrameAllocator<U> other; };
+
+	LLFrameAllocator() throw() { }
+	LLFrameAllocator(const LLFrameAllocator&) throw() { }
+	template <class U> LLFrameAllocator(const LLFrameAllocator<U>&) throw() { }
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+
+	pointer allocate(size_type n, const void* = 0)
+	{
+		return (pointer)gFrameArena.allocate(n * sizeof(T));
+	}
+	void deallocate(pointer, size_type) { }
+
+	size_type max_size() const throw() { return size_type(-1) / sizeof(T); }
+
+	void construct(pointer p, const T& val) { new ((void*)p) T(val); }
+	void destroy(pointer p) { p->~T(); }
+};
+
+template <class T, class U>
+inline bool operator==(const LLFrameAllocator<T>&, const LLFrameAllocator<U>&) { return true; }
+template <class T, class U>
+inline bool operator!=(const LLFrameAllocator<T>&, const LLFrameAllocator<U>&) { return false; }
+
+// 16 byte aligned blocks, for arrays of SIMD types such as LLVector4a;
+// plain new only guarantees 8 on some platforms.  Free with
+// ll_aligned_free_16().
+inline void* ll_aligned_malloc_16(size_t size)
+{
+#if LL_WINDOWS
+	return _aligned_malloc(size, 16);
+#elif LL_DARWIN
+	return malloc(size); // OS X malloc is 16 byte aligned
+#else
+	void* ptr = NULL;
+	return posix_memalign(&ptr, 16, size) == 0 ? ptr : NULL;
+#endif
+}
+
+inline void ll_aligned_free_16(void* ptr)
+{
+#if LL_WINDOWS
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
 // LLRefCount moved to llrefcount.h
 
 // LLPointer moved to llpointer.h
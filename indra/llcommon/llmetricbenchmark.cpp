@@ -0,0 +1,225 @@
+/**
+ * @file llmetricbenchmark.cpp
+ * @brief LLMetricBenchmark class implementation
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmetricbenchmark.h"
+
+#include "llerror.h"
+#include "llfile.h"
+#include "llsdserialize.h"
+#include "lltimer.h"
+
+#include <algorithm>
+
+//----------------------------------------------------------------------------------------------
+// LLMetricBenchmark : Tester instance methods
+//----------------------------------------------------------------------------------------------
+
+LLMetricBenchmark::LLMetricBenchmark(const std::string& name, U32 iterations) :
+	LLMetricPerformanceTesterBasic(name),
+	mIterations(llmax(iterations, 1U)),
+	mRepetitions(0),
+	mMinTime(0.0),
+	mMedianTime(0.0),
+	mMeanTime(0.0),
+	mStdDevTime(0.0)
+{
+	addMetric("MinTime");
+	addMetric("MedianTime");
+	addMetric("MeanTime");
+}
+
+LLMetricBenchmark::~LLMetricBenchmark()
+{
+}
+
+void LLMetricBenchmark::measure(U32 warmups, U32 repetitions)
+{
+	repetitions = llmax(repetitions, 1U);
+
+	setup();
+	for (U32 i = 0; i < warmups; ++i)
+	{
+		run(mIterations);
+	}
+
+	std::vector<F64> times;
+	LLTimer timer;
+	for (U32 i = 0; i < repetitions; ++i)
+	{
+		timer.reset();
+		run(mIterations);
+		times.push_back(timer.getElapsedTimeF64() * 1000000.0 / mIterations);
+	}
+	teardown();
+
+	std::sort(times.begin(), times.end());
+	mRepetitions = repetitions;
+	mMinTime = times.front();
+	mMedianTime = (repetitions & 1) ? times[repetitions / 2]
+									: (times[repetitions / 2 - 1] + times[repetitions / 2]) * 0.5;
+	F64 sum = 0.0;
+	for (U32 i = 0; i < repetitions; ++i)
+	{
+		sum += times[i];
+	}
+	mMeanTime = sum / repetitions;
+	F64 variance = 0.0;
+	for (U32 i = 0; i < repetitions; ++i)
+	{
+		variance += (times[i] - mMeanTime) * (times[i] - mMeanTime);
+	}
+	mStdDevTime = repetitions > 1 ? sqrt(variance / (repetitions - 1)) : 0.0;
+}
+
+void LLMetricBenchmark::getResults(LLSD& record) const
+{
+	record["Iterations"] = (S32)mIterations;
+	record["Repetitions"] = (S32)mRepetitions;
+	record["MinTime"] = mMinTime;
+	record["MedianTime"] = mMedianTime;
+	record["MeanTime"] = mMeanTime;
+	record["StdDevTime"] = mStdDevTime;
+}
+
+/*virtual*/
+void LLMetricBenchmark::outputTestRecord(LLSD* sd)
+{
+	// same metrics as the results file, so --analyzeperformance compares them too
+	LLSD record;
+	getResults(record);
+	std::string label = getCurrentLabelName();
+	(*sd)[label]["MinTime"] = record["MinTime"];
+	(*sd)[label]["MedianTime"] = record["MedianTime"];
+	(*sd)[label]["MeanTime"] = record["MeanTime"];
+}
+
+//----------------------------------------------------------------------------------------------
+// LLMetricBenchmark : static methods and benchmark registry
+//----------------------------------------------------------------------------------------------
+
+//static
+LLMetricBenchmark::factory_list_t& LLMetricBenchmark::getFactories()
+{
+	// function static, Registrars run during static initialization
+	static factory_list_t sFactories;
+	return sFactories;
+}
+
+//static
+void LLMetricBenchmark::addFactory(const std::string& name, factory_t factory)
+{
+	getFactories().push_back(std::make_pair(name, factory));
+}
+
+//static
+S32 LLMetricBenchmark::runBenchmarks(const std::string& filter, U32 warmups, U32 repetitions, LLSD& results)
+{
+	S32 count = 0;
+	factory_list_t& factories = getFactories();
+	for (factory_list_t::iterator iter = factories.begin(); iter != factories.end(); ++iter)
+	{
+		const std::string& name = iter->first;
+		if (!filter.empty() && name.find(filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		LLMetricBenchmark* benchmark = iter->second(name);
+		if (benchmark->isValid())
+		{
+			benchmark->measure(warmups, repetitions);
+			benchmark->getResults(results[name]);
+			if (isMetricLogRequested(name))
+			{
+				benchmark->outputTestResults();
+			}
+			llinfos << "Benchmark " << name << ": median " << benchmark->getMedianTime()
+					<< " usec, min " << benchmark->getMinTime() << " usec, std dev "
+					<< benchmark->getStdDevTime() << " usec per iteration" << llendl;
+			count++;
+		}
+		delete benchmark;
+	}
+	return count;
+}
+
+//static
+S32 LLMetricBenchmark::compareToBaseline(const LLSD& baseline, LLSD& results, F64 tolerance)
+{
+	S32 regressions = 0;
+	for (LLSD::map_iterator iter = results.beginMap(); iter != results.endMap(); ++iter)
+	{
+		if (!baseline.has(iter->first))
+		{
+			continue;
+		}
+		const LLSD& base = baseline[iter->first];
+		LLSD& current = iter->second;
+
+		F64 base_median = base["MedianTime"].asReal();
+		F64 allowed = llmax(base_median * tolerance, base["StdDevTime"].asReal() * 2.0);
+		bool regressed = current["MedianTime"].asReal() - base_median > allowed;
+		current["BaselineMedianTime"] = base_median;
+		current["Regression"] = regressed;
+		if (regressed)
+		{
+			llwarns << "Benchmark " << iter->first << " regressed: median " << current["MedianTime"].asReal()
+					<< " usec, was " << base_median << " usec" << llendl;
+			regressions++;
+		}
+	}
+	return regressions;
+}
+
+//static
+bool LLMetricBenchmark::saveResults(const std::string& filename, const LLSD& results)
+{
+	llofstream os(filename);
+	if (!os.is_open())
+	{
+		llwarns << "Unable to write benchmark results to " << filename << llendl;
+		return false;
+	}
+	LLSDSerialize::toPrettyXML(results, os);
+	os.close();
+	return true;
+}
+
+//static
+bool LLMetricBenchmark::loadResults(const std::string& filename, LLSD& results)
+{
+	llifstream is(filename);
+	if (!is.is_open())
+	{
+		llwarns << "Unable to read benchmark results from " << filename << llendl;
+		return false;
+	}
+	bool success = LLSDSerialize::fromXML(results, is) > 0 && results.isMap();
+	is.close();
+	return success;
+}
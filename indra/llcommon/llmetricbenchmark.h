@@ -0,0 +1,153 @@
+/**
+ * @file llmetricbenchmark.h
+ * @brief LLMetricBenchmark class definition
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMETRICBENCHMARK_H
+#define LL_LLMETRICBENCHMARK_H
+
+#include "llsd.h"
+#include "llmetricperformancetester.h"
+
+#include <vector>
+
+/**
+ * @class LLMetricBenchmark
+ * @brief Performance tester that times a piece of code it runs itself.
+ *
+ * A micro benchmark runs a small operation many times per repetition, a
+ * scenario benchmark runs a whole workload once per repetition.  Either
+ * way the times are per iteration, in microseconds.
+ *
+ * Benchmarks are registered with a static Registrar and only created when
+ * they are run, by runBenchmarks().  Every test executable runs the ones
+ * linked into it with --benchmark, and compares them to an earlier run
+ * with --baseline.
+ */
+class LL_COMMON_API LLMetricBenchmark : public LLMetricPerformanceTesterBasic
+{
+public:
+	/**
+	 * @param[in] name - Unique string identifying this benchmark.
+	 * @param[in] iterations - Times run() repeats the operation per repetition, 1 for a scenario.
+	 */
+	LLMetricBenchmark(const std::string& name, U32 iterations = 1);
+	virtual ~LLMetricBenchmark();
+
+	/**
+	 * @brief Runs the benchmark warmups times untimed, then repetitions times timed.
+	 */
+	void measure(U32 warmups, U32 repetitions);
+
+	/**
+	 * @return Returns the time per iteration statistics of the last measure(), as microseconds.
+	 */
+	F64 getMinTime() const { return mMinTime; }
+	F64 getMedianTime() const { return mMedianTime; }
+	F64 getMeanTime() const { return mMeanTime; }
+	F64 getStdDevTime() const { return mStdDevTime; }
+
+	/**
+	 * @brief Writes the statistics of the last measure() as a record keyed by the benchmark name.
+	 */
+	void getResults(LLSD& record) const;
+
+protected:
+	/**
+	 * @brief Prepares the data the timed runs use. Not timed.
+	 */
+	virtual void setup() {}
+
+	/**
+	 * @brief Does the work being measured, iterations times over.
+	 */
+	virtual void run(U32 iterations) = 0;
+
+	/**
+	 * @brief Releases what setup() made. Not timed.
+	 */
+	virtual void teardown() {}
+
+	/*virtual*/ void outputTestRecord(LLSD* sd);
+
+private:
+	U32 mIterations;
+	U32 mRepetitions;
+	F64 mMinTime;
+	F64 mMedianTime;
+	F64 mMeanTime;
+	F64 mStdDevTime;
+
+// Static members managing the registered benchmarks
+public:
+	typedef LLMetricBenchmark* (*factory_t)(const std::string& name);
+
+	/**
+	 * @class LLMetricBenchmark::Registrar
+	 * @brief Declare one of these statically to make a benchmark available to runBenchmarks().
+	 * T needs a constructor taking the benchmark name.
+	 */
+	template <class T>
+	class Registrar
+	{
+	public:
+		Registrar(const std::string& name)
+		{
+			LLMetricBenchmark::addFactory(name, &Registrar<T>::create);
+		}
+
+	private:
+		static LLMetricBenchmark* create(const std::string& name) { return new T(name); }
+	};
+
+	/**
+	 * @brief Measures every registered benchmark whose name contains filter, one at a time.
+	 * @param[out] results - A map of benchmark names to their getResults() records.
+	 * @return Returns the number of benchmarks run.
+	 */
+	static S32 runBenchmarks(const std::string& filter, U32 warmups, U32 repetitions, LLSD& results);
+
+	/**
+	 * @brief Flags the results whose median time grew past what the baseline allows.
+	 * A slowdown counts when it is more than tolerance, as a fraction of the baseline
+	 * median, and more than twice the baseline's standard deviation, so noise alone
+	 * does not fail a run.  Adds "BaselineMedianTime" and "Regression" to each result
+	 * that the baseline also has.
+	 * @return Returns the number of regressions.
+	 */
+	static S32 compareToBaseline(const LLSD& baseline, LLSD& results, F64 tolerance);
+
+	/**
+	 * @brief Read and write results as LLSD XML.
+	 */
+	static bool saveResults(const std::string& filename, const LLSD& results);
+	static bool loadResults(const std::string& filename, LLSD& results);
+
+private:
+	typedef std::vector<std::pair<std::string, factory_t> > factory_list_t;
+	static factory_list_t& getFactories();
+	static void addFactory(const std::string& name, factory_t factory);
+};
+
+#endif // LL_LLMETRICBENCHMARK_H
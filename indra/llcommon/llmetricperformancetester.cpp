@@ -42,11 +42,13 @@ LLMetricPerformanceTesterBasic::name_tester_map_t LLMetricPerformanceTesterBasic
 /*static*/ 
 void LLMetricPerformanceTesterBasic::cleanClass() 
 {
-	for (name_tester_map_t::iterator iter = sTesterMap.begin() ; iter != sTesterMap.end() ; ++iter)
+	// testers remove themselves from the map when deleted
+	name_tester_map_t testers ;
+	testers.swap(sTesterMap) ;
+	for (name_tester_map_t::iterator iter = testers.begin() ; iter != testers.end() ; ++iter)
 	{
 		delete iter->second ;
 	}
-	sTesterMap.clear() ;
 }
 
 /*static*/ 
@@ -102,6 +104,10 @@ LLMetricPerformanceTesterBasic::LLMetricPerformanceTesterBasic(std::string name)
 
 LLMetricPerformanceTesterBasic::~LLMetricPerformanceTesterBasic() 
 {
+	if (mValidInstance)
+	{
+		sTesterMap.erase(mName) ;
+	}
 }
 
 void LLMetricPerformanceTesterBasic::preOutputTestResults(LLSD* sd) 
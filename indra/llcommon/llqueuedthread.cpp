@@ -32,16 +32,28 @@
 //============================================================================
 
 // MAIN THREAD
-LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded) :
+LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, U32 num_workers) :
 	LLThread(name),
 	mThreaded(threaded),
 	mIdleThread(TRUE),
 	mNextHandle(0),
-	mStarted(FALSE)
+	mStarted(FALSE),
+	mActiveRequests(0),
+	mStatProcessed(0),
+	mStatMaxDepth(0),
+	mStatWaitTime(0),
+	mStatProcessTime(0),
+	mUpdateTimer("Queue " + name)
 {
 	if (mThreaded)
 	{
 		start();
+		for (U32 i = 1; i < num_workers; i++)
+		{
+			QueuedWorker* worker = new QueuedWorker(llformat("%s %d", name.c_str(), i), this);
+			mWorkers.push_back(worker);
+			worker->start();
+		}
 	}
 }
 
@@ -61,6 +73,7 @@ void LLQueuedThread::shutdown()
 	setQuitting();
 
 	unpause(); // MAIN THREAD
+	wakeWorkers();
 	if (mThreaded)
 	{
 		S32 timeout = 100;
@@ -83,6 +96,10 @@ void LLQueuedThread::shutdown()
 		mStatus = STOPPED;
 	}
 
+	// ~LLThread() waits for each worker to leave run()
+	for_each(mWorkers.begin(), mWorkers.end(), DeletePointer());
+	mWorkers.clear();
+
 	QueuedRequest* req;
 	S32 active_count = 0;
 	while ( (req = (QueuedRequest*)mRequestHash.pop_element()) )
@@ -119,6 +136,7 @@ S32 LLQueuedThread::update(U32 max_time_ms)
 
 S32 LLQueuedThread::updateQueue(U32 max_time_ms)
 {
+	LLFastTimer t(mUpdateTimer);
 	F64 max_time = (F64)max_time_ms * .001;
 	LLTimer timer;
 	S32 pending = 1;
@@ -129,8 +147,12 @@ S32 LLQueuedThread::updateQueue(U32 max_time_ms)
 		pending = getPending();
 		if(pending > 0)
 		{
-		unpause();
-	}
+			unpause();
+			if (pending > 1)
+			{
+				wakeWorkers();
+			}
+		}
 	}
 	else
 	{
@@ -174,7 +196,7 @@ void LLQueuedThread::waitOnPending()
 	{
 		update(0);
 
-		if (mIdleThread)
+		if (mIdleThread && mActiveRequests.CurrentValue() == 0)
 		{
 			break;
 		}
@@ -199,6 +221,35 @@ void LLQueuedThread::printQueueStats()
 	{
 		llinfos << "Queued Thread Idle" << llendl;
 	}
+	if (mStatProcessed)
+	{
+		llinfos << llformat("%s: workers:%d processed:%d max depth:%d avg wait:%.2fms avg process:%.2fms",
+							mName.c_str(), getNumWorkers(), mStatProcessed, mStatMaxDepth,
+							(F32)(mStatWaitTime / mStatProcessed) * .001f,
+							(F32)(mStatProcessTime / mStatProcessed) * .001f) << llendl;
+	}
+	unlockData();
+}
+
+// May be called from any thread
+void LLQueuedThread::getQueueStats(U32& processed, U32& max_depth, F32& avg_wait_ms, F32& avg_process_ms)
+{
+	lockData();
+	processed = mStatProcessed;
+	max_depth = mStatMaxDepth;
+	avg_wait_ms = mStatProcessed ? (F32)(mStatWaitTime / mStatProcessed) * .001f : 0.f;
+	avg_process_ms = mStatProcessed ? (F32)(mStatProcessTime / mStatProcessed) * .001f : 0.f;
+	unlockData();
+}
+
+// May be called from any thread
+void LLQueuedThread::resetQueueStats()
+{
+	lockData();
+	mStatProcessed = 0;
+	mStatMaxDepth = 0;
+	mStatWaitTime = 0;
+	mStatProcessTime = 0;
 	unlockData();
 }
 
@@ -225,8 +276,10 @@ bool LLQueuedThread::addRequest(QueuedRequest* req)
 	
 	lockData();
 	req->setStatus(STATUS_QUEUED);
+	req->mQueuedTime = LLTimer::getTotalTime();
 	mRequestQueue.insert(req);
 	mRequestHash.insert(req);
+	mStatMaxDepth = llmax(mStatMaxDepth, (U32)mRequestQueue.size());
 #if _DEBUG
 // 	llinfos << llformat("LLQueuedThread::Added req [%08d]",handle) << llendl;
 #endif
@@ -391,7 +444,7 @@ bool LLQueuedThread::check()
 }		
 	
 //============================================================================
-// Runs on its OWN thread
+// Runs on its OWN thread (or one of the QueuedWorker threads)
 
 S32 LLQueuedThread::processNextRequest()
 {
@@ -405,8 +458,8 @@ S32 LLQueuedThread::processNextRequest()
 		{
 			break;
 		}
-		req = *mRequestQueue.begin();
-		mRequestQueue.erase(mRequestQueue.begin());
+		req = mRequestQueue.top();
+		mRequestQueue.erase(req);
 		if ((req->getFlags() & FLAG_ABORT) || (mStatus == QUITTING))
 		{
 			req->setStatus(STATUS_ABORTED);
@@ -423,10 +476,14 @@ S32 LLQueuedThread::processNextRequest()
 		break;
 	}
 	U32 start_priority = 0 ;
+	U64 start_time = 0;
 	if (req)
 	{
 		req->setStatus(STATUS_INPROGRESS);
 		start_priority = req->getPriority();
+		start_time = LLTimer::getTotalTime();
+		mStatWaitTime += start_time - req->mQueuedTime;
+		mActiveRequests++;
 	}
 	unlockData();
 
@@ -437,10 +494,14 @@ S32 LLQueuedThread::processNextRequest()
 	{
 		// process request		
 		bool complete = req->processRequest();
+		U64 process_time = LLTimer::getTotalTime() - start_time;
 
 		if (complete)
 		{
 			lockData();
+			mStatProcessed++;
+			mStatProcessTime += process_time;
+			mActiveRequests--;
 			req->setStatus(STATUS_COMPLETE);
 			req->finishRequest(true);
 			if (req->getFlags() & FLAG_AUTO_COMPLETE)
@@ -454,7 +515,10 @@ S32 LLQueuedThread::processNextRequest()
 		else
 		{
 			lockData();
+			mStatProcessTime += process_time;
+			mActiveRequests--;
 			req->setStatus(STATUS_QUEUED);
+			req->mQueuedTime = LLTimer::getTotalTime();
 			mRequestQueue.insert(req);
 			unlockData();
 			if (mThreaded && start_priority < PRIORITY_NORMAL)
@@ -513,6 +577,31 @@ void LLQueuedThread::run()
 	llinfos << "LLQueuedThread " << mName << " EXITING." << llendl;
 }
 
+// Runs on a QueuedWorker thread
+// Blocks until there is a request to process, returns false once the queue is quitting
+bool LLQueuedThread::waitForWork()
+{
+	lockData();
+	while (mStatus == RUNNING && (isPaused() || mRequestQueue.empty()))
+	{
+		mRunCondition->wait(); // unlocks mRunCondition
+	}
+	bool res = (mStatus == RUNNING);
+	unlockData();
+	return res;
+}
+
+// Wakes the queue thread and all of its workers
+void LLQueuedThread::wakeWorkers()
+{
+	if (!mWorkers.empty())
+	{
+		lockData();
+		mRunCondition->broadcast();
+		unlockData();
+	}
+}
+
 // virtual
 void LLQueuedThread::startThread()
 {
@@ -530,11 +619,205 @@ void LLQueuedThread::threadedUpdate()
 
 //============================================================================
 
+// Index of the highest set bit, v must be non-zero
+static inline S32 highest_bit(U32 v)
+{
+#if LL_WINDOWS
+	unsigned long index;
+	_BitScanReverse(&index, v);
+	return (S32)index;
+#else
+	return 31 - __builtin_clz(v);
+#endif
+}
+
+LLQueuedThread::RequestQueue::RequestQueue() :
+	mTop(0),
+	mSize(0)
+{
+	memset(mBuckets, 0, sizeof(mBuckets));
+	memset(mMask, 0, sizeof(mMask));
+	memset(mSummary, 0, sizeof(mSummary));
+}
+
+//static
+S32 LLQueuedThread::RequestQueue::getBucket(U32 priority)
+{
+	return llmin((S32)(priority >> BUCKET_SHIFT), (S32)NUM_BUCKETS - 1);
+}
+
+void LLQueuedThread::RequestQueue::setBucketBit(S32 bucket)
+{
+	S32 word = bucket >> 5;
+	mMask[word] |= 1U << (bucket & 31);
+	mSummary[word >> 5] |= 1U << (word & 31);
+	mTop |= 1U << (word >> 5);
+}
+
+void LLQueuedThread::RequestQueue::clearBucketBit(S32 bucket)
+{
+	S32 word = bucket >> 5;
+	mMask[word] &= ~(1U << (bucket & 31));
+	if (!mMask[word])
+	{
+		mSummary[word >> 5] &= ~(1U << (word & 31));
+		if (!mSummary[word >> 5])
+		{
+			mTop &= ~(1U << (word >> 5));
+		}
+	}
+}
+
+S32 LLQueuedThread::RequestQueue::highestBucket() const
+{
+	if (!mTop)
+	{
+		return -1;
+	}
+	S32 summary = highest_bit(mTop);
+	S32 word = (summary << 5) + highest_bit(mSummary[summary]);
+	return (word << 5) + highest_bit(mMask[word]);
+}
+
+S32 LLQueuedThread::RequestQueue::nextBucketBelow(S32 bucket) const
+{
+	// remaining buckets in the same mask word
+	S32 word = bucket >> 5;
+	U32 bits = mMask[word] & ((1U << (bucket & 31)) - 1);
+	if (bits)
+	{
+		return (word << 5) + highest_bit(bits);
+	}
+	// remaining words in the same summary word
+	S32 summary = word >> 5;
+	bits = mSummary[summary] & ((1U << (word & 31)) - 1);
+	if (!bits)
+	{
+		// remaining summary words
+		bits = mTop & ((1U << summary) - 1);
+		if (!bits)
+		{
+			return -1;
+		}
+		summary = highest_bit(bits);
+		bits = mSummary[summary];
+	}
+	word = (summary << 5) + highest_bit(bits);
+	return (word << 5) + highest_bit(mMask[word]);
+}
+
+void LLQueuedThread::RequestQueue::insert(QueuedRequest* req)
+{
+	llassert(!req->mQueueNext);
+	S32 bucket = getBucket(req->getPriority());
+	QueuedRequest* head = mBuckets[bucket];
+	if (head)
+	{
+		// append at the tail, which is head->mQueuePrev
+		req->mQueuePrev = head->mQueuePrev;
+		req->mQueueNext = head;
+		head->mQueuePrev->mQueueNext = req;
+		head->mQueuePrev = req;
+	}
+	else
+	{
+		req->mQueuePrev = req;
+		req->mQueueNext = req;
+		mBuckets[bucket] = req;
+		setBucketBit(bucket);
+	}
+	mSize++;
+}
+
+size_t LLQueuedThread::RequestQueue::erase(QueuedRequest* req)
+{
+	if (!req->mQueueNext)
+	{
+		return 0;
+	}
+	S32 bucket = getBucket(req->getPriority());
+	if (req->mQueueNext == req)
+	{
+		// only entry in its bucket
+		mBuckets[bucket] = NULL;
+		clearBucketBit(bucket);
+	}
+	else
+	{
+		req->mQueuePrev->mQueueNext = req->mQueueNext;
+		req->mQueueNext->mQueuePrev = req->mQueuePrev;
+		if (mBuckets[bucket] == req)
+		{
+			mBuckets[bucket] = req->mQueueNext;
+		}
+	}
+	req->mQueuePrev = NULL;
+	req->mQueueNext = NULL;
+	mSize--;
+	return 1;
+}
+
+LLQueuedThread::QueuedRequest* LLQueuedThread::RequestQueue::top() const
+{
+	S32 bucket = highestBucket();
+	return bucket < 0 ? NULL : mBuckets[bucket];
+}
+
+LLQueuedThread::RequestQueue::const_iterator::const_iterator(const RequestQueue* queue, S32 bucket) :
+	mQueue(queue),
+	mBucket(bucket),
+	mRequest(bucket < 0 ? NULL : queue->mBuckets[bucket])
+{
+}
+
+LLQueuedThread::RequestQueue::const_iterator& LLQueuedThread::RequestQueue::const_iterator::operator++()
+{
+	mRequest = mQueue->next(mBucket, mRequest);
+	return *this;
+}
+
+// Request following req in queue order, bucket is updated when moving on to
+// the next non-empty bucket
+LLQueuedThread::QueuedRequest* LLQueuedThread::RequestQueue::next(S32& bucket, QueuedRequest* req) const
+{
+	req = req->mQueueNext;
+	if (req == mBuckets[bucket])
+	{
+		// wrapped around
+		bucket = nextBucketBelow(bucket);
+		req = bucket < 0 ? NULL : mBuckets[bucket];
+	}
+	return req;
+}
+
+//============================================================================
+
+LLQueuedThread::QueuedWorker::QueuedWorker(const std::string& name, LLQueuedThread* owner) :
+	LLThread(name),
+	mOwner(owner)
+{
+}
+
+// virtual
+void LLQueuedThread::QueuedWorker::run()
+{
+	while (mOwner->waitForWork())
+	{
+		mOwner->processNextRequest();
+	}
+	llinfos << "QueuedWorker " << mName << " EXITING." << llendl;
+}
+
+//============================================================================
+
 LLQueuedThread::QueuedRequest::QueuedRequest(LLQueuedThread::handle_t handle, U32 priority, U32 flags) :
 	LLSimpleHashEntry<LLQueuedThread::handle_t>(handle),
 	mStatus(STATUS_UNKNOWN),
 	mPriority(priority),
-	mFlags(flags)
+	mFlags(flags),
+	mQueuedTime(0),
+	mQueuePrev(NULL),
+	mQueueNext(NULL)
 {
 }
 
@@ -31,15 +31,20 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "llapr.h"
 
 #include "llthread.h"
 #include "llsimplehash.h"
+#include "llfasttimer.h"
 
 //============================================================================
 // Note: ~LLQueuedThread is O(N) N=# of queued threads, assumed to be small
 //   It is assumed that LLQueuedThreads are rarely created/destroyed.
+// A threaded LLQueuedThread may be given num_workers > 1, in which case
+//   additional worker threads service the same request queue. Only use this
+//   when processRequest() is safe to run on several requests concurrently.
 
 class LL_COMMON_API LLQueuedThread : public LLThread
 {
@@ -71,12 +76,17 @@ public:
 
 	typedef U32 handle_t;
 	
+	//------------------------------------------------------------------------
+protected:
+	class RequestQueue;
+
 	//------------------------------------------------------------------------
 public:
 
 	class LL_COMMON_API QueuedRequest : public LLSimpleHashEntry<handle_t>
 	{
 		friend class LLQueuedThread;
+		friend class RequestQueue;
 		
 	protected:
 		virtual ~QueuedRequest(); // use deleteRequest()
@@ -131,25 +141,91 @@ public:
 		LLAtomic32<status_t> mStatus;
 		U32 mPriority;
 		U32 mFlags;
+		U64 mQueuedTime; // usec, when the request last entered the queue
+
+		// RequestQueue links, NULL when the request is not queued
+		QueuedRequest* mQueuePrev;
+		QueuedRequest* mQueueNext;
 	};
 
 protected:
-	struct queued_request_less
+	// Pending requests, bucketed by the top bits of their priority.
+	// Each bucket is an intrusive circular list kept in arrival order, and a
+	// three level bitmask of non-empty buckets finds the highest priority
+	// request, so insert, erase (and therefore setPriority) and pop are O(1).
+	// Requests whose priorities share a bucket are served first come first served.
+	class LL_COMMON_API RequestQueue
 	{
-		bool operator()(const QueuedRequest* lhs, const QueuedRequest* rhs) const
+	public:
+		enum
 		{
-			return lhs->higherPriority(*rhs); // higher priority in front of queue (set)
-		}
+			BUCKET_SHIFT = 19, // 31 significant priority bits -> 4096 buckets
+			NUM_BUCKETS = 1 << (31 - BUCKET_SHIFT),
+			NUM_MASK_WORDS = NUM_BUCKETS / 32,
+			NUM_SUMMARY_WORDS = NUM_MASK_WORDS / 32
+		};
+
+		class const_iterator
+		{
+		public:
+			const_iterator() : mQueue(NULL), mBucket(-1), mRequest(NULL) {}
+			const_iterator(const RequestQueue* queue, S32 bucket);
+			QueuedRequest* operator*() const { return mRequest; }
+			const_iterator& operator++();
+			bool operator==(const const_iterator& rhs) const { return mRequest == rhs.mRequest; }
+			bool operator!=(const const_iterator& rhs) const { return mRequest != rhs.mRequest; }
+		private:
+			const RequestQueue* mQueue;
+			S32 mBucket;
+			QueuedRequest* mRequest;
+		};
+		typedef const_iterator iterator;
+
+		RequestQueue();
+
+		void insert(QueuedRequest* req);
+		size_t erase(QueuedRequest* req); // returns 1 if req was queued, 0 otherwise
+		QueuedRequest* top() const; // highest priority request, or NULL
+
+		bool empty() const { return mSize == 0; }
+		size_t size() const { return mSize; }
+		const_iterator begin() const { return const_iterator(this, highestBucket()); }
+		const_iterator end() const { return const_iterator(); }
+
+	private:
+		static S32 getBucket(U32 priority);
+		S32 highestBucket() const; // -1 if empty
+		S32 nextBucketBelow(S32 bucket) const; // -1 if none
+		QueuedRequest* next(S32& bucket, QueuedRequest* req) const;
+		void setBucketBit(S32 bucket);
+		void clearBucketBit(S32 bucket);
+
+		QueuedRequest* mBuckets[NUM_BUCKETS]; // head of each circular list
+		U32 mMask[NUM_MASK_WORDS];			// bit per non-empty bucket
+		U32 mSummary[NUM_SUMMARY_WORDS];	// bit per non-zero mMask word
+		U32 mTop;							// bit per non-zero mSummary word
+		size_t mSize;
 	};
 
 
+	// Additional thread that services the owning LLQueuedThread's queue
+	class QueuedWorker : public LLThread
+	{
+	public:
+		QueuedWorker(const std::string& name, LLQueuedThread* owner);
+	private:
+		virtual void run(void);
+		LLQueuedThread* mOwner;
+	};
+	friend class QueuedWorker;
+
 	//------------------------------------------------------------------------
 	
 public:
 	static handle_t nullHandle() { return handle_t(0); }
 	
 public:
-	LLQueuedThread(const std::string& name, bool threaded = true);
+	LLQueuedThread(const std::string& name, bool threaded = true, U32 num_workers = 1);
 	virtual ~LLQueuedThread();	
 	virtual void shutdown();
 	
@@ -164,6 +240,9 @@ private:
 	virtual void endThread(void);
 	virtual void threadedUpdate(void);
 
+	bool waitForWork();
+	void wakeWorkers();
+
 protected:
 	handle_t generateHandle();
 	bool addRequest(QueuedRequest* req);
@@ -181,6 +260,11 @@ public:
 
 	S32 getPending();
 	bool getThreaded() { return mThreaded ? true : false; }
+	U32 getNumWorkers() const { return mThreaded ? mWorkers.size() + 1 : 0; }
+
+	// Queue statistics since the last resetQueueStats(), in milliseconds
+	void getQueueStats(U32& processed, U32& max_depth, F32& avg_wait_ms, F32& avg_process_ms);
+	void resetQueueStats();
 
 	// Request accessors
 	status_t getRequestStatus(handle_t handle);
@@ -200,7 +284,7 @@ protected:
 	BOOL mStarted;  // required when mThreaded is false to call startThread() from update()
 	LLAtomic32<BOOL> mIdleThread; // request queue is empty (or we are quitting) and the thread is idle
 	
-	typedef std::set<QueuedRequest*, queued_request_less> request_queue_t;
+	typedef RequestQueue request_queue_t;
 	request_queue_t mRequestQueue;
 
 	enum { REQUEST_HASH_SIZE = 512 }; // must be power of 2
@@ -208,6 +292,18 @@ protected:
 	request_hash_t mRequestHash;
 
 	handle_t mNextHandle;
+
+	typedef std::vector<QueuedWorker*> worker_list_t;
+	worker_list_t mWorkers;
+	LLAtomicS32 mActiveRequests; // requests currently inside processRequest()
+
+	// Guarded by the data lock; times are in usec
+	U32 mStatProcessed;
+	U32 mStatMaxDepth;
+	U64 mStatWaitTime;
+	U64 mStatProcessTime;
+
+	LLFastTimer::DeclareTimer mUpdateTimer;
 };
 
 #endif // LL_LLQUEUEDTHREAD_H
@@ -92,9 +92,6 @@ public:
 	static  void assignUndefined(LLSD::Impl*& var);
 	static  void assign(LLSD::Impl*& var, const LLSD::Impl* other);
 	
-	virtual void assign(Impl*& var, LLSD::Boolean);
-	virtual void assign(Impl*& var, LLSD::Integer);
-	virtual void assign(Impl*& var, LLSD::Real);
 	virtual void assign(Impl*& var, const LLSD::String&);
 	virtual void assign(Impl*& var, const LLSD::UUID&);
 	virtual void assign(Impl*& var, const LLSD::Date&);
@@ -102,7 +99,8 @@ public:
 	virtual void assign(Impl*& var, const LLSD::Binary&);
 		///< If the receiver is the right type and unshared, these are simple
 		//   data assignments, othewise the default implementation handless
-		//   constructing the proper Impl subclass
+		//   constructing the proper Impl subclass.  Boolean, Integer and
+		//   Real values are never stored in an Impl, see LLSD::isInline().
 		 
 	virtual Boolean	asBoolean() const			{ return false; }
 	virtual Integer	asInteger() const			{ return 0; }
@@ -170,65 +168,6 @@ namespace
 	};
 
 	
-	class ImplBoolean
-		: public ImplBase<LLSD::TypeBoolean, LLSD::Boolean>
-	{
-	public:
-		ImplBoolean(LLSD::Boolean v) : Base(v) { }
-		
-		virtual LLSD::Boolean	asBoolean() const	{ return mValue; }
-		virtual LLSD::Integer	asInteger() const	{ return mValue ? 1 : 0; }
-		virtual LLSD::Real		asReal() const		{ return mValue ? 1 : 0; }
-		virtual LLSD::String	asString() const;
-	};
-
-	LLSD::String ImplBoolean::asString() const
-		// *NOTE: The reason that false is not converted to "false" is
-		// because that would break roundtripping,
-		// e.g. LLSD(false).asString().asBoolean().  There are many
-		// reasons for wanting LLSD("false").asBoolean() == true, such
-		// as "everything else seems to work that way".
-		{ return mValue ? "true" : ""; }
-
-
-	class ImplInteger
-		: public ImplBase<LLSD::TypeInteger, LLSD::Integer>
-	{
-	public:
-		ImplInteger(LLSD::Integer v) : Base(v) { }
-		
-		virtual LLSD::Boolean	asBoolean() const	{ return mValue != 0; }
-		virtual LLSD::Integer	asInteger() const	{ return mValue; }
-		virtual LLSD::Real		asReal() const		{ return mValue; }
-		virtual LLSD::String	asString() const;
-	};
-
-	LLSD::String ImplInteger::asString() const
-		{ return llformat("%d", mValue); }
-
-
-	class ImplReal
-		: public ImplBase<LLSD::TypeReal, LLSD::Real>
-	{
-	public:
-		ImplReal(LLSD::Real v) : Base(v) { }
-				
-		virtual LLSD::Boolean	asBoolean() const;
-		virtual LLSD::Integer	asInteger() const;
-		virtual LLSD::Real		asReal() const		{ return mValue; }
-		virtual LLSD::String	asString() const;
-	};
-
-	LLSD::Boolean ImplReal::asBoolean() const
-		{ return !llisnan(mValue)  &&  mValue != 0.0; }
-		
-	LLSD::Integer ImplReal::asInteger() const
-		{ return !llisnan(mValue) ? (LLSD::Integer)mValue : 0; }
-		
-	LLSD::String ImplReal::asString() const
-		{ return llformat("%lg", mValue); }
-
-
 	class ImplString
 		: public ImplBase<LLSD::TypeString, LLSD::String, const LLSD::String&>
 	{
@@ -609,21 +548,6 @@ void LLSD::Impl::assignUndefined(Impl*& var)
 	reset(var, 0);
 }
 
-void LLSD::Impl::assign(Impl*& var, LLSD::Boolean v)
-{
-	reset(var, new ImplBoolean(v));
-}
-
-void LLSD::Impl::assign(Impl*& var, LLSD::Integer v)
-{
-	reset(var, new ImplInteger(v));
-}
-
-void LLSD::Impl::assign(Impl*& var, LLSD::Real v)
-{
-	reset(var, new ImplReal(v));
-}
-
 void LLSD::Impl::assign(Impl*& var, const LLSD::String& v)
 {
 	reset(var, new ImplString(v));
@@ -681,52 +605,141 @@ namespace
 }
 
 
-LLSD::LLSD()							: impl(0)	{ }
-LLSD::~LLSD()							{ Impl::reset(impl, 0); }
+LLSD::LLSD()							: impl(0), mInlineType(TypeUndefined) { }
+LLSD::~LLSD()							{ if (!isInline()) Impl::reset(impl, 0); }
 
-LLSD::LLSD(const LLSD& other)			: impl(0) { assign(other); }
-void LLSD::assign(const LLSD& other)	{ Impl::assign(impl, other.impl); }
+LLSD::LLSD(const LLSD& other)			: impl(0), mInlineType(TypeUndefined) { assign(other); }
+void LLSD::assign(const LLSD& other)
+{
+	if (other.isInline())
+	{
+		// copy first: other may be an element of the container being released
+		U8 type = other.mInlineType;
+		U64 bits = other.mInlineBits;
+		clear();
+		mInlineType = type;
+		mInlineBits = bits;
+	}
+	else
+	{
+		Impl::assign(writableImpl(), other.impl);
+	}
+}
 
 
-void LLSD::clear()						{ Impl::assignUndefined(impl); }
+void LLSD::clear()
+{
+	if (isInline())
+	{
+		mInlineType = TypeUndefined;
+		impl = 0;
+	}
+	else
+	{
+		Impl::assignUndefined(impl);
+	}
+}
 
-LLSD::Type LLSD::type() const			{ return safe(impl).type(); }
+LLSD::Type LLSD::type() const
+{
+	return isInline() ? (Type)mInlineType : safe(impl).type();
+}
+
+LLSD::Impl*& LLSD::writableImpl()
+{
+	if (isInline())
+	{
+		mInlineType = TypeUndefined;
+		impl = 0;
+	}
+	return impl;
+}
+
+const LLSD::Impl& LLSD::readableImpl() const
+{
+	return safe(isInline() ? NULL : impl);
+}
 
 // Scaler Constructors
-LLSD::LLSD(Boolean v)					: impl(0) { assign(v); }
-LLSD::LLSD(Integer v)					: impl(0) { assign(v); }
-LLSD::LLSD(Real v)						: impl(0) { assign(v); }
-LLSD::LLSD(const UUID& v)				: impl(0) { assign(v); }
-LLSD::LLSD(const String& v)				: impl(0) { assign(v); }
-LLSD::LLSD(const Date& v)				: impl(0) { assign(v); }
-LLSD::LLSD(const URI& v)				: impl(0) { assign(v); }
-LLSD::LLSD(const Binary& v)				: impl(0) { assign(v); }
+LLSD::LLSD(Boolean v)					: impl(0), mInlineType(TypeUndefined) { assign(v); }
+LLSD::LLSD(Integer v)					: impl(0), mInlineType(TypeUndefined) { assign(v); }
+LLSD::LLSD(Real v)						: impl(0), mInlineType(TypeUndefined) { assign(v); }
+LLSD::LLSD(const UUID& v)				: impl(0), mInlineType(TypeUndefined) { assign(v); }
+LLSD::LLSD(const String& v)				: impl(0), mInlineType(TypeUndefined) { assign(v); }
+LLSD::LLSD(const Date& v)				: impl(0), mInlineType(TypeUndefined) { assign(v); }
+LLSD::LLSD(const URI& v)				: impl(0), mInlineType(TypeUndefined) { assign(v); }
+LLSD::LLSD(const Binary& v)				: impl(0), mInlineType(TypeUndefined) { assign(v); }
 
 // Convenience Constructors
-LLSD::LLSD(F32 v)						: impl(0) { assign((Real)v); }
+LLSD::LLSD(F32 v)						: impl(0), mInlineType(TypeUndefined) { assign((Real)v); }
 
 // Scalar Assignment
-void LLSD::assign(Boolean v)			{ safe(impl).assign(impl, v); }
-void LLSD::assign(Integer v)			{ safe(impl).assign(impl, v); }
-void LLSD::assign(Real v)				{ safe(impl).assign(impl, v); }
-void LLSD::assign(const String& v)		{ safe(impl).assign(impl, v); }
-void LLSD::assign(const UUID& v)		{ safe(impl).assign(impl, v); }
-void LLSD::assign(const Date& v)		{ safe(impl).assign(impl, v); }
-void LLSD::assign(const URI& v)			{ safe(impl).assign(impl, v); }
-void LLSD::assign(const Binary& v)		{ safe(impl).assign(impl, v); }
+void LLSD::assign(Boolean v)			{ clear(); mInlineType = TypeBoolean; mBoolean = v; }
+void LLSD::assign(Integer v)			{ clear(); mInlineType = TypeInteger; mInteger = v; }
+void LLSD::assign(Real v)				{ clear(); mInlineType = TypeReal; mReal = v; }
+void LLSD::assign(const String& v)		{ Impl*& var = writableImpl(); safe(var).assign(var, v); }
+void LLSD::assign(const UUID& v)		{ Impl*& var = writableImpl(); safe(var).assign(var, v); }
+void LLSD::assign(const Date& v)		{ Impl*& var = writableImpl(); safe(var).assign(var, v); }
+void LLSD::assign(const URI& v)			{ Impl*& var = writableImpl(); safe(var).assign(var, v); }
+void LLSD::assign(const Binary& v)		{ Impl*& var = writableImpl(); safe(var).assign(var, v); }
 
 // Scalar Accessors
-LLSD::Boolean	LLSD::asBoolean() const	{ return safe(impl).asBoolean(); }
-LLSD::Integer	LLSD::asInteger() const	{ return safe(impl).asInteger(); }
-LLSD::Real		LLSD::asReal() const	{ return safe(impl).asReal(); }
-LLSD::String	LLSD::asString() const	{ return safe(impl).asString(); }
-LLSD::UUID		LLSD::asUUID() const	{ return safe(impl).asUUID(); }
-LLSD::Date		LLSD::asDate() const	{ return safe(impl).asDate(); }
-LLSD::URI		LLSD::asURI() const		{ return safe(impl).asURI(); }
-LLSD::Binary	LLSD::asBinary() const	{ return safe(impl).asBinary(); }
+LLSD::Boolean LLSD::asBoolean() const
+{
+	switch (mInlineType)
+	{
+	case TypeBoolean:	return mBoolean;
+	case TypeInteger:	return mInteger != 0;
+	case TypeReal:		return !llisnan(mReal)  &&  mReal != 0.0;
+	default:			return safe(impl).asBoolean();
+	}
+}
+
+LLSD::Integer LLSD::asInteger() const
+{
+	switch (mInlineType)
+	{
+	case TypeBoolean:	return mBoolean ? 1 : 0;
+	case TypeInteger:	return mInteger;
+	case TypeReal:		return !llisnan(mReal) ? (Integer)mReal : 0;
+	default:			return safe(impl).asInteger();
+	}
+}
+
+LLSD::Real LLSD::asReal() const
+{
+	switch (mInlineType)
+	{
+	case TypeBoolean:	return mBoolean ? 1 : 0;
+	case TypeInteger:	return mInteger;
+	case TypeReal:		return mReal;
+	default:			return safe(impl).asReal();
+	}
+}
+
+LLSD::String LLSD::asString() const
+{
+	switch (mInlineType)
+	{
+	// *NOTE: The reason that false is not converted to "false" is
+	// because that would break roundtripping,
+	// e.g. LLSD(false).asString().asBoolean().  There are many
+	// reasons for wanting LLSD("false").asBoolean() == true, such
+	// as "everything else seems to work that way".
+	case TypeBoolean:	return mBoolean ? "true" : "";
+	case TypeInteger:	return llformat("%d", mInteger);
+	case TypeReal:		return llformat("%lg", mReal);
+	default:			return safe(impl).asString();
+	}
+}
+
+LLSD::UUID		LLSD::asUUID() const	{ return readableImpl().asUUID(); }
+LLSD::Date		LLSD::asDate() const	{ return readableImpl().asDate(); }
+LLSD::URI		LLSD::asURI() const		{ return readableImpl().asURI(); }
+LLSD::Binary	LLSD::asBinary() const	{ return readableImpl().asBinary(); }
 
 // const char * helpers
-LLSD::LLSD(const char* v)				: impl(0) { assign(v); }
+LLSD::LLSD(const char* v)				: impl(0), mInlineType(TypeUndefined) { assign(v); }
 void LLSD::assign(const char* v)
 {
 	if(v) assign(std::string(v));
@@ -741,21 +754,21 @@ LLSD LLSD::emptyMap()
 	return v;
 }
 
-bool LLSD::has(const String& k) const	{ return safe(impl).has(k); }
-LLSD LLSD::get(const String& k) const	{ return safe(impl).get(k); } 
-void LLSD::insert(const String& k, const LLSD& v) {	makeMap(impl).insert(k, v); }
+bool LLSD::has(const String& k) const	{ return readableImpl().has(k); }
+LLSD LLSD::get(const String& k) const	{ return readableImpl().get(k); } 
+void LLSD::insert(const String& k, const LLSD& v) {	makeMap(writableImpl()).insert(k, v); }
 
 LLSD& LLSD::with(const String& k, const LLSD& v)
 										{ 
-											makeMap(impl).insert(k, v); 
+											makeMap(writableImpl()).insert(k, v); 
 											return *this;
 										}
-void LLSD::erase(const String& k)		{ makeMap(impl).erase(k); }
+void LLSD::erase(const String& k)		{ makeMap(writableImpl()).erase(k); }
 
 LLSD&		LLSD::operator[](const String& k)
-										{ return makeMap(impl).ref(k); }
+										{ return makeMap(writableImpl()).ref(k); }
 const LLSD& LLSD::operator[](const String& k) const
-										{ return safe(impl).ref(k); }
+										{ return readableImpl().ref(k); }
 
 
 LLSD LLSD::emptyArray()
@@ -765,24 +778,24 @@ LLSD LLSD::emptyArray()
 	return v;
 }
 
-int LLSD::size() const					{ return safe(impl).size(); }
+int LLSD::size() const					{ return readableImpl().size(); }
  
-LLSD LLSD::get(Integer i) const			{ return safe(impl).get(i); } 
-void LLSD::set(Integer i, const LLSD& v){ makeArray(impl).set(i, v); }
-void LLSD::insert(Integer i, const LLSD& v) { makeArray(impl).insert(i, v); }
+LLSD LLSD::get(Integer i) const			{ return readableImpl().get(i); } 
+void LLSD::set(Integer i, const LLSD& v){ makeArray(writableImpl()).set(i, v); }
+void LLSD::insert(Integer i, const LLSD& v) { makeArray(writableImpl()).insert(i, v); }
 
 LLSD& LLSD::with(Integer i, const LLSD& v)
 										{ 
-											makeArray(impl).insert(i, v); 
+											makeArray(writableImpl()).insert(i, v); 
 											return *this;
 										}
-void LLSD::append(const LLSD& v)		{ makeArray(impl).append(v); }
-void LLSD::erase(Integer i)				{ makeArray(impl).erase(i); }
+void LLSD::append(const LLSD& v)		{ makeArray(writableImpl()).append(v); }
+void LLSD::erase(Integer i)				{ makeArray(writableImpl()).erase(i); }
 
 LLSD&		LLSD::operator[](Integer i)
-										{ return makeArray(impl).ref(i); }
+										{ return makeArray(writableImpl()).ref(i); }
 const LLSD& LLSD::operator[](Integer i) const
-										{ return safe(impl).ref(i); }
+										{ return readableImpl().ref(i); }
 
 U32 LLSD::allocationCount()				{ return Impl::sAllocationCount; }
 U32 LLSD::outstandingCount()			{ return Impl::sOutstandingCount; }
@@ -831,12 +844,12 @@ const char *LLSD::dump(const LLSD &llsd)
 	return llsd_dump(llsd, false);
 }
 
-LLSD::map_iterator			LLSD::beginMap()		{ return makeMap(impl).beginMap(); }
-LLSD::map_iterator			LLSD::endMap()			{ return makeMap(impl).endMap(); }
-LLSD::map_const_iterator	LLSD::beginMap() const	{ return safe(impl).beginMap(); }
-LLSD::map_const_iterator	LLSD::endMap() const	{ return safe(impl).endMap(); }
+LLSD::map_iterator			LLSD::beginMap()		{ return makeMap(writableImpl()).beginMap(); }
+LLSD::map_iterator			LLSD::endMap()			{ return makeMap(writableImpl()).endMap(); }
+LLSD::map_const_iterator	LLSD::beginMap() const	{ return readableImpl().beginMap(); }
+LLSD::map_const_iterator	LLSD::endMap() const	{ return readableImpl().endMap(); }
 
-LLSD::array_iterator		LLSD::beginArray()		{ return makeArray(impl).beginArray(); }
-LLSD::array_iterator		LLSD::endArray()		{ return makeArray(impl).endArray(); }
-LLSD::array_const_iterator	LLSD::beginArray() const{ return safe(impl).beginArray(); }
-LLSD::array_const_iterator	LLSD::endArray() const	{ return safe(impl).endArray(); }
+LLSD::array_iterator		LLSD::beginArray()		{ return makeArray(writableImpl()).beginArray(); }
+LLSD::array_iterator		LLSD::endArray()		{ return makeArray(writableImpl()).endArray(); }
+LLSD::array_const_iterator	LLSD::beginArray() const{ return readableImpl().beginArray(); }
+LLSD::array_const_iterator	LLSD::endArray() const	{ return readableImpl().endArray(); }
@@ -319,13 +319,29 @@ public:
 public:
 		class Impl;
 private:
-		Impl* impl;
+		// Undefined, Boolean, Integer and Real values are held inline, all
+		// other types live in a shared, reference counted Impl.
+		// mInlineType is TypeUndefined when impl is in use (a NULL impl
+		// being the Undefined value).
+		union
+		{
+			Impl*		impl;
+			Boolean		mBoolean;
+			Integer		mInteger;
+			Real		mReal;
+			U64			mInlineBits;
+		};
+		U8				mInlineType;
+
+		bool isInline() const			{ return mInlineType != TypeUndefined; }
+		Impl*& writableImpl();			///< drops any inline value
+		const Impl& readableImpl() const;	///< Undefined when inline
 	//@}
 	
 	/** @name Unit Testing Interface */
 	//@{
 public:
-		static U32 allocationCount();	///< how many Impls have been made
+		static U32 allocationCount();	///< how many Impls have been made (inline scalars are not counted)
 		static U32 outstandingCount();	///< how many Impls are still alive
 	//@}
 
@@ -1201,6 +1201,388 @@ bool LLSDBinaryParser::parseString(
 }
 
 
+/**
+ * LLSDBinaryBufferParser
+ */
+namespace
+{
+	// Binary LLSD parser working directly on a contiguous buffer. Follows
+	// the same format rules as LLSDBinaryParser::doParse(), but every
+	// read is a bounds check and a memcpy instead of a stream operation.
+	class LLSDBinaryBufferParser
+	{
+	public:
+		LLSDBinaryBufferParser(const U8* buf, S32 size)
+			: mCur(buf), mEnd(buf + size) { }
+
+		S32 parse(LLSD& data);
+
+	private:
+		S32 parseMap(LLSD& map);
+		S32 parseArray(LLSD& array);
+		bool readBytes(void* out, S32 size);
+		bool readSize(S32& size);
+		bool readString(std::string& value);
+		bool readDelimitedString(std::string& value, char delim);
+
+		enum { PARSE_FAILURE = LLSDParser::PARSE_FAILURE };
+
+		const U8* mCur;
+		const U8* mEnd;
+	};
+
+	bool LLSDBinaryBufferParser::readBytes(void* out, S32 size)
+	{
+		if (size < 0 || size > mEnd - mCur)
+		{
+			return false;
+		}
+		memcpy(out, mCur, size);	/* Flawfinder: ignore */
+		mCur += size;
+		return true;
+	}
+
+	bool LLSDBinaryBufferParser::readSize(S32& size)
+	{
+		U32 value_nbo = 0;
+		if (!readBytes(&value_nbo, sizeof(U32)))
+		{
+			return false;
+		}
+		size = (S32)ntohl(value_nbo);
+		return size >= 0;
+	}
+
+	bool LLSDBinaryBufferParser::readString(std::string& value)
+	{
+		S32 size = 0;
+		if (!readSize(size) || size > mEnd - mCur)
+		{
+			return false;
+		}
+		value.assign((const char*)mCur, size);
+		mCur += size;
+		return true;
+	}
+
+	bool LLSDBinaryBufferParser::readDelimitedString(std::string& value, char delim)
+	{
+		// Notation style strings, unescaped the same way as
+		// deserialize_string_delim() does. Runs between escapes are
+		// copied straight out of the buffer.
+		value.clear();
+		while (true)
+		{
+			const U8* end = mCur;
+			while (end < mEnd && *end != delim && *end != '\\')
+			{
+				++end;
+			}
+			if (end == mEnd)
+			{
+				return false;
+			}
+			value.append((const char*)mCur, end - mCur);
+			mCur = end + 1;
+			if (*end == delim)
+			{
+				return true;
+			}
+
+			if (mCur == mEnd)
+			{
+				return false;
+			}
+			char next_char = (char)*mCur++;
+			if (next_char == 'x')
+			{
+				if (mEnd - mCur < 2)
+				{
+					return false;
+				}
+				U8 byte = hex_as_nybble((char)mCur[0]) << 4;
+				byte |= hex_as_nybble((char)mCur[1]);
+				mCur += 2;
+				value += (char)byte;
+				continue;
+			}
+			switch (next_char)
+			{
+			case 'a':
+				next_char = '\a';
+				break;
+			case 'b':
+				next_char = '\b';
+				break;
+			case 'f':
+				next_char = '\f';
+				break;
+			case 'n':
+				next_char = '\n';
+				break;
+			case 'r':
+				next_char = '\r';
+				break;
+			case 't':
+				next_char = '\t';
+				break;
+			case 'v':
+				next_char = '\v';
+				break;
+			default:
+				break;
+			}
+			value += next_char;
+		}
+	}
+
+	S32 LLSDBinaryBufferParser::parse(LLSD& data)
+	{
+		if (mCur >= mEnd)
+		{
+			return 0;
+		}
+		S32 parse_count = 1;
+		char c = *mCur++;
+		switch(c)
+		{
+		case '{':
+		{
+			S32 child_count = parseMap(data);
+			parse_count = (PARSE_FAILURE == child_count) ? PARSE_FAILURE : parse_count + child_count;
+			break;
+		}
+
+		case '[':
+		{
+			S32 child_count = parseArray(data);
+			parse_count = (PARSE_FAILURE == child_count) ? PARSE_FAILURE : parse_count + child_count;
+			break;
+		}
+
+		case '!':
+			data.clear();
+			break;
+
+		case '0':
+			data = false;
+			break;
+
+		case '1':
+			data = true;
+			break;
+
+		case 'i':
+		{
+			U32 value_nbo = 0;
+			if (readBytes(&value_nbo, sizeof(U32)))
+			{
+				data = (S32)ntohl(value_nbo);
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		case 'r':
+		{
+			F64 real_nbo = 0.0;
+			if (readBytes(&real_nbo, sizeof(F64)))
+			{
+				data = ll_ntohd(real_nbo);
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		case 'u':
+		{
+			LLUUID id;
+			if (readBytes(&id.mData, UUID_BYTES))
+			{
+				data = id;
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		case '\'':
+		case '"':
+		{
+			std::string value;
+			if (readDelimitedString(value, c))
+			{
+				data = value;
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		case 's':
+		{
+			std::string value;
+			if (readString(value))
+			{
+				data = value;
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		case 'l':
+		{
+			std::string value;
+			if (readString(value))
+			{
+				data = LLURI(value);
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		case 'd':
+		{
+			F64 real = 0.0;
+			if (readBytes(&real, sizeof(F64)))
+			{
+				data = LLDate(real);
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		case 'b':
+		{
+			S32 size = 0;
+			if (readSize(size) && size <= mEnd - mCur)
+			{
+				data = LLSD::Binary(mCur, mCur + size);
+				mCur += size;
+			}
+			else
+			{
+				parse_count = PARSE_FAILURE;
+			}
+			break;
+		}
+
+		default:
+			parse_count = PARSE_FAILURE;
+			llinfos << "Unrecognized character while parsing: int(" << (int)c
+				<< ")" << llendl;
+			break;
+		}
+		if (PARSE_FAILURE == parse_count)
+		{
+			data.clear();
+		}
+		return parse_count;
+	}
+
+	S32 LLSDBinaryBufferParser::parseMap(LLSD& map)
+	{
+		map = LLSD::emptyMap();
+		S32 size = 0;
+		if (!readSize(size))
+		{
+			return PARSE_FAILURE;
+		}
+		S32 parse_count = 0;
+		for (S32 count = 0; count < size; ++count)
+		{
+			if (mCur >= mEnd)
+			{
+				return PARSE_FAILURE;
+			}
+			std::string name;
+			char c = *mCur++;
+			bool key_ok = false;
+			switch(c)
+			{
+			case 'k':
+				key_ok = readString(name);
+				break;
+			case '\'':
+			case '"':
+				key_ok = readDelimitedString(name, c);
+				break;
+			}
+			if (!key_ok)
+			{
+				return PARSE_FAILURE;
+			}
+
+			// Parse in place, which keeps a map of maps from copying
+			// (and therefore sharing) every child.
+			S32 child_count = parse(map[name]);
+			if (child_count <= 0)
+			{
+				// There must be a value for every key.
+				return PARSE_FAILURE;
+			}
+			parse_count += child_count;
+		}
+		if (mCur >= mEnd || *mCur++ != '}')
+		{
+			return PARSE_FAILURE;
+		}
+		return parse_count;
+	}
+
+	S32 LLSDBinaryBufferParser::parseArray(LLSD& array)
+	{
+		array = LLSD::emptyArray();
+		S32 size = 0;
+		if (!readSize(size))
+		{
+			return PARSE_FAILURE;
+		}
+		S32 parse_count = 0;
+		for (S32 count = 0; count < size; ++count)
+		{
+			S32 child_count = parse(array[count]);
+			if (child_count <= 0)
+			{
+				return PARSE_FAILURE;
+			}
+			parse_count += child_count;
+		}
+		if (mCur >= mEnd || *mCur++ != ']')
+		{
+			return PARSE_FAILURE;
+		}
+		return parse_count;
+	}
+}
+
+// static
+S32 LLSDSerialize::fromBinary(LLSD& sd, const U8* buf, S32 size)
+{
+	LLSDBinaryBufferParser parser(buf, size);
+	return parser.parse(sd);
+}
+
+
 /**
  * LLSDFormatter
  */
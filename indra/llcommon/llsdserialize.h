@@ -302,6 +302,57 @@ public:
 	 */
 	LLSDXMLParser();
 
+	/** 
+	 * @class LLSDXMLParser::Listener
+	 * @brief Receives values from an incremental parse as they complete.
+	 */
+	class LL_COMMON_API Listener
+	{
+	public:
+		virtual ~Listener() {}
+
+		/** 
+		 * @brief Called for each value once it has been completely
+		 * parsed, so children are seen before the map or array holding
+		 * them.
+		 *
+		 * @param path The map keys and array indices leading from the
+		 * top level value to this one.
+		 * @param value The value, including all of its children.
+		 * @return Return false to drop the value from the final result
+		 * once it has been handled. Dropped array entries become undef
+		 * so that later indices do not change.
+		 */
+		virtual bool valueParsed(const LLSD& path, const LLSD& value) = 0;
+	};
+
+	/** 
+	 * @brief Set the listener told about each value as it is parsed.
+	 *
+	 * @param listener The listener, or NULL for none.
+	 */
+	void setListener(Listener* listener);
+
+	/** 
+	 * @brief Parse the next piece of a document as it arrives.
+	 *
+	 * Feed the document in as many pieces as it is received in, then
+	 * call finishChunks(). Call reset() before starting another one.
+	 * @param buf The next bytes of the document.
+	 * @param len The number of bytes in buf.
+	 * @return Returns false once the document is known to be malformed.
+	 */
+	bool parseChunk(const char* buf, S32 len);
+
+	/** 
+	 * @brief Complete a parse done with parseChunk().
+	 *
+	 * @param data[out] The newly parsed structured data.
+	 * @return Returns the number of LLSD objects parsed into
+	 * data. Returns PARSE_FAILURE (-1) on parse failure.
+	 */
+	S32 finishChunks(LLSD& data);
+
 protected:
 	/** 
 	 * @brief Call this method to parse a stream for LLSD.
@@ -788,6 +839,20 @@ public:
 		(void)p->parse(str, sd, max_bytes);
 		return sd;
 	}
+
+	/**
+	 * @brief Parse binary LLSD straight out of a contiguous buffer.
+	 *
+	 * Unlike the istream methods this does not read the data a
+	 * character at a time: each string and binary value is copied
+	 * once, directly from buf into sd.
+	 * @param sd [out] The data found in the buffer
+	 * @param buf The binary formatted LLSD, without a header
+	 * @param size The number of bytes in buf
+	 * @return Returns the number of LLSD objects parsed into sd, or
+	 * LLSDParser::PARSE_FAILURE on failure.
+	 */
+	static S32 fromBinary(LLSD& sd, const U8* buf, S32 size);
 };
 
 #endif // LL_LLSDSERIALIZE_H
@@ -257,6 +257,10 @@ public:
 	S32 parseLines(std::istream& input, LLSD& data);
 
 	void parsePart(const char *buf, int len);
+
+	bool parseChunk(const char* buf, int len);
+	S32 finishChunks(LLSD& data);
+	void setListener(LLSDXMLParser::Listener* listener) { mListener = listener; }
 	
 	void reset();
 
@@ -312,10 +316,15 @@ private:
 	
 	std::string mCurrentKey;		// Current XML <tag>
 	std::string mCurrentContent;	// String data between <tag> and </tag>
+
+	LLSDXMLParser::Listener* mListener;
+	LLSD mPath;						// keys and indices down to mStack.back(), kept for mListener
+	bool mChunkFailed;				// parseChunk() hit an error
 };
 
 
 LLSDXMLParser::Impl::Impl()
+	: mListener(NULL)
 {
 	mParser = XML_ParserCreate(NULL);
 	reset();
@@ -502,6 +511,9 @@ void LLSDXMLParser::Impl::reset()
 	mSkipping = false;
 	
 	mCurrentKey.clear();
+
+	mPath = LLSD::emptyArray();
+	mChunkFailed = false;
 	
 	XML_ParserReset(mParser, "utf-8");
 	XML_SetUserData(mParser, this);
@@ -543,6 +555,41 @@ void LLSDXMLParser::Impl::parsePart(const char* buf, int len)
 	}
 }
 
+bool LLSDXMLParser::Impl::parseChunk(const char* buf, int len)
+{
+	// Anything after the closing </llsd> is ignored, as parse() does
+	if (mGracefullStop || mChunkFailed)
+	{
+		return !mChunkFailed;
+	}
+	if (XML_Parse(mParser, buf, len, false) == XML_STATUS_ERROR && !mGracefullStop)
+	{
+		llinfos << "LLSDXMLParser::Impl::parseChunk: XML_STATUS_ERROR: "
+			<< XML_ErrorString(XML_GetErrorCode(mParser)) << llendl;
+		mChunkFailed = true;
+	}
+	return !mChunkFailed;
+}
+
+S32 LLSDXMLParser::Impl::finishChunks(LLSD& data)
+{
+	if (!mGracefullStop && !mChunkFailed)
+	{
+		if (XML_Parse(mParser, NULL, 0, true) == XML_STATUS_ERROR && !mGracefullStop)
+		{
+			llinfos << "LLSDXMLParser::Impl::finishChunks: XML_STATUS_ERROR" << llendl;
+			mChunkFailed = true;
+		}
+	}
+	if (mChunkFailed)
+	{
+		data = LLSD();
+		return LLSDParser::PARSE_FAILURE;
+	}
+	data = mResult;
+	return mParseCount;
+}
+
 // Performance testing code
 //#define	XML_PARSER_PERFORMANCE_TESTS
 
@@ -628,6 +675,10 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 		LLSD& map = *mStack.back();
 		LLSD& newElement = map[mCurrentKey];
 		mStack.push_back(&newElement);		
+		if (mListener)
+		{
+			mPath.append(mCurrentKey);
+		}
 
 		mCurrentKey.clear();
 	}
@@ -637,6 +688,10 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 		array.append(LLSD());
 		LLSD& newElement = array[array.size()-1];
 		mStack.push_back(&newElement);
+		if (mListener)
+		{
+			mPath.append(array.size()-1);
+		}
 	}
 	else {
 		// improperly nested value in a non-structure
@@ -785,6 +840,30 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 	}
 
 	mCurrentContent.clear();
+
+	if (mListener && !mStack.empty())
+	{
+		// the top level value is always kept, it is the result
+		S32 last = mPath.size() - 1;
+		bool keep = mListener->valueParsed(mPath, value);
+		LLSD& parent = *mStack.back();
+		if (!keep)
+		{
+			if (parent.isMap())
+			{
+				parent.erase(mPath[last].asString());
+			}
+			else
+			{
+				value.clear();
+			}
+		}
+		mPath.erase(last);
+	}
+	else if (mListener)
+	{
+		mListener->valueParsed(mPath, value);
+	}
 }
 
 void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
@@ -903,6 +982,21 @@ void LLSDXMLParser::parsePart(const char *buf, int len)
 	impl.parsePart(buf, len);
 }
 
+void LLSDXMLParser::setListener(Listener* listener)
+{
+	impl.setListener(listener);
+}
+
+bool LLSDXMLParser::parseChunk(const char* buf, S32 len)
+{
+	return impl.parseChunk(buf, len);
+}
+
+S32 LLSDXMLParser::finishChunks(LLSD& data)
+{
+	return impl.finishChunks(data);
+}
+
 // virtual
 S32 LLSDXMLParser::doParse(std::istream& input, LLSD& data) const
 {
@@ -24,6 +24,7 @@
  * $/LicenseInfo$
  */
 
+
 #include "linden_common.h"
 #include "llstacktrace.h"
 
@@ -45,25 +46,77 @@ static RtlCaptureStackBackTrace_Function* const RtlCaptureStackBackTrace_fn =
    (RtlCaptureStackBackTrace_Function*)
    GetProcAddress(GetModuleHandleA("ntdll.dll"), "RtlCaptureStackBackTrace");
 
-bool ll_get_stack_trace(std::vector<std::string>& lines)
+static const S32 STRING_NAME_LENGTH = 200;
+
+static bool load_symbols()
 {
-	const S32 MAX_STACK_DEPTH = 32;
-	const S32 STRING_NAME_LENGTH = 200;
-	const S32 FRAME_SKIP = 2;
 	static BOOL symbolsLoaded = false;
 	static BOOL firstCall = true;
 
-	HANDLE hProc = GetCurrentProcess();
-
 	// load the symbols if they're not loaded
 	if(!symbolsLoaded && firstCall)
 	{
-		symbolsLoaded = SymInitialize(hProc, NULL, true);
+		symbolsLoaded = SymInitialize(GetCurrentProcess(), NULL, true);
 		firstCall = false;
 	}
+	return symbolsLoaded;
+}
+
+static std::string get_frame_name(HANDLE hProc, void* frame, PIMAGEHLP_SYMBOL64 pSym)
+{
+	std::stringstream stack_line;
+	BOOL ret;
+
+	DWORD64 addr = (DWORD64)frame;
+	ret = SymGetSymFromAddr64(hProc, addr, 0, pSym);
+	if(ret)
+	{
+		stack_line << pSym->Name << " ";
+	}
+
+	IMAGEHLP_LINE64 line;
+	memset(&line, 0, sizeof(IMAGEHLP_LINE64));
+	line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+
+	DWORD dummy;
+	ret = SymGetLineFromAddr64(hProc, addr, &dummy, &line);
+	if(ret)
+	{
+		std::string file_name = line.FileName;
+		std::string::size_type index = file_name.rfind("\\");
+		stack_line << file_name.substr(index + 1, file_name.size()) << ":" << line.LineNumber; 
+	}
+	return stack_line.str();
+}
+
+static void get_frame_names(void* const* frames, S32 depth, std::vector<std::string>& lines)
+{
+	HANDLE hProc = GetCurrentProcess();
+
+	// create something to hold address info
+	PIMAGEHLP_SYMBOL64 pSym;
+	pSym = (PIMAGEHLP_SYMBOL64)malloc(sizeof(IMAGEHLP_SYMBOL64) + STRING_NAME_LENGTH);
+	memset(pSym, 0, sizeof(IMAGEHLP_SYMBOL64) + STRING_NAME_LENGTH);
+	pSym->MaxNameLength = STRING_NAME_LENGTH;
+	pSym->SizeOfStruct = sizeof(IMAGEHLP_SYMBOL64);
+
+	// get address info for each address frame
+	// and store
+	for(S32 i=0; i < depth; i++)
+	{
+		lines.push_back(get_frame_name(hProc, frames[i], pSym));
+	}
+	
+	free(pSym);
+}
+
+bool ll_get_stack_trace(std::vector<std::string>& lines)
+{
+	const S32 MAX_STACK_DEPTH = 32;
+	const S32 FRAME_SKIP = 2;
 
 	// if loaded, get the call stack
-	if(symbolsLoaded)
+	if(load_symbols())
 	{
 		// create the frames to hold the addresses
 		void* frames[MAX_STACK_DEPTH];
@@ -73,44 +126,7 @@ bool ll_get_stack_trace(std::vector<std::string>& lines)
 		// get the addresses
 		depth = RtlCaptureStackBackTrace_fn(FRAME_SKIP, MAX_STACK_DEPTH, frames, NULL);
 
-		IMAGEHLP_LINE64 line;
-		memset(&line, 0, sizeof(IMAGEHLP_LINE64));
-		line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
-
-		// create something to hold address info
-		PIMAGEHLP_SYMBOL64 pSym;
-		pSym = (PIMAGEHLP_SYMBOL64)malloc(sizeof(IMAGEHLP_SYMBOL64) + STRING_NAME_LENGTH);
-		memset(pSym, 0, sizeof(IMAGEHLP_SYMBOL64) + STRING_NAME_LENGTH);
-		pSym->MaxNameLength = STRING_NAME_LENGTH;
-		pSym->SizeOfStruct = sizeof(IMAGEHLP_SYMBOL64);
-
-		// get address info for each address frame
-		// and store
-		for(S32 i=0; i < depth; i++)
-		{
-			std::stringstream stack_line;
-			BOOL ret;
-
-			DWORD64 addr = (DWORD64)frames[i];
-			ret = SymGetSymFromAddr64(hProc, addr, 0, pSym);
-			if(ret)
-			{
-				stack_line << pSym->Name << " ";
-			}
-
-			DWORD dummy;
-			ret = SymGetLineFromAddr64(hProc, addr, &dummy, &line);
-			if(ret)
-			{
-				std::string file_name = line.FileName;
-				std::string::size_type index = file_name.rfind("\\");
-				stack_line << file_name.substr(index + 1, file_name.size()) << ":" << line.LineNumber; 
-			}
-
-			lines.push_back(stack_line.str());
-		}
-		
-		free(pSym);
+		get_frame_names(frames, depth, lines);
 
 		// TODO: figure out a way to cleanup symbol loading
 		// Not hugely necessary, however.
@@ -125,6 +141,31 @@ bool ll_get_stack_trace(std::vector<std::string>& lines)
 	return false;
 }
 
+S32 ll_get_stack_frames(void** frames, S32 max_depth, S32 skip)
+{
+	if (!RtlCaptureStackBackTrace_fn)
+	{
+		return 0;
+	}
+	// skip this function as well
+	return RtlCaptureStackBackTrace_fn(skip + 1, max_depth, frames, NULL);
+}
+
+void ll_get_stack_frame_names(void* const* frames, S32 depth, std::vector<std::string>& names)
+{
+	if (load_symbols())
+	{
+		get_frame_names(frames, depth, names);
+	}
+	else
+	{
+		for (S32 i = 0; i < depth; i++)
+		{
+			names.push_back(llformat("%p", frames[i]));
+		}
+	}
+}
+
 #else
 
 bool ll_get_stack_trace(std::vector<std::string>& lines)
@@ -132,5 +173,52 @@ bool ll_get_stack_trace(std::vector<std::string>& lines)
 	return false;
 }
 
+#if LL_LINUX || LL_DARWIN
+
+#include <execinfo.h>
+
+S32 ll_get_stack_frames(void** frames, S32 max_depth, S32 skip)
+{
+	const S32 MAX_SKIP = 16;
+	void* buffer[MAX_SKIP + 64];
+	skip = llclamp(skip + 1, 0, MAX_SKIP);
+	max_depth = llmin(max_depth, 64);
+
+	S32 depth = backtrace(buffer, skip + max_depth) - skip;
+	if (depth <= 0)
+	{
+		return 0;
+	}
+	memcpy(frames, buffer + skip, depth * sizeof(void*));	/* Flawfinder: ignore */
+	return depth;
+}
+
+void ll_get_stack_frame_names(void* const* frames, S32 depth, std::vector<std::string>& names)
+{
+	char** symbols = depth > 0 ? backtrace_symbols(frames, depth) : NULL;
+	for (S32 i = 0; i < depth; i++)
+	{
+		names.push_back(symbols ? std::string(symbols[i]) : llformat("%p", frames[i]));
+	}
+	free(symbols);
+}
+
+#else
+
+S32 ll_get_stack_frames(void** frames, S32 max_depth, S32 skip)
+{
+	return 0;
+}
+
+void ll_get_stack_frame_names(void* const* frames, S32 depth, std::vector<std::string>& names)
+{
+	for (S32 i = 0; i < depth; i++)
+	{
+		names.push_back(llformat("%p", frames[i]));
+	}
+}
+
+#endif
+
 #endif
 
@@ -34,5 +34,13 @@
 
 LL_COMMON_API bool ll_get_stack_trace(std::vector<std::string>& lines);
 
+// Fills frames with up to max_depth return addresses of the caller's stack,
+// skipping the innermost skip frames, and returns the number captured.
+// Does not allocate on Windows; on other platforms the first call may.
+LL_COMMON_API S32 ll_get_stack_frames(void** frames, S32 max_depth, S32 skip = 0);
+
+// Appends a symbol name (or the raw address) for each frame to names.
+LL_COMMON_API void ll_get_stack_frame_names(void* const* frames, S32 depth, std::vector<std::string>& names);
+
 #endif
 
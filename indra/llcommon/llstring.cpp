@@ -36,6 +36,13 @@
 #include <winnls.h> // for WideCharToMultiByte
 #endif
 
+#if (LL_GNUC && defined(__SSE2__)) || (LL_MSVC && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define LL_UTF8_SSE2 1
+#include <emmintrin.h>
+#else
+#define LL_UTF8_SSE2 0
+#endif
+
 LLFastTimer::DeclareTimer FT_STRING_FORMAT("String Format");
 
 
@@ -375,91 +382,183 @@ S32 wstring_utf8_length(const LLWString& wstr)
 }
 
 
+// Most text is ASCII, so the conversions below copy runs of it a block at a
+// time and only decode or encode the other characters one by one.
+
+// Widens the leading run of ASCII bytes of in, at most len of them, into
+// out and returns its length.
+static S32 widen_ascii(const U8* in, S32 len, llwchar* out)
+{
+	S32 i = 0;
+#if LL_UTF8_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for ( ; i + 16 <= len; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(in + i));
+		if (_mm_movemask_epi8(bytes))
+		{
+			break;
+		}
+		__m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128((__m128i*)(out + i + 12), _mm_unpackhi_epi16(hi, zero));
+	}
+#else
+	for ( ; i + 8 <= len; i += 8)
+	{
+		U64 word;
+		memcpy(&word, in + i, sizeof(word));	/* Flawfinder: ignore */
+		if (word & 0x8080808080808080ULL)
+		{
+			break;
+		}
+		for (S32 j = 0; j < 8; ++j)
+		{
+			out[i + j] = in[i + j];
+		}
+	}
+#endif
+	for ( ; i < len && in[i] < 0x80; ++i)
+	{
+		out[i] = in[i];
+	}
+	return i;
+}
+
+// Narrows the leading run of characters 1 to 0x7F of in, at most len of
+// them, into out and returns its length.
+static S32 narrow_ascii(const llwchar* in, S32 len, char* out)
+{
+	S32 i = 0;
+#if LL_UTF8_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i high = _mm_set1_epi32(~0x7F);
+	for ( ; i + 16 <= len; i += 16)
+	{
+		__m128i chars[4];
+		__m128i ascii = _mm_cmpeq_epi32(zero, zero);
+		for (S32 j = 0; j < 4; ++j)
+		{
+			chars[j] = _mm_loadu_si128((const __m128i*)(in + i + j * 4));
+			// below 0x80 and not NUL
+			ascii = _mm_and_si128(ascii, _mm_cmpeq_epi32(_mm_and_si128(chars[j], high), zero));
+			ascii = _mm_andnot_si128(_mm_cmpeq_epi32(chars[j], zero), ascii);
+		}
+		if (_mm_movemask_epi8(ascii) != 0xFFFF)
+		{
+			break;
+		}
+		__m128i lo = _mm_packs_epi32(chars[0], chars[1]);
+		__m128i hi = _mm_packs_epi32(chars[2], chars[3]);
+		_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for ( ; i < len && (U32)in[i] - 1 < 0x7F; ++i)
+	{
+		out[i] = (char)in[i];
+	}
+	return i;
+}
+
 LLWString utf8str_to_wstring(const std::string& utf8str, S32 len)
 {
 	LLWString wout;
+	if (len <= 0)
+	{
+		return wout;
+	}
+
+	// No byte makes more than one character.  Reads past len stop at the
+	// terminator, as they always have.
+	wout.resize(len);
+	llwchar* out = &wout[0];
+	const U8* in = (const U8*)utf8str.c_str();
+	S32 count = 0;
 
 	S32 i = 0;
 	while (i < len)
 	{
-		llwchar unichar;
-		U8 cur_char = utf8str[i];
+		S32 ascii = widen_ascii(in + i, len - i, out + count);
+		i += ascii;
+		count += ascii;
+		if (i >= len)
+		{
+			break;
+		}
 
-		if (cur_char < 0x80)
+		llwchar unichar;
+		U8 cur_char = in[i];
+		S32 cont_bytes = 0;
+		if ((cur_char >> 5) == 0x6)			// Two byte UTF8 -> 1 UTF32
+		{
+			unichar = (0x1F&cur_char);
+			cont_bytes = 1;
+		}
+		else if ((cur_char >> 4) == 0xe)	// Three byte UTF8 -> 1 UTF32
+		{
+			unichar = (0x0F&cur_char);
+			cont_bytes = 2;
+		}
+		else if ((cur_char >> 3) == 0x1e)	// Four byte UTF8 -> 1 UTF32
 		{
-			// Ascii character, just add it
-			unichar = cur_char;
+			unichar = (0x07&cur_char);
+			cont_bytes = 3;
+		}
+		else if ((cur_char >> 2) == 0x3e)	// Five byte UTF8 -> 1 UTF32
+		{
+			unichar = (0x03&cur_char);
+			cont_bytes = 4;
+		}
+		else if ((cur_char >> 1) == 0x7e)	// Six byte UTF8 -> 1 UTF32
+		{
+			unichar = (0x01&cur_char);
+			cont_bytes = 5;
 		}
 		else
 		{
-			S32 cont_bytes = 0;
-			if ((cur_char >> 5) == 0x6)			// Two byte UTF8 -> 1 UTF32
-			{
-				unichar = (0x1F&cur_char);
-				cont_bytes = 1;
-			}
-			else if ((cur_char >> 4) == 0xe)	// Three byte UTF8 -> 1 UTF32
-			{
-				unichar = (0x0F&cur_char);
-				cont_bytes = 2;
-			}
-			else if ((cur_char >> 3) == 0x1e)	// Four byte UTF8 -> 1 UTF32
-			{
-				unichar = (0x07&cur_char);
-				cont_bytes = 3;
-			}
-			else if ((cur_char >> 2) == 0x3e)	// Five byte UTF8 -> 1 UTF32
-			{
-				unichar = (0x03&cur_char);
-				cont_bytes = 4;
-			}
-			else if ((cur_char >> 1) == 0x7e)	// Six byte UTF8 -> 1 UTF32
+			out[count++] = LL_UNKNOWN_CHAR;
+			++i;
+			continue;
+		}
+
+		// Check that this character doesn't go past the end of the string
+		S32 end = (len < (i + cont_bytes)) ? len : (i + cont_bytes);
+		do
+		{
+			++i;
+
+			cur_char = in[i];
+			if ( (cur_char >> 6) == 0x2 )
 			{
-				unichar = (0x01&cur_char);
-				cont_bytes = 5;
+				unichar <<= 6;
+				unichar += (0x3F&cur_char);
 			}
 			else
 			{
-				wout += LL_UNKNOWN_CHAR;
-				++i;
-				continue;
-			}
-
-			// Check that this character doesn't go past the end of the string
-			S32 end = (len < (i + cont_bytes)) ? len : (i + cont_bytes);
-			do
-			{
-				++i;
-
-				cur_char = utf8str[i];
-				if ( (cur_char >> 6) == 0x2 )
-				{
-					unichar <<= 6;
-					unichar += (0x3F&cur_char);
-				}
-				else
-				{
-					// Malformed sequence - roll back to look at this as a new char
-					unichar = LL_UNKNOWN_CHAR;
-					--i;
-					break;
-				}
-			} while(i < end);
-
-			// Handle overlong characters and NULL characters
-			if ( ((cont_bytes == 1) && (unichar < 0x80))
-				|| ((cont_bytes == 2) && (unichar < 0x800))
-				|| ((cont_bytes == 3) && (unichar < 0x10000))
-				|| ((cont_bytes == 4) && (unichar < 0x200000))
-				|| ((cont_bytes == 5) && (unichar < 0x4000000)) )
-			{
+				// Malformed sequence - roll back to look at this as a new char
 				unichar = LL_UNKNOWN_CHAR;
+				--i;
+				break;
 			}
+		} while(i < end);
+
+		// Handle overlong characters and NULL characters
+		if ( ((cont_bytes == 1) && (unichar < 0x80))
+			|| ((cont_bytes == 2) && (unichar < 0x800))
+			|| ((cont_bytes == 3) && (unichar < 0x10000))
+			|| ((cont_bytes == 4) && (unichar < 0x200000))
+			|| ((cont_bytes == 5) && (unichar < 0x4000000)) )
+		{
+			unichar = LL_UNKNOWN_CHAR;
 		}
 
-		wout += unichar;
+		out[count++] = unichar;
 		++i;
 	}
+	wout.resize(count);
 	return wout;
 }
 
@@ -472,16 +571,41 @@ LLWString utf8str_to_wstring(const std::string& utf8str)
 std::string wstring_to_utf8str(const LLWString& utf32str, S32 len)
 {
 	std::string out;
+	if (len <= 0)
+	{
+		return out;
+	}
+
+	// Start with room for all ASCII, and keep room for the rest of the
+	// string as ASCII after each longer character.
+	out.resize(len);
+	const llwchar* in = utf32str.data();
+	S32 count = 0;
 
 	S32 i = 0;
 	while (i < len)
 	{
-		char tchars[8];		/* Flawfinder: ignore */
-		S32 n = wchar_to_utf8chars(utf32str[i], tchars);
-		tchars[n] = 0;
-		out += tchars;
+		S32 ascii = narrow_ascii(in + i, len - i, &out[count]);
+		i += ascii;
+		count += ascii;
+		if (i >= len)
+		{
+			break;
+		}
+
+		S32 needed = count + 6 + (len - i - 1);
+		if (needed > (S32)out.size())
+		{
+			out.resize(llmax(needed, (S32)(out.size() + out.size() / 2)));
+		}
+		// NULs are dropped
+		if (in[i])
+		{
+			count += wchar_to_utf8chars(in[i], &out[count]);
+		}
 		i++;
 	}
+	out.resize(count);
 	return out;
 }
 
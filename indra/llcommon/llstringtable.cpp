@@ -30,10 +30,13 @@
 #include "llstringtable.h"
 #include "llstl.h"
 
+#include "apr_atomic.h"
+#include "apr_thread_proc.h"
+
 LLStringTable gStringTable(32768);
 
-LLStringTableEntry::LLStringTableEntry(const char *str)
-: mString(NULL), mCount(1)
+LLStringTableEntry::LLStringTableEntry(const char *str, U32 hash)
+: mString(NULL), mCount(1), mHash(hash)
 {
 	// Copy string
 	U32 length = (U32)strlen(str) + 1;	 /*Flawfinder: ignore*/
@@ -49,8 +52,29 @@ LLStringTableEntry::~LLStringTableEntry()
 	mCount = 0;
 }
 
+// gStringTable is constructed before APR is initialized, so it can't own an
+// LLMutex.  Critical sections are a handful of compares, so just spin.
+class LLStringTableLock
+{
+public:
+	LLStringTableLock(volatile U32& lock)
+	:	mLock(lock)
+	{
+		while (apr_atomic_cas32(&mLock, 1, 0) != 0)
+		{
+			apr_thread_yield();
+		}
+	}
+	~LLStringTableLock()
+	{
+		apr_atomic_xchg32(&mLock, 0);
+	}
+private:
+	volatile U32& mLock;
+};
+
 LLStringTable::LLStringTable(int tablesize)
-: mUniqueEntries(0)
+: mUniqueEntries(0), mSlots(NULL), mLock(0)
 {
 	S32 i;
 	if (!tablesize)
@@ -67,65 +91,87 @@ LLStringTable::LLStringTable(int tablesize)
 			break;
 		}
 	}
-	mMaxEntries = tablesize;
+	mMaxEntries = llmax(tablesize, 16);
 
-#if !STRING_TABLE_HASH_MAP
-	// ALlocate strings
-	mStringList = new string_list_ptr_t[mMaxEntries];
-	// Clear strings
+	mSlots = new Slot[mMaxEntries];
 	for (i = 0; i < mMaxEntries; i++)
 	{
-		mStringList[i] = NULL;
+		mSlots[i].mHash = 0;
+		mSlots[i].mEntry = NULL;
 	}
-#endif
 }
 
 LLStringTable::~LLStringTable()
 {
-#if !STRING_TABLE_HASH_MAP
-	if (mStringList)
+	for (S32 i = 0; i < mMaxEntries; i++)
+	{
+		delete mSlots[i].mEntry;
+	}
+	delete [] mSlots;
+	mSlots = NULL;
+}
+
+// FNV-1a over the characters that fit in an entry, so a string longer than
+// MAX_STRINGS_LENGTH finds its truncated copy.
+//static
+U32 LLStringTable::hashString(const char *str)
+{
+	U32 retval = 2166136261U;
+	for (U32 i = 0; str[i] && i < MAX_STRINGS_LENGTH - 1; i++)
+	{
+		retval ^= (U8)str[i];
+		retval *= 16777619U;
+	}
+	return retval;
+}
+
+// Returns the slot holding str, or the free slot where it belongs.
+// Caller must hold mLock.
+S32 LLStringTable::findSlot(const char *str, U32 hash) const
+{
+	U32 mask = mMaxEntries - 1;
+	U32 i = hash & mask;
+	while (mSlots[i].mEntry)
 	{
-		for (S32 i = 0; i < mMaxEntries; i++)
+		if (mSlots[i].mHash == hash
+			&& !strncmp(mSlots[i].mEntry->mString, str, MAX_STRINGS_LENGTH - 1))
 		{
-			if (mStringList[i])
-			{
-				string_list_t::iterator iter;
-				for (iter = mStringList[i]->begin(); iter != mStringList[i]->end(); iter++)
-					delete *iter; // *iter = (LLStringTableEntry*)
-			}
-			delete mStringList[i];
+			break;
 		}
-		delete [] mStringList;
-		mStringList = NULL;
+		i = (i + 1) & mask;
 	}
-#else
-	// Need to clean up the string hash
-	for_each(mStringHash.begin(), mStringHash.end(), DeletePairedPointer());
-	mStringHash.clear();
-#endif
+	return (S32)i;
 }
 
-
-static U32 hash_my_string(const char *str, int max_entries)
+// Doubles the slot array.  Entries stay where they are in memory, only the
+// slots are rehashed, using the stored hashes.  Caller must hold mLock.
+void LLStringTable::grow()
 {
-	U32 retval = 0;
-#if 0
-	while (*str)
+	Slot* old_slots = mSlots;
+	S32 old_size = mMaxEntries;
+
+	mMaxEntries = old_size * 2;
+	mSlots = new Slot[mMaxEntries];
+	U32 mask = mMaxEntries - 1;
+	S32 i;
+	for (i = 0; i < mMaxEntries; i++)
 	{
-		retval <<= 1;
-		retval += *str++;
+		mSlots[i].mHash = 0;
+		mSlots[i].mEntry = NULL;
 	}
-#else
-	while (*str)
+	for (i = 0; i < old_size; i++)
 	{
-		retval = (retval<<4) + *str;
-		U32 x = (retval & 0xf0000000);
-		if (x) retval = retval ^ (x>>24);
-		retval = retval & (~x);
-		str++;
+		if (old_slots[i].mEntry)
+		{
+			U32 j = old_slots[i].mHash & mask;
+			while (mSlots[j].mEntry)
+			{
+				j = (j + 1) & mask;
+			}
+			mSlots[j] = old_slots[i];
+		}
 	}
-#endif
-	return (retval & (max_entries-1)); // max_entries is gauranteed to be power of 2
+	delete [] old_slots;
 }
 
 char* LLStringTable::checkString(const std::string& str)
@@ -155,43 +201,9 @@ LLStringTableEntry* LLStringTable::checkStringEntry(const char *str)
 {
 	if (str)
 	{
-		char *ret_val;
-		LLStringTableEntry	*entry;
-		U32					hash_value = hash_my_string(str, mMaxEntries);
-#if STRING_TABLE_HASH_MAP
-#if 1 // Microsoft
-		string_hash_t::iterator lower = mStringHash.lower_bound(hash_value);
-		string_hash_t::iterator upper = mStringHash.upper_bound(hash_value);
-#else // stlport
-		std::pair<string_hash_t::iterator, string_hash_t::iterator> P = mStringHash.equal_range(hash_value);
-		string_hash_t::iterator lower = P.first;
-		string_hash_t::iterator upper = P.second;
-#endif
-		for (string_hash_t::iterator iter = lower; iter != upper; iter++)
-		{
-			entry = iter->second;
-			ret_val = entry->mString;
-			if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-			{
-				return entry;
-			}
-		}
-#else
-		string_list_t		*strlist = mStringList[hash_value];
-		if (strlist)
-		{
-			string_list_t::iterator iter;
-			for (iter = strlist->begin(); iter != strlist->end(); iter++)
-			{
-				entry = *iter;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					return entry;
-				}
-			}
-		}
-#endif
+		U32 hash_value = hashString(str);
+		LLStringTableLock lock(mLock);
+		return mSlots[findSlot(str, hash_value)].mEntry;
 	}
 	return NULL;
 }
@@ -225,63 +237,27 @@ LLStringTableEntry* LLStringTable::addStringEntry(const char *str)
 {
 	if (str)
 	{
-		char *ret_val = NULL;
-		LLStringTableEntry	*entry;
-		U32					hash_value = hash_my_string(str, mMaxEntries);
-#if STRING_TABLE_HASH_MAP
-#if 1 // Microsoft
-		string_hash_t::iterator lower = mStringHash.lower_bound(hash_value);
-		string_hash_t::iterator upper = mStringHash.upper_bound(hash_value);
-#else // stlport
-		std::pair<string_hash_t::iterator, string_hash_t::iterator> P = mStringHash.equal_range(hash_value);
-		string_hash_t::iterator lower = P.first;
-		string_hash_t::iterator upper = P.second;
-#endif
-		for (string_hash_t::iterator iter = lower; iter != upper; iter++)
+		U32 hash_value = hashString(str);
+		LLStringTableLock lock(mLock);
+		S32 slot = findSlot(str, hash_value);
+		LLStringTableEntry* entry = mSlots[slot].mEntry;
+		if (entry)
 		{
-			entry = iter->second;
-			ret_val = entry->mString;
-			if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-			{
-				entry->incCount();
-				return entry;
-			}
+			entry->incCount();
+			return entry;
 		}
 
-		// not found, so add!
-		LLStringTableEntry* newentry = new LLStringTableEntry(str);
-		ret_val = newentry->mString;
-		mStringHash.insert(string_hash_t::value_type(hash_value, newentry));
-#else
-		string_list_t		*strlist = mStringList[hash_value];
-
-		if (strlist)
-		{
-			string_list_t::iterator iter;
-			for (iter = strlist->begin(); iter != strlist->end(); iter++)
-			{
-				entry = *iter;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					entry->incCount();
-					return entry;
-				}
-			}
-		}
-		else
+		// not found, so add!  Keep the load factor under 3/4.
+		if ((mUniqueEntries + 1) * 4 > mMaxEntries * 3)
 		{
-			mStringList[hash_value] = new string_list_t;
-			strlist = mStringList[hash_value];
+			grow();
+			slot = findSlot(str, hash_value);
 		}
-
-		// not found, so add!
-		LLStringTableEntry *newentry = new LLStringTableEntry(str);
-		//ret_val = newentry->mString;
-		strlist->push_front(newentry);
-#endif
+		entry = new LLStringTableEntry(str, hash_value);
+		mSlots[slot].mHash = hash_value;
+		mSlots[slot].mEntry = entry;
 		mUniqueEntries++;
-		return newentry;
+		return entry;
 	}
 	else
 	{
@@ -293,66 +269,53 @@ void LLStringTable::removeString(const char *str)
 {
 	if (str)
 	{
-		char *ret_val;
-		LLStringTableEntry	*entry;
-		U32					hash_value = hash_my_string(str, mMaxEntries);
-#if STRING_TABLE_HASH_MAP
+		U32 hash_value = hashString(str);
+		LLStringTableLock lock(mLock);
+		U32 hole = findSlot(str, hash_value);
+		LLStringTableEntry* entry = mSlots[hole].mEntry;
+		if (!entry || entry->decCount())
 		{
-#if 1 // Microsoft
-			string_hash_t::iterator lower = mStringHash.lower_bound(hash_value);
-			string_hash_t::iterator upper = mStringHash.upper_bound(hash_value);
-#else // stlport
-			std::pair<string_hash_t::iterator, string_hash_t::iterator> P = mStringHash.equal_range(hash_value);
-			string_hash_t::iterator lower = P.first;
-			string_hash_t::iterator upper = P.second;
-#endif
-			for (string_hash_t::iterator iter = lower; iter != upper; iter++)
-			{
-				entry = iter->second;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					if (!entry->decCount())
-					{
-						mUniqueEntries--;
-						if (mUniqueEntries < 0)
-						{
-							llerror("LLStringTable:removeString trying to remove too many strings!", 0);
-						}
-						delete iter->second;
-						mStringHash.erase(iter);
-					}
-					return;
-				}
-			}
+			return;
 		}
-#else
-		string_list_t		*strlist = mStringList[hash_value];
 
-		if (strlist)
+		mUniqueEntries--;
+		if (mUniqueEntries < 0)
 		{
-			string_list_t::iterator iter;
-			for (iter = strlist->begin(); iter != strlist->end(); iter++)
+			llerror("LLStringTable:removeString trying to remove too many strings!", 0);
+		}
+		delete entry;
+
+		// Shift later members of the probe run back into the hole so that
+		// lookups never need tombstones.
+		U32 mask = mMaxEntries - 1;
+		U32 i = hole;
+		while (true)
+		{
+			i = (i + 1) & mask;
+			if (!mSlots[i].mEntry)
+			{
+				break;
+			}
+			U32 home = mSlots[i].mHash & mask;
+			if (((i - home) & mask) >= ((i - hole) & mask))
 			{
-				entry = *iter;
-				ret_val = entry->mString;
-				if (!strncmp(ret_val, str, MAX_STRINGS_LENGTH))
-				{
-					if (!entry->decCount())
-					{
-						mUniqueEntries--;
-						if (mUniqueEntries < 0)
-						{
-							llerror("LLStringTable:removeString trying to remove too many strings!", 0);
-						}
-						strlist->remove(entry);
-						delete entry;
-					}
-					return;
-				}
+				mSlots[hole] = mSlots[i];
+				hole = i;
 			}
 		}
-#endif
+		mSlots[hole].mHash = 0;
+		mSlots[hole].mEntry = NULL;
 	}
 }
 
+void LLStringTable::getStrings(std::vector<const char*>& strings)
+{
+	LLStringTableLock lock(mLock);
+	for (S32 i = 0; i < mMaxEntries; i++)
+	{
+		if (mSlots[i].mEntry)
+		{
+			strings.push_back(mSlots[i].mEntry->mString);
+		}
+	}
+}
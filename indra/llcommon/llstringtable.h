@@ -33,29 +33,14 @@
 #include "llstl.h"
 #include <list>
 #include <set>
-
-#if LL_WINDOWS
-# if (_MSC_VER >= 1300 && _MSC_VER < 1400)
-#  define STRING_TABLE_HASH_MAP 1
-# endif
-#else
-//# define STRING_TABLE_HASH_MAP 1
-#endif
-
-#if STRING_TABLE_HASH_MAP
-# if LL_WINDOWS
-#  include <hash_map>
-# else
-#  include <ext/hash_map>
-# endif
-#endif
+#include <vector>
 
 const U32 MAX_STRINGS_LENGTH = 256;
 
 class LL_COMMON_API LLStringTableEntry
 {
 public:
-	LLStringTableEntry(const char *str);
+	LLStringTableEntry(const char *str, U32 hash = 0);
 	~LLStringTableEntry();
 
 	void incCount()		{ mCount++; }
@@ -63,8 +48,16 @@ public:
 
 	char *mString;
 	S32  mCount;
+	U32  mHash;
 };
 
+// Interned strings, stored in an open addressed table (linear probing) of
+// {hash, entry} slots so a probe usually touches a single cache line and
+// only dereferences an entry when the full 32 bit hash matches.  Entries
+// are never moved, so the returned char* and LLStringTableEntry* handles
+// stay valid until the string is removed, and the table grows as needed.
+// Lookups and additions are guarded by a spin lock and may be made from
+// any thread.
 class LL_COMMON_API LLStringTable
 {
 public:
@@ -82,21 +75,26 @@ public:
 	LLStringTableEntry *addStringEntry(const std::string& str);
 	void  removeString(const char *str);
 
-	S32 mMaxEntries;
+	// Appends every string currently in the table, in no particular order.
+	void getStrings(std::vector<const char*>& strings);
+
+	static U32 hashString(const char *str);
+
+	S32 mMaxEntries;	// number of slots, always a power of 2
 	S32 mUniqueEntries;
-	
-#if STRING_TABLE_HASH_MAP
-#if LL_WINDOWS
-	typedef std::hash_multimap<U32, LLStringTableEntry *> string_hash_t;
-#else
-	typedef __gnu_cxx::hash_multimap<U32, LLStringTableEntry *> string_hash_t;
-#endif
-	string_hash_t mStringHash;
-#else
-	typedef std::list<LLStringTableEntry *> string_list_t;
-	typedef string_list_t * string_list_ptr_t;
-	string_list_ptr_t	*mStringList;
-#endif	
+
+private:
+	struct Slot
+	{
+		U32					mHash;
+		LLStringTableEntry*	mEntry;	// NULL if the slot is free
+	};
+
+	S32 findSlot(const char *str, U32 hash) const;
+	void grow();
+
+	Slot*			mSlots;
+	volatile U32	mLock;
 };
 
 extern LL_COMMON_API LLStringTable gStringTable;
@@ -194,13 +194,6 @@ void LLThread::unlockData()
 
 class LL_COMMON_API LLThreadSafeRefCount
 {
-public:
-	static void initThreadSafeRefCount(); // creates sMutex
-	static void cleanupThreadSafeRefCount(); // destroys sMutex
-	
-private:
-	static LLMutex* sMutex;
-
 private:
 	LLThreadSafeRefCount(const LLThreadSafeRefCount&); // not implemented
 	LLThreadSafeRefCount&operator=(const LLThreadSafeRefCount&); // not implemented
@@ -213,18 +206,16 @@ public:
 	
 	void ref()
 	{
-		if (sMutex) sMutex->lock();
 		mRef++; 
-		if (sMutex) sMutex->unlock();
 	} 
 
 	S32 unref()
 	{
 		llassert(mRef >= 1);
-		if (sMutex) sMutex->lock();
-		S32 res = --mRef;
-		if (sMutex) sMutex->unlock();
-		if (0 == res) 
+		// Another thread may delete this as soon as the count drops,
+		// so the result comes from the decrement itself.
+		S32 res = mRef.FetchAndSub(1) - 1;
+		if (0 == res)
 		{
 			delete this; 
 			return 0;
@@ -233,11 +224,11 @@ public:
 	}	
 	S32 getNumRefs() const
 	{
-		return mRef;
+		return mRef.CurrentValue();
 	}
 
 private: 
-	S32	mRef; 
+	LLAtomicS32	mRef; 
 };
 
 //============================================================================
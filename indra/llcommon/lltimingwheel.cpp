@@ -0,0 +1,286 @@
+/**
+ * @file lltimingwheel.cpp
+ * @brief Hierarchical timing wheel for scheduling large numbers of timers.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltimingwheel.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//		LLTimingWheel::Entry Implementation
+//
+//////////////////////////////////////////////////////////////////////////////
+
+LLTimingWheel::Entry::Entry()
+:	mPrev(this),
+	mNext(this),
+	mExpiry(0),
+	mWheel(NULL)
+{
+}
+
+LLTimingWheel::Entry::Entry(const Entry&)
+:	mPrev(this),
+	mNext(this),
+	mExpiry(0),
+	mWheel(NULL)
+{
+}
+
+LLTimingWheel::Entry::~Entry()
+{
+	if (mWheel)
+	{
+		mWheel->mCount--;
+	}
+	unlink();
+}
+
+void LLTimingWheel::Entry::unlink()
+{
+	mPrev->mNext = mNext;
+	mNext->mPrev = mPrev;
+	mPrev = this;
+	mNext = this;
+}
+
+void LLTimingWheel::Entry::linkBefore(Entry* next)
+{
+	mPrev = next->mPrev;
+	mNext = next;
+	mPrev->mNext = this;
+	next->mPrev = this;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//		LLTimingWheel::EntryList Implementation
+//
+//////////////////////////////////////////////////////////////////////////////
+
+LLTimingWheel::EntryList::EntryList()
+{
+}
+
+LLTimingWheel::EntryList::~EntryList()
+{
+	while (!empty())
+	{
+		mHead.mNext->unlink();
+	}
+}
+
+LLTimingWheel::Entry* LLTimingWheel::EntryList::popFront()
+{
+	if (empty())
+	{
+		return NULL;
+	}
+	Entry* entry = mHead.mNext;
+	entry->unlink();
+	return entry;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//		LLTimingWheel Implementation
+//
+//////////////////////////////////////////////////////////////////////////////
+
+LLTimingWheel::LLTimingWheel(U64 start_tick)
+:	mCurrentTick(start_tick),
+	mCount(0),
+	mLevel0Mask(0)
+{
+}
+
+LLTimingWheel::~LLTimingWheel()
+{
+	// leave whatever is still scheduled unscheduled, rather than pointing
+	// at a wheel that is gone
+	Entry* lists[LEVELS * SLOTS + 1];
+	lists[0] = &mDue;
+	for (U32 level = 0; level < LEVELS; ++level)
+	{
+		for (U32 slot = 0; slot < SLOTS; ++slot)
+		{
+			lists[1 + level * SLOTS + slot] = &mSlots[level][slot];
+		}
+	}
+	for (U32 i = 0; i < LEVELS * SLOTS + 1; ++i)
+	{
+		while (lists[i]->mNext != lists[i])
+		{
+			Entry* entry = lists[i]->mNext;
+			entry->mWheel = NULL;
+			entry->unlink();
+		}
+	}
+}
+
+void LLTimingWheel::schedule(Entry* entry, U64 expiry)
+{
+	unschedule(entry);
+	entry->mExpiry = expiry;
+	entry->mWheel = this;
+	mCount++;
+	if (expiry <= mCurrentTick)
+	{
+		entry->linkBefore(&mDue);
+	}
+	else
+	{
+		insert(entry);
+	}
+}
+
+void LLTimingWheel::unschedule(Entry* entry)
+{
+	if (entry->mWheel)
+	{
+		entry->mWheel->mCount--;
+		entry->mWheel = NULL;
+	}
+	entry->unlink();
+}
+
+void LLTimingWheel::insert(Entry* entry)
+{
+	// pick the lowest level whose span reaches the expiry; mCurrentTick is
+	// the tick being processed, so delta is never negative here
+	U64 delta = entry->mExpiry - mCurrentTick;
+	U64 slotted = entry->mExpiry;
+	const U64 span = (U64)1 << (SLOT_BITS * LEVELS);
+	if (delta >= span)
+	{
+		// beyond the top level, park it at the far end and look again then
+		delta = span - 1;
+		slotted = mCurrentTick + delta;
+	}
+
+	U32 level = 0;
+	while (delta >= ((U64)1 << (SLOT_BITS * (level + 1))))
+	{
+		level++;
+	}
+	U32 slot = (U32)(slotted >> (SLOT_BITS * level)) & (SLOTS - 1);
+	if (level == 0)
+	{
+		mLevel0Mask |= (U64)1 << slot;
+	}
+	entry->linkBefore(&mSlots[level][slot]);
+}
+
+void LLTimingWheel::cascade(U32 level)
+{
+	U32 slot = (U32)(mCurrentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+	Entry& head = mSlots[level][slot];
+	while (head.mNext != &head)
+	{
+		Entry* entry = head.mNext;
+		entry->unlink();
+		insert(entry);
+	}
+}
+
+void LLTimingWheel::expire(Entry* entry, EntryList& expired)
+{
+	entry->unlink();
+	entry->mWheel = NULL;
+	mCount--;
+	entry->linkBefore(&expired.mHead);
+}
+
+void LLTimingWheel::advance(U64 now, EntryList& expired)
+{
+	while (mDue.mNext != &mDue)
+	{
+		expire(mDue.mNext, expired);
+	}
+
+	while (mCurrentTick < now)
+	{
+		if (mCount == 0)
+		{
+			mCurrentTick = now;
+			break;
+		}
+		if (mLevel0Mask == 0)
+		{
+			// nothing due before level 0 wraps, skip straight to that
+			U64 last_before_wrap = mCurrentTick | (SLOTS - 1);
+			if (last_before_wrap >= now)
+			{
+				mCurrentTick = now;
+				break;
+			}
+			mCurrentTick = last_before_wrap;
+		}
+
+		++mCurrentTick;
+		U32 slot = (U32)mCurrentTick & (SLOTS - 1);
+		if (slot == 0)
+		{
+			// bring the next stretch of each wrapping level down a level
+			for (U32 level = 1; level < LEVELS; ++level)
+			{
+				cascade(level);
+				if (((mCurrentTick >> (SLOT_BITS * level)) & (SLOTS - 1)) != 0)
+				{
+					break;
+				}
+			}
+		}
+
+		U64 bit = (U64)1 << slot;
+		if (mLevel0Mask & bit)
+		{
+			mLevel0Mask &= ~bit;
+			Entry pending;
+			Entry& head = mSlots[0][slot];
+			while (head.mNext != &head)
+			{
+				Entry* entry = head.mNext;
+				entry->unlink();
+				entry->linkBefore(&pending);
+			}
+			while (pending.mNext != &pending)
+			{
+				Entry* entry = pending.mNext;
+				if (entry->mExpiry <= mCurrentTick)
+				{
+					expire(entry, expired);
+				}
+				else
+				{
+					// parked beyond the top level
+					entry->unlink();
+					insert(entry);
+				}
+			}
+		}
+	}
+}
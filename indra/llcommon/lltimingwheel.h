@@ -0,0 +1,127 @@
+/**
+ * @file lltimingwheel.h
+ * @brief Hierarchical timing wheel for scheduling large numbers of timers.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTIMINGWHEEL_H
+#define LL_LLTIMINGWHEEL_H
+
+#include "stdtypes.h"
+
+// Schedules entries to expire at a tick, in whatever unit the owner counts
+// time in, so that advancing the clock only touches the entries that are
+// about to expire instead of every scheduled one.
+//
+// Each level is a ring of SLOTS lists; level 0 holds the entries due within
+// SLOTS ticks, level 1 those due within SLOTS^2 ticks, and so on.  Whenever
+// a level wraps, the next slot of the level above is redistributed to the
+// levels below it.  Scheduling, unscheduling and expiring an entry are all
+// constant time.  Entries further out than the top level can hold are parked
+// at its far end and rescheduled from there.
+//
+// Entries are intrusive: derive from LLTimingWheel::Entry.  Destroying an
+// entry removes it from whichever wheel or list it is in, so the owner of an
+// expired list can safely run callbacks that delete other entries.
+class LL_COMMON_API LLTimingWheel
+{
+public:
+	class LL_COMMON_API Entry
+	{
+	public:
+		Entry();
+		// copies start out unscheduled
+		Entry(const Entry&);
+		Entry& operator=(const Entry&) { return *this; }
+		virtual ~Entry();
+
+		// TRUE while waiting in a wheel, FALSE once expired or unscheduled
+		BOOL isScheduled() const { return mWheel != NULL; }
+		U64 getExpiry() const { return mExpiry; }
+
+	private:
+		void unlink();
+		void linkBefore(Entry* next);
+
+		friend class LLTimingWheel;
+		Entry* mPrev;
+		Entry* mNext;
+		U64 mExpiry;
+		LLTimingWheel* mWheel;
+	};
+
+	// Expired entries, handed back by advance().
+	class LL_COMMON_API EntryList
+	{
+	public:
+		EntryList();
+		~EntryList();
+
+		bool empty() const { return mHead.mNext == &mHead; }
+		// Removes and returns the first entry, or NULL if empty.
+		Entry* popFront();
+
+	private:
+		EntryList(const EntryList&);
+		EntryList& operator=(const EntryList&);
+
+		friend class LLTimingWheel;
+		Entry mHead;
+	};
+
+	LLTimingWheel(U64 start_tick = 0);
+	~LLTimingWheel();
+
+	// Schedules entry to expire at tick expiry, moving it if it is already
+	// scheduled.  Entries due at or before the current tick expire on the
+	// next advance().
+	void schedule(Entry* entry, U64 expiry);
+	// Removes entry from the wheel, or from the expired list it waits in.
+	void unschedule(Entry* entry);
+
+	// Moves the clock forward to now, appending every entry that expired
+	// on the way to expired.
+	void advance(U64 now, EntryList& expired);
+
+	U64 getCurrentTick() const { return mCurrentTick; }
+	U32 size() const { return mCount; }
+
+	enum { SLOT_BITS = 6, SLOTS = 1 << SLOT_BITS, LEVELS = 5 };
+
+private:
+	LLTimingWheel(const LLTimingWheel&);
+	LLTimingWheel& operator=(const LLTimingWheel&);
+
+	void insert(Entry* entry);
+	void cascade(U32 level);
+	void expire(Entry* entry, EntryList& expired);
+
+	U64 mCurrentTick;
+	U32 mCount;
+	// Bit per level 0 slot that may hold entries, to skip empty stretches.
+	U64 mLevel0Mask;
+	Entry mDue;
+	Entry mSlots[LEVELS][SLOTS];
+};
+
+#endif // LL_LLTIMINGWHEEL_H
@@ -0,0 +1,328 @@
+/**
+ * @file lluuidflatmap.h
+ * @brief Open addressed hash map keyed by LLUUID.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLUUIDFLATMAP_H
+#define LL_LLUUIDFLATMAP_H
+
+#include "lluuid.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Hash map from LLUUID with the part of the std::map interface that the
+// UUID registries use.  UUIDs are already random, so folding the key's
+// words together is hash enough, and keys and values sit side by side in
+// one linearly probed array, so a lookup usually touches a single cache
+// line instead of walking a tree.
+//
+// Differences from std::map:
+// - iteration order is arbitrary, and changes when the table grows,
+// - inserting may rehash, which invalidates every iterator,
+// - erasing leaves a tombstone, so other iterators stay valid and
+//   erase(iter++) works as it does with std::map,
+// - value_type is std::pair<LLUUID, T>; don't change a key through it.
+template <class T>
+class LLUUIDFlatMap
+{
+	enum { EMPTY = 0, FULL, DELETED };
+	enum { MIN_CAPACITY = 16 };
+
+public:
+	typedef LLUUID key_type;
+	typedef T mapped_type;
+	typedef std::pair<LLUUID, T> value_type;
+	typedef size_t size_type;
+
+	template <class MAP, class VALUE>
+	class iterator_base
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef VALUE value_type;
+		typedef ptrdiff_t difference_type;
+		typedef VALUE* pointer;
+		typedef VALUE& reference;
+
+		iterator_base() : mMap(NULL), mSlot(0) {}
+		iterator_base(MAP* map, U32 slot) : mMap(map), mSlot(slot) {}
+
+		// iterator to const_iterator
+		template <class OTHER_MAP, class OTHER_VALUE>
+		iterator_base(const iterator_base<OTHER_MAP, OTHER_VALUE>& other)
+		:	mMap(other.mMap), mSlot(other.mSlot)
+		{
+		}
+
+		VALUE& operator*() const { return mMap->mSlots[mSlot]; }
+		VALUE* operator->() const { return &mMap->mSlots[mSlot]; }
+
+		iterator_base& operator++()
+		{
+			mSlot = mMap->nextFull(mSlot + 1);
+			return *this;
+		}
+
+		iterator_base operator++(int)
+		{
+			iterator_base prev = *this;
+			++(*this);
+			return prev;
+		}
+
+		template <class OTHER_MAP, class OTHER_VALUE>
+		bool operator==(const iterator_base<OTHER_MAP, OTHER_VALUE>& other) const { return mSlot == other.mSlot; }
+		template <class OTHER_MAP, class OTHER_VALUE>
+		bool operator!=(const iterator_base<OTHER_MAP, OTHER_VALUE>& other) const { return mSlot != other.mSlot; }
+
+		// Position in the table, for resuming a walk with beginAt().
+		U32 getSlot() const { return mSlot; }
+
+	private:
+		template <class OTHER_MAP, class OTHER_VALUE> friend class iterator_base;
+		friend class LLUUIDFlatMap;
+
+		MAP* mMap;
+		U32 mSlot;
+	};
+
+	typedef iterator_base<LLUUIDFlatMap, value_type> iterator;
+	typedef iterator_base<const LLUUIDFlatMap, const value_type> const_iterator;
+
+	LLUUIDFlatMap() : mSize(0), mDeleted(0) {}
+
+	iterator begin() { return iterator(this, nextFull(0)); }
+	iterator end() { return iterator(this, capacity()); }
+	const_iterator begin() const { return const_iterator(this, nextFull(0)); }
+	const_iterator end() const { return const_iterator(this, capacity()); }
+
+	// First element at or after slot, for round robin walks that span
+	// frames; the table may have been rehashed in between, which only
+	// means some elements get visited early or late.
+	iterator beginAt(U32 slot) { return iterator(this, nextFull(slot < capacity() ? slot : capacity())); }
+
+	size_type size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+
+	iterator find(const LLUUID& key) { return iterator(this, findSlot(key)); }
+	const_iterator find(const LLUUID& key) const { return const_iterator(this, findSlot(key)); }
+	size_type count(const LLUUID& key) const { return findSlot(key) != capacity() ? 1 : 0; }
+
+	T& operator[](const LLUUID& key)
+	{
+		return mSlots[insertSlot(key).first].second;
+	}
+
+	std::pair<iterator, bool> insert(const value_type& value)
+	{
+		std::pair<U32, bool> result = insertSlot(value.first);
+		if (result.second)
+		{
+			mSlots[result.first].second = value.second;
+		}
+		return std::make_pair(iterator(this, result.first), result.second);
+	}
+
+	void erase(iterator iter)
+	{
+		mStates[iter.mSlot] = DELETED;
+		mSlots[iter.mSlot] = value_type();
+		mSize--;
+		mDeleted++;
+	}
+
+	size_type erase(const LLUUID& key)
+	{
+		U32 slot = findSlot(key);
+		if (slot == capacity())
+		{
+			return 0;
+		}
+		erase(iterator(this, slot));
+		return 1;
+	}
+
+	void clear()
+	{
+		if (mSize || mDeleted)
+		{
+			std::fill(mSlots.begin(), mSlots.end(), value_type());
+			std::fill(mStates.begin(), mStates.end(), (U8)EMPTY);
+			mSize = 0;
+			mDeleted = 0;
+		}
+	}
+
+	void swap(LLUUIDFlatMap& other)
+	{
+		mSlots.swap(other.mSlots);
+		mStates.swap(other.mStates);
+		std::swap(mSize, other.mSize);
+		std::swap(mDeleted, other.mDeleted);
+	}
+
+	// Makes room for count elements without rehashing.
+	void reserve(size_type count)
+	{
+		U32 new_capacity = capacityFor((U32)count);
+		if (new_capacity > capacity())
+		{
+			rehash(new_capacity);
+		}
+	}
+
+private:
+	U32 capacity() const { return (U32)mStates.size(); }
+
+	static U32 hashKey(const LLUUID& key)
+	{
+		U32 words[4];
+		memcpy(words, key.mData, sizeof(words));	/* Flawfinder: ignore */
+		U32 hash = (words[0] ^ words[1] ^ words[2] ^ words[3]) * 2654435761U;
+		return hash ^ (hash >> 16);
+	}
+
+	// smallest power of 2 at most half full with count elements
+	static U32 capacityFor(U32 count)
+	{
+		U32 new_capacity = MIN_CAPACITY;
+		while (new_capacity < count * 2)
+		{
+			new_capacity *= 2;
+		}
+		return new_capacity;
+	}
+
+	U32 nextFull(U32 slot) const
+	{
+		U32 end = capacity();
+		while (slot < end && mStates[slot] != FULL)
+		{
+			++slot;
+		}
+		return slot;
+	}
+
+	// returns capacity() if key is missing
+	U32 findSlot(const LLUUID& key) const
+	{
+		U32 end = capacity();
+		if (!mSize)
+		{
+			return end;
+		}
+		U32 mask = end - 1;
+		for (U32 slot = hashKey(key) & mask; ; slot = (slot + 1) & mask)
+		{
+			U8 state = mStates[slot];
+			if (state == EMPTY)
+			{
+				return end;
+			}
+			if (state == FULL && mSlots[slot].first == key)
+			{
+				return slot;
+			}
+		}
+	}
+
+	// slot holding key, and whether it was added
+	std::pair<U32, bool> insertSlot(const LLUUID& key)
+	{
+		U32 slot = findSlot(key);
+		if (slot != capacity())
+		{
+			return std::make_pair(slot, false);
+		}
+
+		// keep at least a quarter of the slots empty so probes stay short
+		if ((mSize + mDeleted + 1) * 4 > capacity() * 3)
+		{
+			rehash(capacityFor(mSize + 1));
+		}
+
+		U32 mask = capacity() - 1;
+		slot = hashKey(key) & mask;
+		while (mStates[slot] == FULL)
+		{
+			slot = (slot + 1) & mask;
+		}
+		if (mStates[slot] == DELETED)
+		{
+			mDeleted--;
+		}
+		mStates[slot] = FULL;
+		mSlots[slot].first = key;
+		mSize++;
+		return std::make_pair(slot, true);
+	}
+
+	void rehash(U32 new_capacity)
+	{
+		std::vector<value_type> old_slots(new_capacity);
+		std::vector<U8> old_states(new_capacity, (U8)EMPTY);
+		old_slots.swap(mSlots);
+		old_states.swap(mStates);
+
+		U32 mask = new_capacity - 1;
+		for (U32 i = 0; i < (U32)old_states.size(); ++i)
+		{
+			if (old_states[i] == FULL)
+			{
+				U32 slot = hashKey(old_slots[i].first) & mask;
+				while (mStates[slot] != EMPTY)
+				{
+					slot = (slot + 1) & mask;
+				}
+				mStates[slot] = FULL;
+				mSlots[slot] = old_slots[i];
+			}
+		}
+		mDeleted = 0;
+	}
+
+	std::vector<value_type> mSlots;
+	std::vector<U8> mStates;
+	U32 mSize;
+	U32 mDeleted;
+};
+
+// llstl.h style helpers, for maps that used to be std::maps
+template <class T>
+inline T* get_ptr_in_map(const LLUUIDFlatMap<T*>& inmap, const LLUUID& key)
+{
+	typename LLUUIDFlatMap<T*>::const_iterator iter = inmap.find(key);
+	return iter == inmap.end() ? NULL : iter->second;
+}
+
+template <class T>
+inline bool is_in_map(const LLUUIDFlatMap<T>& inmap, const LLUUID& key)
+{
+	return inmap.count(key) != 0;
+}
+
+#endif // LL_LLUUIDFLATMAP_H
@@ -0,0 +1,187 @@
+/**
+ * @file llallocator_sampler_test.cpp
+ * @date 2011-08-12
+ * @brief Tests for the LLAllocatorSampler heap profiler.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llallocator_sampler.h"
+#include "../llmemtype.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// The sampler only compares addresses, so the tests make them up.
+	void* fake_pointer(U32 i)
+	{
+		return (void*)(uintptr_t)(0x100000 + i * 16);
+	}
+
+	void allocate_here(U32 first, U32 count, size_t size)
+	{
+		for (U32 i = first; i < first + count; ++i)
+		{
+			LLAllocatorSampler::recordAlloc(fake_pointer(i), size);
+		}
+	}
+
+	// a second call site, different enough not to be folded into the first
+	void allocate_there(U32 first, U32 count, size_t size)
+	{
+		for (U32 i = first + count; i > first; --i)
+		{
+			LLAllocatorSampler::recordAlloc(fake_pointer(i - 1), size);
+		}
+	}
+}
+
+namespace tut
+{
+	struct allocator_sampler
+	{
+		~allocator_sampler()
+		{
+			LLAllocatorSampler::setSampleInterval(0);
+		}
+	};
+
+	typedef test_group<allocator_sampler> allocator_sampler_t;
+	typedef allocator_sampler_t::object allocator_sampler_object_t;
+	tut::allocator_sampler_t tut_allocator_sampler("LLAllocatorSampler");
+
+	template<> template<>
+	void allocator_sampler_object_t::test<1>()
+	{
+		// nothing is recorded while off
+		allocate_here(0, 10, 100);
+		ensure_equals("off", LLAllocatorSampler::getSiteCount(), 0U);
+
+		// an interval of one byte samples everything, exactly
+		LLAllocatorSampler::setSampleInterval(1);
+		{
+			LLMemType mem_type(LLMemType::MTYPE_STARTUP);
+			allocate_here(0, 10, 100);
+		}
+		for (U32 i = 0; i < 4; ++i)
+		{
+			LLAllocatorSampler::recordFree(fake_pointer(i));
+		}
+		// never sampled
+		LLAllocatorSampler::recordFree(fake_pointer(1000));
+		ensure_equals("live size", LLAllocatorSampler::getLiveSize(), 600U);
+
+		LLAllocatorSampler::sites_t sites;
+		LLAllocatorSampler::getSites(sites);
+		ensure_equals("one site", sites.size(), 1U);
+		ensure_equals("site live size", sites[0].mLiveSize, 600U);
+		ensure_equals("site total size", sites[0].mTotalSize, 1000U);
+		ensure_equals("site live count", sites[0].mLiveCount, 6U);
+		ensure_equals("memory type", sites[0].mMemType, LLMemType::MTYPE_STARTUP.mID);
+
+		LLAllocatorSampler::setSampleInterval(0);
+		ensure_equals("forgotten", LLAllocatorSampler::getSiteCount(), 0U);
+	}
+
+	template<> template<>
+	void allocator_sampler_object_t::test<2>()
+	{
+		// growth is measured from the baseline
+		LLAllocatorSampler::setSampleInterval(1);
+		allocate_here(0, 100, 10);
+		LLAllocatorSampler::markBaseline();
+		allocate_here(100, 10, 10);
+		allocate_there(200, 50, 10);
+
+		LLAllocatorSampler::sites_t sites;
+		LLAllocatorSampler::getSites(sites);
+		ensure("several sites", sites.size() >= 2);
+		ensure_equals("largest growth first", sites[0].mGrowth, 500);
+		S64 growth = 0;
+		U64 live = 0;
+		for (size_t i = 0; i < sites.size(); ++i)
+		{
+			ensure("sorted", !i || sites[i - 1].mGrowth >= sites[i].mGrowth);
+			growth += sites[i].mGrowth;
+			live += sites[i].mLiveSize;
+		}
+		ensure_equals("total growth", growth, 600);
+		ensure_equals("total live size", live, 1600U);
+
+		LLAllocatorSampler::getSites(sites, 1);
+		ensure_equals("limited", sites.size(), 1U);
+	}
+
+	template<> template<>
+	void allocator_sampler_object_t::test<3>()
+	{
+		// sparse sampling estimates the real totals
+		const U32 COUNT = 100000;
+		const size_t SIZE = 64;
+		LLAllocatorSampler::setSampleInterval(4096);
+		allocate_here(0, COUNT, SIZE);
+
+		F64 expected = (F64)COUNT * SIZE;
+		F64 estimate = (F64)LLAllocatorSampler::getLiveSize();
+		ensure("estimate close", fabs(estimate - expected) < expected * 0.1);
+
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			LLAllocatorSampler::recordFree(fake_pointer(i));
+		}
+		ensure_equals("all freed", LLAllocatorSampler::getLiveSize(), 0U);
+
+		// large allocations are always sampled, at their own size
+		allocate_here(0, 1, 1 << 20);
+		ensure("large allocation", LLAllocatorSampler::getLiveSize() >= (1 << 20));
+	}
+
+	template<> template<>
+	void allocator_sampler_object_t::test<4>()
+	{
+		// snapshots list every site
+		LLAllocatorSampler::setSampleInterval(1);
+		allocate_here(0, 10, 100);
+		allocate_there(100, 10, 100);
+
+		std::string filename("llallocator_sampler_test.txt");
+		ensure("written", LLAllocatorSampler::writeSnapshot(filename));
+
+		llifstream in(filename);
+		std::string line;
+		S32 lines = 0;
+		while (std::getline(in, line))
+		{
+			if (!line.empty() && line[0] != '#')
+			{
+				ensure("live size column", line.compare(0, 4, "1000") == 0);
+				lines++;
+			}
+		}
+		in.close();
+		LLFile::remove(filename);
+		ensure_equals("one line per site", lines, 2);
+	}
+}
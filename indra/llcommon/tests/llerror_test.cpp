@@ -744,6 +744,40 @@ namespace tut
 		ensure_message_contains(8, "big easy");
 		ensure_message_count(9);
 	}
+
+	template<> template<>
+		// asynchronous logging keeps every message, in order,
+		// and errors are written before the fatal function is called
+	void ErrorTestObject::test<17>()
+	{
+		const int MESSAGES = 3000; // more than the queue holds
+		LLError::setAsyncLogging(true);
+		for (int i = 0; i < MESSAGES; ++i)
+		{
+			llinfos << "queued " << i << "." << llendl;
+		}
+		LLError::flushAsyncLog();
+		ensure_message_count(MESSAGES);
+		for (int i = 0; i < MESSAGES; ++i)
+		{
+			std::ostringstream expected;
+			expected << "queued " << i << ".";
+			ensure_message_contains(i, expected.str());
+		}
+
+		llinfos << "before the error" << llendl;
+		llerrs << "bad word" << llendl;
+		ensure("fatal function called", fatalWasCalled);
+		ensure_message_contains(MESSAGES, "before the error");
+		ensure_message_contains(MESSAGES + 1, "error");
+		ensure_message_contains(MESSAGES + 2, "bad word");
+		ensure_message_count(MESSAGES + 3);
+
+		llinfos << "after" << llendl;
+		LLError::setAsyncLogging(false);
+		// stopping the writer thread may log too
+		ensure_message_contains(MESSAGES + 3, "after");
+	}
 }	
 
 /* Tests left:
@@ -0,0 +1,169 @@
+/**
+ * @file llfasttimer_test.cpp
+ * @date 2011-08-22
+ * @brief Tests for the LLFastTimer trace capture.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llfasttimer.h"
+
+#include <sstream>
+
+#include "../test/lltut.h"
+
+namespace
+{
+	const std::string TRACE_TIMER_NAME("Trace Test");
+	// quotes, a backslash and control characters, all of which need escaping
+	const std::string ESCAPED_TIMER_NAME("say \"hi\"\t\\\n\x01" "end");
+
+	LLFastTimer::DeclareTimer FTM_TRACE_TEST(TRACE_TIMER_NAME);
+	LLFastTimer::DeclareTimer FTM_ESCAPED_TEST(ESCAPED_TIMER_NAME);
+
+	struct trace_event
+	{
+		std::string mName;
+		F64 mTS;
+		F64 mDur;
+	};
+
+	// The "X" events of a trace, written one to a line by writeTrace().
+	void read_trace(const std::string& trace, std::vector<trace_event>& events)
+	{
+		std::istringstream is(trace);
+		std::string line;
+		while (std::getline(is, line))
+		{
+			if (line.find("\"ph\":\"X\"") == std::string::npos)
+			{
+				continue;
+			}
+			trace_event event;
+			size_t name = line.find("\"name\":") + 7;
+			size_t cat = line.find(",\"cat\":");
+			event.mName = line.substr(name, cat - name);
+			event.mTS = atof(line.c_str() + line.find("\"ts\":") + 5);
+			event.mDur = atof(line.c_str() + line.find("\"dur\":") + 6);
+			events.push_back(event);
+		}
+	}
+}
+
+namespace tut
+{
+	struct fasttimer
+	{
+		~fasttimer()
+		{
+			LLFastTimer::setTraceCapture(false);
+		}
+	};
+
+	typedef test_group<fasttimer> fasttimer_t;
+	typedef fasttimer_t::object fasttimer_object_t;
+	tut::fasttimer_t tut_fasttimer("LLFastTimer");
+
+	template<> template<>
+	void fasttimer_object_t::test<1>()
+	{
+		// More events than the ring holds, with the 32-bit clock wrapping
+		// part way through the ones kept: the last TRACE_BUFFER_SIZE are
+		// written, in order, with times relative to the first of them.
+		const LLFastTimer::NamedTimer* timer = LLFastTimer::getTimerByName(TRACE_TIMER_NAME);
+		ensure("timer declared", timer != NULL);
+
+		const U32 KEPT = LLFastTimer::TRACE_BUFFER_SIZE;
+		const U32 RECORDED = KEPT + KEPT / 4;
+		const U32 STEP = 50;
+		const U32 first_kept_start = 0U - (KEPT / 2) * STEP;
+		const U32 first_start = first_kept_start - (RECORDED - KEPT) * STEP;
+		LLFastTimer::setTraceCapture(true);
+		for (U32 i = 0; i < RECORDED; ++i)
+		{
+			LLFastTimer::recordTraceEvent(timer, first_start + i * STEP, 10 + i % 7);
+		}
+		LLFastTimer::setTraceCapture(false);
+
+		std::ostringstream os;
+		LLFastTimer::writeTrace(os);
+		std::vector<trace_event> events;
+		read_trace(os.str(), events);
+		ensure_equals("events kept", (U32)events.size(), KEPT);
+
+		F64 usec_per_count = 1000000.0 / (F64)LLFastTimer::countsPerSecond();
+		F64 tolerance = 0.001 + usec_per_count * 0.0001;
+		for (U32 i = 0; i < KEPT; ++i)
+		{
+			ensure_equals("name", events[i].mName, "\"" + TRACE_TIMER_NAME + "\"");
+			if (i)
+			{
+				ensure("non-decreasing ts", events[i].mTS >= events[i - 1].mTS);
+			}
+			// the first kept event is number RECORDED - KEPT
+			U32 recorded = RECORDED - KEPT + i;
+			ensure_distance("ts", events[i].mTS, (F64)(i * STEP) * usec_per_count, tolerance);
+			ensure_distance("dur", events[i].mDur, (F64)(10 + recorded % 7) * usec_per_count, tolerance);
+		}
+	}
+
+	template<> template<>
+	void fasttimer_object_t::test<2>()
+	{
+		// a capture started again leaves out the events of the last one
+		const LLFastTimer::NamedTimer* timer = LLFastTimer::getTimerByName(TRACE_TIMER_NAME);
+		LLFastTimer::setTraceCapture(true);
+		LLFastTimer::recordTraceEvent(timer, 1000, 10);
+		LLFastTimer::setTraceCapture(false);
+		LLFastTimer::setTraceCapture(true);
+		LLFastTimer::recordTraceEvent(timer, 2000, 10);
+		LLFastTimer::recordTraceEvent(timer, 2100, 10);
+		LLFastTimer::setTraceCapture(false);
+
+		std::ostringstream os;
+		LLFastTimer::writeTrace(os);
+		std::vector<trace_event> events;
+		read_trace(os.str(), events);
+		ensure_equals("events", events.size(), 2U);
+		ensure_equals("first ts", events[0].mTS, 0.0);
+	}
+
+	template<> template<>
+	void fasttimer_object_t::test<3>()
+	{
+		// names are written as JSON strings
+		const LLFastTimer::NamedTimer* timer = LLFastTimer::getTimerByName(ESCAPED_TIMER_NAME);
+		ensure("timer declared", timer != NULL);
+		LLFastTimer::setTraceCapture(true);
+		LLFastTimer::recordTraceEvent(timer, 0, 10);
+		LLFastTimer::setTraceCapture(false);
+
+		std::ostringstream os;
+		LLFastTimer::writeTrace(os);
+		std::vector<trace_event> events;
+		read_trace(os.str(), events);
+		ensure_equals("events", events.size(), 1U);
+		ensure_equals("escaped", events[0].mName, std::string("\"say \\\"hi\\\"\\u0009\\\\\\u000a\\u0001end\""));
+	}
+}
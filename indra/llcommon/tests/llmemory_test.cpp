@@ -0,0 +1,116 @@
+/**
+ * @file llmemory_test.cpp
+ * @date 2011-08-11
+ * @brief Tests for the LLFrameArena per-frame allocator.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmemory.h"
+
+#include <list>
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct memory
+	{
+	};
+
+	typedef test_group<memory> memory_t;
+	typedef memory_t::object memory_object_t;
+	tut::memory_t tut_memory("LLFrameArena");
+
+	template<> template<>
+	void memory_object_t::test<1>()
+	{
+		// allocations are aligned and don't overlap
+		LLFrameArena arena(1024);
+		char* a = (char*)arena.allocate(3);
+		char* b = (char*)arena.allocate(5);
+		char* c = (char*)arena.allocate(8, 64);
+		ensure_equals("a aligned", (uintptr_t)a % 16, 0U);
+		ensure_equals("b aligned", (uintptr_t)b % 16, 0U);
+		ensure_equals("c aligned", (uintptr_t)c % 64, 0U);
+		ensure("b after a", b >= a + 3);
+		ensure("c after b", c >= b + 5);
+		ensure_equals("allocations", arena.getAllocationCount(), 3U);
+		ensure_equals("one chunk", arena.getHeapAllocationCount(), 1U);
+
+		// reset hands out the same memory again
+		arena.reset();
+		ensure_equals("same memory", (char*)arena.allocate(3), a);
+		ensure_equals("last frame allocations", arena.getLastAllocationCount(), 3U);
+		ensure_equals("no heap this frame", arena.getHeapAllocationCount(), 0U);
+	}
+
+	template<> template<>
+	void memory_object_t::test<2>()
+	{
+		// a frame bigger than a chunk is coalesced into one chunk, after
+		// which the same frame doesn't touch the heap
+		LLFrameArena arena(1024);
+		for (S32 i = 0; i < 100; ++i)
+		{
+			arena.allocate(100);
+		}
+		ensure("needed several chunks", arena.getHeapAllocationCount() > 1);
+		arena.reset();
+		ensure("reserved enough", arena.getReservedBytes() >= 100 * 100);
+
+		for (S32 i = 0; i < 100; ++i)
+		{
+			arena.allocate(100);
+		}
+		ensure_equals("steady state", arena.getHeapAllocationCount(), 0U);
+
+		// oversized requests get a chunk of their own
+		char* big = (char*)arena.allocate(1024 * 1024);
+		big[1024 * 1024 - 1] = 1;
+		ensure_equals("big chunk", arena.getHeapAllocationCount(), 1U);
+	}
+
+	template<> template<>
+	void memory_object_t::test<3>()
+	{
+		// STL containers on the global arena
+		gFrameArena.reset();
+		{
+			std::vector<S32, LLFrameAllocator<S32> > numbers;
+			std::list<std::string, LLFrameAllocator<std::string> > names;
+			for (S32 i = 0; i < 1000; ++i)
+			{
+				numbers.push_back(i);
+				names.push_back("name");
+			}
+			ensure_equals("vector contents", numbers[999], 999);
+			ensure_equals("list size", names.size(), 1000U);
+			ensure("arena used", gFrameArena.getAllocationCount() > 1000);
+		}
+		gFrameArena.reset();
+		ensure("counted last frame", gFrameArena.getLastAllocationCount() > 1000);
+	}
+}
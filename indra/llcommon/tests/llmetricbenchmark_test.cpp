@@ -0,0 +1,186 @@
+/**
+ * @file llmetricbenchmark_test.cpp
+ * @date 2011-08-16
+ * @brief Tests for the LLMetricBenchmark harness.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmetricbenchmark.h"
+#include "../llfile.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// Counts the calls the harness makes.
+	class CountingBenchmark : public LLMetricBenchmark
+	{
+	public:
+		CountingBenchmark(const std::string& name) :
+			LLMetricBenchmark(name, 100),
+			mSetups(0),
+			mRuns(0),
+			mTotalIterations(0),
+			mTeardowns(0),
+			mSum(0)
+		{
+		}
+
+		virtual void setup() { mSetups++; }
+		virtual void run(U32 iterations)
+		{
+			mRuns++;
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				mSum += i * i;
+			}
+			mTotalIterations += iterations;
+		}
+		virtual void teardown() { mTeardowns++; }
+
+		S32 mSetups;
+		S32 mRuns;
+		U32 mTotalIterations;
+		S32 mTeardowns;
+		volatile U32 mSum;
+	};
+
+	S32 sScenarioRuns = 0;
+
+	class ScenarioBenchmark : public LLMetricBenchmark
+	{
+	public:
+		ScenarioBenchmark(const std::string& name) : LLMetricBenchmark(name) {}
+
+		virtual void run(U32 iterations)
+		{
+			sScenarioRuns += iterations;
+		}
+	};
+
+	LLMetricBenchmark::Registrar<CountingBenchmark> sCountingRegistrar("llmetricbenchmark_test_micro");
+	LLMetricBenchmark::Registrar<ScenarioBenchmark> sScenarioRegistrar("llmetricbenchmark_test_scenario");
+
+	LLSD make_result(F64 median, F64 std_dev)
+	{
+		LLSD result;
+		result["MedianTime"] = median;
+		result["StdDevTime"] = std_dev;
+		return result;
+	}
+}
+
+namespace tut
+{
+	struct metricbenchmark
+	{
+	};
+
+	typedef test_group<metricbenchmark> metricbenchmark_t;
+	typedef metricbenchmark_t::object metricbenchmark_object_t;
+	tut::metricbenchmark_t tut_metricbenchmark("LLMetricBenchmark");
+
+	template<> template<>
+	void metricbenchmark_object_t::test<1>()
+	{
+		// warmups and repetitions, and the statistics of the timed ones
+		CountingBenchmark benchmark("counting");
+		ensure("registered as a tester", LLMetricPerformanceTesterBasic::getTester("counting") == &benchmark);
+		benchmark.measure(2, 5);
+		ensure_equals("setup once", benchmark.mSetups, 1);
+		ensure_equals("teardown once", benchmark.mTeardowns, 1);
+		ensure_equals("runs", benchmark.mRuns, 7);
+		ensure_equals("iterations", benchmark.mTotalIterations, 700U);
+		ensure("min <= median", benchmark.getMinTime() <= benchmark.getMedianTime());
+		ensure("min <= mean", benchmark.getMinTime() <= benchmark.getMeanTime());
+		ensure("std dev", benchmark.getStdDevTime() >= 0.0);
+
+		LLSD record;
+		benchmark.getResults(record);
+		ensure_equals("iterations recorded", record["Iterations"].asInteger(), 100);
+		ensure_equals("repetitions recorded", record["Repetitions"].asInteger(), 5);
+		ensure("median recorded", record["MedianTime"].asReal() == benchmark.getMedianTime());
+	}
+
+	template<> template<>
+	void metricbenchmark_object_t::test<2>()
+	{
+		// registered benchmarks are created, filtered and released
+		LLSD results = LLSD::emptyMap();
+		sScenarioRuns = 0;
+		S32 count = LLMetricBenchmark::runBenchmarks("llmetricbenchmark_test_scenario", 1, 3, results);
+		ensure_equals("filtered", count, 1);
+		ensure_equals("scenario runs once per repetition", sScenarioRuns, 4);
+		ensure("result", results.has("llmetricbenchmark_test_scenario"));
+		ensure("released", LLMetricPerformanceTesterBasic::getTester("llmetricbenchmark_test_scenario") == NULL);
+
+		results = LLSD::emptyMap();
+		count = LLMetricBenchmark::runBenchmarks("llmetricbenchmark_test", 0, 1, results);
+		ensure_equals("both", count, 2);
+		ensure_equals("both results", results.size(), 2);
+	}
+
+	template<> template<>
+	void metricbenchmark_object_t::test<3>()
+	{
+		// only slowdowns beyond the tolerance and the baseline's noise count
+		LLSD baseline;
+		baseline["steady"] = make_result(100.0, 1.0);
+		baseline["noisy"] = make_result(100.0, 15.0);
+		baseline["faster"] = make_result(100.0, 1.0);
+		baseline["slight"] = make_result(100.0, 1.0);
+
+		LLSD results;
+		results["steady"] = make_result(120.0, 1.0);
+		results["noisy"] = make_result(120.0, 1.0);
+		results["faster"] = make_result(50.0, 1.0);
+		results["slight"] = make_result(105.0, 1.0);
+		results["new"] = make_result(1000.0, 1.0);
+
+		ensure_equals("regressions", LLMetricBenchmark::compareToBaseline(baseline, results, 0.1), 1);
+		ensure("steady regressed", results["steady"]["Regression"].asBoolean());
+		ensure("noisy within noise", !results["noisy"]["Regression"].asBoolean());
+		ensure("faster", !results["faster"]["Regression"].asBoolean());
+		ensure("slight within tolerance", !results["slight"]["Regression"].asBoolean());
+		ensure("not in baseline", !results["new"].has("Regression"));
+		ensure("baseline recorded", results["steady"]["BaselineMedianTime"].asReal() == 100.0);
+	}
+
+	template<> template<>
+	void metricbenchmark_object_t::test<4>()
+	{
+		// results files round trip
+		LLSD results;
+		results["a"] = make_result(1.5, 0.25);
+		std::string filename("llmetricbenchmark_test.xml");
+		ensure("saved", LLMetricBenchmark::saveResults(filename, results));
+		LLSD loaded;
+		ensure("loaded", LLMetricBenchmark::loadResults(filename, loaded));
+		LLFile::remove(filename);
+		ensure("median", loaded["a"]["MedianTime"].asReal() == 1.5);
+		ensure("std dev", loaded["a"]["StdDevTime"].asReal() == 0.25);
+		ensure("missing file", !LLMetricBenchmark::loadResults("llmetricbenchmark_test_missing.xml", loaded));
+	}
+}
@@ -0,0 +1,140 @@
+/**
+ * @file llqueuedthread_test.cpp
+ * @date 2011-08-04
+ * @brief Tests for the LLQueuedThread request queue.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llqueuedthread.h"
+#include "../lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// Non-threaded queue so that requests are only processed from update()
+	class TestQueue : public LLQueuedThread
+	{
+	public:
+		class TestRequest : public QueuedRequest
+		{
+		public:
+			TestRequest(handle_t handle, U32 priority, std::vector<handle_t>* order) :
+				QueuedRequest(handle, priority, FLAG_AUTO_COMPLETE),
+				mOrder(order)
+			{
+			}
+			/*virtual*/ bool processRequest()
+			{
+				mOrder->push_back(getHashKey());
+				return true;
+			}
+		private:
+			std::vector<handle_t>* mOrder;
+		};
+
+		TestQueue() : LLQueuedThread("test", false) {}
+
+		handle_t add(U32 priority)
+		{
+			handle_t handle = generateHandle();
+			addRequest(new TestRequest(handle, priority, &mOrder));
+			return handle;
+		}
+
+		std::vector<handle_t> mOrder;
+	};
+}
+
+namespace tut
+{
+	struct queuedthread
+	{
+		queuedthread()
+		{
+			LLTimer::initClass();
+		}
+	};
+
+	typedef test_group<queuedthread> queuedthread_t;
+	typedef queuedthread_t::object queuedthread_object_t;
+	tut::queuedthread_t tut_queuedthread("LLQueuedThread");
+
+	template<> template<>
+	void queuedthread_object_t::test<1>()
+	{
+		// higher priority first, equal priorities in arrival order
+		TestQueue queue;
+		LLQueuedThread::handle_t low = queue.add(LLQueuedThread::PRIORITY_LOW);
+		LLQueuedThread::handle_t normal1 = queue.add(LLQueuedThread::PRIORITY_NORMAL);
+		LLQueuedThread::handle_t high = queue.add(LLQueuedThread::PRIORITY_HIGH | 0x100000);
+		LLQueuedThread::handle_t normal2 = queue.add(LLQueuedThread::PRIORITY_NORMAL);
+		LLQueuedThread::handle_t urgent = queue.add(LLQueuedThread::PRIORITY_URGENT);
+		ensure_equals("pending", queue.getPending(), 5);
+
+		queue.update(0);
+		ensure_equals("all processed", queue.mOrder.size(), 5U);
+		ensure_equals("urgent", queue.mOrder[0], urgent);
+		ensure_equals("high", queue.mOrder[1], high);
+		ensure_equals("normal 1", queue.mOrder[2], normal1);
+		ensure_equals("normal 2", queue.mOrder[3], normal2);
+		ensure_equals("low", queue.mOrder[4], low);
+		ensure_equals("nothing pending", queue.getPending(), 0);
+	}
+
+	template<> template<>
+	void queuedthread_object_t::test<2>()
+	{
+		// reprioritizing a queued request moves it
+		TestQueue queue;
+		LLQueuedThread::handle_t first = queue.add(LLQueuedThread::PRIORITY_HIGH);
+		LLQueuedThread::handle_t second = queue.add(LLQueuedThread::PRIORITY_NORMAL);
+		LLQueuedThread::handle_t third = queue.add(LLQueuedThread::PRIORITY_LOW);
+		queue.setPriority(third, LLQueuedThread::PRIORITY_IMMEDIATE);
+		queue.setPriority(first, LLQueuedThread::PRIORITY_LOW);
+		ensure_equals("still pending", queue.getPending(), 3);
+
+		queue.update(0);
+		ensure_equals("all processed", queue.mOrder.size(), 3U);
+		ensure_equals("raised", queue.mOrder[0], third);
+		ensure_equals("unchanged", queue.mOrder[1], second);
+		ensure_equals("lowered", queue.mOrder[2], first);
+	}
+
+	template<> template<>
+	void queuedthread_object_t::test<3>()
+	{
+		// aborted requests are dropped without being processed
+		TestQueue queue;
+		LLQueuedThread::handle_t keep = queue.add(LLQueuedThread::PRIORITY_NORMAL);
+		LLQueuedThread::handle_t drop = queue.add(LLQueuedThread::PRIORITY_HIGH);
+		queue.abortRequest(drop, true);
+
+		queue.update(0);
+		ensure_equals("one processed", queue.mOrder.size(), 1U);
+		ensure_equals("kept request", queue.mOrder[0], keep);
+		ensure_equals("aborted request expired", queue.getRequestStatus(drop), LLQueuedThread::STATUS_EXPIRED);
+	}
+}
@@ -33,6 +33,7 @@
 #include "../llsd.h"
 #include "../llsdserialize.h"
 #include "../llformat.h"
+#include "../lltimer.h"
 
 #include "../test/lltut.h"
 
@@ -703,6 +704,97 @@ namespace tut
 			expected,
 			1);
 	}
+	class FolderListener : public LLSDXMLParser::Listener
+	{
+	public:
+		// keeps everything except entries of the "folders" array
+		virtual bool valueParsed(const LLSD& path, const LLSD& value)
+		{
+			if (path.size() == 2 && path[0].asString() == "folders")
+			{
+				mFolders.append(value);
+				return false;
+			}
+			return true;
+		}
+		LLSD mFolders;
+	};
+
+	template<> template<> 
+	void TestLLSDXMLParsingObject::test<5>()
+	{
+		// feeding a document in pieces gives the same result as parsing
+		// it in one go, whatever the piece size
+		LLSD expected;
+		expected["folders"].append(LLSD());
+		expected["folders"][0]["name"] = "a <name> & more";
+		expected["folders"][0]["id"] = LLUUID::generateNewID();
+		expected["folders"].append(12);
+		expected["folders"].append(string_to_vector("hello"));
+		expected["count"] = 3.5;
+		std::ostringstream ostr;
+		LLSDSerialize::toPrettyXML(expected, ostr);
+		std::string xml = ostr.str() + "trailing garbage after the document";
+
+		for (size_t piece = 1; piece < 40; ++piece)
+		{
+			mParser->reset();
+			for (size_t pos = 0; pos < xml.size(); pos += piece)
+			{
+				ensure("chunk parsed", mParser->parseChunk(xml.data() + pos, llmin(piece, xml.size() - pos)));
+			}
+			LLSD actual;
+			ensure_equals("chunked count", mParser->finishChunks(actual), 8);
+			ensure_equals("chunked parse", actual, expected);
+		}
+
+		mParser->reset();
+		std::string bad("<llsd><map><key>a</key><integer>1</string></map></llsd>");
+		mParser->parseChunk(bad.data(), 20);
+		ensure("malformed chunk fails", !mParser->parseChunk(bad.data() + 20, bad.size() - 20));
+		LLSD actual;
+		ensure_equals("malformed count", mParser->finishChunks(actual), S32(LLSDParser::PARSE_FAILURE));
+		ensure("malformed result", actual.isUndefined());
+
+		mParser->reset();
+		std::string truncated("<llsd><map><key>a</key><integer>1</integer>");
+		mParser->parseChunk(truncated.data(), truncated.size());
+		ensure_equals("truncated count", mParser->finishChunks(actual), S32(LLSDParser::PARSE_FAILURE));
+	}
+
+	template<> template<> 
+	void TestLLSDXMLParsingObject::test<6>()
+	{
+		// a listener sees each value as it completes and can drop it
+		LLSD doc;
+		doc["agent"] = LLUUID::generateNewID();
+		for (S32 i = 0; i < 3; ++i)
+		{
+			LLSD folder;
+			folder["name"] = llformat("folder %d", i);
+			folder["version"] = i;
+			doc["folders"].append(folder);
+		}
+		std::ostringstream ostr;
+		LLSDSerialize::toXML(doc, ostr);
+		std::string xml = ostr.str();
+
+		FolderListener listener;
+		mParser->reset();
+		mParser->setListener(&listener);
+		mParser->parseChunk(xml.data(), xml.size() / 2);
+		ensure("first folder seen before the end", listener.mFolders.size() >= 1);
+		mParser->parseChunk(xml.data() + xml.size() / 2, xml.size() - xml.size() / 2);
+		LLSD actual;
+		mParser->finishChunks(actual);
+		mParser->setListener(NULL);
+
+		ensure_equals("all folders seen", listener.mFolders, doc["folders"]);
+		ensure_equals("other values kept", actual["agent"], doc["agent"]);
+		ensure_equals("dropped entries keep their index", actual["folders"].size(), 3);
+		ensure("dropped entries are undef", actual["folders"][2].isUndefined());
+	}
+
 	/*
 	TODO:
 		test XML parsing
@@ -1376,6 +1468,23 @@ namespace tut
 				count3);
 			ensure_equals((msg + " (binaryandxml)").c_str(), actual_value_xml, input);
 		}
+
+		void ensureBinaryBuffer(
+			const std::string& msg,
+			const LLSD& input)
+		{
+			// to binary, and back again through the buffer parser
+			std::stringstream str1;
+			S32 count1 = LLSDSerialize::toBinary(input, str1);
+			std::string buffer = str1.str();
+			LLSD actual_value;
+			S32 count2 = LLSDSerialize::fromBinary(
+				actual_value,
+				(const U8*)buffer.data(),
+				buffer.size());
+			ensure_equals((msg + " buffer count").c_str(), count2, count1);
+			ensure_equals((msg + " (binarybuffer)").c_str(), actual_value, input);
+		}
 	};
 
 	typedef tut::test_group<TestLLSDCrossCompatible> TestLLSDCompatibleGroup;
@@ -1494,5 +1603,190 @@ namespace tut
 		ensureBinaryAndNotation("map", test);
 		ensureBinaryAndXML("map", test);
 	}
-}
 
+	template<> template<> 
+	void TestLLSDCompatibleObject::test<9>()
+	{
+		LLSD test;
+		ensureBinaryBuffer("undef", test);
+		test = true;
+		ensureBinaryBuffer("boolean true", test);
+		test = -234567;
+		ensureBinaryBuffer("integer negative", test);
+		test = -1.0;
+		ensureBinaryBuffer("real negative", test);
+		test = "foobar";
+		ensureBinaryBuffer("string", test);
+		test = LLUUID::generateNewID();
+		ensureBinaryBuffer("uuid", test);
+		test = LLDate(12345.0);
+		ensureBinaryBuffer("date", test);
+		test = LLURI("http://www.secondlife.com/");
+		ensureBinaryBuffer("uri", test);
+		test = string_to_vector("binary data");
+		ensureBinaryBuffer("binary", test);
+
+		test = LLSD::emptyMap();
+		test["foo"] = "bar";
+		test["baz"] = 100;
+		test["nested"].append(LLSD::emptyArray());
+		test["nested"].append(LLSD::emptyMap());
+		test["nested"].append(LLSD());
+		test["nested"].append(3.5);
+		ensureBinaryBuffer("nested", test);
+	}
+
+	template<> template<> 
+	void TestLLSDCompatibleObject::test<10>()
+	{
+		// every truncation of a valid buffer must fail cleanly
+		LLSD test;
+		test["id"] = LLUUID::generateNewID();
+		test["list"].append("one");
+		test["list"].append(2);
+		std::stringstream str;
+		LLSDSerialize::toBinary(test, str);
+		std::string buffer = str.str();
+		for (size_t len = 1; len < buffer.size(); ++len)
+		{
+			LLSD actual;
+			S32 count = LLSDSerialize::fromBinary(actual, (const U8*)buffer.data(), len);
+			ensure_equals("truncated buffer fails", count, S32(LLSDParser::PARSE_FAILURE));
+			ensure("truncated buffer leaves undef", actual.isUndefined());
+		}
+
+		// notation style strings are accepted as keys and values
+		std::string notation("{\0\0\0\1'k\\'ey's\0\0\0\3abc}", 21);
+		LLSD actual;
+		ensure_equals("notation key count", LLSDSerialize::fromBinary(actual, (const U8*)notation.data(), notation.size()), 2);
+		ensure_equals("escaped key", actual["k'ey"].asString(), "abc");
+
+		// every escape unescapes the same as through the istream parser
+		std::string escaped("[\0\0\0\2", 5);
+		escaped += "'a\\ab\\fc\\n\\r\\t\\v\\q\\\\\\'\\x41\\x7e'";
+		escaped += "\"x\\\"y\"]";
+		LLSD expected;
+		std::istringstream istr(escaped);
+		S32 expected_count = LLSDSerialize::fromBinary(expected, istr, escaped.size());
+		LLSD unescaped;
+		ensure_equals("escaped count", LLSDSerialize::fromBinary(unescaped, (const U8*)escaped.data(), escaped.size()),
+					  expected_count);
+		ensure_equals("escaped size", unescaped.size(), 2);
+		ensure_equals("escapes", unescaped[0].asString(), expected[0].asString());
+		ensure_equals("escapes unescaped", unescaped[0].asString(), std::string("a\ab\fc\n\r\t\vq\\'A~"));
+		ensure_equals("escaped delimiter", unescaped[1].asString(), std::string("x\"y"));
+
+		std::string cut_hex("'ab\\x4", 6);
+		ensure_equals("truncated escape fails", LLSDSerialize::fromBinary(unescaped, (const U8*)cut_hex.data(), cut_hex.size()),
+					  S32(LLSDParser::PARSE_FAILURE));
+	}
+
+	struct TestLLSDLoginBenchmark
+	{
+		// Builds something shaped like the inventory skeleton of a login
+		// response: an array of small maps of ids, names and integers.
+		static LLSD makeSkeleton(S32 folders)
+		{
+			LLSD skeleton = LLSD::emptyArray();
+			LLUUID parent_id;
+			parent_id.generate();
+			for (S32 i = 0; i < folders; ++i)
+			{
+				LLUUID folder_id;
+				folder_id.generate();
+				LLSD folder;
+				folder["folder_id"] = folder_id;
+				folder["parent_id"] = parent_id;
+				folder["name"] = llformat("Folder %d", i);
+				folder["type_default"] = -1;
+				folder["version"] = i % 50;
+				skeleton.append(folder);
+			}
+			return skeleton;
+		}
+	};
+
+	typedef tut::test_group<TestLLSDLoginBenchmark> TestLLSDLoginBenchmarkGroup;
+	typedef TestLLSDLoginBenchmarkGroup::object TestLLSDLoginBenchmarkObject;
+	TestLLSDLoginBenchmarkGroup gTestLLSDLoginBenchmarkGroup(
+		"llsd serialize login benchmark");
+
+	template<> template<> 
+	void TestLLSDLoginBenchmarkObject::test<1>()
+	{
+		const S32 FOLDERS = 20000;
+		LLSD skeleton = makeSkeleton(FOLDERS);
+
+		std::ostringstream xml_out;
+		LLSDSerialize::toXML(skeleton, xml_out);
+		std::ostringstream binary_out;
+		LLSDSerialize::toBinary(skeleton, binary_out);
+
+		LLTimer timer;
+		U32 allocations = LLSD::allocationCount();
+		LLSD xml_parsed;
+		std::istringstream xml_in(xml_out.str());
+		timer.reset();
+		LLSDSerialize::fromXML(xml_parsed, xml_in);
+		F64 xml_time = timer.getElapsedTimeF64();
+		U32 xml_allocations = LLSD::allocationCount() - allocations;
+
+		allocations = LLSD::allocationCount();
+		LLSD binary_parsed;
+		std::istringstream binary_in(binary_out.str());
+		timer.reset();
+		LLSDSerialize::fromBinary(binary_parsed, binary_in, binary_out.str().size());
+		F64 binary_time = timer.getElapsedTimeF64();
+		U32 binary_allocations = LLSD::allocationCount() - allocations;
+
+		ensure_equals("xml round trip", xml_parsed, skeleton);
+		ensure_equals("binary round trip", binary_parsed, skeleton);
+
+		// integers are held inline, so each folder costs its map, two
+		// UUIDs and a name; the array adds one more
+		ensure_equals("binary parse allocations", binary_allocations, U32(FOLDERS * 4 + 1));
+
+		llinfos << "LLSD login skeleton of " << FOLDERS << " folders, sizeof(LLSD) "
+				<< sizeof(LLSD) << ": xml parse " << xml_time * 1000.0 << " ms ("
+				<< xml_allocations << " allocations), binary parse "
+				<< binary_time * 1000.0 << " ms (" << binary_allocations
+				<< " allocations)" << llendl;
+	}
+
+	template<> template<> 
+	void TestLLSDLoginBenchmarkObject::test<2>()
+	{
+		// buffer parser against the istream parser on the same bytes
+		const S32 FOLDERS = 20000;
+		const S32 PASSES = 5;
+		LLSD skeleton = makeSkeleton(FOLDERS);
+		std::ostringstream binary_out;
+		LLSDSerialize::toBinary(skeleton, binary_out);
+		const std::string buffer = binary_out.str();
+
+		LLTimer timer;
+		LLSD stream_parsed;
+		timer.reset();
+		for (S32 i = 0; i < PASSES; ++i)
+		{
+			std::istringstream binary_in(buffer);
+			LLSDSerialize::fromBinary(stream_parsed, binary_in, buffer.size());
+		}
+		F64 stream_time = timer.getElapsedTimeF64() / PASSES;
+
+		LLSD buffer_parsed;
+		timer.reset();
+		for (S32 i = 0; i < PASSES; ++i)
+		{
+			LLSDSerialize::fromBinary(buffer_parsed, (const U8*)buffer.data(), buffer.size());
+		}
+		F64 buffer_time = timer.getElapsedTimeF64() / PASSES;
+
+		ensure_equals("stream parse", stream_parsed, skeleton);
+		ensure_equals("buffer parse", buffer_parsed, skeleton);
+
+		llinfos << "LLSD binary parse of " << buffer.size() << " bytes: istream "
+				<< stream_time * 1000.0 << " ms, buffer " << buffer_time * 1000.0
+				<< " ms" << llendl;
+	}
+}
@@ -30,6 +30,224 @@
 #include "../test/lltut.h"
 
 #include "../llstring.h"
+#include "../llmetricbenchmark.h"
+
+namespace
+{
+	// The one character at a time conversions that utf8str_to_wstring()
+	// and wstring_to_utf8str() used to be, to check the block copying
+	// versions against and to time them against.
+	LLWString old_utf8str_to_wstring(const std::string& utf8str, S32 len)
+	{
+		LLWString wout;
+		S32 i = 0;
+		while (i < len)
+		{
+			llwchar unichar;
+			U8 cur_char = utf8str[i];
+			if (cur_char < 0x80)
+			{
+				unichar = cur_char;
+			}
+			else
+			{
+				S32 cont_bytes = 0;
+				if ((cur_char >> 5) == 0x6)
+				{
+					unichar = (0x1F&cur_char);
+					cont_bytes = 1;
+				}
+				else if ((cur_char >> 4) == 0xe)
+				{
+					unichar = (0x0F&cur_char);
+					cont_bytes = 2;
+				}
+				else if ((cur_char >> 3) == 0x1e)
+				{
+					unichar = (0x07&cur_char);
+					cont_bytes = 3;
+				}
+				else if ((cur_char >> 2) == 0x3e)
+				{
+					unichar = (0x03&cur_char);
+					cont_bytes = 4;
+				}
+				else if ((cur_char >> 1) == 0x7e)
+				{
+					unichar = (0x01&cur_char);
+					cont_bytes = 5;
+				}
+				else
+				{
+					wout += LL_UNKNOWN_CHAR;
+					++i;
+					continue;
+				}
+				S32 end = (len < (i + cont_bytes)) ? len : (i + cont_bytes);
+				do
+				{
+					++i;
+					cur_char = utf8str[i];
+					if ( (cur_char >> 6) == 0x2 )
+					{
+						unichar <<= 6;
+						unichar += (0x3F&cur_char);
+					}
+					else
+					{
+						unichar = LL_UNKNOWN_CHAR;
+						--i;
+						break;
+					}
+				} while(i < end);
+				if ( ((cont_bytes == 1) && (unichar < 0x80))
+					|| ((cont_bytes == 2) && (unichar < 0x800))
+					|| ((cont_bytes == 3) && (unichar < 0x10000))
+					|| ((cont_bytes == 4) && (unichar < 0x200000))
+					|| ((cont_bytes == 5) && (unichar < 0x4000000)) )
+				{
+					unichar = LL_UNKNOWN_CHAR;
+				}
+			}
+			wout += unichar;
+			++i;
+		}
+		return wout;
+	}
+
+	std::string old_wstring_to_utf8str(const LLWString& utf32str, S32 len)
+	{
+		std::string out;
+		for (S32 i = 0; i < len; i++)
+		{
+			char tchars[8];		/* Flawfinder: ignore */
+			S32 n = wchar_to_utf8chars(utf32str[i], tchars);
+			tchars[n] = 0;
+			out += tchars;
+		}
+		return out;
+	}
+
+	// Text made of lines of about line_length characters, mostly ASCII
+	// with one in every non_ascii characters taken from others.
+	std::string make_corpus(S32 length, S32 line_length, S32 non_ascii, const char* others[], S32 num_others)
+	{
+		const char* words[] = { "hello", "anyone", "going", "to", "the", "sim", "tonight", "lol", "brb",
+								"notecard", "landmark", "object", "texture", "and", "is", "it" };
+		std::string text;
+		U32 seed = 4321;
+		S32 line = 0;
+		while ((S32)text.size() < length)
+		{
+			seed = seed * 1103515245 + 12345;
+			if (non_ascii && (seed >> 16) % non_ascii == 0)
+			{
+				text += others[(seed >> 8) % num_others];
+			}
+			else
+			{
+				text += words[(seed >> 16) % 16];
+			}
+			if ((S32)text.size() - line >= line_length)
+			{
+				text += '\n';
+				line = text.size();
+			}
+			else
+			{
+				text += ' ';
+			}
+		}
+		return text;
+	}
+
+	const char* LATIN[] = { "caf\xc3\xa9", "\xe2\x82\xac" "5", "na\xc3\xafve", "\xf0\x9f\x98\x80" };
+	const char* CJK[] = { "\xe3\x81\x93\xe3\x82\x93\xe3\x81\xab\xe3\x81\xa1\xe3\x81\xaf",
+						  "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", "\xe3\x81\x82\xe3\x82\x8a" };
+
+	// Text converted to LLWString and back, for tracking across builds.
+	// Chat converts a line at a time, a notecard all at once.
+	class ConversionBenchmark : public LLMetricBenchmark
+	{
+	public:
+		ConversionBenchmark(const std::string& name, bool whole) :
+			LLMetricBenchmark(name),
+			mWhole(whole),
+			mSize(0)
+		{
+		}
+
+		virtual void setup()
+		{
+			if (mWhole)
+			{
+				mLines.push_back(makeText());
+			}
+			else
+			{
+				LLStringUtil::getTokens(makeText(), mLines, "\n");
+			}
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 pass = 0; pass < iterations; ++pass)
+			{
+				for (size_t i = 0; i < mLines.size(); ++i)
+				{
+					mSize += wstring_to_utf8str(utf8str_to_wstring(mLines[i])).size();
+				}
+			}
+		}
+
+		virtual void teardown()
+		{
+			mLines.clear();
+		}
+
+	protected:
+		virtual std::string makeText() const = 0;
+
+	private:
+		std::vector<std::string> mLines;
+		bool mWhole;
+		size_t mSize;
+	};
+
+	// A busy chat log.
+	class ChatConversionBenchmark : public ConversionBenchmark
+	{
+	public:
+		ChatConversionBenchmark(const std::string& name) : ConversionBenchmark(name, false) {}
+
+	protected:
+		virtual std::string makeText() const { return make_corpus(200000, 60, 20, LATIN, 4); }
+	};
+
+	// A chat log mostly in Japanese.
+	class JapaneseChatConversionBenchmark : public ConversionBenchmark
+	{
+	public:
+		JapaneseChatConversionBenchmark(const std::string& name) : ConversionBenchmark(name, false) {}
+
+	protected:
+		virtual std::string makeText() const { return make_corpus(200000, 60, 2, CJK, 3); }
+	};
+
+	// A large notecard.
+	class NotecardConversionBenchmark : public ConversionBenchmark
+	{
+	public:
+		NotecardConversionBenchmark(const std::string& name) : ConversionBenchmark(name, true) {}
+
+	protected:
+		virtual std::string makeText() const { return make_corpus(65536, 80, 50, LATIN, 4); }
+	};
+
+	LLMetricBenchmark::Registrar<ChatConversionBenchmark> sChatConversionRegistrar("utf8_chat_conversion");
+	LLMetricBenchmark::Registrar<JapaneseChatConversionBenchmark> sJapaneseChatConversionRegistrar("utf8_japanese_chat_conversion");
+	LLMetricBenchmark::Registrar<NotecardConversionBenchmark> sNotecardConversionRegistrar("utf8_notecard_conversion");
+}
 
 namespace tut
 {
@@ -742,4 +960,51 @@ namespace tut
 		ensure("empty substr.", !LLStringUtil::endsWith(empty, value));
 		ensure("empty everything.", !LLStringUtil::endsWith(empty, empty));
 	}
+
+	template<> template<>
+	void string_index_object_t::test<41>()
+	{
+		// the block copying conversions agree with the old ones, malformed
+		// sequences included, whatever the alignment of the ASCII runs
+		const char* others[] = { "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xc3", "\x80\x80",
+								 "\xe2\x82", "\xc0\x80", "\xfe", "\xf8\x88\x80\x80\x80", "\xfc\x84\x80\x80\x80\x80" };
+		U32 seed = 99;
+		for (S32 pass = 0; pass < 2000; ++pass)
+		{
+			std::string utf8;
+			S32 pieces = pass % 40;
+			for (S32 i = 0; i < pieces; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				U32 pick = (seed >> 16) % 24;
+				if (pick < 10)
+				{
+					utf8 += others[pick];
+				}
+				else
+				{
+					utf8.append(1 + (seed >> 8) % 20, (char)('a' + pick));
+				}
+			}
+			S32 len = utf8.size();
+			LLWString wstr = utf8str_to_wstring(utf8);
+			ensure("utf8str_to_wstring", wstr == old_utf8str_to_wstring(utf8, len));
+			// a short len stops part way through a character
+			ensure("utf8str_to_wstring with len", utf8str_to_wstring(utf8, len / 2) == old_utf8str_to_wstring(utf8, len / 2));
+			ensure("wstring_to_utf8str", wstring_to_utf8str(wstr) == old_wstring_to_utf8str(wstr, wstr.size()));
+		}
+
+		// NULs are dropped, others outside of ASCII are encoded
+		LLWString wstr;
+		for (llwchar c = 0; c < 0x90; ++c)
+		{
+			wstr += c;
+		}
+		wstr += (llwchar)0x10FFFF;
+		wstr += (llwchar)0x7FFFFFFF;
+		ensure("wstring_to_utf8str across the ASCII boundary",
+			   wstring_to_utf8str(wstr) == old_wstring_to_utf8str(wstr, wstr.size()));
+		ensure("round trip", utf8str_to_wstring(wstring_to_utf8str(wstr)) == wstr.substr(1));
+		ensure("empty", utf8str_to_wstring(std::string()).empty() && wstring_to_utf8str(LLWString()).empty());
+	}
 }
@@ -0,0 +1,315 @@
+/**
+ * @file llstringtable_test.cpp
+ * @date 2011-08-09
+ * @brief Tests and lookup benchmark for the open addressed LLStringTable.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llstringtable.h"
+#include "../llthread.h"
+#include "../lltimer.h"
+
+#include <map>
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// The fixed size, linear probed table LLMessageStringTable used to be,
+	// kept here only so the benchmark has something to compare against.
+	class OldMessageStringTable
+	{
+	public:
+		enum { BUCKETS = 8192, LENGTH = 64 };
+
+		OldMessageStringTable()
+		{
+			for (U32 i = 0; i < BUCKETS; i++)
+			{
+				mEmpty[i] = TRUE;
+				mString[i][0] = 0;
+			}
+		}
+
+		char* getString(const char* str)
+		{
+			U32 hash_value = 0;
+			const char* c = str;
+			while (*c++)
+			{
+				hash_value += *c;
+				hash_value <<= 1;
+			}
+			hash_value %= BUCKETS;
+			while (!mEmpty[hash_value])
+			{
+				if (!strncmp(str, mString[hash_value], LENGTH))
+				{
+					return mString[hash_value];
+				}
+				hash_value = (hash_value + 1) % BUCKETS;
+			}
+			strncpy(mString[hash_value], str, LENGTH);	/* Flawfinder: ignore */
+			mString[hash_value][LENGTH - 1] = 0;
+			mEmpty[hash_value] = FALSE;
+			return mString[hash_value];
+		}
+
+	private:
+		BOOL mEmpty[BUCKETS];
+		char mString[BUCKETS][LENGTH];	/* Flawfinder: ignore */
+	};
+
+	// Looks up names already added by the main thread and adds its own.
+	class LookupThread : public LLThread
+	{
+	public:
+		LookupThread(LLStringTable* table, const std::vector<std::string>* shared, S32 id) :
+			LLThread("LookupThread"),
+			mTable(table),
+			mShared(shared),
+			mID(id),
+			mMismatches(0)
+		{
+		}
+
+		virtual void run()
+		{
+			for (S32 pass = 0; pass < 50; ++pass)
+			{
+				for (U32 i = 0; i < mShared->size(); ++i)
+				{
+					const char* found = mTable->checkString((*mShared)[i]);
+					if (!found || (*mShared)[i] != found)
+					{
+						mMismatches++;
+					}
+				}
+				mTable->addString(llformat("thread%d_%d", mID, pass));
+			}
+		}
+
+		LLStringTable* mTable;
+		const std::vector<std::string>* mShared;
+		S32 mID;
+		S32 mMismatches;
+	};
+}
+
+namespace tut
+{
+	struct stringtable
+	{
+		stringtable()
+		{
+			LLTimer::initClass();
+		}
+	};
+
+	typedef test_group<stringtable> stringtable_t;
+	typedef stringtable_t::object stringtable_object_t;
+	tut::stringtable_t tut_stringtable("LLStringTable");
+
+	template<> template<>
+	void stringtable_object_t::test<1>()
+	{
+		// interning and reference counting
+		LLStringTable table(16);
+		ensure("missing string", table.checkString("foo") == NULL);
+		char* foo = table.addString("foo");
+		ensure_equals("copied", std::string(foo), "foo");
+		ensure("same handle", table.addString(std::string("foo")) == foo);
+		ensure("check finds it", table.checkString("foo") == foo);
+		ensure_equals("one unique entry", table.mUniqueEntries, 1);
+		ensure_equals("two references", table.checkStringEntry("foo")->mCount, 2);
+
+		table.removeString("foo");
+		ensure("still referenced", table.checkString("foo") == foo);
+		table.removeString("foo");
+		ensure("removed", table.checkString("foo") == NULL);
+		ensure_equals("no entries", table.mUniqueEntries, 0);
+		ensure("NULL is never interned", table.addString((const char*)NULL) == NULL);
+	}
+
+	template<> template<>
+	void stringtable_object_t::test<2>()
+	{
+		// handles survive the table growing
+		LLStringTable table(16);
+		std::vector<char*> handles;
+		for (S32 i = 0; i < 1000; ++i)
+		{
+			handles.push_back(table.addString(llformat("name%d", i)));
+		}
+		ensure("grew", table.mMaxEntries >= 1000);
+		for (S32 i = 0; i < 1000; ++i)
+		{
+			ensure("stable handle", table.checkString(llformat("name%d", i)) == handles[i]);
+		}
+
+		std::vector<const char*> strings;
+		table.getStrings(strings);
+		ensure_equals("getStrings", strings.size(), 1000U);
+	}
+
+	template<> template<>
+	void stringtable_object_t::test<3>()
+	{
+		// random adds and removes, checked against a std::map, so that
+		// removal from the middle of a probe run is exercised
+		LLStringTable table(16);
+		std::map<std::string, S32> counts;
+		U32 seed = 12345;
+		for (S32 i = 0; i < 20000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			std::string name = llformat("n%u", (seed >> 16) % 300);
+			if ((seed >> 8) & 1)
+			{
+				table.addString(name);
+				counts[name]++;
+			}
+			else if (counts[name] > 0)
+			{
+				table.removeString(name.c_str());
+				counts[name]--;
+			}
+		}
+
+		S32 unique = 0;
+		for (std::map<std::string, S32>::iterator it = counts.begin(); it != counts.end(); ++it)
+		{
+			LLStringTableEntry* entry = table.checkStringEntry(it->first);
+			if (it->second)
+			{
+				ensure("present", entry != NULL);
+				ensure_equals("count", entry->mCount, it->second);
+				unique++;
+			}
+			else
+			{
+				ensure("absent", entry == NULL);
+			}
+		}
+		ensure_equals("unique entries", table.mUniqueEntries, unique);
+	}
+
+	template<> template<>
+	void stringtable_object_t::test<4>()
+	{
+		// overlong strings are truncated and still found
+		LLStringTable table(16);
+		std::string longname(MAX_STRINGS_LENGTH + 20, 'x');
+		char* interned = table.addString(longname);
+		ensure_equals("truncated", strlen(interned), MAX_STRINGS_LENGTH - 1);
+		ensure("found again", table.checkString(longname) == interned);
+		ensure_equals("one entry", table.mUniqueEntries, 1);
+	}
+
+	template<> template<>
+	void stringtable_object_t::test<5>()
+	{
+		// concurrent lookups while other threads add
+		const S32 NUM_THREADS = 4;
+		LLStringTable table(16);
+		std::vector<std::string> shared;
+		for (S32 i = 0; i < 500; ++i)
+		{
+			shared.push_back(llformat("shared%d", i));
+			table.addString(shared.back());
+		}
+
+		std::vector<LookupThread*> threads;
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			threads.push_back(new LookupThread(&table, &shared, i));
+			threads.back()->start();
+		}
+		S32 mismatches = 0;
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			while (!threads[i]->isStopped())
+			{
+				LLThread::yield();
+			}
+			mismatches += threads[i]->mMismatches;
+			delete threads[i];
+		}
+		ensure_equals("lookups all succeeded", mismatches, 0);
+		ensure_equals("thread additions", table.mUniqueEntries, 500 + NUM_THREADS * 50);
+	}
+
+	template<> template<>
+	void stringtable_object_t::test<6>()
+	{
+		// Message decode benchmark: the template has roughly 2000 message,
+		// block and variable names, and every non-"Fast" LLMessageSystem
+		// accessor interns its block and variable name arguments.
+		const S32 NAMES = 2000;
+		const S32 PASSES = 200;
+		const char* words[] = { "AgentData", "AgentID", "SessionID", "ObjectData", "Position",
+								"Rotation", "Velocity", "TextureEntry", "ParcelData", "RegionHandle" };
+		std::vector<std::string> names;
+		for (S32 i = 0; i < NAMES; ++i)
+		{
+			names.push_back(llformat("%s%d", words[i % 10], i / 10));
+		}
+
+		LLStringTable table(8192);
+		OldMessageStringTable* old_table = new OldMessageStringTable;
+		for (S32 i = 0; i < NAMES; ++i)
+		{
+			table.addString(names[i]);
+			old_table->getString(names[i].c_str());
+		}
+
+		U32 sum = 0;
+		LLTimer timer;
+		timer.reset();
+		for (S32 pass = 0; pass < PASSES; ++pass)
+		{
+			for (S32 i = 0; i < NAMES; ++i)
+			{
+				sum += (U32)(intptr_t)old_table->getString(names[i].c_str());
+			}
+		}
+		F64 old_time = timer.getElapsedTimeF64();
+
+		timer.reset();
+		for (S32 pass = 0; pass < PASSES; ++pass)
+		{
+			for (S32 i = 0; i < NAMES; ++i)
+			{
+				sum += (U32)(intptr_t)table.checkString(names[i].c_str());
+			}
+		}
+		F64 table_time = timer.getElapsedTimeF64();
+		delete old_table;
+
+		ensure("lookups happened", sum != 0);
+		llinfos << "LLStringTable: " << NAMES * PASSES << " name lookups, old message table "
+				<< old_time << " sec, open addressing " << table_time << " sec" << llendl;
+	}
+}
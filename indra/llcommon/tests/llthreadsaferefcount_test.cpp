@@ -0,0 +1,266 @@
+/**
+ * @file llthreadsaferefcount_test.cpp
+ * @date 2011-08-02
+ * @brief Tests and microbenchmark for the atomic LLThreadSafeRefCount.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llthread.h"
+#include "../llpointer.h"
+#include "../lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	class Counted : public LLThreadSafeRefCount
+	{
+	public:
+		Counted(bool* deleted) : mDeleted(deleted) {}
+	protected:
+		~Counted() { *mDeleted = true; }
+	private:
+		bool* mDeleted;
+	};
+
+	// Hammers ref()/unref() on a shared object, the way the image decode,
+	// texture cache and fetch threads pass LLImageBase objects around.
+	class RefThread : public LLThread
+	{
+	public:
+		RefThread(LLThreadSafeRefCount* target, S32 iterations) :
+			LLThread("RefThread"),
+			mTarget(target),
+			mIterations(iterations)
+		{
+		}
+
+		virtual void run()
+		{
+			for (S32 i = 0; i < mIterations; ++i)
+			{
+				mTarget->ref();
+				mTarget->unref();
+			}
+		}
+
+	private:
+		LLThreadSafeRefCount* mTarget;
+		S32 mIterations;
+	};
+
+	LLAtomicS32 sReleasedDeleted(0);
+
+	class Released : public LLThreadSafeRefCount
+	{
+	protected:
+		~Released() { sReleasedDeleted++; }
+	};
+
+	// Drops one reference to each object in turn, recording what
+	// unref() returned, so that every thread races to drop the last one.
+	class UnrefThread : public LLThread
+	{
+	public:
+		UnrefThread(const std::vector<Released*>& targets, LLAtomicS32* ready, S32 threads) :
+			LLThread("UnrefThread"),
+			mTargets(targets),
+			mReady(ready),
+			mThreads(threads)
+		{
+		}
+
+		virtual void run()
+		{
+			(*mReady)++;
+			while (mReady->CurrentValue() < mThreads)
+			{
+			}
+			for (size_t i = 0; i < mTargets.size(); ++i)
+			{
+				mResults.push_back(mTargets[i]->unref());
+			}
+		}
+
+		std::vector<S32> mResults;
+
+	private:
+		std::vector<Released*> mTargets;
+		LLAtomicS32* mReady;
+		S32 mThreads;
+	};
+}
+
+namespace tut
+{
+	struct threadsaferefcount
+	{
+		threadsaferefcount()
+		{
+			LLTimer::initClass();
+		}
+	};
+
+	typedef test_group<threadsaferefcount> threadsaferefcount_t;
+	typedef threadsaferefcount_t::object threadsaferefcount_object_t;
+	tut::threadsaferefcount_t tut_threadsaferefcount("LLThreadSafeRefCount");
+
+	template<> template<>
+	void threadsaferefcount_object_t::test<1>()
+	{
+		bool deleted = false;
+		Counted* counted = new Counted(&deleted);
+		ensure_equals("starts unreferenced", counted->getNumRefs(), 0);
+		counted->ref();
+		counted->ref();
+		ensure_equals("two refs", counted->getNumRefs(), 2);
+		ensure_equals("unref returns remaining count", counted->unref(), 1);
+		ensure("still alive with one ref", !deleted);
+		ensure_equals("last unref returns 0", counted->unref(), 0);
+		ensure("deleted on last unref", deleted);
+	}
+
+	template<> template<>
+	void threadsaferefcount_object_t::test<2>()
+	{
+		bool deleted = false;
+		{
+			LLPointer<Counted> ptr = new Counted(&deleted);
+			LLPointer<Counted> copy = ptr;
+			ensure_equals("LLPointer refs", ptr->getNumRefs(), 2);
+		}
+		ensure("LLPointer releases object", deleted);
+	}
+
+	template<> template<>
+	void threadsaferefcount_object_t::test<3>()
+	{
+		// Multithreaded ref/unref microbenchmark: the count must be exact
+		// after all threads finish, and the throughput is reported so the
+		// atomic implementation can be compared with the old global mutex.
+		const S32 NUM_THREADS = 4;
+		const S32 ITERATIONS = 1000000;
+
+		bool deleted = false;
+		Counted* counted = new Counted(&deleted);
+		counted->ref();
+
+		std::vector<RefThread*> threads;
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			threads.push_back(new RefThread(counted, ITERATIONS));
+		}
+
+		LLTimer timer;
+		timer.reset();
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			threads[i]->start();
+		}
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			while (!threads[i]->isStopped())
+			{
+				LLThread::yield();
+			}
+		}
+		F64 elapsed = timer.getElapsedTimeF64();
+
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			delete threads[i];
+		}
+
+		ensure_equals("count exact after contention", counted->getNumRefs(), 1);
+		ensure("not deleted while referenced", !deleted);
+
+		F64 ops = 2.0 * NUM_THREADS * ITERATIONS;
+		llinfos << "LLThreadSafeRefCount: " << NUM_THREADS << " threads, "
+				<< ops << " ref/unref ops in " << elapsed << " sec ("
+				<< (elapsed > 0.0 ? ops / elapsed : 0.0) << " ops/sec)" << llendl;
+
+		counted->unref();
+		ensure("deleted after final unref", deleted);
+	}
+
+	template<> template<>
+	void threadsaferefcount_object_t::test<4>()
+	{
+		// Every thread holds one reference to each object and they all
+		// drop them at once: each object must be deleted exactly once,
+		// and the counts unref() returns must be exactly one of each
+		// from 0 to NUM_THREADS - 1.
+		const S32 NUM_THREADS = 4;
+		const S32 OBJECTS = 100000;
+
+		sReleasedDeleted = 0;
+		std::vector<Released*> targets;
+		for (S32 i = 0; i < OBJECTS; ++i)
+		{
+			Released* released = new Released;
+			for (S32 j = 0; j < NUM_THREADS; ++j)
+			{
+				released->ref();
+			}
+			targets.push_back(released);
+		}
+
+		LLAtomicS32 ready(0);
+		std::vector<UnrefThread*> threads;
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			threads.push_back(new UnrefThread(targets, &ready, NUM_THREADS));
+		}
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			threads[i]->start();
+		}
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			while (!threads[i]->isStopped())
+			{
+				LLThread::yield();
+			}
+		}
+
+		ensure_equals("each object deleted once", (S32)sReleasedDeleted, OBJECTS);
+		for (S32 i = 0; i < OBJECTS; ++i)
+		{
+			U32 seen = 0;
+			for (S32 j = 0; j < NUM_THREADS; ++j)
+			{
+				S32 remaining = threads[j]->mResults[i];
+				ensure("remaining count in range", remaining >= 0 && remaining < NUM_THREADS);
+				seen |= 1 << remaining;
+			}
+			ensure_equals("each remaining count returned once", seen, (U32)((1 << NUM_THREADS) - 1));
+		}
+
+		for (S32 i = 0; i < NUM_THREADS; ++i)
+		{
+			delete threads[i];
+		}
+	}
+}
@@ -0,0 +1,253 @@
+/**
+ * @file lltimingwheel_test.cpp
+ * @date 2011-08-17
+ * @brief Tests for LLTimingWheel and the LLEventTimer scheduling on it.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltimingwheel.h"
+#include "../lleventtimer.h"
+
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace
+{
+	struct TestEntry : public LLTimingWheel::Entry
+	{
+		TestEntry() : mIndex(0), mExpiredAt(0), mExpiredCount(0) {}
+		U32 mIndex;
+		U64 mExpiredAt;
+		S32 mExpiredCount;
+	};
+
+	// Advances the wheel and marks what expired.
+	S32 advance(LLTimingWheel& wheel, U64 now)
+	{
+		S32 count = 0;
+		LLTimingWheel::EntryList expired;
+		wheel.advance(now, expired);
+		while (!expired.empty())
+		{
+			TestEntry* entry = static_cast<TestEntry*>(expired.popFront());
+			entry->mExpiredAt = now;
+			entry->mExpiredCount++;
+			count++;
+		}
+		return count;
+	}
+
+	S32 sTicks = 0;
+
+	class CountingTimer : public LLEventTimer
+	{
+	public:
+		CountingTimer(F32 period, BOOL done = FALSE) : LLEventTimer(period), mDone(done) {}
+		virtual BOOL tick() { sTicks++; return mDone; }
+		void stop() { mEventTimer.stop(); }
+		void start() { mEventTimer.start(); }
+
+	private:
+		BOOL mDone;
+	};
+}
+
+namespace tut
+{
+	struct timingwheel
+	{
+		timingwheel()
+		{
+			LLTimer::initClass();
+		}
+	};
+
+	typedef test_group<timingwheel> timingwheel_t;
+	typedef timingwheel_t::object timingwheel_object_t;
+	tut::timingwheel_t tut_timingwheel("LLTimingWheel");
+
+	template<> template<>
+	void timingwheel_object_t::test<1>()
+	{
+		// scheduling, rescheduling and unscheduling
+		LLTimingWheel wheel(1000);
+		TestEntry a, b, c, d;
+		wheel.schedule(&a, 1010);
+		wheel.schedule(&b, 1010);
+		wheel.schedule(&c, 1500);
+		wheel.schedule(&d, 900);
+		ensure_equals("size", wheel.size(), 4U);
+		ensure("scheduled", a.isScheduled());
+
+		ensure_equals("past due expires on the next advance", advance(wheel, 1000), 1);
+		ensure_equals("past due", d.mExpiredCount, 1);
+		ensure("expired entries are unscheduled", !d.isScheduled());
+
+		ensure_equals("nothing due yet", advance(wheel, 1009), 0);
+		wheel.schedule(&b, 1200);
+		ensure_equals("a only", advance(wheel, 1010), 1);
+		ensure_equals("a at its tick", a.mExpiredAt, 1010ULL);
+
+		wheel.unschedule(&c);
+		ensure("unscheduled", !c.isScheduled());
+		ensure_equals("b only", advance(wheel, 2000), 1);
+		ensure_equals("b late, as asked", b.mExpiredCount, 1);
+		ensure_equals("c never", c.mExpiredCount, 0);
+		ensure_equals("empty", wheel.size(), 0U);
+
+		// further out than the top level reaches
+		U64 far = 2000 + ((U64)1 << 33) + 77;
+		wheel.schedule(&c, far);
+		U64 now = 2000;
+		while (now + ((U64)1 << 26) < far)
+		{
+			now += (U64)1 << 26;
+			ensure_equals("parked", advance(wheel, now), 0);
+		}
+		ensure_equals("not yet", advance(wheel, far - 1), 0);
+		ensure_equals("far", advance(wheel, far), 1);
+	}
+
+	template<> template<>
+	void timingwheel_object_t::test<2>()
+	{
+		// random expiries across every level, advanced in random steps, each
+		// expire on the first advance that reaches them
+		const U32 COUNT = 2000;
+		std::vector<TestEntry> entries(COUNT);
+		LLTimingWheel wheel(12345);
+		U32 seed = 1;
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			U32 shift = (seed >> 16) % 26;
+			seed = seed * 1103515245 + 12345;
+			U64 delay = ((U64)seed >> 8) & (((U64)1 << shift) - 1);
+			entries[i].mIndex = i;
+			wheel.schedule(&entries[i], 12345 + 1 + delay);
+		}
+
+		U64 now = 12345;
+		S32 total = 0;
+		std::vector<S32> seen(COUNT, 0);
+		while (wheel.size() > 0)
+		{
+			seed = seed * 1103515245 + 12345;
+			// mostly frame sized steps, with the occasional long stall
+			U64 step = (seed >> 16) % 50 ? (seed >> 8) % 40 : (seed >> 4) % 5000000;
+			U64 last = now;
+			now += step;
+			total += advance(wheel, now);
+			for (U32 i = 0; i < COUNT; ++i)
+			{
+				const TestEntry& entry = entries[i];
+				U64 expiry = entry.getExpiry();
+				if (entry.mExpiredCount != seen[i])
+				{
+					// just expired
+					ensure("not early", expiry <= now);
+					ensure("not late", expiry > last);
+					seen[i] = entry.mExpiredCount;
+				}
+				else if (!entry.mExpiredCount)
+				{
+					ensure("expired when due", expiry > now);
+				}
+			}
+		}
+		ensure_equals("all expired once", total, (S32)COUNT);
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			ensure_equals("once", entries[i].mExpiredCount, 1);
+		}
+	}
+
+	template<> template<>
+	void timingwheel_object_t::test<3>()
+	{
+		// entries leave lists and wheels when destroyed or unscheduled
+		LLTimingWheel wheel;
+		TestEntry a;
+		TestEntry* b = new TestEntry;
+		TestEntry* c = new TestEntry;
+		wheel.schedule(&a, 5);
+		wheel.schedule(b, 5);
+		wheel.schedule(c, 100000);
+		delete c;
+		ensure_equals("destroyed entry leaves the wheel", wheel.size(), 2U);
+
+		LLTimingWheel::EntryList expired;
+		wheel.advance(10, expired);
+		ensure_equals("both out of the wheel", wheel.size(), 0U);
+		ensure("first", expired.popFront() == &a);
+		delete b;
+		ensure("destroyed entry leaves the expired list", expired.empty());
+
+		wheel.advance(20, expired);
+		wheel.schedule(&a, 30);
+		wheel.advance(40, expired);
+		wheel.unschedule(&a);
+		ensure("unscheduled entry leaves the expired list", expired.empty());
+
+		TestEntry d;
+		{
+			LLTimingWheel short_lived;
+			short_lived.schedule(&d, 7);
+		}
+		ensure("outlives its wheel", !d.isScheduled());
+	}
+
+	template<> template<>
+	void timingwheel_object_t::test<4>()
+	{
+		// LLEventTimer: due timers tick on each update, stopped ones never,
+		// finished ones are deleted
+		sTicks = 0;
+		CountingTimer every_frame(0.f);
+		CountingTimer stopped(0.f);
+		CountingTimer later(3600.f);
+		new CountingTimer(-1.f, TRUE);
+		stopped.stop();
+
+		ms_sleep(2);
+		LLEventTimer::updateClass();
+		ensure_equals("first update", sTicks, 2);
+		ms_sleep(2);
+		LLEventTimer::updateClass();
+		ensure_equals("once done is deleted", sTicks, 3);
+
+		stopped.start();
+		ms_sleep(2);
+		LLEventTimer::updateClass();
+		ensure_equals("restarted", sTicks, 5);
+
+		every_frame.stop();
+		stopped.stop();
+		ms_sleep(2);
+		LLEventTimer::updateClass();
+		ensure_equals("both stopped", sTicks, 5);
+	}
+}
@@ -0,0 +1,333 @@
+/**
+ * @file lluuidflatmap_test.cpp
+ * @date 2011-08-15
+ * @brief Tests and benchmarks for LLUUIDFlatMap.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lluuidflatmap.h"
+#include "../llmetricbenchmark.h"
+
+#include <algorithm>
+#include <map>
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// Random looking ids without the cost of LLUUID::generate(), and the
+	// same ones every run.
+	void make_ids(std::vector<LLUUID>& ids, U32 count, U32 seed)
+	{
+		ids.resize(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			for (S32 j = 0; j < UUID_BYTES; ++j)
+			{
+				seed = seed * 1103515245 + 12345;
+				ids[i].mData[j] = (U8)(seed >> 16);
+			}
+		}
+	}
+
+	template <class MAP>
+	void fill_map(MAP& map, const std::vector<LLUUID>& ids)
+	{
+		for (U32 i = 0; i < ids.size(); ++i)
+		{
+			map[ids[i]] = i;
+		}
+	}
+
+	// Hits and misses, then a full walk, as the registries do them.
+	template <class MAP>
+	U32 sum_map(const MAP& map, const std::vector<LLUUID>& hits, const std::vector<LLUUID>& misses)
+	{
+		U32 sum = 0;
+		for (U32 i = 0; i < hits.size(); ++i)
+		{
+			typename MAP::const_iterator iter = map.find(hits[i]);
+			if (iter != map.end())
+			{
+				sum += iter->second;
+			}
+			sum += (U32)map.count(misses[i]);
+		}
+		for (typename MAP::const_iterator iter = map.begin(); iter != map.end(); ++iter)
+		{
+			sum += iter->second;
+		}
+		return sum;
+	}
+
+	// Size of the maps the registry benchmarks use: an object list's worth.
+	const U32 BENCHMARK_IDS = 100000;
+
+	// Lookups, for tracking across builds and against std::map.
+	template <class MAP>
+	class FindBenchmark : public LLMetricBenchmark
+	{
+	public:
+		FindBenchmark(const std::string& name) :
+			LLMetricBenchmark(name, BENCHMARK_IDS),
+			mNext(0),
+			mSum(0)
+		{
+		}
+
+		virtual void setup()
+		{
+			make_ids(mIDs, BENCHMARK_IDS, 6);
+			fill_map(mMap, mIDs);
+			// look up in a different order than inserted
+			std::random_shuffle(mIDs.begin(), mIDs.end());
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				mSum += mMap.find(mIDs[mNext])->second;
+				mNext = (mNext + 1) % mIDs.size();
+			}
+		}
+
+		virtual void teardown()
+		{
+			mMap.clear();
+			mIDs.clear();
+		}
+
+	private:
+		std::vector<LLUUID> mIDs;
+		MAP mMap;
+		U32 mNext;
+		U32 mSum;
+	};
+
+	// Full walks of the same map.
+	template <class MAP>
+	class IterateBenchmark : public LLMetricBenchmark
+	{
+	public:
+		IterateBenchmark(const std::string& name) :
+			LLMetricBenchmark(name, 10),
+			mSum(0)
+		{
+		}
+
+		virtual void setup()
+		{
+			std::vector<LLUUID> ids;
+			make_ids(ids, BENCHMARK_IDS, 7);
+			fill_map(mMap, ids);
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				for (typename MAP::const_iterator iter = mMap.begin(); iter != mMap.end(); ++iter)
+				{
+					mSum += iter->second;
+				}
+			}
+		}
+
+		virtual void teardown()
+		{
+			mMap.clear();
+		}
+
+	private:
+		MAP mMap;
+		U32 mSum;
+	};
+
+	typedef LLUUIDFlatMap<U32> flat_map_t;
+	typedef std::map<LLUUID, U32> std_map_t;
+
+	LLMetricBenchmark::Registrar<FindBenchmark<flat_map_t> > sFindRegistrar("uuidflatmap_find");
+	LLMetricBenchmark::Registrar<FindBenchmark<std_map_t> > sStdFindRegistrar("uuidflatmap_find_std_map");
+	LLMetricBenchmark::Registrar<IterateBenchmark<flat_map_t> > sIterateRegistrar("uuidflatmap_iterate");
+	LLMetricBenchmark::Registrar<IterateBenchmark<std_map_t> > sStdIterateRegistrar("uuidflatmap_iterate_std_map");
+}
+
+namespace tut
+{
+	struct uuidflatmap
+	{
+	};
+
+	typedef test_group<uuidflatmap> uuidflatmap_t;
+	typedef uuidflatmap_t::object uuidflatmap_object_t;
+	tut::uuidflatmap_t tut_uuidflatmap("LLUUIDFlatMap");
+
+	template<> template<>
+	void uuidflatmap_object_t::test<1>()
+	{
+		// the std::map subset
+		LLUUIDFlatMap<S32> map;
+		LLUUID a, b;
+		a.generate();
+		b.generate();
+		ensure("empty", map.empty());
+		ensure("empty begin", map.begin() == map.end());
+		ensure("missing", map.find(a) == map.end());
+
+		map[a] = 1;
+		ensure("inserted", map.insert(std::make_pair(b, 2)).second);
+		ensure("not replaced", !map.insert(std::make_pair(b, 3)).second);
+		ensure_equals("size", map.size(), 2U);
+		ensure_equals("a", map.find(a)->second, 1);
+		ensure_equals("b", map[b], 2);
+		ensure_equals("count", map.count(a), 1U);
+		ensure("is_in_map", is_in_map(map, b));
+
+		ensure_equals("erase", map.erase(a), 1U);
+		ensure_equals("erase again", map.erase(a), 0U);
+		ensure("erased", map.find(a) == map.end());
+		ensure_equals("one left", map.size(), 1U);
+
+		LLUUIDFlatMap<S32> other;
+		other.swap(map);
+		ensure("swapped", map.empty() && other.count(b));
+		other.clear();
+		ensure("cleared", other.empty() && other.begin() == other.end());
+
+		LLUUIDFlatMap<S32*> ptrs;
+		S32 value = 5;
+		ptrs[a] = &value;
+		ensure("get_ptr_in_map", get_ptr_in_map(ptrs, a) == &value);
+		ensure("get_ptr_in_map missing", get_ptr_in_map(ptrs, b) == NULL);
+	}
+
+	template<> template<>
+	void uuidflatmap_object_t::test<2>()
+	{
+		// random inserts and erases, checked against a std::map, so that
+		// tombstones and growth are exercised
+		std::vector<LLUUID> ids;
+		make_ids(ids, 500, 3);
+		LLUUIDFlatMap<U32> map;
+		std::map<LLUUID, U32> expected;
+		U32 seed = 12345;
+		for (S32 i = 0; i < 50000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			const LLUUID& id = ids[(seed >> 16) % ids.size()];
+			if ((seed >> 8) & 1)
+			{
+				map[id] = i;
+				expected[id] = i;
+			}
+			else
+			{
+				ensure_equals("erase result", map.erase(id), expected.erase(id));
+			}
+		}
+
+		ensure_equals("size", map.size(), expected.size());
+		size_t walked = 0;
+		for (LLUUIDFlatMap<U32>::const_iterator iter = map.begin(); iter != map.end(); ++iter)
+		{
+			ensure_equals("value", iter->second, expected[iter->first]);
+			walked++;
+		}
+		ensure_equals("walked", walked, expected.size());
+	}
+
+	template<> template<>
+	void uuidflatmap_object_t::test<3>()
+	{
+		// erasing while iterating, as the registries clean up
+		std::vector<LLUUID> ids;
+		make_ids(ids, 1000, 4);
+		LLUUIDFlatMap<U32> map;
+		fill_map(map, ids);
+		for (LLUUIDFlatMap<U32>::iterator iter = map.begin(); iter != map.end(); )
+		{
+			if (iter->second & 1)
+			{
+				map.erase(iter++);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+		ensure_equals("half left", map.size(), 500U);
+		for (U32 i = 0; i < ids.size(); ++i)
+		{
+			ensure_equals("odd ones erased", map.count(ids[i]), (i & 1) ? 0U : 1U);
+		}
+	}
+
+	template<> template<>
+	void uuidflatmap_object_t::test<4>()
+	{
+		// a round robin walk resumed from a saved slot sees everything once
+		std::vector<LLUUID> ids;
+		make_ids(ids, 300, 5);
+		LLUUIDFlatMap<U32> map;
+		fill_map(map, ids);
+
+		std::vector<S32> seen(ids.size(), 0);
+		U32 slot = 0;
+		while (true)
+		{
+			LLUUIDFlatMap<U32>::iterator iter = map.beginAt(slot);
+			if (iter == map.end())
+			{
+				break;
+			}
+			seen[iter->second]++;
+			slot = iter.getSlot() + 1;
+		}
+		for (U32 i = 0; i < seen.size(); ++i)
+		{
+			ensure_equals("visited once", seen[i], 1);
+		}
+		ensure("past the end", map.beginAt(0xffffffff) == map.end());
+	}
+
+	template<> template<>
+	void uuidflatmap_object_t::test<5>()
+	{
+		// Same hits, misses and walk as std::map over a few thousand ids.
+		std::vector<LLUUID> ids;
+		std::vector<LLUUID> misses;
+		make_ids(ids, 5000, 1);
+		make_ids(misses, 5000, 2);
+		std::vector<LLUUID> hits(ids);
+		std::random_shuffle(hits.begin(), hits.end());
+
+		std_map_t std_map;
+		fill_map(std_map, ids);
+		flat_map_t flat_map;
+		fill_map(flat_map, ids);
+		ensure_equals("same results", sum_map(flat_map, hits, misses), sum_map(std_map, hits, misses));
+	}
+}
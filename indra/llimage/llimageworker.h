@@ -72,7 +72,7 @@ public:
 	};
 	
 public:
-	LLImageDecodeThread(bool threaded = true);
+	LLImageDecodeThread(bool threaded = true, U32 num_workers = 1);
 	handle_t decodeImage(LLImageFormatted* image,
 						 U32 priority, S32 discard, BOOL needs_aux,
 						 Responder* responder);
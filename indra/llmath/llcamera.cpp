@@ -28,6 +28,7 @@
 
 #include "llmath.h"
 #include "llcamera.h"
+#include "llvector4a.h"
 
 // ---------------- Constructors and destructors ----------------
 
@@ -270,6 +271,123 @@ S32 LLCamera::AABBInFrustum(const LLVector3 &center, const LLVector3& radius)
 	return result;
 }
 
+void LLCamera::AABBInFrustumBatch(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results) const
+{
+	batchAABBInFrustum(centers, radii, count, results, mPlaneCount);
+}
+
+void LLCamera::AABBInFrustumNoFarClipBatch(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results) const
+{
+	batchAABBInFrustum(centers, radii, count, results, AGENT_PLANE_FAR);
+}
+
+// Same test as AABBInFrustum(), with the same operations in the same
+// order so the results match it exactly.
+void LLCamera::batchAABBInFrustum(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results, U32 skip_plane) const
+{
+	static const LLVector3 scaler[] = {
+		LLVector3(-1,-1,-1),
+		LLVector3( 1,-1,-1),
+		LLVector3(-1, 1,-1),
+		LLVector3( 1, 1,-1),
+		LLVector3(-1,-1, 1),
+		LLVector3( 1,-1, 1),
+		LLVector3(-1, 1, 1),
+		LLVector3( 1, 1, 1)
+	};
+
+	// normal, mask signs and -d of each plane that takes part
+	LLVector3 normal[7];
+	LLVector3 sign[7];
+	F32 neg_d[7];
+	U32 planes = 0;
+	for (U32 i = 0; i < mPlaneCount; i++)
+	{
+		U8 mask = mAgentPlanes[i].mask;
+		if (i == skip_plane || mask == 0xff)
+		{
+			continue;
+		}
+		const LLPlane& p = mAgentPlanes[i].p;
+		normal[planes] = LLVector3(p);
+		sign[planes] = scaler[mask];
+		neg_d[planes] = -p.mV[3];
+		planes++;
+	}
+
+#if LL_VECTORIZE
+	for (U32 base = 0; base < count; base += 4)
+	{
+		// load four boxes, repeating the last one if there are fewer left,
+		// and transpose them into x, y and z registers
+		U32 last = llmin(count - base, 4U) - 1;
+		__m128 cx = centers[base].mQ;
+		__m128 cy = centers[base + llmin(1U, last)].mQ;
+		__m128 cz = centers[base + llmin(2U, last)].mQ;
+		__m128 cw = centers[base + last].mQ;
+		_MM_TRANSPOSE4_PS(cx, cy, cz, cw);
+		__m128 rx = radii[base].mQ;
+		__m128 ry = radii[base + llmin(1U, last)].mQ;
+		__m128 rz = radii[base + llmin(2U, last)].mQ;
+		__m128 rw = radii[base + last].mQ;
+		_MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+
+		__m128 outside = _mm_setzero_ps();
+		__m128 partial = _mm_setzero_ps();
+		for (U32 i = 0; i < planes; i++)
+		{
+			__m128 nx = _mm_set1_ps(normal[i].mV[VX]);
+			__m128 ny = _mm_set1_ps(normal[i].mV[VY]);
+			__m128 nz = _mm_set1_ps(normal[i].mV[VZ]);
+			__m128 sx = _mm_mul_ps(_mm_set1_ps(sign[i].mV[VX]), rx);
+			__m128 sy = _mm_mul_ps(_mm_set1_ps(sign[i].mV[VY]), ry);
+			__m128 sz = _mm_mul_ps(_mm_set1_ps(sign[i].mV[VZ]), rz);
+			__m128 d = _mm_set1_ps(neg_d[i]);
+
+			// n * (center - rscale) > -d
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_sub_ps(cx, sx)),
+												_mm_mul_ps(ny, _mm_sub_ps(cy, sy))),
+									 _mm_mul_ps(nz, _mm_sub_ps(cz, sz)));
+			outside = _mm_or_ps(outside, _mm_cmpgt_ps(dist, d));
+
+			// n * (center + rscale) > -d
+			dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_add_ps(cx, sx)),
+										 _mm_mul_ps(ny, _mm_add_ps(cy, sy))),
+							  _mm_mul_ps(nz, _mm_add_ps(cz, sz)));
+			partial = _mm_or_ps(partial, _mm_cmpgt_ps(dist, d));
+		}
+
+		S32 out_bits = _mm_movemask_ps(outside);
+		S32 partial_bits = _mm_movemask_ps(partial);
+		for (U32 j = 0; j <= last; j++)
+		{
+			results[base + j] = (out_bits & (1 << j)) ? 0 : ((partial_bits & (1 << j)) ? 1 : 2);
+		}
+	}
+#else
+	for (U32 j = 0; j < count; j++)
+	{
+		LLVector3 center(centers[j].getF32ptr());
+		LLVector3 radius(radii[j].getF32ptr());
+		S32 result = 2;
+		for (U32 i = 0; i < planes; i++)
+		{
+			LLVector3 rscale = radius.scaledVec(sign[i]);
+			if (normal[i] * (center - rscale) > neg_d[i])
+			{
+				result = 0;
+				break;
+			}
+			if (normal[i] * (center + rscale) > neg_d[i])
+			{
+				result = 1;
+			}
+		}
+		results[j] = result;
+	}
+#endif
+}
+
 S32 LLCamera::AABBInFrustumNoFarClip(const LLVector3 &center, const LLVector3& radius) 
 {
 	static const LLVector3 scaler[] = {
@@ -32,6 +32,8 @@
 #include "llcoordframe.h"
 #include "llplane.h"
 
+class LLVector4a;
+
 const F32 DEFAULT_FIELD_OF_VIEW 	= 60.f * DEG_TO_RAD;
 const F32 DEFAULT_ASPECT_RATIO 		= 640.f / 480.f;
 const F32 DEFAULT_NEAR_PLANE 		= 0.25f;
@@ -196,6 +198,12 @@ public:
 	S32 AABBInFrustum(const LLVector3 &center, const LLVector3& radius);
 	S32 AABBInFrustumNoFarClip(const LLVector3 &center, const LLVector3& radius);
 
+	// Same as AABBInFrustum() and AABBInFrustumNoFarClip() for count boxes
+	// at once, given as centers and half sizes (w is ignored).  Writes 0, 1
+	// or 2 for each box to results.  Tests four boxes at a time with SSE.
+	void AABBInFrustumBatch(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results) const;
+	void AABBInFrustumNoFarClipBatch(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results) const;
+
 	//does a quick 'n dirty sphere-sphere check
 	S32 sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius); 
 
@@ -211,6 +219,7 @@ public:
 	friend std::ostream& operator<<(std::ostream &s, const LLCamera &C);
 
 protected:
+	void batchAABBInFrustum(const LLVector4a* centers, const LLVector4a* radii, U32 count, S32* results, U32 skip_plane) const;
 	void calculateFrustumPlanes();
 	void calculateFrustumPlanes(F32 left, F32 right, F32 top, F32 bottom);
 	void calculateFrustumPlanesFromWindow(F32 x1, F32 y1, F32 x2, F32 y2);
@@ -0,0 +1,110 @@
+/**
+ * @file llmatrix4a.cpp
+ * @brief LLMatrix4a batch transforms
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmatrix4a.h"
+
+void LLMatrix4a::affineTransform(const LLVector4a* src, LLVector4a* dst, U32 count) const
+{
+	for (U32 i = 0; i < count; ++i)
+	{
+		affineTransform(src[i], dst[i]);
+	}
+}
+
+void LLMatrix4a::rotate(const LLVector4a* src, LLVector4a* dst, U32 count) const
+{
+	for (U32 i = 0; i < count; ++i)
+	{
+		rotate(src[i], dst[i]);
+	}
+}
+
+void LLMatrix4a::rotateNormals(const LLVector4a* src, LLVector4a* dst, U32 count) const
+{
+	for (U32 i = 0; i < count; ++i)
+	{
+		rotate(src[i], dst[i]);
+		dst[i].normalize3();
+	}
+}
+
+void LLMatrix4a::affineTransform(const F32* src, U32 src_stride, F32* dst, U32 dst_stride, U32 count) const
+{
+	const U8* src_bytes = reinterpret_cast<const U8*>(src);
+	U8* dst_bytes = reinterpret_cast<U8*>(dst);
+	LLVector4a v;
+	for (U32 i = 0; i < count; ++i)
+	{
+		v.load3(reinterpret_cast<const F32*>(src_bytes));
+		affineTransform(v, v);
+		v.store3(reinterpret_cast<F32*>(dst_bytes));
+		src_bytes += src_stride;
+		dst_bytes += dst_stride;
+	}
+}
+
+void LLMatrix4a::rotateNormals(const F32* src, U32 src_stride, F32* dst, U32 dst_stride, U32 count) const
+{
+	const U8* src_bytes = reinterpret_cast<const U8*>(src);
+	U8* dst_bytes = reinterpret_cast<U8*>(dst);
+	LLVector4a v;
+	for (U32 i = 0; i < count; ++i)
+	{
+		v.load3(reinterpret_cast<const F32*>(src_bytes));
+		rotate(v, v);
+		v.normalize3();
+		v.store3(reinterpret_cast<F32*>(dst_bytes));
+		src_bytes += src_stride;
+		dst_bytes += dst_stride;
+	}
+}
+
+void LLMatrix4a::affineTransform(const LLVector4a* src, F32* dst, U32 dst_stride, U32 count) const
+{
+	U8* dst_bytes = reinterpret_cast<U8*>(dst);
+	LLVector4a v;
+	for (U32 i = 0; i < count; ++i)
+	{
+		affineTransform(src[i], v);
+		v.store3(reinterpret_cast<F32*>(dst_bytes));
+		dst_bytes += dst_stride;
+	}
+}
+
+void LLMatrix4a::rotateNormals(const LLVector4a* src, F32* dst, U32 dst_stride, U32 count) const
+{
+	U8* dst_bytes = reinterpret_cast<U8*>(dst);
+	LLVector4a v;
+	for (U32 i = 0; i < count; ++i)
+	{
+		rotate(src[i], v);
+		v.normalize3();
+		v.store3(reinterpret_cast<F32*>(dst_bytes));
+		dst_bytes += dst_stride;
+	}
+}
@@ -0,0 +1,272 @@
+/**
+ * @file llmatrix4a.h
+ * @brief LLMatrix4a class header file - 16 byte aligned 4x4 matrix for SIMD math
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMATRIX4A_H
+#define LL_LLMATRIX4A_H
+
+#include "llvector4a.h"
+#include "llquaternion2.h"
+#include "m3math.h"
+#include "m4math.h"
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// LLMatrix4a
+//
+// LLMatrix4 as four LLVector4a rows, with the same layout and conventions:
+// vectors are rows multiplied on the left, the translation is the last row,
+// and setMul(a, b) is a * b, so transforming by the result is transforming
+// by a and then by b.
+//
+// The batch transforms are what the geometry and skinning loops should
+// call; they keep the matrix in registers for the whole run.
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+LL_LLV4MATH_ALIGN_PREFIX
+
+class LLMatrix4a
+{
+public:
+	LLVector4a mMatrix[LLV4_NUM_AXIS];
+
+	LLMatrix4a()									{ }
+	explicit LLMatrix4a(const LLMatrix4& mat)		{ loadu(mat); }
+
+	inline void loadu(const LLMatrix4& src);
+	// Rotation rows from src, no translation
+	inline void loadu(const LLMatrix3& src);
+	inline void store(LLMatrix4& dst) const;
+	LLMatrix4 getMatrix4() const					{ LLMatrix4 mat; store(mat); return mat; }
+
+	inline void setIdentity();
+	// Same rotation as LLMatrix4(q), no translation
+	inline void setRotation(const LLQuaternion2& q);
+	inline void setTranslation(const LLVector4a& pos);
+
+	// a * b, as LLMatrix4's operator*=
+	inline void setMul(const LLMatrix4a& a, const LLMatrix4a& b);
+	inline void setLerp(const LLMatrix4a& a, const LLMatrix4a& b, F32 w);
+	inline void transpose();
+
+	// x, y and z of v as a point: v * mat for an LLVector3
+	inline void affineTransform(const LLVector4a& v, LLVector4a& res) const;
+	// x, y and z of v as a direction, rotate_vector() without the w row
+	inline void rotate(const LLVector4a& v, LLVector4a& res) const;
+	// All four components of v, as v * mat for an LLVector4
+	inline void rotate4(const LLVector4a& v, LLVector4a& res) const;
+
+	//-------------------------------------------------------------------------
+	// Batch transforms.  src and dst may be the same array.
+	//-------------------------------------------------------------------------
+
+	void affineTransform(const LLVector4a* src, LLVector4a* dst, U32 count) const;
+	void rotate(const LLVector4a* src, LLVector4a* dst, U32 count) const;
+	// Rotates then normalizes, for normals and binormals
+	void rotateNormals(const LLVector4a* src, LLVector4a* dst, U32 count) const;
+
+	// The same on x, y, z float triples stride bytes apart, such as the
+	// positions in a vertex buffer strider, which need not be aligned.
+	void affineTransform(const F32* src, U32 src_stride, F32* dst, U32 dst_stride, U32 count) const;
+	void rotateNormals(const F32* src, U32 src_stride, F32* dst, U32 dst_stride, U32 count) const;
+
+	// From an aligned array, such as LLVolumeFace's, to float triples
+	void affineTransform(const LLVector4a* src, F32* dst, U32 dst_stride, U32 count) const;
+	void rotateNormals(const LLVector4a* src, F32* dst, U32 dst_stride, U32 count) const;
+}
+
+LL_LLV4MATH_ALIGN_POSTFIX;
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// LLMatrix4a
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+inline void LLMatrix4a::loadu(const LLMatrix4& src)
+{
+	mMatrix[VX].loadua(src.mMatrix[VX]);
+	mMatrix[VY].loadua(src.mMatrix[VY]);
+	mMatrix[VZ].loadua(src.mMatrix[VZ]);
+	mMatrix[VW].loadua(src.mMatrix[VW]);
+}
+
+inline void LLMatrix4a::loadu(const LLMatrix3& src)
+{
+	mMatrix[VX].load3(src.mMatrix[VX]);
+	mMatrix[VY].load3(src.mMatrix[VY]);
+	mMatrix[VZ].load3(src.mMatrix[VZ]);
+	mMatrix[VW].set(0.f, 0.f, 0.f, 1.f);
+}
+
+inline void LLMatrix4a::store(LLMatrix4& dst) const
+{
+	for (U32 i = 0; i < LLV4_NUM_AXIS; ++i)
+	{
+		dst.mMatrix[i][VX] = mMatrix[i].mV[VX];
+		dst.mMatrix[i][VY] = mMatrix[i].mV[VY];
+		dst.mMatrix[i][VZ] = mMatrix[i].mV[VZ];
+		dst.mMatrix[i][VW] = mMatrix[i].mV[VW];
+	}
+}
+
+inline void LLMatrix4a::setIdentity()
+{
+	mMatrix[VX].set(1.f, 0.f, 0.f, 0.f);
+	mMatrix[VY].set(0.f, 1.f, 0.f, 0.f);
+	mMatrix[VZ].set(0.f, 0.f, 1.f, 0.f);
+	mMatrix[VW].set(0.f, 0.f, 0.f, 1.f);
+}
+
+inline void LLMatrix4a::setRotation(const LLQuaternion2& q)
+{
+	const F32* v = q.mQ.mV;
+	F32 xx = v[VX] * v[VX];
+	F32 xy = v[VX] * v[VY];
+	F32 xz = v[VX] * v[VZ];
+	F32 xw = v[VX] * v[VW];
+	F32 yy = v[VY] * v[VY];
+	F32 yz = v[VY] * v[VZ];
+	F32 yw = v[VY] * v[VW];
+	F32 zz = v[VZ] * v[VZ];
+	F32 zw = v[VZ] * v[VW];
+
+	mMatrix[VX].set(1.f - 2.f * (yy + zz), 2.f * (xy + zw), 2.f * (xz - yw), 0.f);
+	mMatrix[VY].set(2.f * (xy - zw), 1.f - 2.f * (xx + zz), 2.f * (yz + xw), 0.f);
+	mMatrix[VZ].set(2.f * (xz + yw), 2.f * (yz - xw), 1.f - 2.f * (xx + yy), 0.f);
+	mMatrix[VW].set(0.f, 0.f, 0.f, 1.f);
+}
+
+inline void LLMatrix4a::setTranslation(const LLVector4a& pos)
+{
+	mMatrix[VW].set(pos.mV[VX], pos.mV[VY], pos.mV[VZ], 1.f);
+}
+
+inline void LLMatrix4a::setMul(const LLMatrix4a& a, const LLMatrix4a& b)
+{
+	// each row of the result is that row of a transformed by b; a or b may
+	// be *this
+	LLVector4a rows[LLV4_NUM_AXIS];
+	b.rotate4(a.mMatrix[VX], rows[VX]);
+	b.rotate4(a.mMatrix[VY], rows[VY]);
+	b.rotate4(a.mMatrix[VZ], rows[VZ]);
+	b.rotate4(a.mMatrix[VW], rows[VW]);
+	mMatrix[VX] = rows[VX];
+	mMatrix[VY] = rows[VY];
+	mMatrix[VZ] = rows[VZ];
+	mMatrix[VW] = rows[VW];
+}
+
+inline void LLMatrix4a::setLerp(const LLMatrix4a& a, const LLMatrix4a& b, F32 w)
+{
+	mMatrix[VX].setLerp(a.mMatrix[VX], b.mMatrix[VX], w);
+	mMatrix[VY].setLerp(a.mMatrix[VY], b.mMatrix[VY], w);
+	mMatrix[VZ].setLerp(a.mMatrix[VZ], b.mMatrix[VZ], w);
+	mMatrix[VW].setLerp(a.mMatrix[VW], b.mMatrix[VW], w);
+}
+
+inline void LLMatrix4a::transpose()
+{
+#if LL_VECTORIZE
+	__m128 r0 = mMatrix[VX].mQ;
+	__m128 r1 = mMatrix[VY].mQ;
+	__m128 r2 = mMatrix[VZ].mQ;
+	__m128 r3 = mMatrix[VW].mQ;
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	mMatrix[VX].mQ = r0;
+	mMatrix[VY].mQ = r1;
+	mMatrix[VZ].mQ = r2;
+	mMatrix[VW].mQ = r3;
+#else
+	for (U32 i = 0; i < LLV4_NUM_AXIS; ++i)
+	{
+		for (U32 j = i + 1; j < LLV4_NUM_AXIS; ++j)
+		{
+			F32 t = mMatrix[i].mV[j];
+			mMatrix[i].mV[j] = mMatrix[j].mV[i];
+			mMatrix[j].mV[i] = t;
+		}
+	}
+#endif
+}
+
+inline void LLMatrix4a::affineTransform(const LLVector4a& v, LLVector4a& res) const
+{
+#if LL_VECTORIZE
+	__m128 x = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 y = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 r = _mm_add_ps(mMatrix[VW].mQ, _mm_mul_ps(x, mMatrix[VX].mQ));
+	r = _mm_add_ps(r, _mm_mul_ps(y, mMatrix[VY].mQ));
+	res.mQ = _mm_add_ps(r, _mm_mul_ps(z, mMatrix[VZ].mQ));
+#else
+	F32 x = v.mV[VX], y = v.mV[VY], z = v.mV[VZ];
+	for (U32 i = 0; i < LLV4_NUM_AXIS; ++i)
+	{
+		res.mV[i] = x * mMatrix[VX].mV[i] + y * mMatrix[VY].mV[i] + z * mMatrix[VZ].mV[i] + mMatrix[VW].mV[i];
+	}
+#endif
+}
+
+inline void LLMatrix4a::rotate(const LLVector4a& v, LLVector4a& res) const
+{
+#if LL_VECTORIZE
+	__m128 x = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 y = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 r = _mm_mul_ps(x, mMatrix[VX].mQ);
+	r = _mm_add_ps(r, _mm_mul_ps(y, mMatrix[VY].mQ));
+	res.mQ = _mm_add_ps(r, _mm_mul_ps(z, mMatrix[VZ].mQ));
+#else
+	F32 x = v.mV[VX], y = v.mV[VY], z = v.mV[VZ];
+	for (U32 i = 0; i < LLV4_NUM_AXIS; ++i)
+	{
+		res.mV[i] = x * mMatrix[VX].mV[i] + y * mMatrix[VY].mV[i] + z * mMatrix[VZ].mV[i];
+	}
+#endif
+}
+
+inline void LLMatrix4a::rotate4(const LLVector4a& v, LLVector4a& res) const
+{
+#if LL_VECTORIZE
+	__m128 x = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 y = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 w = _mm_shuffle_ps(v.mQ, v.mQ, _MM_SHUFFLE(3, 3, 3, 3));
+	__m128 r = _mm_mul_ps(x, mMatrix[VX].mQ);
+	r = _mm_add_ps(r, _mm_mul_ps(y, mMatrix[VY].mQ));
+	r = _mm_add_ps(r, _mm_mul_ps(z, mMatrix[VZ].mQ));
+	res.mQ = _mm_add_ps(r, _mm_mul_ps(w, mMatrix[VW].mQ));
+#else
+	F32 x = v.mV[VX], y = v.mV[VY], z = v.mV[VZ], w = v.mV[VW];
+	for (U32 i = 0; i < LLV4_NUM_AXIS; ++i)
+	{
+		res.mV[i] = x * mMatrix[VX].mV[i] + y * mMatrix[VY].mV[i] + z * mMatrix[VZ].mV[i] + w * mMatrix[VW].mV[i];
+	}
+#endif
+}
+
+#endif // LL_LLMATRIX4A_H
@@ -30,7 +30,7 @@
 #include "lltreenode.h"
 #include "v3math.h"
 #include <vector>
-#include <set>
+#include <new>
 
 
 #define OCT_ERRS LL_DEBUGS("OctreeErrors")
@@ -44,6 +44,56 @@
 
 template <class T> class LLOctreeNode;
 
+// Free list of equally sized blocks for octree nodes, carved out of
+// chunks of NODES_PER_CHUNK, so nodes created together sit next to each
+// other in memory instead of being scattered over the heap.  Chunks are
+// kept for the life of the process.  Like the octree itself this is not
+// thread safe.
+template <size_t SIZE>
+class LLOctreePool
+{
+public:
+	static void* allocate()
+	{
+		if (!sFreeList)
+		{
+			grow();
+		}
+		FreeBlock* block = sFreeList;
+		sFreeList = block->mNext;
+		return block;
+	}
+
+	static void free(void* ptr)
+	{
+		FreeBlock* block = (FreeBlock*) ptr;
+		block->mNext = sFreeList;
+		sFreeList = block;
+	}
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* mNext;
+	};
+
+	static void grow()
+	{
+		const U32 NODES_PER_CHUNK = 64;
+		U8* chunk = (U8*) ::operator new(SIZE * NODES_PER_CHUNK);
+		// hand out the chunk front to back
+		for (U32 i = NODES_PER_CHUNK; i > 0; i--)
+		{
+			free(chunk + (i - 1) * SIZE);
+		}
+	}
+
+	static FreeBlock* sFreeList;
+};
+
+template <size_t SIZE>
+typename LLOctreePool<SIZE>::FreeBlock* LLOctreePool<SIZE>::sFreeList = NULL;
+
 template <class T>
 class LLOctreeListener: public LLTreeListener<T>
 {
@@ -55,6 +105,9 @@ public:
 	virtual void handleChildRemoval(const oct_node* parent, const oct_node* child) = 0;
 };
 
+// Elements must provide getPositionGroup() and getBinRadius() for
+// placement, and getBinIndex()/setBinIndex(S32) where the node keeps
+// their index in its element list (-1 when not in the octree).
 template <class T>
 class LLOctreeTraveler
 {
@@ -69,11 +122,10 @@ class LLOctreeNode : public LLTreeNode<T>
 public:
 	typedef LLOctreeTraveler<T>									oct_traveler;
 	typedef LLTreeTraveler<T>									tree_traveler;
-	typedef typename std::set<LLPointer<T> >					element_list;
-	typedef typename std::set<LLPointer<T> >::iterator			element_iter;
-	typedef typename std::set<LLPointer<T> >::const_iterator	const_element_iter;
+	typedef typename std::vector<LLPointer<T> >					element_list;
+	typedef typename std::vector<LLPointer<T> >::iterator		element_iter;
+	typedef typename std::vector<LLPointer<T> >::const_iterator	const_element_iter;
 	typedef typename std::vector<LLTreeListener<T>*>::iterator	tree_listener_iter;
-	typedef typename std::vector<LLOctreeNode<T>* >				child_list;
 	typedef LLTreeNode<T>		BaseType;
 	typedef LLOctreeNode<T>		oct_node;
 	typedef LLOctreeListener<T>	oct_listener;
@@ -81,6 +133,7 @@ public:
 	static const U8 OCTANT_POSITIVE_X = 0x01;
 	static const U8 OCTANT_POSITIVE_Y = 0x02;
 	static const U8 OCTANT_POSITIVE_Z = 0x04;
+	static const U32 MAX_CHILDREN = 8;
 		
 	LLOctreeNode(	LLVector3d center, 
 					LLVector3d size, 
@@ -110,6 +163,28 @@ public:
 		} 
 	}
 
+	// nodes come from LLOctreePool, subclasses that add members from the heap
+	void* operator new(size_t size)
+	{
+		if (size == sizeof(oct_node))
+		{
+			return LLOctreePool<sizeof(oct_node)>::allocate();
+		}
+		return ::operator new(size);
+	}
+
+	void operator delete(void* ptr, size_t size)
+	{
+		if (size == sizeof(oct_node))
+		{
+			LLOctreePool<sizeof(oct_node)>::free(ptr);
+		}
+		else
+		{
+			::operator delete(ptr);
+		}
+	}
+
 	inline const BaseType* getParent()	const			{ return mParent; }
 	inline void setParent(BaseType* parent)			{ mParent = (oct_node*) parent; }
 	inline const LLVector3d& getCenter() const			{ return mCenter; }
@@ -218,20 +293,39 @@ public:
 	}
 
 	void accept(oct_traveler* visitor)				{ visitor->visit(this); }
-	virtual bool isLeaf() const						{ return mChild.empty(); }
+	virtual bool isLeaf() const						{ return mChildCount == 0; }
 	
 	U32 getElementCount() const						{ return mData.size(); }
 	element_list& getData()							{ return mData; }
 	const element_list& getData() const				{ return mData; }
+	bool hasData(T* data) const
+	{
+		S32 index = data->getBinIndex();
+		return index >= 0 && index < (S32) mData.size() && mData[index] == data;
+	}
 	
-	U32 getChildCount()	const						{ return mChild.size(); }
+	U32 getChildCount()	const						{ return mChildCount; }
 	oct_node* getChild(U32 index)					{ return mChild[index]; }
 	const oct_node* getChild(U32 index) const		{ return mChild[index]; }
-	child_list& getChildren()						{ return mChild; }
-	const child_list& getChildren() const			{ return mChild; }
 	
 	void accept(tree_traveler* visitor) const		{ visitor->visit(this); }
 	void accept(oct_traveler* visitor) const		{ visitor->visit(this); }
+
+	// Depth first walk that calls visitor.visit(node) on this node and its
+	// descendants, bound at compile time rather than through the virtual
+	// calls of LLOctreeTraveler.  visit() returns false to skip the
+	// children of the node it was given.
+	template <class V>
+	void traverse(V& visitor) const
+	{
+		if (visitor.visit(this))
+		{
+			for (U32 i = 0; i < mChildCount; i++)
+			{
+				mChild[i]->traverse(visitor);
+			}
+		}
+	}
 	
 	oct_node* getNodeAt(const LLVector3d& pos, const F64& rad)
 	{ 
@@ -288,14 +382,14 @@ public:
 			{ //it belongs here
 #if LL_OCTREE_PARANOIA_CHECK
 				//if this is a redundant insertion, error out (should never happen)
-				if (mData.find(data) != mData.end())
+				if (hasData(data))
 				{
 					llwarns << "Redundant octree insertion detected. " << data << llendl;
 					return false;
 				}
 #endif
 
-				mData.insert(data);
+				addData(data);
 				BaseType::insert(data);
 				return true;
 			}
@@ -320,23 +414,19 @@ public:
 				//push center in direction of data
 				LLOctreeNode<T>::pushCenter(center, size, data);
 
-				// handle case where floating point number gets too small
-				if( llabs(center.mdV[0] - getCenter().mdV[0]) < F_APPROXIMATELY_ZERO &&
+				// handle case where floating point number gets too small,
+				// or all the child slots are somehow taken already
+				if( (llabs(center.mdV[0] - getCenter().mdV[0]) < F_APPROXIMATELY_ZERO &&
 					llabs(center.mdV[1] - getCenter().mdV[1]) < F_APPROXIMATELY_ZERO &&
-					llabs(center.mdV[2] - getCenter().mdV[2]) < F_APPROXIMATELY_ZERO)
+					llabs(center.mdV[2] - getCenter().mdV[2]) < F_APPROXIMATELY_ZERO) ||
+					getChildCount() == MAX_CHILDREN)
 				{
-					mData.insert(data);
+					addData(data);
 					BaseType::insert(data);
 					return true;
 				}
 
 #if LL_OCTREE_PARANOIA_CHECK
-				if (getChildCount() == 8)
-				{
-					//this really isn't possible, something bad has happened
-					OCT_ERRS << "Octree detected floating point error and gave up." << llendl;
-					return false;
-				}
 				
 				//make sure no existing node matches this position
 				for (U32 i = 0; i < getChildCount(); i++)
@@ -377,9 +467,9 @@ public:
 
 	bool remove(T* data)
 	{
-		if (mData.find(data) != mData.end())
+		if (hasData(data))
 		{	//we have data
-			mData.erase(data);
+			removeData(data->getBinIndex());
 			notifyRemoval(data);
 			checkAlive();
 			return true;
@@ -414,9 +504,9 @@ public:
 
 	void removeByAddress(T* data)
 	{
-        if (mData.find(data) != mData.end())
+        if (hasData(data))
 		{
-			mData.erase(data);
+			removeData(data->getBinIndex());
 			notifyRemoval(data);
 			llwarns << "FOUND!" << llendl;
 			checkAlive();
@@ -432,7 +522,7 @@ public:
 
 	void clearChildren()
 	{
-		mChild.clear();
+		mChildCount = 0;
 	}
 
 	void validate()
@@ -478,13 +568,13 @@ public:
 			}
 		}
 
-		if (mChild.size() >= 8)
+#endif
+		if (mChildCount >= MAX_CHILDREN)
 		{
-			OCT_ERRS <<"Octree node has too many children... why?" << llendl;
+			llerrs << "Octree node has too many children." << llendl;
 		}
-#endif
 
-		mChild.push_back(child);
+		mChild[mChildCount++] = child;
 		child->setParent(this);
 
 		if (!silent)
@@ -510,7 +600,11 @@ public:
 			mChild[index]->destroy();
 			delete mChild[index];
 		}
-		mChild.erase(mChild.begin() + index);
+		mChildCount--;
+		for (U32 i = index; i < mChildCount; i++)
+		{
+			mChild[i] = mChild[i + 1];
+		}
 
 		checkAlive();
 	}
@@ -541,8 +635,28 @@ public:
 		//OCT_ERRS << "Octree failed to delete requested child." << llendl;
 	}
 
-protected:	
-	child_list mChild;
+protected:
+	void addData(T* data)
+	{
+		data->setBinIndex(mData.size());
+		mData.push_back(data);
+	}
+
+	// moves the last element into the hole, element order is not kept
+	void removeData(U32 index)
+	{
+		mData[index]->setBinIndex(-1);
+		if (index != mData.size() - 1)
+		{
+			mData[index] = mData.back();
+			mData[index]->setBinIndex(index);
+		}
+		mData.pop_back();
+	}
+
+	// children are kept inline so traversals don't chase another pointer
+	oct_node* mChild[MAX_CHILDREN];
+	U8 mChildCount;
 	element_list mData;
 	oct_node* mParent;
 	LLVector3d mCenter;
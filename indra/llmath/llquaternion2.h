@@ -0,0 +1,149 @@
+/**
+ * @file llquaternion2.h
+ * @brief LLQuaternion2 class header file - 16 byte aligned quaternion for SIMD math
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLQUATERNION2_H
+#define LL_LLQUATERNION2_H
+
+#include "llvector4a.h"
+#include "llquaternion.h"
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// LLQuaternion2
+//
+// LLQuaternion in an LLVector4a, stored x, y, z, w like LLQuaternion::mQ and
+// following the same conventions: setMul(a, b) is a * b, and rotate() is
+// what vec * quat does to an LLVector3.
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+LL_LLV4MATH_ALIGN_PREFIX
+
+class LLQuaternion2
+{
+public:
+	LLVector4a mQ;
+
+	LLQuaternion2()									{ }
+	explicit LLQuaternion2(const LLQuaternion& q)	{ set(q); }
+
+	void set(const LLQuaternion& q)			{ mQ.loadua(q.mQ); }
+	LLQuaternion getQuaternion() const		{ return LLQuaternion(mQ.mV[VX], mQ.mV[VY], mQ.mV[VZ], mQ.mV[VW]); }
+	void setIdentity()						{ mQ.set(0.f, 0.f, 0.f, 1.f); }
+
+	// a * b, as LLQuaternion's operator*
+	inline void setMul(const LLQuaternion2& a, const LLQuaternion2& b);
+	// Same as LLQuaternion::normalize(): a quaternion too short to
+	// normalize becomes the identity.  Returns the length before.
+	inline F32 normalize();
+	inline void conjugate();
+
+	// Rotates v's x, y and z by this normalized quaternion, keeping v's w
+	inline void rotate(const LLVector4a& v, LLVector4a& res) const;
+}
+
+LL_LLV4MATH_ALIGN_POSTFIX;
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// LLQuaternion2
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+inline void LLQuaternion2::setMul(const LLQuaternion2& a, const LLQuaternion2& b)
+{
+#if LL_VECTORIZE
+	// a.w * b.xyz + b.w * a.xyz + a.xyz x b.xyz, b.w * a.w - a.xyz . b.xyz,
+	// as four lane wise products
+	const __m128 aq = a.mQ.mQ;
+	const __m128 bq = b.mQ.mQ;
+	const __m128 negate_w = _mm_set_ps(-0.f, 0.f, 0.f, 0.f);
+
+	__m128 res = _mm_mul_ps(_mm_shuffle_ps(bq, bq, _MM_SHUFFLE(3, 3, 3, 3)), aq);
+	__m128 t = _mm_mul_ps(_mm_shuffle_ps(aq, aq, _MM_SHUFFLE(0, 3, 3, 3)),
+						  _mm_shuffle_ps(bq, bq, _MM_SHUFFLE(0, 2, 1, 0)));
+	res = _mm_add_ps(res, _mm_xor_ps(t, negate_w));
+	t = _mm_mul_ps(_mm_shuffle_ps(aq, aq, _MM_SHUFFLE(1, 1, 0, 2)),
+				   _mm_shuffle_ps(bq, bq, _MM_SHUFFLE(1, 0, 2, 1)));
+	res = _mm_add_ps(res, _mm_xor_ps(t, negate_w));
+	t = _mm_mul_ps(_mm_shuffle_ps(aq, aq, _MM_SHUFFLE(2, 0, 2, 1)),
+				   _mm_shuffle_ps(bq, bq, _MM_SHUFFLE(2, 1, 0, 2)));
+	mQ.mQ = _mm_sub_ps(res, t);
+#else
+	const F32* aq = a.mQ.mV;
+	const F32* bq = b.mQ.mV;
+	mQ.set(bq[VW] * aq[VX] + bq[VX] * aq[VW] + bq[VY] * aq[VZ] - bq[VZ] * aq[VY],
+		   bq[VW] * aq[VY] + bq[VY] * aq[VW] + bq[VZ] * aq[VX] - bq[VX] * aq[VZ],
+		   bq[VW] * aq[VZ] + bq[VZ] * aq[VW] + bq[VX] * aq[VY] - bq[VY] * aq[VX],
+		   bq[VW] * aq[VW] - bq[VX] * aq[VX] - bq[VY] * aq[VY] - bq[VZ] * aq[VZ]);
+#endif
+}
+
+inline F32 LLQuaternion2::normalize()
+{
+	F32 mag = sqrtf(mQ.dot4(mQ));
+	if (mag > FP_MAG_THRESHOLD)
+	{
+		// like LLQuaternion, leave nearly unit quaternions alone so they
+		// don't drift between quantized states
+		if (fabs(1.f - mag) > ONE_PART_IN_A_MILLION)
+		{
+			mQ.mul(1.f / mag);
+		}
+	}
+	else
+	{
+		setIdentity();
+		mag = 0.f;
+	}
+	return mag;
+}
+
+inline void LLQuaternion2::conjugate()
+{
+#if LL_VECTORIZE
+	mQ.mQ = _mm_xor_ps(mQ.mQ, _mm_set_ps(0.f, -0.f, -0.f, -0.f));
+#else
+	mQ.set(-mQ.mV[VX], -mQ.mV[VY], -mQ.mV[VZ], mQ.mV[VW]);
+#endif
+}
+
+inline void LLQuaternion2::rotate(const LLVector4a& v, LLVector4a& res) const
+{
+	// v + w * t + q x t, where t = 2 * (q x v)
+	LLVector4a t;
+	t.setCross3(mQ, v);
+	t.mul(2.f);
+	LLVector4a qt;
+	qt.setCross3(mQ, t);
+	LLVector4a w;
+	w.splat(mQ.mV[VW]);
+	w.mul(t);
+	res.setAdd(v, w);
+	res.add(qt);
+}
+
+#endif // LL_LLQUATERNION2_H
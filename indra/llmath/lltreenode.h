@@ -53,9 +53,10 @@ public:
 	virtual bool insert(T* data);
 	virtual bool remove(T* data);
 	virtual void notifyRemoval(T* data);
-	virtual U32 getListenerCount()					{ return mListeners.size(); }
-	virtual LLTreeListener<T>* getListener(U32 index) const { return mListeners[index]; }
-	virtual void addListener(LLTreeListener<T>* listener) { mListeners.push_back(listener); }
+	// not virtual, these are on the hot path of every octree traversal
+	U32 getListenerCount() const					{ return mListeners.size(); }
+	LLTreeListener<T>* getListener(U32 index) const	{ return mListeners[index]; }
+	void addListener(LLTreeListener<T>* listener)	{ mListeners.push_back(listener); }
 
 protected:
 	void destroyListeners()
@@ -0,0 +1,343 @@
+/**
+ * @file llvector4a.h
+ * @brief LLVector4a class header file - 16 byte aligned vector for SIMD math
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVECTOR4A_H
+#define LL_LLVECTOR4A_H
+
+#include "llv4math.h"
+#include "v3math.h"
+#include "v4math.h"
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// LLVector4a
+//
+// Four floats in one SSE register, for the hot paths that transform many
+// vectors at once.  Unlike LLVector3 the default constructor leaves the
+// contents undefined, and most operations write their result to *this
+// (setAdd(a, b) rather than a + b) so the compiler keeps everything in
+// registers.  The 3 component operations ignore and may clobber w.
+//
+// Instances must be 16 byte aligned.  Members and locals are; arrays on
+// the heap must come from ll_aligned_malloc_16().  Builds without SSE get
+// the same interface in plain C++.
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+LL_LLV4MATH_ALIGN_PREFIX
+
+class LLVector4a
+{
+public:
+	union {
+		F32		mV[LLV4_NUM_AXIS];
+		V4F32	mQ;
+	};
+
+	LLVector4a()											{ }
+	LLVector4a(F32 x, F32 y, F32 z, F32 w = 0.f)			{ set(x, y, z, w); }
+	explicit LLVector4a(const LLVector3& vec, F32 w = 0.f)	{ set(vec.mV[VX], vec.mV[VY], vec.mV[VZ], w); }
+	explicit LLVector4a(const LLVector4& vec)				{ loadua(vec.mV); }
+
+	//-------------------------------------------------------------------------
+	// Loads and stores
+	//-------------------------------------------------------------------------
+
+	inline void set(F32 x, F32 y, F32 z, F32 w = 0.f);
+	inline void splat(F32 a);
+	inline void clear();
+	// x, y and z from src, which need not be aligned; w = 0
+	inline void load3(const F32* src);
+	// Four floats from 16 byte aligned src
+	inline void load4a(const F32* src);
+	// Four floats from anywhere
+	inline void loadua(const F32* src);
+	// x, y and z to dst, which need not be aligned
+	inline void store3(F32* dst) const;
+	// Four floats to 16 byte aligned dst
+	inline void store4a(F32* dst) const;
+
+	LLVector3 getVector3() const	{ return LLVector3(mV[VX], mV[VY], mV[VZ]); }
+	LLVector4 getVector4() const	{ return LLVector4(mV[VX], mV[VY], mV[VZ], mV[VW]); }
+	const F32* getF32ptr() const	{ return mV; }
+	F32* getF32ptr()				{ return mV; }
+
+	//-------------------------------------------------------------------------
+	// Arithmetic, all four components
+	//-------------------------------------------------------------------------
+
+	inline void setAdd(const LLVector4a& a, const LLVector4a& b);
+	inline void setSub(const LLVector4a& a, const LLVector4a& b);
+	inline void setMul(const LLVector4a& a, const LLVector4a& b);
+	inline void setMul(const LLVector4a& a, F32 b);
+	inline void setMin(const LLVector4a& a, const LLVector4a& b);
+	inline void setMax(const LLVector4a& a, const LLVector4a& b);
+	// a + (b - a) * w
+	inline void setLerp(const LLVector4a& a, const LLVector4a& b, F32 w);
+
+	void add(const LLVector4a& b)	{ setAdd(*this, b); }
+	void sub(const LLVector4a& b)	{ setSub(*this, b); }
+	void mul(const LLVector4a& b)	{ setMul(*this, b); }
+	void mul(F32 b)					{ setMul(*this, b); }
+
+	inline F32 dot4(const LLVector4a& b) const;
+
+	//-------------------------------------------------------------------------
+	// 3 component operations
+	//-------------------------------------------------------------------------
+
+	inline F32 dot3(const LLVector4a& b) const;
+	inline void setCross3(const LLVector4a& a, const LLVector4a& b);
+	F32 getLengthSquared3() const	{ return dot3(*this); }
+	F32 getLength3() const			{ return sqrtf(dot3(*this)); }
+	// Same as LLVector3::normVec(): a vector too short to normalize becomes
+	// zero.  Returns the length before normalizing.
+	inline F32 normalize3();
+	// TRUE if x, y and z are each within tolerance of b's
+	inline BOOL equals3(const LLVector4a& b, F32 tolerance = 0.001f) const;
+}
+
+LL_LLV4MATH_ALIGN_POSTFIX;
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// LLVector4a
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+inline void LLVector4a::set(F32 x, F32 y, F32 z, F32 w)
+{
+#if LL_VECTORIZE
+	mQ = _mm_set_ps(w, z, y, x);
+#else
+	mV[VX] = x;
+	mV[VY] = y;
+	mV[VZ] = z;
+	mV[VW] = w;
+#endif
+}
+
+inline void LLVector4a::splat(F32 a)
+{
+#if LL_VECTORIZE
+	mQ = _mm_set1_ps(a);
+#else
+	set(a, a, a, a);
+#endif
+}
+
+inline void LLVector4a::clear()
+{
+#if LL_VECTORIZE
+	mQ = _mm_setzero_ps();
+#else
+	set(0.f, 0.f, 0.f, 0.f);
+#endif
+}
+
+inline void LLVector4a::load3(const F32* src)
+{
+#if LL_VECTORIZE
+	// two loads rather than one of four floats, which could read past the
+	// end of an array of LLVector3
+	__m128 xy = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(src));
+	__m128 z = _mm_load_ss(src + 2);
+	mQ = _mm_movelh_ps(xy, z);
+#else
+	set(src[VX], src[VY], src[VZ], 0.f);
+#endif
+}
+
+inline void LLVector4a::load4a(const F32* src)
+{
+#if LL_VECTORIZE
+	mQ = _mm_load_ps(src);
+#else
+	set(src[VX], src[VY], src[VZ], src[VW]);
+#endif
+}
+
+inline void LLVector4a::loadua(const F32* src)
+{
+#if LL_VECTORIZE
+	mQ = _mm_loadu_ps(src);
+#else
+	set(src[VX], src[VY], src[VZ], src[VW]);
+#endif
+}
+
+inline void LLVector4a::store3(F32* dst) const
+{
+#if LL_VECTORIZE
+	_mm_storel_pi(reinterpret_cast<__m64*>(dst), mQ);
+	_mm_store_ss(dst + 2, _mm_movehl_ps(mQ, mQ));
+#else
+	dst[VX] = mV[VX];
+	dst[VY] = mV[VY];
+	dst[VZ] = mV[VZ];
+#endif
+}
+
+inline void LLVector4a::store4a(F32* dst) const
+{
+#if LL_VECTORIZE
+	_mm_store_ps(dst, mQ);
+#else
+	dst[VX] = mV[VX];
+	dst[VY] = mV[VY];
+	dst[VZ] = mV[VZ];
+	dst[VW] = mV[VW];
+#endif
+}
+
+inline void LLVector4a::setAdd(const LLVector4a& a, const LLVector4a& b)
+{
+#if LL_VECTORIZE
+	mQ = _mm_add_ps(a.mQ, b.mQ);
+#else
+	set(a.mV[VX] + b.mV[VX], a.mV[VY] + b.mV[VY], a.mV[VZ] + b.mV[VZ], a.mV[VW] + b.mV[VW]);
+#endif
+}
+
+inline void LLVector4a::setSub(const LLVector4a& a, const LLVector4a& b)
+{
+#if LL_VECTORIZE
+	mQ = _mm_sub_ps(a.mQ, b.mQ);
+#else
+	set(a.mV[VX] - b.mV[VX], a.mV[VY] - b.mV[VY], a.mV[VZ] - b.mV[VZ], a.mV[VW] - b.mV[VW]);
+#endif
+}
+
+inline void LLVector4a::setMul(const LLVector4a& a, const LLVector4a& b)
+{
+#if LL_VECTORIZE
+	mQ = _mm_mul_ps(a.mQ, b.mQ);
+#else
+	set(a.mV[VX] * b.mV[VX], a.mV[VY] * b.mV[VY], a.mV[VZ] * b.mV[VZ], a.mV[VW] * b.mV[VW]);
+#endif
+}
+
+inline void LLVector4a::setMul(const LLVector4a& a, F32 b)
+{
+#if LL_VECTORIZE
+	mQ = _mm_mul_ps(a.mQ, _mm_set1_ps(b));
+#else
+	set(a.mV[VX] * b, a.mV[VY] * b, a.mV[VZ] * b, a.mV[VW] * b);
+#endif
+}
+
+inline void LLVector4a::setMin(const LLVector4a& a, const LLVector4a& b)
+{
+#if LL_VECTORIZE
+	mQ = _mm_min_ps(a.mQ, b.mQ);
+#else
+	set(llmin(a.mV[VX], b.mV[VX]), llmin(a.mV[VY], b.mV[VY]), llmin(a.mV[VZ], b.mV[VZ]), llmin(a.mV[VW], b.mV[VW]));
+#endif
+}
+
+inline void LLVector4a::setMax(const LLVector4a& a, const LLVector4a& b)
+{
+#if LL_VECTORIZE
+	mQ = _mm_max_ps(a.mQ, b.mQ);
+#else
+	set(llmax(a.mV[VX], b.mV[VX]), llmax(a.mV[VY], b.mV[VY]), llmax(a.mV[VZ], b.mV[VZ]), llmax(a.mV[VW], b.mV[VW]));
+#endif
+}
+
+inline void LLVector4a::setLerp(const LLVector4a& a, const LLVector4a& b, F32 w)
+{
+#if LL_VECTORIZE
+	mQ = _mm_add_ps(a.mQ, _mm_mul_ps(_mm_sub_ps(b.mQ, a.mQ), _mm_set1_ps(w)));
+#else
+	set(llv4lerp(a.mV[VX], b.mV[VX], w), llv4lerp(a.mV[VY], b.mV[VY], w),
+		llv4lerp(a.mV[VZ], b.mV[VZ], w), llv4lerp(a.mV[VW], b.mV[VW], w));
+#endif
+}
+
+inline F32 LLVector4a::dot4(const LLVector4a& b) const
+{
+#if LL_VECTORIZE
+	__m128 m = _mm_mul_ps(mQ, b.mQ);
+	__m128 s = _mm_add_ps(m, _mm_movehl_ps(m, m));		// x+z, y+w
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(s);
+#else
+	return mV[VX] * b.mV[VX] + mV[VY] * b.mV[VY] + mV[VZ] * b.mV[VZ] + mV[VW] * b.mV[VW];
+#endif
+}
+
+inline F32 LLVector4a::dot3(const LLVector4a& b) const
+{
+#if LL_VECTORIZE
+	__m128 m = _mm_mul_ps(mQ, b.mQ);
+	__m128 y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z = _mm_movehl_ps(m, m);
+	return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(m, y), z));
+#else
+	return mV[VX] * b.mV[VX] + mV[VY] * b.mV[VY] + mV[VZ] * b.mV[VZ];
+#endif
+}
+
+inline void LLVector4a::setCross3(const LLVector4a& a, const LLVector4a& b)
+{
+#if LL_VECTORIZE
+	// a.yzx * b.zxy - a.zxy * b.yzx
+	__m128 a_yzx = _mm_shuffle_ps(a.mQ, a.mQ, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 b_zxy = _mm_shuffle_ps(b.mQ, b.mQ, _MM_SHUFFLE(3, 1, 0, 2));
+	__m128 a_zxy = _mm_shuffle_ps(a.mQ, a.mQ, _MM_SHUFFLE(3, 1, 0, 2));
+	__m128 b_yzx = _mm_shuffle_ps(b.mQ, b.mQ, _MM_SHUFFLE(3, 0, 2, 1));
+	mQ = _mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx));
+#else
+	set(a.mV[VY] * b.mV[VZ] - a.mV[VZ] * b.mV[VY],
+		a.mV[VZ] * b.mV[VX] - a.mV[VX] * b.mV[VZ],
+		a.mV[VX] * b.mV[VY] - a.mV[VY] * b.mV[VX],
+		0.f);
+#endif
+}
+
+inline F32 LLVector4a::normalize3()
+{
+	F32 mag = getLength3();
+	if (mag > FP_MAG_THRESHOLD)
+	{
+		mul(1.f / mag);
+	}
+	else
+	{
+		clear();
+		mag = 0.f;
+	}
+	return mag;
+}
+
+inline BOOL LLVector4a::equals3(const LLVector4a& b, F32 tolerance) const
+{
+	return fabsf(mV[VX] - b.mV[VX]) <= tolerance
+		&& fabsf(mV[VY] - b.mV[VY]) <= tolerance
+		&& fabsf(mV[VZ] - b.mV[VZ]) <= tolerance;
+}
+
+#endif // LL_LLVECTOR4A_H
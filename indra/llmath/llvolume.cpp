@@ -29,6 +29,7 @@
 #include <set>
 
 #include "llerror.h"
+#include "llmemory.h"
 #include "llmemtype.h"
 
 #include "llvolumemgr.h"
@@ -39,6 +40,7 @@
 #include "m3math.h"
 #include "lldarray.h"
 #include "llvolume.h"
+#include "llvolumebvh.h"
 #include "llstl.h"
 
 #define DEBUG_SILHOUETTE_BINORMALS 0
@@ -1648,17 +1650,19 @@ void LLPathParams::copyParams(const LLPathParams &params)
 	setSkew(params.getSkew());
 }
 
-S32 profile_delete_lock = 1 ; 
+// Number of LLVolumes deleting their profile, which may happen on several
+// threads at once now that volumes are built off the main thread.
+LLAtomicS32 profile_delete_unlocks;
 LLProfile::~LLProfile()
 {
-	if(profile_delete_lock)
+	if(!profile_delete_unlocks.CurrentValue())
 	{
 		llerrs << "LLProfile should not be deleted here!" << llendl ;
 	}
 }
 
 
-S32 LLVolume::sNumMeshPoints = 0;
+LLAtomicS32 LLVolume::sNumMeshPoints;	// static storage starts at 0
 
 LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const BOOL generate_single_face, const BOOL is_unique)
 	: mParams(params)
@@ -1707,14 +1711,19 @@ void LLVolume::genBinormals(S32 face)
 	mVolumeFaces[face].createBinormals();
 }
 
+void LLVolume::genBVH(S32 face)
+{
+	mVolumeFaces[face].createBVH();
+}
+
 LLVolume::~LLVolume()
 {
 	sNumMeshPoints -= mMesh.size();
 	delete mPathp;
 
-	profile_delete_lock = 0 ;
+	profile_delete_unlocks++;
 	delete mProfilep;
-	profile_delete_lock = 1 ;
+	profile_delete_unlocks--;
 
 	mPathp = NULL;
 	mProfilep = NULL;
@@ -3315,6 +3324,23 @@ S32 *LLVolume::getTriangleIndices(U32 &num_indices) const
 	return index;
 }
 
+U32 LLVolume::getMemoryUsage() const
+{
+	U32 bytes = sizeof(LLVolume);
+	bytes += mMesh.capacity() * sizeof(Point);
+	bytes += mPathp->mPath.capacity() * sizeof(LLPath::PathPt);
+	bytes += mProfilep->mProfile.capacity() * sizeof(LLVector3);
+	for (S32 i = 0; i < (S32)mVolumeFaces.size(); ++i)
+	{
+		const LLVolumeFace& face = mVolumeFaces[i];
+		bytes += sizeof(LLVolumeFace);
+		bytes += face.mNumVertices * (3 * sizeof(LLVector4a) + sizeof(LLVector2));
+		bytes += (face.mIndices.capacity() + face.mTriStrip.capacity()) * sizeof(U16);
+		bytes += face.mEdge.capacity() * sizeof(S32);
+	}
+	return bytes;
+}
+
 S32 LLVolume::getNumTriangleIndices() const
 {
 	BOOL profile_open = getProfile().isOpen();
@@ -3389,6 +3415,8 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 	normals.clear();
 	segments.clear();
 
+	LLVector4a cam_vec(obj_cam_vec);
+
 	S32 cur_index = 0;
 	//for each face
 	for (face_list_t::iterator iter = mVolumeFaces.begin();
@@ -3420,9 +3448,9 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 				S32 v3 = face.mIndices[j*3+2];
 
 				//get current face center
-				LLVector3 cCenter = (face.mVertices[v1].mPosition + 
-									face.mVertices[v2].mPosition + 
-									face.mVertices[v3].mPosition) / 3.0f;
+				LLVector3 cCenter = (face.mPositions[v1].getVector3() + 
+									face.mPositions[v2].getVector3() + 
+									face.mPositions[v3].getVector3()) / 3.0f;
 
 				//for each edge
 				for (S32 k = 0; k < 3; k++) {
@@ -3440,9 +3468,9 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 					v3 = face.mIndices[nIndex*3+2];
 
 					//get neighbor face center
-					LLVector3 nCenter = (face.mVertices[v1].mPosition + 
-									face.mVertices[v2].mPosition + 
-									face.mVertices[v3].mPosition) / 3.0f;
+					LLVector3 nCenter = (face.mPositions[v1].getVector3() + 
+									face.mPositions[v2].getVector3() + 
+									face.mPositions[v3].getVector3()) / 3.0f;
 
 					//draw line
 					vertices.push_back(cCenter);
@@ -3465,15 +3493,15 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 #elif DEBUG_SILHOUETTE_NORMALS
 
 			//for each vertex
-			for (U32 j = 0; j < face.mVertices.size(); j++) {
-				vertices.push_back(face.mVertices[j].mPosition);
-				vertices.push_back(face.mVertices[j].mPosition + face.mVertices[j].mNormal*0.1f);
+			for (S32 j = 0; j < face.mNumVertices; j++) {
+				vertices.push_back(face.mPositions[j].getVector3());
+				vertices.push_back(face.mPositions[j].getVector3() + face.mNormals[j].getVector3()*0.1f);
 				normals.push_back(LLVector3(0,0,1));
 				normals.push_back(LLVector3(0,0,1));
 				segments.push_back(vertices.size());
 #if DEBUG_SILHOUETTE_BINORMALS
-				vertices.push_back(face.mVertices[j].mPosition);
-				vertices.push_back(face.mVertices[j].mPosition + face.mVertices[j].mBinormal*0.1f);
+				vertices.push_back(face.mPositions[j].getVector3());
+				vertices.push_back(face.mPositions[j].getVector3() + face.mBinormals[j].getVector3()*0.1f);
 				normals.push_back(LLVector3(0,0,1));
 				normals.push_back(LLVector3(0,0,1));
 				segments.push_back(vertices.size());
@@ -3499,18 +3527,23 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 				S32 v2 = face.mIndices[j*3+1];
 				S32 v3 = face.mIndices[j*3+2];
 
-				LLVector3 norm = (face.mVertices[v1].mPosition - face.mVertices[v2].mPosition) % 
-					(face.mVertices[v2].mPosition - face.mVertices[v3].mPosition);
+				LLVector4a d1;
+				LLVector4a d2;
+				d1.setSub(face.mPositions[v1], face.mPositions[v2]);
+				d2.setSub(face.mPositions[v2], face.mPositions[v3]);
+				LLVector4a norm;
+				norm.setCross3(d1, d2);
 				
-				if (norm.magVecSquared() < 0.00000001f) 
+				if (norm.getLengthSquared3() < 0.00000001f) 
 				{
 					fFacing[j] = AWAY | TOWARDS;
 				}
 				else 
 				{
 					//get view vector
-					LLVector3 view = (obj_cam_vec-face.mVertices[v1].mPosition);
-					bool away = view * norm > 0.0f; 
+					LLVector4a view;
+					view.setSub(cam_vec, face.mPositions[v1]);
+					bool away = view.dot3(norm) > 0.0f; 
 					if (away) 
 					{
 						fFacing[j] = AWAY;
@@ -3556,13 +3589,13 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 						S32 v1 = face.mIndices[j*3+k];
 						S32 v2 = face.mIndices[j*3+((k+1)%3)];
 						
-						vertices.push_back(face.mVertices[v1].mPosition*mat);
-						LLVector3 norm1 = face.mVertices[v1].mNormal * norm_mat;
+						vertices.push_back(face.mPositions[v1].getVector3()*mat);
+						LLVector3 norm1 = face.mNormals[v1].getVector3() * norm_mat;
 						norm1.normVec();
 						normals.push_back(norm1);
 
-						vertices.push_back(face.mVertices[v2].mPosition*mat);
-						LLVector3 norm2 = face.mVertices[v2].mNormal * norm_mat;
+						vertices.push_back(face.mPositions[v2].getVector3()*mat);
+						LLVector3 norm2 = face.mNormals[v2].getVector3() * norm_mat;
 						norm2.normVec();
 						normals.push_back(norm2);
 
@@ -3613,54 +3646,69 @@ S32 LLVolume::lineSegmentIntersect(const LLVector3& start, const LLVector3& end,
 				genBinormals(i);
 			}
 			
-			for (U32 tri = 0; tri < face.mIndices.size()/3; tri++) 
-			{
-				S32 index1 = face.mIndices[tri*3+0];
-				S32 index2 = face.mIndices[tri*3+1];
-				S32 index3 = face.mIndices[tri*3+2];
+			genBVH(i);
 
-				F32 a, b, t;
-			
-				if (LLTriangleRayIntersect(face.mVertices[index1].mPosition,
-										   face.mVertices[index2].mPosition,
-										   face.mVertices[index3].mPosition,
-										   start, dir, &a, &b, &t, FALSE))
+			F32 a, b;
+			S32 tri = -1;
+			if (face.mBVH)
+			{
+				tri = face.mBVH->lineSegmentIntersect(face, start, dir, closest_t, a, b);
+			}
+			else
+			{
+				for (U32 j = 0; j < face.mIndices.size()/3; j++) 
 				{
-					if ((t >= 0.f) &&      // if hit is after start
-						(t <= 1.f) &&      // and before end
-						(t < closest_t))   // and this hit is closer
-		{
-						closest_t = t;
-						hit_face = i;
-
-						if (intersection != NULL)
+					F32 tri_a, tri_b, t;
+					if (LLTriangleRayIntersect(face.mPositions[face.mIndices[j*3+0]].getVector3(),
+											   face.mPositions[face.mIndices[j*3+1]].getVector3(),
+											   face.mPositions[face.mIndices[j*3+2]].getVector3(),
+											   start, dir, &tri_a, &tri_b, &t, FALSE))
+					{
+						if ((t >= 0.f) &&      // if hit is after start
+							(t <= 1.f) &&      // and before end
+							(t < closest_t))   // and this hit is closer
 						{
-							*intersection = start + dir * closest_t;
+							closest_t = t;
+							a = tri_a;
+							b = tri_b;
+							tri = j;
 						}
-			
-						if (tex_coord != NULL)
+					}
+				}
+			}
+
+			if (tri >= 0)
 			{
-							*tex_coord = ((1.f - a - b)  * face.mVertices[index1].mTexCoord +
-										  a              * face.mVertices[index2].mTexCoord +
-										  b              * face.mVertices[index3].mTexCoord);
+				S32 index1 = face.mIndices[tri*3+0];
+				S32 index2 = face.mIndices[tri*3+1];
+				S32 index3 = face.mIndices[tri*3+2];
 
-						}
+				hit_face = i;
 
-						if (normal != NULL)
+				if (intersection != NULL)
 				{
-							*normal    = ((1.f - a - b)  * face.mVertices[index1].mNormal + 
-										  a              * face.mVertices[index2].mNormal +
-										  b              * face.mVertices[index3].mNormal);
-						}
+					*intersection = start + dir * closest_t;
+				}
+			
+				if (tex_coord != NULL)
+				{
+					*tex_coord = ((1.f - a - b)  * face.mTexCoords[index1] +
+								  a              * face.mTexCoords[index2] +
+								  b              * face.mTexCoords[index3]);
+				}
 
-						if (bi_normal != NULL)
-					{
-							*bi_normal = ((1.f - a - b)  * face.mVertices[index1].mBinormal + 
-										  a              * face.mVertices[index2].mBinormal +
-										  b              * face.mVertices[index3].mBinormal);
-						}
+				if (normal != NULL)
+				{
+					*normal    = ((1.f - a - b)  * face.mNormals[index1].getVector3() + 
+								  a              * face.mNormals[index2].getVector3() +
+								  b              * face.mNormals[index3].getVector3());
+				}
 
-					}
+				if (bi_normal != NULL)
+				{
+					*bi_normal = ((1.f - a - b)  * face.mBinormals[index1].getVector3() + 
+								  a              * face.mBinormals[index2].getVector3() +
+								  b              * face.mBinormals[index3].getVector3());
 				}
 			}
 		}		
@@ -4404,8 +4452,131 @@ std::ostream& operator<<(std::ostream &s, const LLVolume *volumep)
 }
 
 
+LLVolumeFace::LLVolumeFace() : 
+	mID(0),
+	mTypeMask(0),
+	mHasBinormals(FALSE),
+	mBeginS(0),
+	mBeginT(0),
+	mNumS(0),
+	mNumT(0),
+	mNumVertices(0),
+	mPositions(NULL),
+	mNormals(NULL),
+	mBinormals(NULL),
+	mTexCoords(NULL),
+	mBVH(NULL)
+{
+}
+
+LLVolumeFace::LLVolumeFace(const LLVolumeFace& src) :
+	mNumVertices(0),
+	mPositions(NULL),
+	mNormals(NULL),
+	mBinormals(NULL),
+	mTexCoords(NULL),
+	mBVH(NULL)
+{
+	*this = src;
+}
+
+LLVolumeFace& LLVolumeFace::operator=(const LLVolumeFace& rhs)
+{
+	if (&rhs != this)
+	{
+		mID = rhs.mID;
+		mTypeMask = rhs.mTypeMask;
+		mCenter = rhs.mCenter;
+		mHasBinormals = rhs.mHasBinormals;
+		mBeginS = rhs.mBeginS;
+		mBeginT = rhs.mBeginT;
+		mNumS = rhs.mNumS;
+		mNumT = rhs.mNumT;
+		mExtents[0] = rhs.mExtents[0];
+		mExtents[1] = rhs.mExtents[1];
+		// the copy builds its own when it is first picked
+		destroyBVH();
+		copyVertices(rhs);
+		mIndices = rhs.mIndices;
+		mTriStrip = rhs.mTriStrip;
+		mEdge = rhs.mEdge;
+	}
+	return *this;
+}
+
+LLVolumeFace::~LLVolumeFace()
+{
+	destroyBVH();
+	freeVertices();
+}
+
+void LLVolumeFace::createBVH()
+{
+	if (!mBVH && mIndices.size() / 3 >= LLVolumeBVH::MIN_TRIANGLES)
+	{
+		mBVH = new LLVolumeBVH(*this);
+	}
+}
+
+void LLVolumeFace::destroyBVH()
+{
+	delete mBVH;
+	mBVH = NULL;
+}
+
+void LLVolumeFace::resizeVertices(S32 num_verts)
+{
+	destroyBVH();
+
+	if (num_verts == mNumVertices && mPositions)
+	{
+		return;
+	}
+
+	freeVertices();
+
+	if (num_verts > 0)
+	{
+		// positions, normals and binormals, then texture coordinates padded
+		// to a whole number of vectors
+		S32 num_vecs = num_verts * 3 + (num_verts + 1) / 2;
+		mPositions = (LLVector4a*) ll_aligned_malloc_16(num_vecs * sizeof(LLVector4a));
+		if (!mPositions)
+		{
+			llerrs << "Out of memory allocating " << num_verts << " volume face vertices" << llendl;
+		}
+		mNormals = mPositions + num_verts;
+		mBinormals = mNormals + num_verts;
+		mTexCoords = (LLVector2*) (mBinormals + num_verts);
+	}
+	mNumVertices = num_verts;
+}
+
+void LLVolumeFace::copyVertices(const LLVolumeFace& src)
+{
+	resizeVertices(src.mNumVertices);
+	if (mNumVertices)
+	{
+		S32 num_vecs = mNumVertices * 3 + (mNumVertices + 1) / 2;
+		memcpy(mPositions, src.mPositions, num_vecs * sizeof(LLVector4a));
+	}
+}
+
+void LLVolumeFace::freeVertices()
+{
+	ll_aligned_free_16(mPositions);
+	mPositions = NULL;
+	mNormals = NULL;
+	mBinormals = NULL;
+	mTexCoords = NULL;
+	mNumVertices = 0;
+}
+
 BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
 {
+	// partial builds move the vertices of flexible prims in place
+	destroyBVH();
+
 	if (mTypeMask & CAP_MASK)
 	{
 		return createCap(volume, partial_build);
@@ -4421,19 +4592,6 @@ BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
 	}
 }
 
-void	LerpPlanarVertex(LLVolumeFace::VertexData& v0,
-				   LLVolumeFace::VertexData& v1,
-				   LLVolumeFace::VertexData& v2,
-				   LLVolumeFace::VertexData& vout,
-				   F32	coef01,
-				   F32	coef02)
-{
-	vout.mPosition = v0.mPosition + ((v1.mPosition-v0.mPosition)*coef01)+((v2.mPosition-v0.mPosition)*coef02);
-	vout.mTexCoord = v0.mTexCoord + ((v1.mTexCoord-v0.mTexCoord)*coef01)+((v2.mTexCoord-v0.mTexCoord)*coef02);
-	vout.mNormal = v0.mNormal;
-	vout.mBinormal = v0.mBinormal;
-}
-
 BOOL LLVolumeFace::createUnCutCubeCap(LLVolume* volume, BOOL partial_build)
 {
 	LLMemType m1(LLMemType::MTYPE_VOLUME);
@@ -4460,72 +4618,82 @@ BOOL LLVolumeFace::createUnCutCubeCap(LLVolume* volume, BOOL partial_build)
 	else
 		offset = mBeginS;
 
-	VertexData	corners[4];
-	VertexData baseVert;
+	LLVector4a corners[4];
+	LLVector2 corner_tex_coords[4];
 	for(int t = 0; t < 4; t++){
-		corners[t].mPosition = mesh[offset + (grid_size*t)].mPos;
-		corners[t].mTexCoord.mV[0] = profile[grid_size*t].mV[0]+0.5f;
-		corners[t].mTexCoord.mV[1] = 0.5f - profile[grid_size*t].mV[1];
-	}
-	baseVert.mNormal = 
-		((corners[1].mPosition-corners[0].mPosition) % 
-		(corners[2].mPosition-corners[1].mPosition));
-	baseVert.mNormal.normVec();
+		corners[t].load3(mesh[offset + (grid_size*t)].mPos.mV);
+		corner_tex_coords[t].mV[0] = profile[grid_size*t].mV[0]+0.5f;
+		corner_tex_coords[t].mV[1] = 0.5f - profile[grid_size*t].mV[1];
+	}
+	LLVector4a lhs;
+	LLVector4a rhs;
+	lhs.setSub(corners[1], corners[0]);
+	rhs.setSub(corners[2], corners[1]);
+	LLVector4a normal;
+	normal.setCross3(lhs, rhs);
+	normal.normalize3();
 	if(!(mTypeMask & TOP_MASK)){
-		baseVert.mNormal *= -1.0f;
+		normal.mul(-1.0f);
 	}else{
 		//Swap the UVs on the U(X) axis for top face
-		LLVector2 swap;
-		swap = corners[0].mTexCoord;
-		corners[0].mTexCoord=corners[3].mTexCoord;
-		corners[3].mTexCoord=swap;
-		swap = corners[1].mTexCoord;
-		corners[1].mTexCoord=corners[2].mTexCoord;
-		corners[2].mTexCoord=swap;
-	}
-	baseVert.mBinormal = calc_binormal_from_triangle( 
-		corners[0].mPosition, corners[0].mTexCoord,
-		corners[1].mPosition, corners[1].mTexCoord,
-		corners[2].mPosition, corners[2].mTexCoord);
-	for(int t = 0; t < 4; t++){
-		corners[t].mBinormal = baseVert.mBinormal;
-		corners[t].mNormal = baseVert.mNormal;
+		std::swap(corner_tex_coords[0], corner_tex_coords[3]);
+		std::swap(corner_tex_coords[1], corner_tex_coords[2]);
 	}
+	LLVector4a binormal(calc_binormal_from_triangle( 
+		corners[0].getVector3(), corner_tex_coords[0],
+		corners[1].getVector3(), corner_tex_coords[1],
+		corners[2].getVector3(), corner_tex_coords[2]));
 	mHasBinormals = TRUE;
 
-	if (partial_build)
-	{
-		mVertices.clear();
-	}
+	resizeVertices(num_vertices);
 
-	S32	vtop = mVertices.size();
+	// every vertex lies in the plane of corners 0, 1 and 3
+	LLVector4a edge_s;
+	LLVector4a edge_t;
+	edge_s.setSub(corners[1], corners[0]);
+	edge_t.setSub(corners[3], corners[0]);
+	LLVector2 tex_edge_s = corner_tex_coords[1] - corner_tex_coords[0];
+	LLVector2 tex_edge_t = corner_tex_coords[3] - corner_tex_coords[0];
+
+	LLVector4a face_min;
+	LLVector4a face_max;
+	S32 cur_vertex = 0;
 	for(int gx = 0;gx<grid_size+1;gx++){
 		for(int gy = 0;gy<grid_size+1;gy++){
-			VertexData newVert;
-			LerpPlanarVertex(
-				corners[0],
-				corners[1],
-				corners[3],
-				newVert,
-				(F32)gx/(F32)grid_size,
-				(F32)gy/(F32)grid_size);
-			mVertices.push_back(newVert);
+			F32 coef_s = (F32)gx/(F32)grid_size;
+			F32 coef_t = (F32)gy/(F32)grid_size;
+
+			LLVector4a step_s;
+			LLVector4a step_t;
+			step_s.setMul(edge_s, coef_s);
+			step_t.setMul(edge_t, coef_t);
+			LLVector4a& pos = mPositions[cur_vertex];
+			pos.setAdd(corners[0], step_s);
+			pos.add(step_t);
+			mTexCoords[cur_vertex] = corner_tex_coords[0] + (tex_edge_s*coef_s) + (tex_edge_t*coef_t);
+			mNormals[cur_vertex] = normal;
+			mBinormals[cur_vertex] = binormal;
 
 			if (gx == 0 && gy == 0)
 			{
-				min = max = newVert.mPosition;
+				face_min = face_max = pos;
 			}
 			else
 			{
-				update_min_max(min,max,newVert.mPosition);
+				face_min.setMin(face_min, pos);
+				face_max.setMax(face_max, pos);
 			}
+			cur_vertex++;
 		}
 	}
 	
+	min = face_min.getVector3();
+	max = face_max.getVector3();
 	mCenter = (min + max) * 0.5f;
 
 	if (!partial_build)
 	{
+		mIndices.clear();
 #if GEN_TRI_STRIP
 		mTriStrip.clear();
 #endif
@@ -4539,7 +4707,7 @@ BOOL LLVolumeFace::createUnCutCubeCap(LLVolume* volume, BOOL partial_build)
 				{
 					for(S32 i=5;i>=0;i--)
 					{
-						mIndices.push_back(vtop+(gy*(grid_size+1))+gx+idxs[i]);
+						mIndices.push_back((gy*(grid_size+1))+gx+idxs[i]);
 					}
 					
 #if GEN_TRI_STRIP
@@ -4564,7 +4732,7 @@ BOOL LLVolumeFace::createUnCutCubeCap(LLVolume* volume, BOOL partial_build)
 				{
 					for(S32 i=0;i<6;i++)
 					{
-						mIndices.push_back(vtop+(gy*(grid_size+1))+gx+idxs[i]);
+						mIndices.push_back((gy*(grid_size+1))+gx+idxs[i]);
 					}
 
 #if GEN_TRI_STRIP
@@ -4623,7 +4791,9 @@ BOOL LLVolumeFace::createCap(LLVolume* volume, BOOL partial_build)
 	num_vertices = profile.size();
 	num_indices = (profile.size() - 2)*3;
 
-	mVertices.resize(num_vertices);
+	// solid caps also get a vertex in the middle
+	BOOL has_center = !(mTypeMask & HOLLOW_MASK) && !(mTypeMask & OPEN_MASK);
+	resizeVertices(has_center ? num_vertices + 1 : num_vertices);
 
 	if (!partial_build)
 	{
@@ -4651,66 +4821,66 @@ BOOL LLVolumeFace::createCap(LLVolume* volume, BOOL partial_build)
 	LLVector2 cuv;
 	LLVector2 min_uv, max_uv;
 
-	LLVector3& min = mExtents[0];
-	LLVector3& max = mExtents[1];
+	LLVector4a face_min;
+	LLVector4a face_max;
 
 	// Copy the vertices into the array
 	for (S32 i = 0; i < num_vertices; i++)
 	{
 		if (mTypeMask & TOP_MASK)
 		{
-			mVertices[i].mTexCoord.mV[0] = profile[i].mV[0]+0.5f;
-			mVertices[i].mTexCoord.mV[1] = profile[i].mV[1]+0.5f;
+			mTexCoords[i].mV[0] = profile[i].mV[0]+0.5f;
+			mTexCoords[i].mV[1] = profile[i].mV[1]+0.5f;
 		}
 		else
 		{
 			// Mirror for underside.
-			mVertices[i].mTexCoord.mV[0] = profile[i].mV[0]+0.5f;
-			mVertices[i].mTexCoord.mV[1] = 0.5f - profile[i].mV[1];
+			mTexCoords[i].mV[0] = profile[i].mV[0]+0.5f;
+			mTexCoords[i].mV[1] = 0.5f - profile[i].mV[1];
 		}
 
-		mVertices[i].mPosition = mesh[i + offset].mPos;
+		mPositions[i].load3(mesh[i + offset].mPos.mV);
 		
 		if (i == 0)
 		{
-			min = max = mVertices[i].mPosition;
-			min_uv = max_uv = mVertices[i].mTexCoord;
+			face_min = face_max = mPositions[i];
+			min_uv = max_uv = mTexCoords[i];
 		}
 		else
 		{
-			update_min_max(min,max, mVertices[i].mPosition);
-			update_min_max(min_uv, max_uv, mVertices[i].mTexCoord);
+			face_min.setMin(face_min, mPositions[i]);
+			face_max.setMax(face_max, mPositions[i]);
+			update_min_max(min_uv, max_uv, mTexCoords[i]);
 		}
 	}
 
-	mCenter = (min+max)*0.5f;
+	mExtents[0] = face_min.getVector3();
+	mExtents[1] = face_max.getVector3();
+	mCenter = (mExtents[0]+mExtents[1])*0.5f;
 	cuv = (min_uv + max_uv)*0.5f;
 
+	LLVector3 pos0 = mPositions[0].getVector3();
+	LLVector3 pos1 = mPositions[1].getVector3();
 	LLVector3 binormal = calc_binormal_from_triangle( 
 		mCenter, cuv,
-		mVertices[0].mPosition, mVertices[0].mTexCoord,
-		mVertices[1].mPosition, mVertices[1].mTexCoord);
+		pos0, mTexCoords[0],
+		pos1, mTexCoords[1]);
 	binormal.normVec();
 
 	LLVector3 d0;
 	LLVector3 d1;
 	LLVector3 normal;
 
-	d0 = mCenter-mVertices[0].mPosition;
-	d1 = mCenter-mVertices[1].mPosition;
+	d0 = mCenter-pos0;
+	d1 = mCenter-pos1;
 
 	normal = (mTypeMask & TOP_MASK) ? (d0%d1) : (d1%d0);
 	normal.normVec();
 
-	VertexData vd;
-	vd.mPosition = mCenter;
-	vd.mNormal = normal;
-	vd.mBinormal = binormal;
-	vd.mTexCoord = cuv;
-	
-	if (!(mTypeMask & HOLLOW_MASK) && !(mTypeMask & OPEN_MASK))
+	if (has_center)
 	{
-		mVertices.push_back(vd);
+		mPositions[num_vertices].load3(mCenter.mV);
+		mTexCoords[num_vertices] = cuv;
 		num_vertices++;
 		if (!partial_build)
 		{
@@ -4718,11 +4888,12 @@ BOOL LLVolumeFace::createCap(LLVolume* volume, BOOL partial_build)
 		}
 	}
 		
-	
+	LLVector4a normal4a(normal);
+	LLVector4a binormal4a(binormal);
 	for (S32 i = 0; i < num_vertices; i++)
 	{
-		mVertices[i].mBinormal = binormal;
-		mVertices[i].mNormal = normal;
+		mBinormals[i] = binormal4a;
+		mNormals[i] = normal4a;
 	}
 
 	mHasBinormals = TRUE;
@@ -5055,36 +5226,34 @@ void LLVolumeFace::createBinormals()
 		//generate binormals
 		for (U32 i = 0; i < mIndices.size()/3; i++) 
 		{	//for each triangle
-			const VertexData& v0 = mVertices[mIndices[i*3+0]];
-			const VertexData& v1 = mVertices[mIndices[i*3+1]];
-			const VertexData& v2 = mVertices[mIndices[i*3+2]];
+			const U16* idx = &(mIndices[i*3]);
 						
 			//calculate binormal
-			LLVector3 binorm = calc_binormal_from_triangle(v0.mPosition, v0.mTexCoord,
-															v1.mPosition, v1.mTexCoord,
-															v2.mPosition, v2.mTexCoord);
+			LLVector4a binorm(calc_binormal_from_triangle(mPositions[idx[0]].getVector3(), mTexCoords[idx[0]],
+														  mPositions[idx[1]].getVector3(), mTexCoords[idx[1]],
+														  mPositions[idx[2]].getVector3(), mTexCoords[idx[2]]));
 
 			for (U32 j = 0; j < 3; j++) 
 			{ //add triangle normal to vertices
-				mVertices[mIndices[i*3+j]].mBinormal += binorm; // * (weight_sum - d[j])/weight_sum;
+				mBinormals[idx[j]].add(binorm); // * (weight_sum - d[j])/weight_sum;
 			}
 
 			//even out quad contributions
 			if (i % 2 == 0) 
 			{
-				mVertices[mIndices[i*3+2]].mBinormal += binorm;
+				mBinormals[idx[2]].add(binorm);
 			}
 			else 
 			{
-				mVertices[mIndices[i*3+1]].mBinormal += binorm;
+				mBinormals[idx[1]].add(binorm);
 			}
 		}
 
 		//normalize binormals
-		for (U32 i = 0; i < mVertices.size(); i++) 
+		for (S32 i = 0; i < mNumVertices; i++) 
 		{
-			mVertices[i].mBinormal.normVec();
-			mVertices[i].mNormal.normVec();
+			mBinormals[i].normalize3();
+			mNormals[i].normalize3();
 		}
 
 		mHasBinormals = TRUE;
@@ -5117,7 +5286,7 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 	num_vertices = mNumS*mNumT;
 	num_indices = (mNumS-1)*(mNumT-1)*6;
 
-	mVertices.resize(num_vertices);
+	resizeVertices(num_vertices);
 
 	if (!partial_build)
 	{
@@ -5179,21 +5348,21 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 				i = mBeginS + s + max_s*t;
 			}
 
-			mVertices[cur_vertex].mPosition = mesh[i].mPos;
-			mVertices[cur_vertex].mTexCoord = LLVector2(ss,tt);
+			mPositions[cur_vertex].load3(mesh[i].mPos.mV);
+			mTexCoords[cur_vertex] = LLVector2(ss,tt);
 		
-			mVertices[cur_vertex].mNormal = LLVector3(0,0,0);
-			mVertices[cur_vertex].mBinormal = LLVector3(0,0,0);
+			mNormals[cur_vertex].clear();
+			mBinormals[cur_vertex].clear();
 
 			cur_vertex++;
 
 			if ((mTypeMask & INNER_MASK) && (mTypeMask & FLAT_MASK) && mNumS > 2 && s > 0)
 			{
-				mVertices[cur_vertex].mPosition = mesh[i].mPos;
-				mVertices[cur_vertex].mTexCoord = LLVector2(ss,tt);
+				mPositions[cur_vertex].load3(mesh[i].mPos.mV);
+				mTexCoords[cur_vertex] = LLVector2(ss,tt);
 			
-				mVertices[cur_vertex].mNormal = LLVector3(0,0,0);
-				mVertices[cur_vertex].mBinormal = LLVector3(0,0,0);
+				mNormals[cur_vertex].clear();
+				mBinormals[cur_vertex].clear();
 				cur_vertex++;
 			}
 		}
@@ -5211,11 +5380,11 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 
 			i = mBeginS + s + max_s*t;
 			ss = profile[mBeginS + s].mV[2] - begin_stex;
-			mVertices[cur_vertex].mPosition = mesh[i].mPos;
-			mVertices[cur_vertex].mTexCoord = LLVector2(ss,tt);
+			mPositions[cur_vertex].load3(mesh[i].mPos.mV);
+			mTexCoords[cur_vertex] = LLVector2(ss,tt);
 		
-			mVertices[cur_vertex].mNormal = LLVector3(0,0,0);
-			mVertices[cur_vertex].mBinormal = LLVector3(0,0,0);
+			mNormals[cur_vertex].clear();
+			mBinormals[cur_vertex].clear();
 
 			cur_vertex++;
 		}
@@ -5223,17 +5392,17 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 	
 
 	//get bounding box for this side
-	LLVector3& face_min = mExtents[0];
-	LLVector3& face_max = mExtents[1];
-	mCenter.clearVec();
-
-	face_min = face_max = mVertices[0].mPosition;
-	for (U32 i = 1; i < mVertices.size(); ++i)
+	LLVector4a face_min = mPositions[0];
+	LLVector4a face_max = mPositions[0];
+	for (S32 i = 1; i < mNumVertices; ++i)
 	{
-		update_min_max(face_min, face_max, mVertices[i].mPosition);
+		face_min.setMin(face_min, mPositions[i]);
+		face_max.setMax(face_max, mPositions[i]);
 	}
 
-	mCenter = (face_min + face_max) * 0.5f;
+	mExtents[0] = face_min.getVector3();
+	mExtents[1] = face_max.getVector3();
+	mCenter = (mExtents[0] + mExtents[1]) * 0.5f;
 
 	S32 cur_index = 0;
 	S32 cur_edge = 0;
@@ -5331,33 +5500,42 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 	{
 		const U16* idx = &(mIndices[i*3]);
 			
-		VertexData* v[] = 
-		{	&mVertices[idx[0]], &mVertices[idx[1]], &mVertices[idx[2]] };
+		const LLVector4a& v0 = mPositions[idx[0]];
+		LLVector4a d1;
+		LLVector4a d2;
+		d1.setSub(v0, mPositions[idx[1]]);
+		d2.setSub(v0, mPositions[idx[2]]);
 					
 		//calculate triangle normal
-		LLVector3 norm = (v[0]->mPosition-v[1]->mPosition) % (v[0]->mPosition-v[2]->mPosition);
+		LLVector4a norm;
+		norm.setCross3(d1, d2);
 
-		v[0]->mNormal += norm;
-		v[1]->mNormal += norm;
-		v[2]->mNormal += norm;
+		mNormals[idx[0]].add(norm);
+		mNormals[idx[1]].add(norm);
+		mNormals[idx[2]].add(norm);
 
 		//even out quad contributions
-		v[i%2+1]->mNormal += norm;
+		mNormals[idx[i%2+1]].add(norm);
 	}
 	
 	// adjust normals based on wrapping and stitching
 	
-	BOOL s_bottom_converges = ((mVertices[0].mPosition - mVertices[mNumS*(mNumT-2)].mPosition).magVecSquared() < 0.000001f);
-	BOOL s_top_converges = ((mVertices[mNumS-1].mPosition - mVertices[mNumS*(mNumT-2)+mNumS-1].mPosition).magVecSquared() < 0.000001f);
+	LLVector4a bottom_delta;
+	LLVector4a top_delta;
+	bottom_delta.setSub(mPositions[0], mPositions[mNumS*(mNumT-2)]);
+	top_delta.setSub(mPositions[mNumS-1], mPositions[mNumS*(mNumT-2)+mNumS-1]);
+	BOOL s_bottom_converges = (bottom_delta.getLengthSquared3() < 0.000001f);
+	BOOL s_top_converges = (top_delta.getLengthSquared3() < 0.000001f);
 	if (sculpt_stitching == LL_SCULPT_TYPE_NONE)  // logic for non-sculpt volumes
 	{
 		if (volume->getPath().isOpen() == FALSE)
 		{ //wrap normals on T
 			for (S32 i = 0; i < mNumS; i++)
 			{
-				LLVector3 norm = mVertices[i].mNormal + mVertices[mNumS*(mNumT-1)+i].mNormal;
-				mVertices[i].mNormal = norm;
-				mVertices[mNumS*(mNumT-1)+i].mNormal = norm;
+				LLVector4a norm;
+				norm.setAdd(mNormals[i], mNormals[mNumS*(mNumT-1)+i]);
+				mNormals[i] = norm;
+				mNormals[mNumS*(mNumT-1)+i] = norm;
 			}
 		}
 
@@ -5365,9 +5543,10 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 		{ //wrap normals on S
 			for (S32 i = 0; i < mNumT; i++)
 			{
-				LLVector3 norm = mVertices[mNumS*i].mNormal + mVertices[mNumS*i+mNumS-1].mNormal;
-				mVertices[mNumS * i].mNormal = norm;
-				mVertices[mNumS * i+mNumS-1].mNormal = norm;
+				LLVector4a norm;
+				norm.setAdd(mNormals[mNumS*i], mNormals[mNumS*i+mNumS-1]);
+				mNormals[mNumS * i] = norm;
+				mNormals[mNumS * i+mNumS-1] = norm;
 			}
 		}
 	
@@ -5378,7 +5557,7 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 			{ //all lower S have same normal
 				for (S32 i = 0; i < mNumT; i++)
 				{
-					mVertices[mNumS*i].mNormal = LLVector3(1,0,0);
+					mNormals[mNumS*i].set(1,0,0);
 				}
 			}
 
@@ -5386,7 +5565,7 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 			{ //all upper S have same normal
 				for (S32 i = 0; i < mNumT; i++)
 				{
-					mVertices[mNumS*i+mNumS-1].mNormal = LLVector3(-1,0,0);
+					mNormals[mNumS*i+mNumS-1].set(-1,0,0);
 				}
 			}
 		}
@@ -5414,30 +5593,31 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 		{
 			// average normals for north pole
 		
-			LLVector3 average(0.0, 0.0, 0.0);
+			LLVector4a average;
+			average.clear();
 			for (S32 i = 0; i < mNumS; i++)
 			{
-				average += mVertices[i].mNormal;
+				average.add(mNormals[i]);
 			}
 
 			// set average
 			for (S32 i = 0; i < mNumS; i++)
 			{
-				mVertices[i].mNormal = average;
+				mNormals[i] = average;
 			}
 
 			// average normals for south pole
 		
-			average = LLVector3(0.0, 0.0, 0.0);
+			average.clear();
 			for (S32 i = 0; i < mNumS; i++)
 			{
-				average += mVertices[i + mNumS * (mNumT - 1)].mNormal;
+				average.add(mNormals[i + mNumS * (mNumT - 1)]);
 			}
 
 			// set average
 			for (S32 i = 0; i < mNumS; i++)
 			{
-				mVertices[i + mNumS * (mNumT - 1)].mNormal = average;
+				mNormals[i + mNumS * (mNumT - 1)] = average;
 			}
 
 		}
@@ -5447,9 +5627,10 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 		{
 			for (S32 i = 0; i < mNumT; i++)
 			{
-				LLVector3 norm = mVertices[mNumS*i].mNormal + mVertices[mNumS*i+mNumS-1].mNormal;
-				mVertices[mNumS * i].mNormal = norm;
-				mVertices[mNumS * i+mNumS-1].mNormal = norm;
+				LLVector4a norm;
+				norm.setAdd(mNormals[mNumS*i], mNormals[mNumS*i+mNumS-1]);
+				mNormals[mNumS * i] = norm;
+				mNormals[mNumS * i+mNumS-1] = norm;
 			}
 		}
 
@@ -5459,9 +5640,10 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 		{
 			for (S32 i = 0; i < mNumS; i++)
 			{
-				LLVector3 norm = mVertices[i].mNormal + mVertices[mNumS*(mNumT-1)+i].mNormal;
-				mVertices[i].mNormal = norm;
-				mVertices[mNumS*(mNumT-1)+i].mNormal = norm;
+				LLVector4a norm;
+				norm.setAdd(mNormals[i], mNormals[mNumS*(mNumT-1)+i]);
+				mNormals[i] = norm;
+				mNormals[mNumS*(mNumT-1)+i] = norm;
 			}
 			
 		}
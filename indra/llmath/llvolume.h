@@ -36,6 +36,7 @@ class LLProfile;
 class LLPath;
 class LLVolumeFace;
 class LLVolume;
+class LLVolumeBVH;
 
 #include "lldarray.h"
 #include "lluuid.h"
@@ -43,11 +44,13 @@ class LLVolume;
 //#include "vmath.h"
 #include "v2math.h"
 #include "v3math.h"
+#include "llvector4a.h"
 #include "llquaternion.h"
 #include "llstrider.h"
 #include "v4coloru.h"
 #include "llrefcount.h"
 #include "llfile.h"
+#include "llapr.h"
 
 //============================================================================
 
@@ -779,29 +782,21 @@ public:
 class LLVolumeFace
 {
 public:
-	LLVolumeFace() : 
-		mID(0),
-		mTypeMask(0),
-		mHasBinormals(FALSE),
-		mBeginS(0),
-		mBeginT(0),
-		mNumS(0),
-		mNumT(0)
-	{
-	}
+	LLVolumeFace();
+	LLVolumeFace(const LLVolumeFace& src);
+	LLVolumeFace& operator=(const LLVolumeFace& rhs);
+	~LLVolumeFace();
 
 	BOOL create(LLVolume* volume, BOOL partial_build = FALSE);
 	void createBinormals();
 	void makeTriStrip();
-	
-	class VertexData
-	{
-	public:
-		LLVector3 mPosition;
-		LLVector3 mNormal;
-		LLVector3 mBinormal;
-		LLVector2 mTexCoord;
-	};
+	// Builds mBVH if the face has enough triangles to make it worthwhile.
+	void createBVH();
+	void destroyBVH();
+
+	// Makes room for num_verts vertices in every vertex array, reallocating
+	// them if the count changes.  The contents are undefined afterwards.
+	void resizeVertices(S32 num_verts);
 
 	enum
 	{
@@ -832,12 +827,28 @@ public:
 
 	LLVector3 mExtents[2]; //minimum and maximum point of face
 
-	std::vector<VertexData> mVertices;
+	// Vertex attributes as separate arrays of mNumVertices each, carved
+	// out of one 16 byte aligned block so they can be transformed and
+	// copied a vector at a time.  w is unused.  Binormals are zero until
+	// mHasBinormals is set.
+	S32 mNumVertices;
+	LLVector4a* mPositions;
+	LLVector4a* mNormals;
+	LLVector4a* mBinormals;
+	LLVector2* mTexCoords;
+
 	std::vector<U16>	mIndices;
 	std::vector<U16>	mTriStrip;
 	std::vector<S32>	mEdge;
 
+	// Picking acceleration, built on the first pick after the geometry
+	// changes.  NULL until then, and for small faces.
+	LLVolumeBVH* mBVH;
+
 private:
+	void copyVertices(const LLVolumeFace& src);
+	void freeVertices();
+
 	BOOL createUnCutCubeCap(LLVolume* volume, BOOL partial_build = FALSE);
 	BOOL createCap(LLVolume* volume, BOOL partial_build = FALSE);
 	BOOL createSide(LLVolume* volume, BOOL partial_build = FALSE);
@@ -885,6 +896,7 @@ public:
 
 	void regen();
 	void genBinormals(S32 face);
+	void genBVH(S32 face);
 
 	BOOL isConvex() const;
 	BOOL isCap(S32 face);
@@ -898,6 +910,9 @@ public:
 	// returns number of triangle indeces required for path/profile mesh
 	S32 getNumTriangleIndices() const;
 
+	// approximate bytes of geometry held by this volume
+	U32 getMemoryUsage() const;
+
 	void generateSilhouetteVertices(std::vector<LLVector3> &vertices, 
 									std::vector<LLVector3> &normals, 
 									std::vector<S32> &segments, 
@@ -931,7 +946,7 @@ public:
 	LLFaceID generateFaceMask();
 
 	BOOL isFaceMaskValid(LLFaceID face_mask);
-	static S32 sNumMeshPoints;
+	static LLAtomicS32 sNumMeshPoints; // volumes may be generated on several threads
 
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume &volume);
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume *volumep);		// HACK to bypass Windoze confusion over 
@@ -0,0 +1,213 @@
+/** 
+ * @file llvolumebvh.cpp
+ * @brief LLVolumeBVH class implementation.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumebvh.h"
+
+#include <algorithm>
+
+#include "llmemtype.h"
+#include "llvolume.h"
+
+// Triangles per leaf.  Below this a split costs more box tests than it
+// saves triangle tests.
+static const U32 LEAF_TRIANGLES = 4;
+
+// Deepest the tree gets is about log2(MAX_VOLUME_TRIANGLE_INDICES / 3 /
+// LEAF_TRIANGLES) since every split halves its triangles.
+static const U32 MAX_STACK = 64;
+
+// Boxes grow by this much of their size so hits right on a triangle's
+// edge, which LLTriangleRayIntersect() accepts, aren't boxed out.
+static const F32 BOX_SLOP = 0.0001f;
+
+namespace
+{
+	// Orders triangles by their centroid along one axis.
+	struct CentroidLess
+	{
+		CentroidLess(const std::vector<LLVector3>& centroids, U32 axis) :
+			mCentroids(centroids),
+			mAxis(axis)
+		{
+		}
+
+		bool operator()(U32 a, U32 b) const
+		{
+			return mCentroids[a].mV[mAxis] < mCentroids[b].mV[mAxis];
+		}
+
+		const std::vector<LLVector3>& mCentroids;
+		U32 mAxis;
+	};
+}
+
+LLVolumeBVH::LLVolumeBVH(const LLVolumeFace& face)
+{
+	LLMemType m1(LLMemType::MTYPE_VOLUME);
+
+	U32 num_triangles = face.mIndices.size() / 3;
+	if (num_triangles == 0)
+	{
+		return;
+	}
+
+	std::vector<LLVector3> centroids(num_triangles);
+	std::vector<LLVector3> mins(num_triangles);
+	std::vector<LLVector3> maxs(num_triangles);
+	mTriangles.resize(num_triangles);
+	for (U32 tri = 0; tri < num_triangles; tri++)
+	{
+		LLVector3 v0 = face.mPositions[face.mIndices[tri*3+0]].getVector3();
+		LLVector3 v1 = face.mPositions[face.mIndices[tri*3+1]].getVector3();
+		LLVector3 v2 = face.mPositions[face.mIndices[tri*3+2]].getVector3();
+
+		mins[tri] = v0;
+		maxs[tri] = v0;
+		update_min_max(mins[tri], maxs[tri], v1);
+		update_min_max(mins[tri], maxs[tri], v2);
+		centroids[tri] = (v0 + v1 + v2) / 3.f;
+		mTriangles[tri] = tri;
+	}
+
+	// a full binary tree over n leaves has 2n - 1 nodes, and halving
+	// leaves at least LEAF_TRIANGLES / 2 triangles in each leaf
+	mNodes.reserve(2 * ((num_triangles + LEAF_TRIANGLES / 2 - 1) / (LEAF_TRIANGLES / 2)));
+	build(0, num_triangles, centroids, mins, maxs);
+}
+
+void LLVolumeBVH::build(U32 first, U32 count, const std::vector<LLVector3>& centroids,
+						const std::vector<LLVector3>& mins, const std::vector<LLVector3>& maxs)
+{
+	U32 index = mNodes.size();
+	mNodes.push_back(Node());
+
+	LLVector3 min = mins[mTriangles[first]];
+	LLVector3 max = maxs[mTriangles[first]];
+	LLVector3 centroid_min = centroids[mTriangles[first]];
+	LLVector3 centroid_max = centroid_min;
+	for (U32 i = first + 1; i < first + count; i++)
+	{
+		U32 tri = mTriangles[i];
+		update_min_max(min, max, mins[tri]);
+		update_min_max(min, max, maxs[tri]);
+		update_min_max(centroid_min, centroid_max, centroids[tri]);
+	}
+
+	LLVector3 size = (max - min) * 0.5f;
+	mNodes[index].mCenter = (min + max) * 0.5f;
+	mNodes[index].mSize = size + size * BOX_SLOP + LLVector3(F_APPROXIMATELY_ZERO, F_APPROXIMATELY_ZERO, F_APPROXIMATELY_ZERO);
+
+	if (count <= LEAF_TRIANGLES)
+	{
+		mNodes[index].mFirst = first;
+		mNodes[index].mCount = count;
+		return;
+	}
+
+	// split at the median centroid along the axis they spread out most on
+	LLVector3 spread = centroid_max - centroid_min;
+	U32 axis = VX;
+	if (spread.mV[VY] > spread.mV[axis])
+	{
+		axis = VY;
+	}
+	if (spread.mV[VZ] > spread.mV[axis])
+	{
+		axis = VZ;
+	}
+
+	U32 half = count / 2;
+	std::nth_element(mTriangles.begin() + first, mTriangles.begin() + first + half,
+					 mTriangles.begin() + first + count, CentroidLess(centroids, axis));
+
+	build(first, half, centroids, mins, maxs);
+	mNodes[index].mFirst = mNodes.size();
+	mNodes[index].mCount = 0;
+	build(first + half, count - half, centroids, mins, maxs);
+}
+
+S32 LLVolumeBVH::lineSegmentIntersect(const LLVolumeFace& face, const LLVector3& start, const LLVector3& dir,
+									  F32& closest_t, F32& a, F32& b) const
+{
+	if (mNodes.empty())
+	{
+		return -1;
+	}
+
+	S32 hit = -1;
+	LLVector3 end = start + dir * llmin(closest_t, 1.f);
+
+	U32 stack[MAX_STACK];
+	U32 depth = 0;
+	stack[depth++] = 0;
+
+	while (depth > 0)
+	{
+		const Node& node = mNodes[stack[--depth]];
+		if (!LLLineSegmentBoxIntersect(start, end, node.mCenter, node.mSize))
+		{
+			continue;
+		}
+
+		if (node.mCount == 0)
+		{
+			if (depth + 2 > MAX_STACK)
+			{
+				llerrs << "Volume BVH deeper than " << MAX_STACK << llendl;
+			}
+			stack[depth++] = node.mFirst;
+			stack[depth++] = &node - &mNodes[0] + 1;
+			continue;
+		}
+
+		for (U32 i = node.mFirst; i < node.mFirst + node.mCount; i++)
+		{
+			U32 tri = mTriangles[i];
+			S32 index1 = face.mIndices[tri*3+0];
+			S32 index2 = face.mIndices[tri*3+1];
+			S32 index3 = face.mIndices[tri*3+2];
+
+			F32 tri_a, tri_b, t;
+			if (LLTriangleRayIntersect(face.mPositions[index1].getVector3(),
+									   face.mPositions[index2].getVector3(),
+									   face.mPositions[index3].getVector3(),
+									   start, dir, &tri_a, &tri_b, &t, FALSE) &&
+				t >= 0.f && t <= 1.f && t < closest_t)
+			{
+				closest_t = t;
+				a = tri_a;
+				b = tri_b;
+				hit = tri;
+				// only closer hits from here on
+				end = start + dir * t;
+			}
+		}
+	}
+
+	return hit;
+}
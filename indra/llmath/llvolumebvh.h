@@ -0,0 +1,78 @@
+/** 
+ * @file llvolumebvh.h
+ * @brief LLVolumeBVH class, a bounding volume hierarchy over the
+ * triangles of an LLVolumeFace for ray picking.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include <vector>
+
+#include "v3math.h"
+
+class LLVolumeFace;
+
+// Binary tree of axis aligned boxes over a face's triangles, so a line
+// segment only gets tested against the triangles in the boxes it passes
+// through.  Built from the face's positions and indices as they are at
+// the time; the face throws it away when its geometry changes.
+class LLVolumeBVH
+{
+public:
+	// Faces with fewer triangles than this are tested triangle by triangle.
+	static const U32 MIN_TRIANGLES = 64;
+
+	LLVolumeBVH(const LLVolumeFace& face);
+
+	// Finds the closest triangle of face hit from start along dir with
+	// 0 <= t <= 1 and t < closest_t, as LLTriangleRayIntersect() reports
+	// them.  On a hit returns the triangle's index (its first index is
+	// face.mIndices[triangle * 3]) and updates closest_t, a and b.
+	// Returns -1 otherwise.
+	S32 lineSegmentIntersect(const LLVolumeFace& face, const LLVector3& start, const LLVector3& dir,
+							 F32& closest_t, F32& a, F32& b) const;
+
+	U32 getNodeCount() const						{ return mNodes.size(); }
+
+private:
+	// Interior nodes have mCount == 0; their first child follows them and
+	// mFirst is the index of the second.  Leaves hold mCount triangles
+	// from mTriangles[mFirst].
+	struct Node
+	{
+		LLVector3 mCenter;
+		LLVector3 mSize;	// half size
+		U32 mFirst;
+		U32 mCount;
+	};
+
+	void build(U32 first, U32 count, const std::vector<LLVector3>& centroids,
+			   const std::vector<LLVector3>& mins, const std::vector<LLVector3>& maxs);
+
+	std::vector<Node> mNodes;
+	std::vector<U32> mTriangles;
+};
+
+#endif
@@ -45,7 +45,13 @@ F32 LLVolumeLODGroup::mDetailScales[NUM_LODS] = {1.f, 1.5f, 2.5f, 4.f};
 //============================================================================
 
 LLVolumeMgr::LLVolumeMgr()
-:	mDataMutex(NULL)
+:	mDataMutex(NULL),
+	mBuildThread(NULL),
+	mCacheBudget(0),
+	mCacheBytes(0),
+	mCacheHits(0),
+	mCacheMisses(0),
+	mCacheEvictions(0)
 {
 	// the LLMutex magic interferes with easy unit testing,
 	// so you now must manually call useMutex() to use it
@@ -56,6 +62,10 @@ LLVolumeMgr::~LLVolumeMgr()
 {
 	cleanup();
 
+	// the groups have given up their builds, so nothing waits on these
+	delete mBuildThread;
+	mBuildThread = NULL;
+
 	delete mDataMutex;
 	mDataMutex = NULL;
 }
@@ -79,6 +89,8 @@ BOOL LLVolumeMgr::cleanup()
  		delete volgroupp;
 	}
 	mVolumeLODGroups.clear();
+	mCache.clear();
+	mCacheBytes = 0;
 	if (mDataMutex)
 	{
 		mDataMutex->unlock();
@@ -106,6 +118,16 @@ LLVolume* LLVolumeMgr::refVolume(const LLVolumeParams &volume_params, const S32
 	{
 		volgroupp = iter->second;
 	}
+	if (volgroupp->mCached[detail])
+	{
+		removeFromCache(volgroupp, detail);
+		mCacheHits++;
+	}
+	else if (volgroupp->mVolumeLODs[detail].isNull() &&
+			 volgroupp->mBuildHandles[detail] == LLQueuedThread::nullHandle())
+	{
+		mCacheMisses++;
+	}
 	if (mDataMutex)
 	{
 		mDataMutex->unlock();
@@ -113,6 +135,22 @@ LLVolume* LLVolumeMgr::refVolume(const LLVolumeParams &volume_params, const S32
 	return volgroupp->refLOD(detail);
 }
 
+BOOL LLVolumeMgr::requestVolume(const LLVolumeParams &volume_params, const S32 detail)
+{
+	LLVolumeLODGroup* volgroupp = getGroup(volume_params);
+	if (!volgroupp)
+	{
+		return TRUE;
+	}
+	BOOL building = volgroupp->mBuildHandles[detail] != LLQueuedThread::nullHandle();
+	BOOL res = volgroupp->requestLOD(detail);
+	if (!building && volgroupp->mBuildHandles[detail] != LLQueuedThread::nullHandle())
+	{
+		mCacheMisses++;
+	}
+	return res;
+}
+
 // virtual
 LLVolumeLODGroup* LLVolumeMgr::getGroup( const LLVolumeParams& volume_params ) const
 {
@@ -159,12 +197,21 @@ void LLVolumeMgr::unrefVolume(LLVolume *volumep)
 	{
 		LLVolumeLODGroup* volgroupp = iter->second;
 
-		volgroupp->derefLOD(volumep);
-		if (volgroupp->getNumRefs() == 0)
+		volgroupp->derefLOD(volumep, mCacheBudget != 0);
+		for (S32 i = 0; mCacheBudget && i < LLVolumeLODGroup::NUM_LODS; i++)
 		{
-			mVolumeLODGroups.erase(params);
+			if (volgroupp->mVolumeLODs[i] == volumep && !volgroupp->mLODRefs[i])
+			{
+				addToCache(volgroupp, i);
+			}
+		}
+		if (volgroupp->getNumRefs() == 0 && !volgroupp->isCached())
+		{
+			// params may belong to a volume freed by derefLOD()
+			mVolumeLODGroups.erase(iter);
 			delete volgroupp;
 		}
+		trimCache();
 	}
 	if (mDataMutex)
 	{
@@ -176,6 +223,7 @@ void LLVolumeMgr::unrefVolume(LLVolume *volumep)
 // protected
 void LLVolumeMgr::insertGroup(LLVolumeLODGroup* volgroup)
 {
+	volgroup->setBuildThread(mBuildThread);
 	mVolumeLODGroups[volgroup->getVolumeParams()] = volgroup;
 }
 
@@ -220,6 +268,72 @@ void LLVolumeMgr::useMutex()
 	}
 }
 
+void LLVolumeMgr::startBuildThread(U32 num_workers)
+{
+	if (!mBuildThread)
+	{
+		mBuildThread = new LLVolumeBuildThread(true, num_workers);
+		for (volume_lod_group_map_t::iterator iter = mVolumeLODGroups.begin();
+			 iter != mVolumeLODGroups.end(); ++iter)
+		{
+			iter->second->setBuildThread(mBuildThread);
+		}
+	}
+}
+
+void LLVolumeMgr::setCacheBudget(U32 budget)
+{
+	if (mDataMutex)
+	{
+		mDataMutex->lock();
+	}
+	mCacheBudget = budget;
+	trimCache();
+	if (mDataMutex)
+	{
+		mDataMutex->unlock();
+	}
+}
+
+// protected
+void LLVolumeMgr::addToCache(LLVolumeLODGroup* volgroup, S32 detail)
+{
+	LLVolumeCacheEntry entry;
+	entry.mGroup = volgroup;
+	entry.mDetail = detail;
+	entry.mBytes = volgroup->mVolumeLODs[detail]->getMemoryUsage();
+	mCache.push_front(entry);
+	mCacheBytes += entry.mBytes;
+	volgroup->mCacheEntries[detail] = mCache.begin();
+	volgroup->mCached[detail] = TRUE;
+}
+
+// protected
+void LLVolumeMgr::removeFromCache(LLVolumeLODGroup* volgroup, S32 detail)
+{
+	mCacheBytes -= volgroup->mCacheEntries[detail]->mBytes;
+	mCache.erase(volgroup->mCacheEntries[detail]);
+	volgroup->mCached[detail] = FALSE;
+}
+
+// protected
+void LLVolumeMgr::trimCache()
+{
+	while (mCacheBytes > mCacheBudget && !mCache.empty())
+	{
+		LLVolumeLODGroup* volgroupp = mCache.back().mGroup;
+		S32 detail = mCache.back().mDetail;
+		removeFromCache(volgroupp, detail);
+		volgroupp->mVolumeLODs[detail] = NULL;
+		mCacheEvictions++;
+		if (volgroupp->getNumRefs() == 0 && !volgroupp->isCached())
+		{
+			mVolumeLODGroups.erase(volgroupp->getVolumeParams());
+			delete volgroupp;
+		}
+	}
+}
+
 std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr)
 {
 	s << "{ numLODgroups=" << volume_mgr.mVolumeLODGroups.size() << ", ";
@@ -249,12 +363,15 @@ std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr)
 
 LLVolumeLODGroup::LLVolumeLODGroup(const LLVolumeParams &params)
 	: mVolumeParams(params),
-	  mRefs(0)
+	  mRefs(0),
+	  mBuildThread(NULL)
 {
 	for (S32 i = 0; i < NUM_LODS; i++)
 	{
 		mLODRefs[i] = 0;
 		mAccessCount[i] = 0;
+		mBuildHandles[i] = LLQueuedThread::nullHandle();
+		mCached[i] = FALSE;
 	}
 }
 
@@ -263,6 +380,16 @@ LLVolumeLODGroup::~LLVolumeLODGroup()
 	for (S32 i = 0; i < NUM_LODS; i++)
 	{
 		llassert_always(mLODRefs[i] == 0);
+		if (mBuildHandles[i] != LLQueuedThread::nullHandle())
+		{
+			// Abort first so a build that is still running deletes itself
+			// when done, then complete one that already finished.
+			mBuildThread->abortRequest(mBuildHandles[i], true);
+			if (mBuildThread->getRequestStatus(mBuildHandles[i]) == LLQueuedThread::STATUS_COMPLETE)
+			{
+				mBuildThread->completeRequest(mBuildHandles[i]);
+			}
+		}
 	}
 }
 
@@ -295,6 +422,10 @@ LLVolume* LLVolumeLODGroup::refLOD(const S32 detail)
 	mAccessCount[detail]++;
 	
 	mRefs++;
+	if (mBuildHandles[detail] != LLQueuedThread::nullHandle())
+	{
+		finishBuild(detail, TRUE);
+	}
 	if (mVolumeLODs[detail].isNull())
 	{
 		LLMemType m1(LLMemType::MTYPE_VOLUME);
@@ -304,7 +435,68 @@ LLVolume* LLVolumeLODGroup::refLOD(const S32 detail)
 	return mVolumeLODs[detail];
 }
 
-BOOL LLVolumeLODGroup::derefLOD(LLVolume *volumep)
+BOOL LLVolumeLODGroup::requestLOD(const S32 detail)
+{
+	llassert(detail >=0 && detail < NUM_LODS);
+	if (mBuildHandles[detail] != LLQueuedThread::nullHandle())
+	{
+		return finishBuild(detail, FALSE);
+	}
+	if (mVolumeLODs[detail].notNull() || !mBuildThread)
+	{
+		return TRUE;
+	}
+	mBuildHandles[detail] = mBuildThread->buildVolume(mVolumeParams, mDetailScales[detail], LLQueuedThread::PRIORITY_NORMAL);
+	return FALSE;
+}
+
+// Takes the volume from a finished build.  When waiting, a build that has
+// not started yet is taken back to be built by refLOD() right away, rather
+// than waiting behind the rest of the queue.
+// Returns TRUE if the build is no longer in flight.
+BOOL LLVolumeLODGroup::finishBuild(const S32 detail, BOOL wait)
+{
+	LLQueuedThread::handle_t handle = mBuildHandles[detail];
+	LLQueuedThread::status_t status = mBuildThread->getRequestStatus(handle);
+	if (wait)
+	{
+		if (status == LLQueuedThread::STATUS_QUEUED)
+		{
+			mBuildThread->abortRequest(handle, true);
+			// in the unlikely case it started in the meantime, it deletes itself when done
+			status = mBuildThread->getRequestStatus(handle);
+			if (status != LLQueuedThread::STATUS_COMPLETE)
+			{
+				mBuildHandles[detail] = LLQueuedThread::nullHandle();
+				return TRUE;
+			}
+		}
+		else if (status == LLQueuedThread::STATUS_INPROGRESS)
+		{
+			mBuildThread->waitForResult(handle, false);
+			status = mBuildThread->getRequestStatus(handle);
+		}
+	}
+
+	if (status == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS)
+	{
+		return FALSE;
+	}
+
+	if (status == LLQueuedThread::STATUS_COMPLETE)
+	{
+		LLVolumeBuildThread::BuildRequest* req = (LLVolumeBuildThread::BuildRequest*)mBuildThread->getRequest(handle);
+		if (mVolumeLODs[detail].isNull())
+		{
+			mVolumeLODs[detail] = req->getVolume();
+		}
+		mBuildThread->completeRequest(handle);
+	}
+	mBuildHandles[detail] = LLQueuedThread::nullHandle();
+	return TRUE;
+}
+
+BOOL LLVolumeLODGroup::derefLOD(LLVolume *volumep, BOOL keep_unreferenced)
 {
 	llassert_always(mRefs > 0);
 	mRefs--;
@@ -314,12 +506,10 @@ BOOL LLVolumeLODGroup::derefLOD(LLVolume *volumep)
 		{
 			llassert_always(mLODRefs[i] > 0);
 			mLODRefs[i]--;
-#if 1 // SJB: Possible opt: keep other lods around
-			if (!mLODRefs[i])
+			if (!mLODRefs[i] && !keep_unreferenced)
 			{
 				mVolumeLODs[i] = NULL;
 			}
-#endif
 			return TRUE;
 		}
 	}
@@ -327,6 +517,18 @@ BOOL LLVolumeLODGroup::derefLOD(LLVolume *volumep)
 	return FALSE;
 }
 
+BOOL LLVolumeLODGroup::isCached() const
+{
+	for (S32 i = 0; i < NUM_LODS; i++)
+	{
+		if (mCached[i])
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 S32 LLVolumeLODGroup::getDetailFromTan(const F32 tan_angle)
 {
 	S32 i = 0;
@@ -396,3 +598,43 @@ std::ostream& operator<<(std::ostream& s, const LLVolumeLODGroup& volgroup)
 	return s;
 }
 
+
+//============================================================================
+
+LLVolumeBuildThread::BuildRequest::BuildRequest(handle_t handle, U32 priority, const LLVolumeParams& volume_params, F32 detail)
+	: LLQueuedThread::QueuedRequest(handle, priority),
+	  mVolumeParams(volume_params),
+	  mDetail(detail)
+{
+}
+
+LLVolumeBuildThread::BuildRequest::~BuildRequest()
+{
+}
+
+// BUILD THREAD
+bool LLVolumeBuildThread::BuildRequest::processRequest()
+{
+	LLMemType m1(LLMemType::MTYPE_VOLUME);
+	mVolume = new LLVolume(mVolumeParams, mDetail);
+	return true;
+}
+
+// MAIN THREAD
+LLVolumeBuildThread::LLVolumeBuildThread(bool threaded, U32 num_workers)
+	: LLQueuedThread("volumebuild", threaded, num_workers)
+{
+}
+
+// MAIN THREAD
+LLQueuedThread::handle_t LLVolumeBuildThread::buildVolume(const LLVolumeParams& volume_params, F32 detail, U32 priority)
+{
+	handle_t handle = generateHandle();
+	BuildRequest* req = new BuildRequest(handle, priority, volume_params, detail);
+	bool res = addRequest(req);
+	if (!res)
+	{
+		llerrs << "volume build requested after LLVolumeBuildThread shut down" << llendl;
+	}
+	return handle;
+}
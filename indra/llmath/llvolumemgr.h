@@ -27,18 +27,64 @@
 #ifndef LL_LLVOLUMEMGR_H
 #define LL_LLVOLUMEMGR_H
 
+#include <list>
 #include <map>
 
 #include "llvolume.h"
 #include "llpointer.h"
 #include "llthread.h"
+#include "llqueuedthread.h"
 
 class LLVolumeParams;
 class LLVolumeLODGroup;
 
+// An unreferenced LOD kept in LLVolumeMgr's cache
+struct LLVolumeCacheEntry
+{
+	LLVolumeLODGroup* mGroup;
+	S32 mDetail;
+	U32 mBytes;
+};
+typedef std::list<LLVolumeCacheEntry> volume_cache_list_t;
+
+// Largest cache budget, in megabytes, the viewer settings may ask for
+// (keeps the budget in bytes within a U32)
+const U32 VOLUME_CACHE_MAX_MB = 1024;
+
+// Generates volumes off the main thread for LLVolumeMgr::requestVolume()
+class LLVolumeBuildThread : public LLQueuedThread
+{
+public:
+	class BuildRequest : public LLQueuedThread::QueuedRequest
+	{
+	protected:
+		virtual ~BuildRequest(); // use deleteRequest()
+
+	public:
+		BuildRequest(handle_t handle, U32 priority, const LLVolumeParams& volume_params, F32 detail);
+
+		/*virtual*/ bool processRequest();
+
+		// Only valid once the request is complete
+		LLVolume* getVolume() const { return mVolume; }
+
+	private:
+		// input
+		LLVolumeParams mVolumeParams;
+		F32 mDetail;
+		// output
+		LLPointer<LLVolume> mVolume;
+	};
+
+public:
+	LLVolumeBuildThread(bool threaded = true, U32 num_workers = 1);
+	handle_t buildVolume(const LLVolumeParams& volume_params, F32 detail, U32 priority);
+};
+
 class LLVolumeLODGroup
 {
 	LOG_CLASS(LLVolumeLODGroup);
+	friend class LLVolumeMgr;
 	
 public:
 	enum
@@ -49,14 +95,20 @@ public:
 	LLVolumeLODGroup(const LLVolumeParams &params);
 	~LLVolumeLODGroup();
 	bool cleanupRefs();
+	void setBuildThread(LLVolumeBuildThread* build_thread) { mBuildThread = build_thread; }
 
 	static S32 getDetailFromTan(const F32 tan_angle);
 	static void getDetailProximity(const F32 tan_angle, F32 &to_lower, F32& to_higher);
 	static F32 getVolumeScaleFromDetail(const S32 detail);
 
 	LLVolume* refLOD(const S32 detail);
-	BOOL derefLOD(LLVolume *volumep);
+	// keep_unreferenced leaves the LOD built once its last reference goes
+	BOOL derefLOD(LLVolume *volumep, BOOL keep_unreferenced = FALSE);
+	// Starts building the LOD on the build thread if it is neither built nor
+	// being built. Returns TRUE once refLOD() can return it without building it.
+	BOOL requestLOD(const S32 detail);
 	S32 getNumRefs() const { return mRefs; }
+	BOOL isCached() const;
 	
 	const LLVolumeParams* getVolumeParams() const { return &mVolumeParams; };
 
@@ -64,14 +116,21 @@ public:
 	friend std::ostream& operator<<(std::ostream& s, const LLVolumeLODGroup& volgroup);
 
 protected:
+	BOOL finishBuild(const S32 detail, BOOL wait);
+
 	LLVolumeParams mVolumeParams;
 
 	S32 mRefs;
 	S32 mLODRefs[NUM_LODS];
 	LLPointer<LLVolume> mVolumeLODs[NUM_LODS];
+	LLVolumeBuildThread* mBuildThread;
+	LLQueuedThread::handle_t mBuildHandles[NUM_LODS]; // in flight builds, shared by every request for the LOD
 	static F32 mDetailThresholds[NUM_LODS];
 	static F32 mDetailScales[NUM_LODS];
 	S32		mAccessCount[NUM_LODS];
+	// unreferenced LODs in the volume manager's cache
+	BOOL	mCached[NUM_LODS];
+	volume_cache_list_t::iterator mCacheEntries[NUM_LODS];
 };
 
 class LLVolumeMgr
@@ -89,15 +148,38 @@ public:
 	virtual LLVolume *refVolume(const LLVolumeParams &volume_params, const S32 detail);
 	virtual void unrefVolume(LLVolume *volumep);
 
+	// Use this before refVolume() to keep drawing another LOD of a volume
+	// while the one wanted is built in the background.  Returns TRUE once
+	// refVolume() will not have to build or wait for it.  Volumes nobody
+	// has referenced yet, and every volume until startBuildThread(), are
+	// always built by refVolume().
+	BOOL requestVolume(const LLVolumeParams &volume_params, const S32 detail);
+
 	void dump();
 
 	// manually call this for mutex magic
 	void useMutex();
 
+	// manually call this to build requested volumes on num_workers threads
+	void startBuildThread(U32 num_workers = 1);
+
+	// Keeps up to budget bytes of volumes that are no longer referenced,
+	// least recently used first out.  0 releases them right away.
+	void setCacheBudget(U32 budget);
+	U32 getCacheBudget() const		{ return mCacheBudget; }
+	U32 getCacheBytes() const		{ return mCacheBytes; }
+	U32 getCacheCount() const		{ return (U32)mCache.size(); }
+	U32 getCacheHits() const		{ return mCacheHits; }
+	U32 getCacheMisses() const		{ return mCacheMisses; }
+	U32 getCacheEvictions() const	{ return mCacheEvictions; }
+
 	friend std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr);
 
 protected:
 	void insertGroup(LLVolumeLODGroup* volgroup);
+	void addToCache(LLVolumeLODGroup* volgroup, S32 detail);
+	void removeFromCache(LLVolumeLODGroup* volgroup, S32 detail);
+	void trimCache();
 	// Overridden in llphysics/abstract/utils/llphysicsvolumemanager.h
 	virtual LLVolumeLODGroup* createNewGroup(const LLVolumeParams& volume_params);
 
@@ -106,6 +188,14 @@ protected:
 	volume_lod_group_map_t mVolumeLODGroups;
 
 	LLMutex* mDataMutex;
+	LLVolumeBuildThread* mBuildThread;
+
+	volume_cache_list_t mCache; // most recently used first
+	U32 mCacheBudget;
+	U32 mCacheBytes;
+	U32 mCacheHits;
+	U32 mCacheMisses;
+	U32 mCacheEvictions;
 };
 
 #endif // LL_LLVOLUMEMGR_H
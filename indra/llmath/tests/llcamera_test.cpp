@@ -0,0 +1,139 @@
+/**
+ * @file llcamera_test.cpp
+ * @date 2011-08-26
+ * @brief Tests for LLCamera's batched frustum tests.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llcamera.h"
+#include "../llvector4a.h"
+
+namespace tut
+{
+	struct llcamera_data
+	{
+		LLCamera mCamera;
+		U32 mSeed;
+
+		llcamera_data() : mSeed(4321)
+		{
+			// looking down +x from the origin, corners in the order
+			// LLViewerCamera unprojects them: near plane first, then far
+			LLVector3 frust[8] = {
+				LLVector3(1.f, 1.f, -1.f), LLVector3(1.f, -1.f, -1.f),
+				LLVector3(1.f, -1.f, 1.f), LLVector3(1.f, 1.f, 1.f),
+				LLVector3(50.f, 40.f, -40.f), LLVector3(50.f, -40.f, -40.f),
+				LLVector3(50.f, -40.f, 40.f), LLVector3(50.f, 40.f, 40.f)
+			};
+			mCamera.calcAgentFrustumPlanes(frust);
+		}
+
+		// whole numbers, so some boxes touch the planes exactly
+		F32 next(S32 low, S32 high)
+		{
+			mSeed = mSeed * 1664525 + 1013904223;
+			return (F32)(low + (S32)((mSeed >> 8) % (U32)(high - low)));
+		}
+
+		// checks every batch size against the scalar tests
+		void compare()
+		{
+			S32 counts[3] = { 0, 0, 0 };
+			for (U32 batch = 0; batch < 400; ++batch)
+			{
+				const U32 count = 1 + batch % 9;
+				LLVector4a centers[9];
+				LLVector4a radii[9];
+				for (U32 i = 0; i < count; ++i)
+				{
+					centers[i].set(next(-30, 90), next(-60, 60), next(-60, 60), 7.f);
+					radii[i].set(next(0, 20) + 0.5f, next(0, 20), next(0, 20) + 0.25f, -3.f);
+				}
+
+				S32 results[9];
+				S32 no_far_results[9];
+				mCamera.AABBInFrustumBatch(centers, radii, count, results);
+				mCamera.AABBInFrustumNoFarClipBatch(centers, radii, count, no_far_results);
+				for (U32 i = 0; i < count; ++i)
+				{
+					LLVector3 center = centers[i].getVector3();
+					LLVector3 radius = radii[i].getVector3();
+					ensure_equals("AABBInFrustum", results[i], mCamera.AABBInFrustum(center, radius));
+					ensure_equals("AABBInFrustumNoFarClip", no_far_results[i], mCamera.AABBInFrustumNoFarClip(center, radius));
+					counts[results[i]]++;
+				}
+			}
+			ensure("some outside", counts[0] > 0);
+			ensure("some partly in", counts[1] > 0);
+			ensure("some fully in", counts[2] > 0);
+		}
+	};
+	typedef test_group<llcamera_data> llcamera_test;
+	typedef llcamera_test::object llcamera_object;
+	tut::llcamera_test llcamera_testcase("LLCamera");
+
+	template<> template<>
+	void llcamera_object::test<1>()
+	{
+		// boxes in front of, inside and behind the frustum
+		LLVector4a centers[3];
+		LLVector4a radii[3];
+		centers[0].set(25.f, 0.f, 0.f);
+		centers[1].set(25.f, 30.f, 0.f);
+		centers[2].set(-25.f, 0.f, 0.f);
+		radii[0].splat(1.f);
+		radii[1].splat(10.f);
+		radii[2].splat(1.f);
+		S32 results[3];
+		mCamera.AABBInFrustumBatch(centers, radii, 3, results);
+		ensure_equals("inside", results[0], 2);
+		ensure_equals("straddling", results[1], 1);
+		ensure_equals("behind", results[2], 0);
+
+		// past the far plane only counts without far clipping
+		centers[0].set(100.f, 0.f, 0.f);
+		mCamera.AABBInFrustumBatch(centers, radii, 1, results);
+		ensure_equals("beyond far", results[0], 0);
+		mCamera.AABBInFrustumNoFarClipBatch(centers, radii, 1, results);
+		ensure_equals("beyond far, no far clip", results[0], 2);
+	}
+
+	template<> template<>
+	void llcamera_object::test<2>()
+	{
+		// the batches agree with the scalar tests box for box
+		compare();
+	}
+
+	template<> template<>
+	void llcamera_object::test<3>()
+	{
+		// including with a user clip plane and an ignored plane
+		mCamera.setUserClipPlane(LLPlane(LLVector3(0.f, 0.f, 10.f), LLVector3(0.f, 0.f, 1.f)));
+		mCamera.ignoreAgentFrustumPlane(LLCamera::AGENT_PLANE_TOP);
+		compare();
+	}
+}
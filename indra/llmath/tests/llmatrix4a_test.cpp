@@ -0,0 +1,238 @@
+/**
+ * @file llmatrix4a_test.cpp
+ * @date 2011-08-18
+ * @brief Tests for LLMatrix4a and LLQuaternion2, checked against LLMatrix4
+ * and LLQuaternion.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+#include "llmemory.h"
+
+#include "../llmatrix4a.h"
+
+namespace tut
+{
+	struct llmatrix4a_data
+	{
+		LLMatrix4 mLegacy;
+		LLQuaternion mRot;
+
+		llmatrix4a_data()
+		{
+			mRot.setQuat(0.7f, LLVector3(1.f, 2.f, -0.5f));
+			mLegacy.initAll(LLVector3(0.5f, 1.5f, 2.f), mRot, LLVector3(10.f, -20.f, 30.f));
+		}
+
+		bool matches(const LLMatrix4& a, const LLMatrix4& b, F32 tolerance = 1e-5f)
+		{
+			for (U32 i = 0; i < 4; ++i)
+			{
+				for (U32 j = 0; j < 4; ++j)
+				{
+					if (fabsf(a.mMatrix[i][j] - b.mMatrix[i][j]) > tolerance)
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+	};
+	typedef test_group<llmatrix4a_data> llmatrix4a_test;
+	typedef llmatrix4a_test::object llmatrix4a_object;
+	tut::llmatrix4a_test llmatrix4a_testcase("LLMatrix4a");
+
+	template<> template<>
+	void llmatrix4a_object::test<1>()
+	{
+		// round trips, identity, transpose and lerp
+		LLMatrix4a mat(mLegacy);
+		ensure("round trip", matches(mat.getMatrix4(), mLegacy, 0.f));
+
+		LLMatrix4a ident;
+		ident.setIdentity();
+		ensure("identity", matches(ident.getMatrix4(), LLMatrix4(), 0.f));
+
+		LLMatrix4 transposed = mLegacy;
+		transposed.transpose();
+		mat.transpose();
+		ensure("transpose", matches(mat.getMatrix4(), transposed, 0.f));
+		mat.transpose();
+
+		LLMatrix4a half;
+		half.setLerp(ident, mat, 0.5f);
+		ensure_distance("lerp", half.mMatrix[VW].mV[VX], 5.f, 1e-6f);
+
+		LLMatrix3 rot3(mRot);
+		LLMatrix4a rot;
+		rot.loadu(rot3);
+		ensure("from LLMatrix3", matches(rot.getMatrix4(), LLMatrix4(rot3, LLVector4(0.f, 0.f, 0.f, 1.f))));
+	}
+
+	template<> template<>
+	void llmatrix4a_object::test<2>()
+	{
+		// single vector transforms and products match LLMatrix4's
+		LLMatrix4a mat(mLegacy);
+		LLVector3 v(3.f, -1.f, 0.25f);
+		LLVector4a res;
+
+		mat.affineTransform(LLVector4a(v), res);
+		ensure("affineTransform", res.equals3(LLVector4a(v * mLegacy), 1e-4f));
+		mat.rotate(LLVector4a(v), res);
+		ensure("rotate", res.equals3(LLVector4a(rotate_vector(v, mLegacy)), 1e-4f));
+		LLVector4 v4(3.f, -1.f, 0.25f, 2.f);
+		mat.rotate4(LLVector4a(v4), res);
+		LLVector4 legacy4 = v4 * mLegacy;
+		ensure("rotate4", res.equals3(LLVector4a(legacy4), 1e-4f));
+		ensure_distance("rotate4 w", res.mV[VW], legacy4.mV[VW], 1e-4f);
+
+		LLMatrix4 other;
+		other.initAll(LLVector3(1.f, 1.f, 2.f), LLQuaternion(-1.2f, LLVector3(0.f, 1.f, 1.f)), LLVector3(-1.f, 4.f, 2.f));
+		LLMatrix4 product = mLegacy;
+		product *= other;
+		LLMatrix4a prod;
+		prod.setMul(mat, LLMatrix4a(other));
+		ensure("setMul", matches(prod.getMatrix4(), product, 1e-4f));
+		mat.setMul(mat, LLMatrix4a(other));
+		ensure("setMul in place", matches(mat.getMatrix4(), product, 1e-4f));
+	}
+
+	template<> template<>
+	void llmatrix4a_object::test<3>()
+	{
+		// batch and strided transforms agree with per vertex legacy math
+		const U32 count = 37;
+		LLMatrix4a mat(mLegacy);
+		LLVector4a* src = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a) * count);
+		LLVector4a* dst = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a) * count);
+		std::vector<LLVector3> legacy(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			legacy[i].setVec((F32)i, 1.f - 0.5f * i, 0.25f * i * i);
+			src[i] = LLVector4a(legacy[i]);
+		}
+
+		mat.affineTransform(src, dst, count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			ensure("batch affineTransform", dst[i].equals3(LLVector4a(legacy[i] * mLegacy), 1e-2f));
+		}
+
+		mat.rotateNormals(src, dst, count);
+		for (U32 i = 1; i < count; ++i)
+		{
+			LLVector3 n = rotate_vector(legacy[i], mLegacy);
+			n.normVec();
+			ensure("batch rotateNormals", dst[i].equals3(LLVector4a(n), 1e-5f));
+		}
+
+		// in place
+		mat.rotate(src, src, count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			ensure("batch rotate", src[i].equals3(LLVector4a(rotate_vector(legacy[i], mLegacy)), 1e-2f));
+		}
+
+		// positions interleaved with other data, as in a vertex buffer
+		const U32 stride = 8 * sizeof(F32);
+		std::vector<F32> verts(count * 8, -1.f);
+		for (U32 i = 0; i < count; ++i)
+		{
+			verts[i * 8 + 1] = legacy[i].mV[VX];
+			verts[i * 8 + 2] = legacy[i].mV[VY];
+			verts[i * 8 + 3] = legacy[i].mV[VZ];
+		}
+		mat.affineTransform(&verts[1], stride, &verts[1], stride, count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLVector4a p;
+			p.load3(&verts[i * 8 + 1]);
+			ensure("strided affineTransform", p.equals3(LLVector4a(legacy[i] * mLegacy), 1e-2f));
+			ensure("strided leaves neighbours", verts[i * 8] == -1.f && verts[i * 8 + 4] == -1.f);
+		}
+
+		// from an aligned array into the strided buffer
+		for (U32 i = 0; i < count; ++i)
+		{
+			src[i] = LLVector4a(legacy[i]);
+		}
+		mat.affineTransform(src, &verts[1], stride, count);
+		mat.rotateNormals(src, &verts[4], stride, count);
+		for (U32 i = 1; i < count; ++i)
+		{
+			LLVector4a p;
+			p.load3(&verts[i * 8 + 1]);
+			ensure("aligned to strided affineTransform", p.equals3(LLVector4a(legacy[i] * mLegacy), 1e-2f));
+			LLVector3 n = rotate_vector(legacy[i], mLegacy);
+			n.normVec();
+			LLVector4a pn;
+			pn.load3(&verts[i * 8 + 4]);
+			ensure("aligned to strided rotateNormals", pn.equals3(LLVector4a(n), 1e-5f));
+			ensure("aligned to strided leaves neighbours", verts[i * 8] == -1.f && verts[i * 8 + 7] == -1.f);
+		}
+
+		ll_aligned_free_16(src);
+		ll_aligned_free_16(dst);
+	}
+
+	template<> template<>
+	void llmatrix4a_object::test<4>()
+	{
+		// LLQuaternion2 against LLQuaternion
+		LLQuaternion other(2.1f, LLVector3(-1.f, 0.5f, 0.25f));
+		LLQuaternion2 a(mRot);
+		LLQuaternion2 b(other);
+		ensure("round trip", a.getQuaternion() == mRot);
+
+		LLQuaternion product = mRot * other;
+		LLQuaternion2 prod;
+		prod.setMul(a, b);
+		ensure("setMul", prod.mQ.equals3(LLVector4a(product.mQ[VX], product.mQ[VY], product.mQ[VZ]), 1e-6f));
+		ensure_distance("setMul w", prod.mQ.mV[VW], product.mQ[VW], 1e-6f);
+
+		LLVector3 v(1.f, -2.f, 3.f);
+		LLVector4a res;
+		a.rotate(LLVector4a(v, 7.f), res);
+		ensure("rotate", res.equals3(LLVector4a(v * mRot), 1e-5f));
+		ensure_equals("rotate keeps w", res.mV[VW], 7.f);
+
+		LLMatrix4a rot;
+		rot.setRotation(a);
+		ensure("setRotation", matches(rot.getMatrix4(), LLMatrix4(mRot)));
+
+		LLQuaternion2 conj = a;
+		conj.conjugate();
+		LLQuaternion2 ident;
+		ident.setMul(a, conj);
+		ensure("conjugate", ident.mQ.equals3(LLVector4a(0.f, 0.f, 0.f), 1e-6f));
+		ensure_distance("conjugate w", ident.mQ.mV[VW], 1.f, 1e-6f);
+
+		LLQuaternion2 small;
+		small.mQ.set(0.f, 0.f, 0.f, 0.f);
+		ensure_equals("normalize zero", small.normalize(), 0.f);
+		ensure_equals("becomes identity", small.mQ.mV[VW], 1.f);
+	}
+}
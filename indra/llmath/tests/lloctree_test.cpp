@@ -0,0 +1,434 @@
+/**
+ * @file lloctree_test.cpp
+ * @date 2011-08-25
+ * @brief Tests and benchmarks for LLOctreeNode and LLOctreeRoot.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "../v3dmath.h"
+#include "../lloctree.h"
+#include "llmetricbenchmark.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// Stands in for LLDrawable.
+	class TestElement : public LLRefCount
+	{
+	public:
+		TestElement(const LLVector3d& pos, F64 radius) :
+			mPosition(pos),
+			mRadius(radius),
+			mBinIndex(-1),
+			mVisits(0)
+		{
+		}
+
+		const LLVector3d& getPositionGroup() const	{ return mPosition; }
+		F64 getBinRadius() const					{ return mRadius; }
+		S32 getBinIndex() const						{ return mBinIndex; }
+		void setBinIndex(S32 index)					{ mBinIndex = index; }
+
+		LLVector3d mPosition;
+		F64 mRadius;
+		S32 mBinIndex;
+		mutable U32 mVisits;
+	};
+
+	typedef LLOctreeNode<TestElement> TestNode;
+	typedef LLOctreeRoot<TestElement> TestRoot;
+
+	// Repeatable positions in a region, about as dense as a busy sim.
+	class Scatter
+	{
+	public:
+		Scatter() : mSeed(12345) { }
+
+		F64 next(F64 low, F64 high)
+		{
+			mSeed = mSeed * 1664525 + 1013904223;
+			return low + (high - low) * (F64)(mSeed >> 8) / (F64)(1 << 24);
+		}
+
+		LLVector3d position()
+		{
+			return LLVector3d(next(0.0, 256.0), next(0.0, 256.0), next(20.0, 60.0));
+		}
+
+		TestElement* element()
+		{
+			// bin radius is 4 times the radius, like LLDrawable's
+			return new TestElement(position(), next(0.5, 8.0) * 4.0);
+		}
+
+	private:
+		U32 mSeed;
+	};
+
+	TestRoot* new_root()
+	{
+		// like LLSpatialPartition's
+		return new TestRoot(LLVector3d(0, 0, 0), LLVector3d(1, 1, 1), NULL);
+	}
+
+	// Counts nodes and elements and checks their bookkeeping.
+	struct CountVisitor
+	{
+		CountVisitor() : mNodes(0), mElements(0), mErrors(0) { }
+
+		bool visit(const TestNode* node)
+		{
+			mNodes++;
+			mElements += node->getElementCount();
+			if (node->getChildCount() > TestNode::MAX_CHILDREN)
+			{
+				mErrors++;
+			}
+			for (U32 i = 0; i < node->getElementCount(); i++)
+			{
+				TestElement* element = node->getData()[i];
+				if (element->getBinIndex() != (S32)i || !node->hasData(element))
+				{
+					mErrors++;
+				}
+			}
+			for (U32 i = 0; i < node->getChildCount(); i++)
+			{
+				if (node->getChild(i)->getParent() != node)
+				{
+					mErrors++;
+				}
+			}
+			return true;
+		}
+
+		U32 mNodes;
+		U32 mElements;
+		U32 mErrors;
+	};
+
+	// Culls against a sphere around the camera the way LLOctreeCull does
+	// against the frustum: virtual traversal, nodes fully inside skip the
+	// test for their children.
+	class SphereCull : public LLOctreeTraveler<TestElement>
+	{
+	public:
+		SphereCull(const LLVector3d& origin, F64 radius) :
+			mOrigin(origin),
+			mRadius(radius),
+			mRes(0),
+			mVisible(0)
+		{
+		}
+
+		virtual void traverse(const TestNode* node)
+		{
+			if (mRes == 2)
+			{
+				LLOctreeTraveler<TestElement>::traverse(node);
+			}
+			else
+			{
+				mRes = check(node);
+				if (mRes)
+				{
+					LLOctreeTraveler<TestElement>::traverse(node);
+				}
+				mRes = 0;
+			}
+		}
+
+		virtual void visit(const TestNode* node)
+		{
+			for (TestNode::const_element_iter i = node->getData().begin(); i != node->getData().end(); ++i)
+			{
+				(*i)->mVisits++;
+				mVisible++;
+			}
+		}
+
+		// 0 outside, 1 partly in, 2 fully in
+		S32 check(const TestNode* node) const
+		{
+			// loose bounds, elements may stick out by their bin radius
+			LLVector3d size = node->getSize() * 2.0;
+			F64 dist_squared = 0.0;
+			F64 far_squared = 0.0;
+			for (U32 i = 0; i < 3; i++)
+			{
+				F64 low = node->getCenter().mdV[i] - size.mdV[i];
+				F64 high = node->getCenter().mdV[i] + size.mdV[i];
+				F64 p = mOrigin.mdV[i];
+				F64 d = p < low ? low - p : (p > high ? p - high : 0.0);
+				F64 f = llmax(p - low, high - p);
+				dist_squared += d * d;
+				far_squared += f * f;
+			}
+			if (dist_squared > mRadius * mRadius)
+			{
+				return 0;
+			}
+			return far_squared <= mRadius * mRadius ? 2 : 1;
+		}
+
+		LLVector3d mOrigin;
+		F64 mRadius;
+		S32 mRes;
+		U32 mVisible;
+	};
+
+	const U32 DENSE_SIM_ELEMENTS = 16384;
+
+	class OctreeBenchmark : public LLMetricBenchmark
+	{
+	public:
+		OctreeBenchmark(const std::string& name, U32 iterations) :
+			LLMetricBenchmark(name, iterations),
+			mRoot(NULL)
+		{
+		}
+
+		void build()
+		{
+			mRoot = new_root();
+			for (U32 i = 0; i < DENSE_SIM_ELEMENTS; ++i)
+			{
+				mElements.push_back(mScatter.element());
+				mRoot->insert(mElements.back());
+			}
+		}
+
+		virtual void teardown()
+		{
+			delete mRoot;
+			mRoot = NULL;
+			mElements.clear();
+		}
+
+	protected:
+		Scatter mScatter;
+		TestRoot* mRoot;
+		std::vector<LLPointer<TestElement> > mElements;
+	};
+
+	// Fills an empty octree with a dense sim's worth of elements.
+	class InsertBenchmark : public OctreeBenchmark
+	{
+	public:
+		InsertBenchmark(const std::string& name) : OctreeBenchmark(name, 10) { }
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				teardown();
+				build();
+			}
+		}
+	};
+
+	// Moves elements the way LLSpatialPartition::move() does.
+	class MoveBenchmark : public OctreeBenchmark
+	{
+	public:
+		MoveBenchmark(const std::string& name) : OctreeBenchmark(name, 100000) { }
+
+		virtual void setup()
+		{
+			build();
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				TestElement* element = mElements[i % mElements.size()];
+				mRoot->remove(element);
+				element->mPosition = mScatter.position();
+				mRoot->insert(element);
+			}
+		}
+	};
+
+	// Culls a dense sim from a camera moving through it.
+	class CullBenchmark : public OctreeBenchmark
+	{
+	public:
+		CullBenchmark(const std::string& name) : OctreeBenchmark(name, 1000) { }
+
+		virtual void setup()
+		{
+			build();
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				SphereCull cull(LLVector3d((i * 7) % 256, (i * 13) % 256, 30.0), 64.0);
+				cull.traverse(mRoot);
+			}
+		}
+	};
+
+	LLMetricBenchmark::Registrar<InsertBenchmark> sInsertRegistrar("octree_insert");
+	LLMetricBenchmark::Registrar<MoveBenchmark> sMoveRegistrar("octree_move");
+	LLMetricBenchmark::Registrar<CullBenchmark> sCullRegistrar("octree_cull");
+}
+
+namespace tut
+{
+	struct lloctree_data
+	{
+		Scatter mScatter;
+		std::vector<LLPointer<TestElement> > mElements;
+		TestRoot* mRoot;
+
+		lloctree_data() : mRoot(new_root())
+		{
+		}
+
+		~lloctree_data()
+		{
+			delete mRoot;
+		}
+
+		void fill(U32 count)
+		{
+			for (U32 i = 0; i < count; ++i)
+			{
+				mElements.push_back(mScatter.element());
+				mRoot->insert(mElements.back());
+			}
+		}
+	};
+	typedef test_group<lloctree_data> lloctree_test;
+	typedef lloctree_test::object lloctree_object;
+	tut::lloctree_test lloctree_testcase("LLOctree");
+
+	template<> template<>
+	void lloctree_object::test<1>()
+	{
+		// every element ends up in exactly one node that knows where it is
+		fill(2000);
+		CountVisitor counter;
+		mRoot->traverse(counter);
+		ensure_equals("elements", counter.mElements, 2000U);
+		ensure_equals("bookkeeping", counter.mErrors, 0U);
+		ensure("branches", counter.mNodes > 1);
+		for (U32 i = 0; i < mElements.size(); ++i)
+		{
+			ensure("found", mRoot->getNodeAt(mElements[i])->hasData(mElements[i]));
+		}
+	}
+
+	template<> template<>
+	void lloctree_object::test<2>()
+	{
+		// removal keeps the element lists compact and prunes empty nodes
+		fill(2000);
+		for (U32 i = 0; i < mElements.size(); i += 2)
+		{
+			ensure("removed", mRoot->remove(mElements[i]));
+			ensure_equals("no longer binned", mElements[i]->getBinIndex(), -1);
+		}
+		CountVisitor counter;
+		mRoot->traverse(counter);
+		ensure_equals("elements left", counter.mElements, 1000U);
+		ensure_equals("bookkeeping", counter.mErrors, 0U);
+
+		for (U32 i = 1; i < mElements.size(); i += 2)
+		{
+			mRoot->remove(mElements[i]);
+		}
+		ensure_equals("empty", mRoot->getElementCount(), 0U);
+		ensure_equals("pruned", mRoot->getChildCount(), 0U);
+
+		// and the elements can go back in
+		for (U32 i = 0; i < mElements.size(); ++i)
+		{
+			mRoot->insert(mElements[i]);
+		}
+		CountVisitor refill;
+		mRoot->traverse(refill);
+		ensure_equals("reinserted", refill.mElements, 2000U);
+		ensure_equals("bookkeeping after reinsertion", refill.mErrors, 0U);
+	}
+
+	struct TopLevelVisitor
+	{
+		TopLevelVisitor(const TestNode* root) : mRoot(root), mNodes(0) { }
+
+		bool visit(const TestNode* node)
+		{
+			mNodes++;
+			return node == mRoot;
+		}
+
+		const TestNode* mRoot;
+		U32 mNodes;
+	};
+
+	template<> template<>
+	void lloctree_object::test<3>()
+	{
+		// the compile time traversal matches the virtual one and can prune
+		fill(2000);
+		SphereCull everything(LLVector3d(128.0, 128.0, 40.0), 1.0e6);
+		everything.traverse(mRoot);
+		ensure_equals("virtual traversal", everything.mVisible, 2000U);
+
+		TopLevelVisitor top(mRoot);
+		mRoot->traverse(top);
+		ensure_equals("pruned traversal", top.mNodes, 1 + mRoot->getChildCount());
+
+		// a small sphere sees everything near it, and culls most of the rest
+		LLVector3d origin(64.0, 64.0, 40.0);
+		SphereCull cull(origin, 16.0);
+		cull.traverse(mRoot);
+		ensure("culled", cull.mVisible < 1000);
+		for (U32 i = 0; i < mElements.size(); ++i)
+		{
+			if ((mElements[i]->mPosition - origin).magVec() < 16.0)
+			{
+				ensure_equals("near visible", mElements[i]->mVisits, 2U);
+			}
+		}
+	}
+
+	template<> template<>
+	void lloctree_object::test<4>()
+	{
+		// nodes are recycled through the pool
+		TestNode* node = new TestNode(LLVector3d(0, 0, 0), LLVector3d(1, 1, 1), NULL);
+		delete node;
+		TestNode* again = new TestNode(LLVector3d(0, 0, 0), LLVector3d(1, 1, 1), NULL);
+		ensure("reused", node == again);
+		delete again;
+	}
+}
@@ -0,0 +1,144 @@
+/**
+ * @file llvector4a_test.cpp
+ * @date 2011-08-18
+ * @brief Tests for LLVector4a, checked against LLVector3 and LLVector4.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+#include "llmemory.h"
+
+#include "../llvector4a.h"
+
+namespace tut
+{
+	struct llvector4a_data
+	{
+	};
+	typedef test_group<llvector4a_data> llvector4a_test;
+	typedef llvector4a_test::object llvector4a_object;
+	tut::llvector4a_test llvector4a_testcase("LLVector4a");
+
+	template<> template<>
+	void llvector4a_object::test<1>()
+	{
+		// alignment, loads, stores and conversions
+		ensure_equals("size", sizeof(LLVector4a), (size_t)16);
+		LLVector4a stack[3];
+		ensure("stack aligned", ((size_t)&stack[1] & 15) == 0);
+		LLVector4a* heap = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a) * 3);
+		ensure("heap aligned", ((size_t)heap & 15) == 0);
+		ll_aligned_free_16(heap);
+
+		LLVector3 vec3(1.5f, -2.f, 3.25f);
+		LLVector4a a(vec3);
+		ensure("from LLVector3", a.getVector3() == vec3 && a.mV[VW] == 0.f);
+		LLVector4 vec4(1.f, 2.f, 3.f, 4.f);
+		ensure("from LLVector4", LLVector4a(vec4).getVector4() == vec4);
+
+		// load3 and store3 touch exactly three floats
+		F32 src[5] = { 9.f, 1.f, 2.f, 3.f, 9.f };
+		a.load3(src + 1);
+		ensure("load3", a.mV[VX] == 1.f && a.mV[VY] == 2.f && a.mV[VZ] == 3.f && a.mV[VW] == 0.f);
+		F32 dst[5] = { 7.f, 7.f, 7.f, 7.f, 7.f };
+		a.set(4.f, 5.f, 6.f, 8.f);
+		a.store3(dst + 1);
+		ensure("store3", dst[0] == 7.f && dst[1] == 4.f && dst[2] == 5.f && dst[3] == 6.f && dst[4] == 7.f);
+
+		LLVector4a b;
+		b.loadua(src + 1);
+		ensure("loadua", b.mV[VW] == 9.f);
+		LLVector4a aligned_dst;
+		a.store4a(aligned_dst.getF32ptr());
+		b.load4a(aligned_dst.getF32ptr());
+		ensure("aligned round trip", b.mV[VX] == 4.f && b.mV[VW] == 8.f);
+
+		b.splat(2.5f);
+		ensure("splat", b.mV[VX] == 2.5f && b.mV[VW] == 2.5f);
+		b.clear();
+		ensure("clear", b.mV[VY] == 0.f && b.mV[VW] == 0.f);
+	}
+
+	template<> template<>
+	void llvector4a_object::test<2>()
+	{
+		// arithmetic matches LLVector4's
+		LLVector4 va(1.f, -2.f, 3.f, 0.5f);
+		LLVector4 vb(-4.f, 5.f, 0.25f, 2.f);
+		LLVector4a a(va);
+		LLVector4a b(vb);
+		LLVector4a r;
+
+		r.setAdd(a, b);
+		ensure("add", r.getVector4() == va + vb);
+		r.setSub(a, b);
+		ensure("sub", r.getVector4() == va - vb);
+		r.setMul(a, 2.f);
+		ensure("scale", r.getVector4() == LLVector4(2.f, -4.f, 6.f, 1.f));
+		r.setMul(a, b);
+		ensure("mul", r.getVector4() == LLVector4(-4.f, -10.f, 0.75f, 1.f));
+		r.setMin(a, b);
+		ensure("min", r.getVector4() == LLVector4(-4.f, -2.f, 0.25f, 0.5f));
+		r.setMax(a, b);
+		ensure("max", r.getVector4() == LLVector4(1.f, 5.f, 3.f, 2.f));
+		r.setLerp(a, b, 0.5f);
+		ensure("lerp", r.getVector4() == LLVector4(-1.5f, 1.5f, 1.625f, 1.25f));
+
+		r = a;
+		r.add(b);
+		r.sub(b);
+		ensure("in place", r.getVector4() == va);
+
+		ensure_equals("dot4", a.dot4(b), -4.f - 10.f + 0.75f + 1.f);
+	}
+
+	template<> template<>
+	void llvector4a_object::test<3>()
+	{
+		// 3 component operations match LLVector3's, whatever is in w
+		LLVector3 va(0.3f, -1.2f, 2.5f);
+		LLVector3 vb(-0.7f, 0.4f, 1.1f);
+		LLVector4a a(va, 100.f);
+		LLVector4a b(vb, -100.f);
+
+		ensure_equals("dot3", a.dot3(b), va * vb);
+		LLVector4a c;
+		c.setCross3(a, b);
+		ensure("cross3", c.equals3(LLVector4a(va % vb), 1e-6f));
+		ensure_equals("length", a.getLength3(), va.length());
+
+		LLVector3 vn = va;
+		F32 mag = vn.normVec();
+		LLVector4a n = a;
+		ensure_equals("normalize3 length", n.normalize3(), mag);
+		ensure("normalize3", n.equals3(LLVector4a(vn), 1e-6f));
+
+		LLVector4a zero(0.f, 0.f, 0.f, 5.f);
+		ensure_equals("zero length", zero.normalize3(), 0.f);
+		ensure("stays zero", zero.equals3(LLVector4a(0.f, 0.f, 0.f), 0.f));
+
+		ensure("equals3 ignores w", LLVector4a(1.f, 2.f, 3.f, 4.f).equals3(LLVector4a(1.f, 2.f, 3.f, -4.f)));
+		ensure("equals3 tolerance", !LLVector4a(1.f, 2.f, 3.f).equals3(LLVector4a(1.f, 2.1f, 3.f), 0.01f));
+	}
+}
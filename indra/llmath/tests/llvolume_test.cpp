@@ -0,0 +1,499 @@
+/**
+ * @file llvolume_test.cpp
+ * @date 2011-08-22
+ * @brief Tests and benchmarks for LLVolume generation and LLVolumeFace
+ * vertex storage.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llmatrix4a.h"
+#include "../m4math.h"
+#include "llmetricbenchmark.h"
+#include "llpointer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// The build tool's basic prims.
+	struct PrimShape
+	{
+		const char* mName;
+		U8 mProfile;
+		U8 mPath;
+		F32 mRatioX;
+		F32 mRatioY;
+		F32 mShearX;
+	};
+
+	const PrimShape STANDARD_PRIMS[] =
+	{
+		{ "box",		LL_PCODE_PROFILE_SQUARE,		LL_PCODE_PATH_LINE,		1.f, 1.f,	0.f },
+		{ "cylinder",	LL_PCODE_PROFILE_CIRCLE,		LL_PCODE_PATH_LINE,		1.f, 1.f,	0.f },
+		{ "prism",		LL_PCODE_PROFILE_SQUARE,		LL_PCODE_PATH_LINE,		0.f, 1.f,	-0.5f },
+		{ "sphere",		LL_PCODE_PROFILE_CIRCLE_HALF,	LL_PCODE_PATH_CIRCLE,	1.f, 1.f,	0.f },
+		{ "torus",		LL_PCODE_PROFILE_CIRCLE,		LL_PCODE_PATH_CIRCLE,	1.f, 0.25f,	0.f },
+		{ "tube",		LL_PCODE_PROFILE_SQUARE,		LL_PCODE_PATH_CIRCLE,	1.f, 0.25f,	0.f },
+		{ "ring",		LL_PCODE_PROFILE_EQUALTRI,		LL_PCODE_PATH_CIRCLE,	1.f, 0.25f,	0.f },
+	};
+	const U32 NUM_STANDARD_PRIMS = LL_ARRAY_SIZE(STANDARD_PRIMS);
+
+	// Highest level of detail the viewer asks for.
+	const F32 HIGH_DETAIL = 4.f;
+
+	LLVolumeParams make_params(const PrimShape& shape, F32 hollow = 0.f, F32 begin_s = 0.f, F32 end_s = 1.f)
+	{
+		LLVolumeParams params;
+		params.setType(shape.mProfile, shape.mPath);
+		params.setBeginAndEndS(begin_s, end_s);
+		params.setBeginAndEndT(0.f, 1.f);
+		params.setHollow(hollow);
+		params.setRatio(shape.mRatioX, shape.mRatioY);
+		params.setShear(shape.mShearX, 0.f);
+		return params;
+	}
+
+	// Generates every standard prim at full detail, from new volumes so
+	// that the path and profile are built each time.
+	class GenerateBenchmark : public LLMetricBenchmark
+	{
+	public:
+		GenerateBenchmark(const std::string& name) :
+			LLMetricBenchmark(name, 200),
+			mNumFaces(0)
+		{
+		}
+
+		virtual void setup()
+		{
+			for (U32 i = 0; i < NUM_STANDARD_PRIMS; ++i)
+			{
+				mParams.push_back(make_params(STANDARD_PRIMS[i]));
+			}
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				LLPointer<LLVolume> volume = new LLVolume(mParams[i % mParams.size()], HIGH_DETAIL);
+				mNumFaces += volume->getNumVolumeFaces();
+			}
+		}
+
+		virtual void teardown()
+		{
+			mParams.clear();
+		}
+
+	private:
+		std::vector<LLVolumeParams> mParams;
+		S32 mNumFaces;
+	};
+
+	// Transforms every face of every standard prim into an interleaved
+	// buffer, as LLFace::getGeometryVolume() does on a rebuild.
+	class FaceRebuildBenchmark : public LLMetricBenchmark
+	{
+	public:
+		FaceRebuildBenchmark(const std::string& name) :
+			LLMetricBenchmark(name, 2000)
+		{
+		}
+
+		virtual void setup()
+		{
+			LLMatrix4 mat;
+			mat.initAll(LLVector3(2.f, 0.5f, 1.f), LLQuaternion(0.6f, LLVector3(1.f, 1.f, 0.f)), LLVector3(128.f, 64.f, 22.f));
+			mMatVert.loadu(mat);
+			mMatNormal.loadu(LLMatrix3(LLQuaternion(0.6f, LLVector3(1.f, 1.f, 0.f))));
+
+			S32 max_vertices = 0;
+			for (U32 i = 0; i < NUM_STANDARD_PRIMS; ++i)
+			{
+				LLVolume* volume = new LLVolume(make_params(STANDARD_PRIMS[i]), HIGH_DETAIL);
+				for (S32 f = 0; f < volume->getNumVolumeFaces(); ++f)
+				{
+					volume->genBinormals(f);
+					max_vertices = llmax(max_vertices, volume->getVolumeFace(f).mNumVertices);
+				}
+				mVolumes.push_back(volume);
+			}
+			// position, normal, binormal and texture coordinate
+			mBuffer.resize(max_vertices * VERTEX_FLOATS);
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				const LLVolume* volume = mVolumes[i % mVolumes.size()];
+				for (S32 f = 0; f < volume->getNumVolumeFaces(); ++f)
+				{
+					const LLVolumeFace& face = volume->getVolumeFace(f);
+					const U32 stride = VERTEX_FLOATS * sizeof(F32);
+					mMatVert.affineTransform(face.mPositions, &mBuffer[0], stride, face.mNumVertices);
+					mMatNormal.rotateNormals(face.mNormals, &mBuffer[3], stride, face.mNumVertices);
+					mMatNormal.rotateNormals(face.mBinormals, &mBuffer[6], stride, face.mNumVertices);
+					for (S32 v = 0; v < face.mNumVertices; ++v)
+					{
+						mBuffer[v * VERTEX_FLOATS + 9] = face.mTexCoords[v].mV[VX];
+						mBuffer[v * VERTEX_FLOATS + 10] = face.mTexCoords[v].mV[VY];
+					}
+				}
+			}
+		}
+
+		virtual void teardown()
+		{
+			mVolumes.clear();
+			mBuffer.clear();
+		}
+
+	private:
+		enum { VERTEX_FLOATS = 11 };
+
+		std::vector<LLPointer<LLVolume> > mVolumes;
+		std::vector<F32> mBuffer;
+		LLMatrix4a mMatVert;
+		LLMatrix4a mMatNormal;
+	};
+
+	// Picks the way LLVolume::lineSegmentIntersect() did before faces had
+	// a BVH: every triangle of every face whose box the segment touches.
+	S32 pick_every_triangle(const LLVolume* volume, const LLVector3& start, const LLVector3& end, F32& closest_t)
+	{
+		S32 hit_face = -1;
+		LLVector3 dir = end - start;
+		closest_t = 2.f;
+		for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
+		{
+			const LLVolumeFace& face = volume->getVolumeFace(i);
+			LLVector3 box_center = (face.mExtents[0] + face.mExtents[1]) / 2.f;
+			LLVector3 box_size = face.mExtents[1] - face.mExtents[0];
+			if (!LLLineSegmentBoxIntersect(start, end, box_center, box_size))
+			{
+				continue;
+			}
+			for (U32 tri = 0; tri < face.mIndices.size() / 3; ++tri)
+			{
+				F32 a, b, t;
+				if (LLTriangleRayIntersect(face.mPositions[face.mIndices[tri * 3 + 0]].getVector3(),
+										   face.mPositions[face.mIndices[tri * 3 + 1]].getVector3(),
+										   face.mPositions[face.mIndices[tri * 3 + 2]].getVector3(),
+										   start, dir, &a, &b, &t, FALSE) &&
+					t >= 0.f && t <= 1.f && t < closest_t)
+				{
+					closest_t = t;
+					hit_face = i;
+				}
+			}
+		}
+		return hit_face;
+	}
+
+	// Mouse picks generated from a fixed seed over a scene of standard
+	// prims at full detail: segments from all around each prim towards a
+	// point near its middle, some of them passing the prim by.
+	class PickScene
+	{
+	public:
+		PickScene() : mSeed(2718)
+		{
+			for (U32 i = 0; i < NUM_STANDARD_PRIMS; ++i)
+			{
+				mVolumes.push_back(new LLVolume(make_params(STANDARD_PRIMS[i]), HIGH_DETAIL));
+			}
+			for (U32 i = 0; i < 512; ++i)
+			{
+				LLVector3 from(next() * 2.f, next() * 2.f, next() * 2.f);
+				from.normVec();
+				from *= 3.f;
+				LLVector3 to(next() * 0.6f, next() * 0.6f, next() * 0.6f);
+				mStarts.push_back(from);
+				mEnds.push_back(from + (to - from) * 2.f);
+			}
+		}
+
+		std::vector<LLPointer<LLVolume> > mVolumes;
+		std::vector<LLVector3> mStarts;
+		std::vector<LLVector3> mEnds;
+
+	private:
+		// -0.5 to 0.5
+		F32 next()
+		{
+			mSeed = mSeed * 1664525 + 1013904223;
+			return (F32)(mSeed >> 8) / (F32)(1 << 24) - 0.5f;
+		}
+
+		U32 mSeed;
+	};
+
+	class PickBenchmark : public LLMetricBenchmark
+	{
+	public:
+		PickBenchmark(const std::string& name, bool every_triangle) :
+			LLMetricBenchmark(name, 5000),
+			mScene(NULL),
+			mEveryTriangle(every_triangle),
+			mHits(0)
+		{
+		}
+
+		virtual void setup()
+		{
+			mScene = new PickScene;
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; ++i)
+			{
+				LLVolume* volume = mScene->mVolumes[i % mScene->mVolumes.size()];
+				U32 ray = i % mScene->mStarts.size();
+				S32 face;
+				if (mEveryTriangle)
+				{
+					F32 t;
+					face = pick_every_triangle(volume, mScene->mStarts[ray], mScene->mEnds[ray], t);
+				}
+				else
+				{
+					LLVector3 intersection;
+					face = volume->lineSegmentIntersect(mScene->mStarts[ray], mScene->mEnds[ray], -1, &intersection);
+				}
+				mHits += face >= 0;
+			}
+		}
+
+		virtual void teardown()
+		{
+			delete mScene;
+			mScene = NULL;
+		}
+
+	private:
+		PickScene* mScene;
+		bool mEveryTriangle;
+		U32 mHits;
+	};
+
+	class BVHPickBenchmark : public PickBenchmark
+	{
+	public:
+		BVHPickBenchmark(const std::string& name) : PickBenchmark(name, false) { }
+	};
+
+	class TrianglePickBenchmark : public PickBenchmark
+	{
+	public:
+		TrianglePickBenchmark(const std::string& name) : PickBenchmark(name, true) { }
+	};
+
+	LLMetricBenchmark::Registrar<GenerateBenchmark> sGenerateRegistrar("volume_generate");
+	LLMetricBenchmark::Registrar<FaceRebuildBenchmark> sFaceRebuildRegistrar("volume_face_rebuild");
+	LLMetricBenchmark::Registrar<BVHPickBenchmark> sBVHPickRegistrar("volume_pick");
+	LLMetricBenchmark::Registrar<TrianglePickBenchmark> sTrianglePickRegistrar("volume_pick_every_triangle");
+}
+
+namespace tut
+{
+	struct llvolume_data
+	{
+		// Checks the invariants every consumer of a face relies on.
+		void checkFace(const std::string& name, const LLVolumeFace& face)
+		{
+			ensure(name + " has vertices", face.mNumVertices > 0);
+			ensure(name + " positions aligned", ((size_t)face.mPositions & 15) == 0);
+			ensure(name + " normals aligned", ((size_t)face.mNormals & 15) == 0);
+			ensure(name + " binormals aligned", ((size_t)face.mBinormals & 15) == 0);
+
+			for (U32 i = 0; i < face.mIndices.size(); ++i)
+			{
+				ensure(name + " index in range", face.mIndices[i] < face.mNumVertices);
+			}
+
+			LLVector4a min(face.mExtents[0]);
+			LLVector4a max(face.mExtents[1]);
+			LLVector4a slop;
+			slop.splat(1e-5f);
+			min.sub(slop);
+			max.add(slop);
+			for (S32 i = 0; i < face.mNumVertices; ++i)
+			{
+				const F32* p = face.mPositions[i].getF32ptr();
+				for (U32 j = 0; j < 3; ++j)
+				{
+					ensure(name + " position inside extents", p[j] >= min.mV[j] && p[j] <= max.mV[j]);
+				}
+			}
+		}
+	};
+	typedef test_group<llvolume_data> llvolume_test;
+	typedef llvolume_test::object llvolume_object;
+	tut::llvolume_test llvolume_testcase("LLVolume");
+
+	template<> template<>
+	void llvolume_object::test<1>()
+	{
+		// every standard prim, whole and hollow with a cut, at each detail
+		const F32 details[] = { 1.f, 1.5f, 2.5f, HIGH_DETAIL };
+		for (U32 i = 0; i < NUM_STANDARD_PRIMS; ++i)
+		{
+			for (U32 d = 0; d < LL_ARRAY_SIZE(details); ++d)
+			{
+				LLPointer<LLVolume> whole = new LLVolume(make_params(STANDARD_PRIMS[i]), details[d]);
+				LLPointer<LLVolume> cut = new LLVolume(make_params(STANDARD_PRIMS[i], 0.5f, 0.2f, 0.7f), details[d]);
+				ensure(std::string(STANDARD_PRIMS[i].mName) + " gains faces when cut",
+					   cut->getNumVolumeFaces() > whole->getNumVolumeFaces());
+				for (S32 f = 0; f < whole->getNumVolumeFaces(); ++f)
+				{
+					checkFace(STANDARD_PRIMS[i].mName, whole->getVolumeFace(f));
+				}
+				for (S32 f = 0; f < cut->getNumVolumeFaces(); ++f)
+				{
+					checkFace(std::string(STANDARD_PRIMS[i].mName) + " cut", cut->getVolumeFace(f));
+				}
+			}
+		}
+	}
+
+	template<> template<>
+	void llvolume_object::test<2>()
+	{
+		// a partial rebuild reuses the arrays and reproduces the geometry
+		LLPointer<LLVolume> volume = new LLVolume(make_params(STANDARD_PRIMS[1]), 2.5f);
+		const LLVolumeFace& face = volume->getVolumeFace(0);
+		LLVolumeFace before = face;
+		const LLVector4a* positions = face.mPositions;
+
+		volume->regen();
+		ensure("arrays kept", face.mPositions == positions);
+		ensure_equals("same count", face.mNumVertices, before.mNumVertices);
+		for (S32 i = 0; i < face.mNumVertices; ++i)
+		{
+			ensure("same positions", face.mPositions[i].equals3(before.mPositions[i], 0.f));
+			ensure("same tex coords", face.mTexCoords[i] == before.mTexCoords[i]);
+		}
+
+		// binormals are generated on demand and come out unit length
+		for (S32 f = 0; f < volume->getNumVolumeFaces(); ++f)
+		{
+			volume->genBinormals(f);
+			const LLVolumeFace& vf = volume->getVolumeFace(f);
+			for (S32 i = 0; i < vf.mNumVertices; ++i)
+			{
+				ensure_distance("unit binormal", vf.mBinormals[i].getLength3(), 1.f, 1e-3f);
+			}
+		}
+	}
+
+	template<> template<>
+	void llvolume_object::test<3>()
+	{
+		// copies own their vertices
+		LLPointer<LLVolume> volume = new LLVolume(make_params(STANDARD_PRIMS[0]), 1.f);
+		const LLVolumeFace& face = volume->getVolumeFace(0);
+
+		LLVolumeFace copy(face);
+		ensure("copy has own arrays", copy.mPositions != face.mPositions);
+		ensure_equals("copy count", copy.mNumVertices, face.mNumVertices);
+		ensure("copy positions", copy.mPositions[1].equals3(face.mPositions[1], 0.f));
+		ensure("copy tex coords", copy.mTexCoords[copy.mNumVertices - 1] == face.mTexCoords[face.mNumVertices - 1]);
+		ensure("copy indices", copy.mIndices == face.mIndices);
+
+		copy.mPositions[1].clear();
+		ensure("original untouched", !face.mPositions[1].equals3(copy.mPositions[1], 0.f));
+
+		LLVolumeFace assigned;
+		assigned = copy;
+		assigned = assigned;
+		ensure("self assignment", assigned.mPositions[1].equals3(copy.mPositions[1], 0.f));
+		ensure("assigned has own arrays", assigned.mPositions != copy.mPositions);
+
+		assigned.resizeVertices(0);
+		ensure_equals("emptied", assigned.mNumVertices, 0);
+		ensure("freed", assigned.mPositions == NULL && assigned.mTexCoords == NULL);
+		LLVolumeFace empty(assigned);
+		ensure("copy of empty", empty.mNumVertices == 0 && empty.mPositions == NULL);
+	}
+
+	template<> template<>
+	void llvolume_object::test<4>()
+	{
+		// picking through the BVH finds the same hits as testing every triangle
+		PickScene scene;
+		U32 hits = 0;
+		for (U32 v = 0; v < scene.mVolumes.size(); ++v)
+		{
+			LLVolume* volume = scene.mVolumes[v];
+			for (U32 ray = 0; ray < scene.mStarts.size(); ++ray)
+			{
+				const LLVector3& start = scene.mStarts[ray];
+				const LLVector3& end = scene.mEnds[ray];
+				F32 expected_t;
+				S32 expected = pick_every_triangle(volume, start, end, expected_t);
+				LLVector3 intersection;
+				S32 face = volume->lineSegmentIntersect(start, end, -1, &intersection);
+				ensure_equals(std::string(STANDARD_PRIMS[v].mName) + " face hit", face, expected);
+				if (face >= 0)
+				{
+					ensure("intersection", dist_vec(intersection, start + (end - start) * expected_t) < 1e-4f);
+					hits++;
+				}
+			}
+
+			bool any_bvh = false;
+			for (S32 f = 0; f < volume->getNumVolumeFaces(); ++f)
+			{
+				const LLVolumeFace& face = volume->getVolumeFace(f);
+				ensure("big faces get a BVH", face.mBVH || face.mIndices.size() / 3 < LLVolumeBVH::MIN_TRIANGLES);
+				any_bvh = any_bvh || face.mBVH;
+			}
+			ensure("some BVH", any_bvh);
+		}
+		ensure("scene hit", hits > scene.mStarts.size());
+	}
+
+	template<> template<>
+	void llvolume_object::test<5>()
+	{
+		// the BVH goes away when the geometry is rebuilt, and isn't copied
+		LLPointer<LLVolume> volume = new LLVolume(make_params(STANDARD_PRIMS[3]), HIGH_DETAIL);
+		volume->genBVH(0);
+		const LLVolumeFace& face = volume->getVolumeFace(0);
+		ensure("built", face.mBVH != NULL);
+		ensure("has nodes", face.mBVH->getNodeCount() > 1);
+
+		LLVolumeFace copy(face);
+		ensure("not shared", copy.mBVH == NULL);
+
+		volume->regen();
+		ensure("rebuilt geometry drops it", face.mBVH == NULL);
+	}
+}
@@ -0,0 +1,166 @@
+/**
+ * @file llvolumemgr_test.cpp
+ * @date 2011-08-24
+ * @brief Tests for building LLVolumeMgr volumes on the build thread.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+#include "lltimer.h"
+
+#include "../llvolumemgr.h"
+
+namespace tut
+{
+	struct llvolumemgr_data
+	{
+		LLVolumeParams mParams;
+
+		llvolumemgr_data()
+		{
+			mParams.setType(LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_LINE);
+		}
+
+		// requests until the build thread is done with it
+		BOOL waitForVolume(LLVolumeMgr& mgr, S32 detail)
+		{
+			for (S32 i = 0; i < 10000; ++i)
+			{
+				if (mgr.requestVolume(mParams, detail))
+				{
+					return TRUE;
+				}
+				ms_sleep(1);
+			}
+			return FALSE;
+		}
+	};
+	typedef test_group<llvolumemgr_data> llvolumemgr_test;
+	typedef llvolumemgr_test::object llvolumemgr_object;
+	tut::llvolumemgr_test llvolumemgr_testcase("LLVolumeMgr");
+
+	template<> template<>
+	void llvolumemgr_object::test<1>()
+	{
+		// without a build thread everything is built by refVolume()
+		LLVolumeMgr mgr;
+		ensure("unreferenced", mgr.requestVolume(mParams, 3));
+		LLPointer<LLVolume> low = mgr.refVolume(mParams, 0);
+		ensure("no build thread", mgr.requestVolume(mParams, 3));
+		LLPointer<LLVolume> high = mgr.refVolume(mParams, 3);
+		ensure("built", high.notNull() && high != low);
+		ensure_equals("detail", high->getDetail(), LLVolumeLODGroup::getVolumeScaleFromDetail(3));
+		mgr.unrefVolume(high);
+		mgr.unrefVolume(low);
+	}
+
+	template<> template<>
+	void llvolumemgr_object::test<2>()
+	{
+		// a requested LOD is built in the background and shared
+		LLVolumeMgr mgr;
+		mgr.startBuildThread(2);
+		LLPointer<LLVolume> low = mgr.refVolume(mParams, 0);
+		ensure("referenced volumes are known", mgr.requestVolume(mParams, 0));
+
+		ensure("built in background", waitForVolume(mgr, 3));
+		LLPointer<LLVolume> high = mgr.refVolume(mParams, 3);
+		LLPointer<LLVolume> again = mgr.refVolume(mParams, 3);
+		ensure("shared", high.notNull() && high == again);
+		ensure_equals("detail", high->getDetail(), LLVolumeLODGroup::getVolumeScaleFromDetail(3));
+		ensure("generated", high->getNumVolumeFaces() > 0);
+
+		// refVolume() takes over or waits for a build still in flight
+		mgr.requestVolume(mParams, 2);
+		LLPointer<LLVolume> mid = mgr.refVolume(mParams, 2);
+		ensure("in flight", mid.notNull() && mid->getNumVolumeFaces() > 0);
+		ensure("now built", mgr.requestVolume(mParams, 2));
+
+		mgr.unrefVolume(mid);
+		mgr.unrefVolume(again);
+		mgr.unrefVolume(high);
+		mgr.unrefVolume(low);
+	}
+
+	template<> template<>
+	void llvolumemgr_object::test<3>()
+	{
+		// groups going away with builds in flight
+		LLVolumeMgr mgr;
+		mgr.startBuildThread();
+		for (S32 i = 0; i < 20; ++i)
+		{
+			mParams.setBeginAndEndS(0.f, 1.f - 0.01f * i);
+			LLPointer<LLVolume> low = mgr.refVolume(mParams, 0);
+			mgr.requestVolume(mParams, 3);
+			mgr.requestVolume(mParams, 2);
+			mgr.unrefVolume(low);
+		}
+		ensure("cleaned up", mgr.cleanup());
+	}
+
+	template<> template<>
+	void llvolumemgr_object::test<4>()
+	{
+		// unreferenced volumes stay cached within the budget, least
+		// recently used out first
+		LLVolumeMgr mgr;
+		LLVolumeParams other = mParams;
+		other.setTaper(0.5f, 0.5f); // same size, different shape
+
+		LLPointer<LLVolume> volume = mgr.refVolume(mParams, 3);
+		U32 bytes = volume->getMemoryUsage();
+		ensure("volume size", bytes > 0);
+		mgr.unrefVolume(volume);
+		ensure("released without a budget", mgr.getGroup(mParams) == NULL);
+		ensure_equals("nothing cached", mgr.getCacheCount(), 0U);
+
+		mgr.setCacheBudget(bytes * 3 / 2);
+		LLVolume* first = mgr.refVolume(mParams, 3);
+		mgr.unrefVolume(first);
+		ensure("kept", mgr.getGroup(mParams) != NULL);
+		ensure_equals("cached bytes", mgr.getCacheBytes(), bytes);
+		ensure("same volume", mgr.refVolume(mParams, 3) == first);
+		ensure_equals("hit", mgr.getCacheHits(), 1U);
+		ensure_equals("not cached while referenced", mgr.getCacheCount(), 0U);
+		mgr.unrefVolume(first);
+
+		// a second volume pushes the first one out
+		LLVolume* second = mgr.refVolume(other, 3);
+		mgr.unrefVolume(second);
+		ensure_equals("evicted", mgr.getCacheEvictions(), 1U);
+		ensure("least recently used gone", mgr.getGroup(mParams) == NULL);
+		ensure("most recently used kept", mgr.getGroup(other) != NULL);
+		ensure_equals("one cached", mgr.getCacheCount(), 1U);
+
+		LLVolume* again = mgr.refVolume(mParams, 3);
+		ensure_equals("misses", mgr.getCacheMisses(), 4U);
+
+		mgr.setCacheBudget(0);
+		ensure("budget lowered", mgr.getGroup(other) == NULL);
+		ensure_equals("empty", mgr.getCacheBytes(), 0U);
+		ensure("referenced groups stay", mgr.getGroup(mParams) != NULL);
+		mgr.unrefVolume(again);
+	}
+}
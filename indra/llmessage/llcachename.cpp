@@ -35,6 +35,7 @@
 #include "llrand.h"
 #include "llsdserialize.h"
 #include "lluuid.h"
+#include "lluuidflatmap.h"
 #include "message.h"
 #include "llmemtype.h"
 
@@ -187,8 +188,8 @@ void ReplySender::flush()
 
 typedef std::set<LLUUID>					AskQueue;
 typedef std::list<PendingReply*>			ReplyQueue;
-typedef std::map<LLUUID,U32>				PendingQueue;
-typedef std::map<LLUUID, LLCacheNameEntry*> Cache;
+typedef LLUUIDFlatMap<U32>					PendingQueue;
+typedef LLUUIDFlatMap<LLCacheNameEntry*>	Cache;
 typedef std::map<std::string, LLUUID> 		ReverseCache;
 
 class LLCacheName::Impl
@@ -114,6 +114,17 @@ public:
 			// of the header can be parsed.  In the ::completed call above only the body is contained in the LLSD.
 			virtual void completedHeader(U32 status, const std::string& reason, const LLSD& content);
 
+			// Override to return true to have an LLSD XML body parsed as it
+			// downloads rather than all at once when the request completes.
+			// completed() is then called with the parsed content directly,
+			// without going through completedRaw().
+			virtual bool streamLLSD() const { return false; }
+
+			// Called for each value of a streamed body as soon as it has been
+			// parsed. Return false to leave the value out of the content given
+			// to completed(), see LLSDXMLParser::Listener.
+			virtual bool streamedValue(const LLSD& path, const LLSD& value) { return true; }
+
 			// Used internally to set the url for debugging later.
 			void setURL(const std::string& url);
 
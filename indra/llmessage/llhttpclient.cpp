@@ -50,13 +50,18 @@ LLURLRequest::SSLCertVerifyCallback LLHTTPClient::mCertVerifyCallback = NULL;
 
 namespace
 {
-	class LLHTTPClientURLAdaptor : public LLURLRequestComplete
+	class LLHTTPClientURLAdaptor : public LLURLRequestComplete, public LLSDXMLParser::Listener
 	{
 	public:
 		LLHTTPClientURLAdaptor(LLCurl::ResponderPtr responder)
 			: LLURLRequestComplete(), mResponder(responder), mStatus(499),
 			  mReason("LLURLRequest complete w/no status")
 		{
+			if (mResponder.get() && mResponder->streamLLSD())
+			{
+				mStreamParser = new LLSDXMLParser;
+				mStreamParser->setListener(this);
+			}
 		}
 		
 		~LLHTTPClientURLAdaptor()
@@ -69,6 +74,25 @@ namespace
 
 			mStatus = status;
 			mReason = reason;
+
+			// a new status line starts a new body, e.g. after a redirect
+			if (mStreamParser.notNull())
+			{
+				mStreamParser->reset();
+			}
+		}
+
+		virtual void body(const U8* data, S32 bytes)
+		{
+			if (mStreamParser.notNull())
+			{
+				mStreamParser->parseChunk((const char*)data, bytes);
+			}
+		}
+
+		virtual bool valueParsed(const LLSD& path, const LLSD& value)
+		{
+			return mResponder->streamedValue(path, value);
 		}
 
 		virtual void complete(const LLChannelDescriptors& channels,
@@ -79,7 +103,20 @@ namespace
 				// Allow clients to parse headers before we attempt to parse
 				// the body and provide completed/result/error calls.
 				mResponder->completedHeader(mStatus, mReason, mHeaderOutput);
-				mResponder->completedRaw(mStatus, mReason, channels, buffer);
+				if (mStreamParser.notNull())
+				{
+					LLSD content;
+					if (mStreamParser->finishChunks(content) == LLSDParser::PARSE_FAILURE)
+					{
+						llinfos << "Failed to deserialize streamed LLSD. [" << mStatus << "]: " << mReason << llendl;
+					}
+					mStreamParser->setListener(NULL);
+					mResponder->completed(mStatus, mReason, content);
+				}
+				else
+				{
+					mResponder->completedRaw(mStatus, mReason, channels, buffer);
+				}
 			}
 		}
 		virtual void header(const std::string& header, const std::string& value)
@@ -92,6 +129,7 @@ namespace
 		U32 mStatus;
 		std::string mReason;
 		LLSD mHeaderOutput;
+		LLPointer<LLSDXMLParser> mStreamParser;
 	};
 	
 	class Injector : public LLIOPipe
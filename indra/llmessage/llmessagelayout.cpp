@@ -0,0 +1,137 @@
+/** 
+ * @file llmessagelayout.cpp
+ * @brief LLMessageLayout class implementation.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmessagelayout.h"
+
+#include "llmessagetemplate.h"
+#include "lltemplatemessagereader.h"
+#include "message.h"
+
+LLMessageLayout::LLMessageLayout(const char* message_name, const char* block_name,
+								 const LLMessageField* fields, S32 field_count) :
+	mMessageName(message_name),
+	mBlockName(block_name),
+	mFields(fields),
+	mFieldCount(field_count),
+	mTemplate(NULL),
+	mBound(FALSE),
+	mBlockIndex(-1)
+{
+}
+
+BOOL LLMessageLayout::bind(const LLMessageTemplate* message_template)
+{
+	mTemplate = message_template;
+	mBound = FALSE;
+	mVariableIndices.clear();
+	mVariableTypes.clear();
+
+	LLMessageStringTable* strings = LLMessageStringTable::getInstance();
+	if (message_template->mName != strings->getString(mMessageName))
+	{
+		// some other message
+		return FALSE;
+	}
+
+	mBlockIndex = message_template->getBlockIndex(strings->getString(mBlockName));
+	if (mBlockIndex < 0)
+	{
+		llwarns << "Block " << mBlockName << " not in message " << mMessageName << llendl;
+		return FALSE;
+	}
+
+	const LLMessageBlock* block = *(message_template->mMemberBlocks.begin() + mBlockIndex);
+	for (S32 i = 0; i < mFieldCount; i++)
+	{
+		const LLMessageField& field = mFields[i];
+		S32 index = block->getVariableIndex(strings->getString(field.mVariable));
+		if (index < 0)
+		{
+			llwarns << "Variable " << field.mVariable << " not in message " << mMessageName
+					<< " block " << mBlockName << llendl;
+			return FALSE;
+		}
+
+		const LLMessageVariable* var = *(block->mMemberVariables.begin() + index);
+		S32 size = (var->getType() == MVT_VARIABLE) ? (S32)sizeof(LLMessageBytes) : var->getSize();
+		if (field.mSize != size)
+		{
+			llwarns << "Msg " << mMessageName << " variable " << field.mVariable
+					<< " is size " << var->getSize()
+					<< " but decoding into a member of size " << field.mSize << llendl;
+			return FALSE;
+		}
+
+		mVariableIndices.push_back(index);
+		mVariableTypes.push_back((U8)var->getType());
+	}
+
+	mBound = TRUE;
+	return TRUE;
+}
+
+S32 LLMessageLayout::getNumberOfBlocks(const LLTemplateMessageReader& reader)
+{
+	const LLMessageTemplate* message_template = reader.getMessageTemplate();
+	if (!message_template)
+	{
+		return 0;
+	}
+	if (message_template != mTemplate)
+	{
+		bind(message_template);
+	}
+	return mBound ? reader.getBlockCount(mBlockIndex) : 0;
+}
+
+BOOL LLMessageLayout::decode(const LLTemplateMessageReader& reader, void* out, S32 blocknum)
+{
+	if (blocknum < 0 || blocknum >= getNumberOfBlocks(reader))
+	{
+		return FALSE;
+	}
+
+	U8* dest = (U8*)out;
+	for (S32 i = 0; i < mFieldCount; i++)
+	{
+		S32 size = 0;
+		const U8* data = reader.getVariableData(mBlockIndex, blocknum, mVariableIndices[i], size);
+		U8* member = dest + mFields[i].mOffset;
+		if (mVariableTypes[i] == MVT_VARIABLE)
+		{
+			LLMessageBytes* bytes = (LLMessageBytes*)member;
+			bytes->mData = data;
+			bytes->mSize = size;
+		}
+		else
+		{
+			htonmemcpy(member, data, (EMsgVariableType)mVariableTypes[i], size);
+		}
+	}
+	return TRUE;
+}
@@ -0,0 +1,106 @@
+/** 
+ * @file llmessagelayout.h
+ * @brief LLMessageLayout class, decodes template message blocks
+ * straight into plain structs.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGELAYOUT_H
+#define LL_LLMESSAGELAYOUT_H
+
+#include <cstddef>
+#include <vector>
+
+class LLMessageTemplate;
+class LLTemplateMessageReader;
+
+// A variable length field, left in the reader's copy of the message.
+// Valid until the reader moves on to the next message.
+struct LLMessageBytes
+{
+	const U8*	mData;
+	S32			mSize;
+};
+
+// One entry of a layout's field table: which template variable goes
+// into which member of the struct.
+struct LLMessageField
+{
+	const char*	mVariable;
+	size_t		mOffset;
+	S32			mSize;
+};
+
+// Builds an LLMessageField for member of struct type, filled from the
+// template variable of the same name.  Variable length members are
+// LLMessageBytes.
+#define LL_MESSAGE_FIELD(type, member, variable) \
+	{ variable, offsetof(type, member), sizeof(((type*)0)->member) }
+
+// Decodes a block of one message into a plain struct, field by field
+// from a static table, instead of a get*Fast() call per variable.
+// Names are looked up once, the first time a message with a new
+// template is decoded; after that only template positions are used.
+//
+//	struct TerseRegion { U64 mRegionHandle; U16 mTimeDilation; };
+//	static const LLMessageField sRegionFields[] =
+//	{
+//		LL_MESSAGE_FIELD(TerseRegion, mRegionHandle, "RegionHandle"),
+//		LL_MESSAGE_FIELD(TerseRegion, mTimeDilation, "TimeDilation"),
+//	};
+//	static LLMessageLayout sRegionLayout("ImprovedTerseObjectUpdate", "RegionData",
+//									   sRegionFields, LL_ARRAY_SIZE(sRegionFields));
+//	TerseRegion region;
+//	sRegionLayout.decode(reader, &region);
+class LLMessageLayout
+{
+public:
+	LLMessageLayout(const char* message_name, const char* block_name,
+					const LLMessageField* fields, S32 field_count);
+
+	// Fills out from instance blocknum of the block in the message reader
+	// is reading.  Returns FALSE, leaving out alone, if that's another
+	// message, the block isn't there, or the fields don't match its
+	// template.
+	BOOL decode(const LLTemplateMessageReader& reader, void* out, S32 blocknum = 0);
+
+	// How many of the block the message reader is reading has
+	S32 getNumberOfBlocks(const LLTemplateMessageReader& reader);
+
+private:
+	BOOL bind(const LLMessageTemplate* message_template);
+
+	const char*				mMessageName;
+	const char*				mBlockName;
+	const LLMessageField*	mFields;
+	S32						mFieldCount;
+
+	// Where the fields are in the template last decoded
+	const LLMessageTemplate*	mTemplate;
+	BOOL					mBound;
+	S32						mBlockIndex;
+	std::vector<S32>		mVariableIndices;
+	std::vector<U8>			mVariableTypes;
+};
+
+#endif // LL_LLMESSAGELAYOUT_H
@@ -139,16 +139,16 @@ public:
 class LLMessageVariable
 {
 public:
-	LLMessageVariable() : mName(NULL), mType(MVT_NULL), mSize(-1)
+	LLMessageVariable() : mName(NULL), mType(MVT_NULL), mSize(-1), mOffset(-1)
 	{
 	}
 
-	LLMessageVariable(char *name) : mType(MVT_NULL), mSize(-1)
+	LLMessageVariable(char *name) : mType(MVT_NULL), mSize(-1), mOffset(-1)
 	{
 		mName = name;
 	}
 
-	LLMessageVariable(const char *name, const EMsgVariableType type, const S32 size) : mType(type), mSize(size) 
+	LLMessageVariable(const char *name, const EMsgVariableType type, const S32 size) : mType(type), mSize(size), mOffset(-1)
 	{
 		mName = LLMessageStringTable::getInstance()->getString(name); 
 	}
@@ -160,10 +160,15 @@ public:
 	EMsgVariableType getType() const				{ return mType; }
 	S32	getSize() const								{ return mSize; }
 	char *getName() const							{ return mName; }
+
+	// Offset from the start of its block, -1 if a variable length field comes first
+	S32 getOffset() const							{ return mOffset; }
+	void setOffset(S32 offset)						{ mOffset = offset; }
 protected:
 	char				*mName;
 	EMsgVariableType	mType;
 	S32					mSize;
+	S32					mOffset;
 };
 
 
@@ -197,6 +202,7 @@ public:
 			llerrs << name << " has already been used as a variable name!" << llendl;
 		}
 		*varp = new LLMessageVariable(name, type, size);
+		(*varp)->setOffset(mTotalSize);
 		if (((*varp)->getType() != MVT_VARIABLE)
 			&&(mTotalSize != -1))
 		{
@@ -224,6 +230,13 @@ public:
 		return iter != mMemberVariables.end()? *iter : NULL;
 	}
 
+	// Position of the variable in the block, -1 if it isn't in it
+	S32 getVariableIndex(const char* name) const
+	{
+		message_variable_map_t::const_iterator iter = mMemberVariables.find(name);
+		return iter != mMemberVariables.end()? (S32)(iter - mMemberVariables.begin()) : -1;
+	}
+
 	friend std::ostream&	 operator<<(std::ostream& s, LLMessageBlock &msg);
 
 	typedef LLDynamicArrayIndexed<LLMessageVariable*, const char *, 8> message_variable_map_t;
@@ -391,6 +404,13 @@ public:
 		return iter != mMemberBlocks.end()? *iter : NULL;
 	}
 
+	// Position of the block in the message, -1 if it isn't in it
+	S32 getBlockIndex(const char* name) const
+	{
+		message_block_map_t::const_iterator iter = mMemberBlocks.find((char*)name);
+		return iter != mMemberBlocks.end()? (S32)(iter - mMemberBlocks.begin()) : -1;
+	}
+
 public:
 	typedef LLDynamicArrayIndexed<LLMessageBlock*, char*, 8> message_block_map_t;
 	message_block_map_t						mMemberBlocks;
@@ -47,14 +47,25 @@ LLPacketRing::LLPacketRing () :
 	mInBufferLength(0),
 	mOutBufferLength(0),
 	mDropPercentage(0.0f),
-	mPacketsToDrop(0x0)
+	mPacketsToDrop(0x0),
+	mReceiveBatchCount(0),
+	mReceiveBatchNext(0),
+	mReceiveCalls(0),
+	mBatchedPacketsIn(0)
 {
+	mReceiveBatchData = new char[RECEIVE_BATCH_SIZE * NET_BUFFER_SIZE];
+	for (S32 i = 0; i < RECEIVE_BATCH_SIZE; i++)
+	{
+		mReceiveBatch[i].mData = mReceiveBatchData + i * NET_BUFFER_SIZE;
+		mReceiveBatch[i].mSize = 0;
+	}
 }
 
 ///////////////////////////////////////////////////////////
 LLPacketRing::~LLPacketRing ()
 {
 	cleanup();
+	delete[] mReceiveBatchData;
 }
 	
 ///////////////////////////////////////////////////////////
@@ -75,6 +86,9 @@ void LLPacketRing::cleanup ()
 		delete packetp;
 		mSendQueue.pop();
 	}
+
+	mReceiveBatchCount = 0;
+	mReceiveBatchNext = 0;
 }
 
 ///////////////////////////////////////////////////////////
@@ -216,28 +230,71 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 	else
 	{
 		// no delay, pull straight from net
-		packet_size = receive_packet(socket, datap);		
-		mLastSender = ::get_sender();
-		mLastReceivingIF = ::get_receiving_interface();
-
-		if (packet_size)  // did we actually get a packet?
+		char* packet_data = NULL;
+		packet_size = receivePacketInPlace(socket, &packet_data);
+		if (packet_size > 0)
 		{
-			if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
-			{
-				mPacketsToDrop++;
-			}
-
-			if (mPacketsToDrop)
-			{
-				packet_size = 0;
-				mPacketsToDrop--;
-			}
+			memcpy(datap, packet_data, packet_size);		/* Flawfinder : ignore */
 		}
 	}
 
 	return packet_size;
 }
 
+///////////////////////////////////////////////////////////
+S32 LLPacketRing::receivePacketInPlace (S32 socket, char **datap)
+{
+	if (mUseInThrottle)
+	{
+		*datap = mReceiveBuffer;
+		return receivePacket(socket, mReceiveBuffer);
+	}
+
+	*datap = mReceiveBuffer;
+	const LLNetPacket* packetp = nextBatchedPacket(socket);
+	if (!packetp)
+	{
+		return 0;
+	}
+
+	S32 packet_size = packetp->mSize;
+	*datap = packetp->mData;
+	mLastSender = LLHost(packetp->mSenderIP, packetp->mSenderPort);
+	mLastReceivingIF = LLHost(packetp->mReceivingIP, INVALID_PORT);
+
+	if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
+	{
+		mPacketsToDrop++;
+	}
+
+	if (mPacketsToDrop)
+	{
+		packet_size = 0;
+		mPacketsToDrop--;
+	}
+
+	return packet_size;
+}
+
+///////////////////////////////////////////////////////////
+const LLNetPacket* LLPacketRing::nextBatchedPacket(S32 socket)
+{
+	if (mReceiveBatchNext >= mReceiveBatchCount)
+	{
+		// batch used up, read whatever is waiting on the socket
+		mReceiveBatchNext = 0;
+		mReceiveBatchCount = receive_packets(socket, mReceiveBatch, RECEIVE_BATCH_SIZE);
+		mReceiveCalls++;
+		mBatchedPacketsIn += mReceiveBatchCount;
+		if (!mReceiveBatchCount)
+		{
+			return NULL;
+		}
+	}
+
+	return &mReceiveBatch[mReceiveBatchNext++];
+}
+
 BOOL LLPacketRing::sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host)
 {
 	BOOL status = TRUE;
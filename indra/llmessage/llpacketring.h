@@ -53,6 +53,11 @@ public:
 	S32  receivePacket (S32 socket, char *datap);
 	S32  receiveFromRing (S32 socket, char *datap);
 
+	// Like receivePacket(), but hands back a pointer to the packet's data
+	// in the receive batch instead of copying it.  The data stays valid
+	// until the next receive call.
+	S32  receivePacketInPlace (S32 socket, char **datap);
+
 	BOOL sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host);
 
 	inline LLHost getLastSender();
@@ -60,7 +65,16 @@ public:
 
 	S32 getAndResetActualInBits()				{ S32 bits = mActualBitsIn; mActualBitsIn = 0; return bits;}
 	S32 getAndResetActualOutBits()				{ S32 bits = mActualBitsOut; mActualBitsOut = 0; return bits;}
+
+	// Socket reads made to refill the receive batch, and the packets they returned
+	U64 getReceiveCalls() const					{ return mReceiveCalls; }
+	U64 getBatchedPacketsIn() const				{ return mBatchedPacketsIn; }
+
+	enum { RECEIVE_BATCH_SIZE = 32 };
+
 protected:
+	const LLNetPacket* nextBatchedPacket(S32 socket);
+
 	BOOL mUseInThrottle;
 	BOOL mUseOutThrottle;
 	
@@ -82,6 +96,17 @@ protected:
 
 	LLHost mLastSender;
 	LLHost mLastReceivingIF;
+
+	// Packets read off the socket in one go, handed out one at a time
+	char* mReceiveBatchData;
+	LLNetPacket mReceiveBatch[RECEIVE_BATCH_SIZE];
+	S32 mReceiveBatchCount;
+	S32 mReceiveBatchNext;
+	U64 mReceiveCalls;
+	U64 mBatchedPacketsIn;
+
+	// Holds throttled packets for receivePacketInPlace()
+	char mReceiveBuffer[NET_BUFFER_SIZE];		/* Flawfinder : ignore */
 };
 
 
@@ -41,16 +41,14 @@ LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
 												 number_template_map) :
 	mReceiveSize(0),
 	mCurrentRMessageTemplate(NULL),
-	mCurrentRMessageData(NULL),
-	mMessageNumbers(number_template_map)
+	mMessageNumbers(number_template_map),
+	mDecoded(false)
 {
 }
 
 //virtual 
 LLTemplateMessageReader::~LLTemplateMessageReader()
 {
-	delete mCurrentRMessageData;
-	mCurrentRMessageData = NULL;
 }
 
 //virtual
@@ -58,8 +56,35 @@ void LLTemplateMessageReader::clearMessage()
 {
 	mReceiveSize = -1;
 	mCurrentRMessageTemplate = NULL;
-	delete mCurrentRMessageData;
-	mCurrentRMessageData = NULL;
+	mDecoded = false;
+}
+
+const LLTemplateMessageReader::LLMsgVarSlice& LLTemplateMessageReader::getSlice(S32 block_index, S32 blocknum, S32 variable_index) const
+{
+	const LLMessageBlock* block = *(mCurrentRMessageTemplate->mMemberBlocks.begin() + block_index);
+	S32 slice = mBlockFirstSlice[block_index] + blocknum * block->mMemberVariables.size() + variable_index;
+	return mVarSlices[slice];
+}
+
+S32 LLTemplateMessageReader::getBlockCount(S32 block_index) const
+{
+	if (!mDecoded || block_index < 0 || block_index >= (S32)mBlockCount.size())
+	{
+		return 0;
+	}
+	return mBlockCount[block_index];
+}
+
+const U8* LLTemplateMessageReader::getVariableData(S32 block_index, S32 blocknum, S32 variable_index, S32& size) const
+{
+	if (blocknum < 0 || blocknum >= getBlockCount(block_index))
+	{
+		size = 0;
+		return NULL;
+	}
+	const LLMsgVarSlice& slice = getSlice(block_index, blocknum, variable_index);
+	size = slice.mSize;
+	return &mMessageData[0] + slice.mOffset;
 }
 
 void LLTemplateMessageReader::getData(const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
@@ -71,77 +96,55 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
 		return;
 	}
 
-	if (!mCurrentRMessageData)
+	if (!mDecoded)
 	{
 		llerrs << "Invalid mCurrentMessageData in getData!" << llendl;
 		return;
 	}
 
-	char *bnamep = (char *)blockname + blocknum; // this works because it's just a hash.  The bnamep is never derefference
-	char *vnamep = (char *)varname; 
-
-	LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-
-	if (iter == mCurrentRMessageData->mMemberBlocks.end())
+	S32 block_index = mCurrentRMessageTemplate->getBlockIndex(blockname);
+	if (blocknum < 0 || blocknum >= getBlockCount(block_index))
 	{
 		llerrs << "Block " << blockname << " #" << blocknum
-			<< " not in message " << mCurrentRMessageData->mName << llendl;
+			<< " not in message " << mCurrentRMessageTemplate->mName << llendl;
 		return;
 	}
 
-	LLMsgBlkData *msg_block_data = iter->second;
-	LLMsgVarData& vardata = msg_block_data->mMemberVarData[vnamep];
-
-	if (!vardata.getName())
+	const LLMessageBlock* block = *(mCurrentRMessageTemplate->mMemberBlocks.begin() + block_index);
+	S32 variable_index = block->getVariableIndex(varname);
+	if (variable_index < 0)
 	{
-		llerrs << "Variable "<< vnamep << " not in message "
-			<< mCurrentRMessageData->mName<< " block " << bnamep << llendl;
+		llerrs << "Variable "<< varname << " not in message "
+			<< mCurrentRMessageTemplate->mName << " block " << blockname << llendl;
 		return;
 	}
 
-	if (size && size != vardata.getSize())
+	const LLMsgVarSlice& slice = getSlice(block_index, blocknum, variable_index);
+	if (size && size != slice.mSize)
 	{
-		llerrs << "Msg " << mCurrentRMessageData->mName 
-			<< " variable " << vnamep
-			<< " is size " << vardata.getSize()
+		llerrs << "Msg " << mCurrentRMessageTemplate->mName 
+			<< " variable " << varname
+			<< " is size " << slice.mSize
 			<< " but copying into buffer of size " << size
 			<< llendl;
 		return;
 	}
 
-
-	const S32 vardata_size = vardata.getSize();
-	if( max_size >= vardata_size )
+	const U8* vardata = &mMessageData[0] + slice.mOffset;
+	if( max_size >= slice.mSize )
 	{   
-		switch( vardata_size )
-		{ 
-		case 1:
-			*((U8*)datap) = *((U8*)vardata.getData());
-			break;
-		case 2:
-			*((U16*)datap) = *((U16*)vardata.getData());
-			break;
-		case 4:
-			*((U32*)datap) = *((U32*)vardata.getData());
-			break;
-		case 8:
-			((U32*)datap)[0] = ((U32*)vardata.getData())[0];
-			((U32*)datap)[1] = ((U32*)vardata.getData())[1];
-			break;
-		default:
-			memcpy(datap, vardata.getData(), vardata_size);
-			break;
-		}
+		const LLMessageVariable* var = *(block->mMemberVariables.begin() + variable_index);
+		htonmemcpy(datap, vardata, var->getType(), slice.mSize);
 	}
 	else
 	{
-		llwarns << "Msg " << mCurrentRMessageData->mName 
-			<< " variable " << vnamep
-			<< " is size " << vardata.getSize()
+		llwarns << "Msg " << mCurrentRMessageTemplate->mName 
+			<< " variable " << varname
+			<< " is size " << slice.mSize
 			<< " but truncated to max size of " << max_size
 			<< llendl;
 
-		memcpy(datap, vardata.getData(), max_size);
+		memcpy(datap, vardata, max_size);
 	}
 }
 
@@ -154,70 +157,26 @@ S32 LLTemplateMessageReader::getNumberOfBlocks(const char *blockname)
 		return -1;
 	}
 
-	if (!mCurrentRMessageData)
+	if (!mDecoded)
 	{
 		llerrs << "Invalid mCurrentRMessageData in getData!" << llendl;
 		return -1;
 	}
 
-	char *bnamep = (char *)blockname; 
-
-	LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-	
-	if (iter == mCurrentRMessageData->mMemberBlocks.end())
-	{
-		return 0;
-	}
-
-	return (iter->second)->mBlockNumber;
+	return getBlockCount(mCurrentRMessageTemplate->getBlockIndex(blockname));
 }
 
 S32 LLTemplateMessageReader::getSize(const char *blockname, const char *varname)
 {
-	// is there a message ready to go?
-	if (mReceiveSize == -1)
-	{	// This is a serious error - crash 
-		llerrs << "No message waiting for decode 4!" << llendl;
-		return LL_MESSAGE_ERROR;
-	}
-
-	if (!mCurrentRMessageData)
-	{	// This is a serious error - crash
-		llerrs << "Invalid mCurrentRMessageData in getData!" << llendl;
-		return LL_MESSAGE_ERROR;
-	}
-
-	char *bnamep = (char *)blockname; 
-
-	LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-	
-	if (iter == mCurrentRMessageData->mMemberBlocks.end())
-	{	// don't crash
-		llinfos << "Block " << bnamep << " not in message "
-			<< mCurrentRMessageData->mName << llendl;
-		return LL_BLOCK_NOT_IN_MESSAGE;
-	}
-
-	char *vnamep = (char *)varname; 
-
-	LLMsgBlkData* msg_data = iter->second;
-	LLMsgVarData& vardata = msg_data->mMemberVarData[vnamep];
-	
-	if (!vardata.getName())
-	{	// don't crash
-		llinfos << "Variable " << varname << " not in message "
-			<< mCurrentRMessageData->mName << " block " << bnamep << llendl;
-		return LL_VARIABLE_NOT_IN_BLOCK;
-	}
-
-	if (mCurrentRMessageTemplate->mMemberBlocks[bnamep]->mType != MBT_SINGLE)
+	S32 size = getSize(blockname, 0, varname);
+	if (size >= 0
+		&& (*(mCurrentRMessageTemplate->mMemberBlocks.begin() + mCurrentRMessageTemplate->getBlockIndex(blockname)))->mType != MBT_SINGLE)
 	{	// This is a serious error - crash
-		llerrs << "Block " << bnamep << " isn't type MBT_SINGLE,"
+		llerrs << "Block " << blockname << " isn't type MBT_SINGLE,"
 			" use getSize with blocknum argument!" << llendl;
 		return LL_MESSAGE_ERROR;
 	}
-
-	return vardata.getSize();
+	return size;
 }
 
 S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const char *varname)
@@ -229,35 +188,30 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const
 		return LL_MESSAGE_ERROR;
 	}
 
-	if (!mCurrentRMessageData)
+	if (!mDecoded)
 	{	// This is a serious error - crash
 		llerrs << "Invalid mCurrentRMessageData in getData!" << llendl;
 		return LL_MESSAGE_ERROR;
 	}
 
-	char *bnamep = (char *)blockname + blocknum; 
-	char *vnamep = (char *)varname; 
-
-	LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-	
-	if (iter == mCurrentRMessageData->mMemberBlocks.end())
+	S32 block_index = mCurrentRMessageTemplate->getBlockIndex(blockname);
+	if (blocknum < 0 || blocknum >= getBlockCount(block_index))
 	{	// don't crash
-		llinfos << "Block " << bnamep << " not in message " 
-			<< mCurrentRMessageData->mName << llendl;
+		llinfos << "Block " << blockname << " #" << blocknum << " not in message " 
+			<< mCurrentRMessageTemplate->mName << llendl;
 		return LL_BLOCK_NOT_IN_MESSAGE;
 	}
 
-	LLMsgBlkData* msg_data = iter->second;
-	LLMsgVarData& vardata = msg_data->mMemberVarData[vnamep];
-	
-	if (!vardata.getName())
+	const LLMessageBlock* block = *(mCurrentRMessageTemplate->mMemberBlocks.begin() + block_index);
+	S32 variable_index = block->getVariableIndex(varname);
+	if (variable_index < 0)
 	{	// don't crash
-		llinfos << "Variable " << vnamep << " not in message "
-			<<  mCurrentRMessageData->mName << " block " << bnamep << llendl;
+		llinfos << "Variable " << varname << " not in message "
+			<<  mCurrentRMessageTemplate->mName << " block " << blockname << llendl;
 		return LL_VARIABLE_NOT_IN_BLOCK;
 	}
 
-	return vardata.getSize();
+	return getSlice(block_index, blocknum, variable_index).mSize;
 }
 
 void LLTemplateMessageReader::getBinaryData(const char *blockname, 
@@ -531,18 +485,21 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 {
 	llassert( mReceiveSize >= 0 );
 	llassert( mCurrentRMessageTemplate);
-	llassert( !mCurrentRMessageData );
-	delete mCurrentRMessageData; // just to make sure
 
 	// The offset tells us how may bytes to skip after the end of the
 	// message name.
 	U8 offset = buffer[PHL_OFFSET];
 	S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(mCurrentRMessageTemplate->mFrequency) + offset;
 
-	// create base working data set
-	mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+	// keep our own copy, callers are free to reuse the buffer once the
+	// handler has run
+	mMessageData.assign(buffer, buffer + mReceiveSize);
+	mVarSlices.clear();
+	mBlockFirstSlice.clear();
+	mBlockCount.clear();
+	S32 total_blocks = 0;
 	
-	// loop through the template building the data structure as we go
+	// loop through the template recording where each variable is as we go
 	LLMessageTemplate::message_block_map_t::const_iterator iter;
 	for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
 		iter != mCurrentRMessageTemplate->mMemberBlocks.end();
@@ -589,36 +546,35 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 			return FALSE;
 		}
 
-		LLMsgBlkData* cur_data_block = NULL;
+		mBlockFirstSlice.push_back(mVarSlices.size());
+		mBlockCount.push_back(repeat_number);
+		total_blocks += repeat_number;
 
 		// now loop through the block
 		for (i = 0; i < repeat_number; i++)
 		{
-			if (i)
+			if ((mbci->mTotalSize != -1) && (decode_pos + mbci->mTotalSize <= mReceiveSize))
 			{
-				// build new name to prevent collisions
-				// TODO: This should really change to a vector
-				cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
-				cur_data_block->mName = mbci->mName + i;
-			}
-			else
-			{
-				cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
+				// all fixed size and all there, the template has the offsets
+				for (LLMessageBlock::message_variable_map_t::const_iterator iter = 
+						 mbci->mMemberVariables.begin();
+					 iter != mbci->mMemberVariables.end(); iter++)
+				{
+					const LLMessageVariable& mvci = **iter;
+					LLMsgVarSlice slice = { decode_pos + mvci.getOffset(), mvci.getSize() };
+					mVarSlices.push_back(slice);
+				}
+				decode_pos += mbci->mTotalSize;
+				continue;
 			}
 
-			// add the block to the message
-			mCurrentRMessageData->addBlock(cur_data_block);
-
 			// now read the variables
 			for (LLMessageBlock::message_variable_map_t::const_iterator iter = 
 					 mbci->mMemberVariables.begin();
 				 iter != mbci->mMemberVariables.end(); iter++)
 			{
 				const LLMessageVariable& mvci = **iter;
-
-				// ok, build out the variables
-				// add variable block
-				cur_data_block->addVariable(mvci.getName(), mvci.getType());
+				LLMsgVarSlice slice = { 0, 0 };
 
 				// what type of variable?
 				if (mvci.getType() == MVT_VARIABLE)
@@ -658,37 +614,44 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 					}
 					decode_pos += data_size;
 
-					cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
+					if (tsize && ((S32)tsize > mReceiveSize - decode_pos))
+					{
+						// don't read past the packet, treat as 0 length
+						logRanOffEndOfPacket(sender, decode_pos, tsize);
+					}
+					else
+					{
+						slice.mOffset = decode_pos;
+						slice.mSize = tsize;
+					}
 					decode_pos += tsize;
 				}
 				else
 				{
 					// fixed!
-					// so, copy data pointer and set data size to fixed size
+					// so, point at the data and set data size to fixed size
+					slice.mSize = mvci.getSize();
 					if ((decode_pos + mvci.getSize()) > mReceiveSize)
 					{
 						logRanOffEndOfPacket(sender, decode_pos, mvci.getSize());
 
 						// default to 0s.
-						U32 size = mvci.getSize();
-						std::vector<U8> data(size, 0);
-						cur_data_block->addData(mvci.getName(), &(data[0]), 
-												size, mvci.getType());
+						slice.mOffset = mMessageData.size();
+						mMessageData.resize(mMessageData.size() + mvci.getSize(), 0);
 					}
 					else
 					{
-						cur_data_block->addData(mvci.getName(), 
-												&buffer[decode_pos], 
-												mvci.getSize(), 
-												mvci.getType());
+						slice.mOffset = decode_pos;
 					}
 					decode_pos += mvci.getSize();
 				}
+				mVarSlices.push_back(slice);
 			}
 		}
 	}
+	mDecoded = true;
 
-	if (mCurrentRMessageData->mMemberBlocks.empty()
+	if (!total_blocks
 		&& !mCurrentRMessageTemplate->mMemberBlocks.empty())
 	{
 		lldebugs << "Empty message '" << mCurrentRMessageTemplate->mName << "' (no blocks)" << llendl;
@@ -753,6 +716,7 @@ BOOL LLTemplateMessageReader::validateMessage(const U8* buffer,
 											  bool trusted)
 {
 	mReceiveSize = buffer_size;
+	mDecoded = false;
 	BOOL valid = decodeTemplate(buffer, buffer_size, &mCurrentRMessageTemplate );
 	if(valid)
 	{
@@ -823,5 +787,39 @@ void LLTemplateMessageReader::copyToBuilder(LLMessageBuilder& builder) const
     {
         return;
     }
-	builder.copyFromMessageData(*mCurrentRMessageData);
+	if (!mDecoded)
+	{
+		return;
+	}
+
+	// rebuild the message the way the builder takes it
+	LLMsgData data(mCurrentRMessageTemplate->mName);
+	S32 block_index = 0;
+	LLMessageTemplate::message_block_map_t::const_iterator iter;
+	for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
+		iter != mCurrentRMessageTemplate->mMemberBlocks.end();
+		++iter, ++block_index)
+	{
+		const LLMessageBlock* mbci = *iter;
+		S32 repeat_number = mBlockCount[block_index];
+		for (S32 i = 0; i < repeat_number; i++)
+		{
+			LLMsgBlkData* cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
+			cur_data_block->mName = mbci->mName + i;
+			data.addBlock(cur_data_block);
+
+			S32 variable_index = 0;
+			for (LLMessageBlock::message_variable_map_t::const_iterator var_iter = 
+					 mbci->mMemberVariables.begin();
+				 var_iter != mbci->mMemberVariables.end(); ++var_iter, ++variable_index)
+			{
+				const LLMessageVariable& mvci = **var_iter;
+				const LLMsgVarSlice& slice = getSlice(block_index, i, variable_index);
+				cur_data_block->addVariable(mvci.getName(), mvci.getType());
+				cur_data_block->addData(mvci.getName(), &mMessageData[0] + slice.mOffset, 
+										slice.mSize, mvci.getType());
+			}
+		}
+	}
+	builder.copyFromMessageData(data);
 }
@@ -30,9 +30,9 @@
 #include "llmessagereader.h"
 
 #include <map>
+#include <vector>
 
 class LLMessageTemplate;
-class LLMsgData;
 
 class LLTemplateMessageReader : public LLMessageReader
 {
@@ -105,6 +105,12 @@ public:
 	bool isTrusted() const;
 	bool isBanned(bool trusted_source) const;
 	bool isUdpBanned() const;
+
+	// Access by block and variable position in the template, for
+	// LLMessageLayout.  Both are only valid while a message is read.
+	const LLMessageTemplate* getMessageTemplate() const	{ return mCurrentRMessageTemplate; }
+	S32 getBlockCount(S32 block_index) const;
+	const U8* getVariableData(S32 block_index, S32 blocknum, S32 variable_index, S32& size) const;
 	
 private:
 
@@ -118,10 +124,25 @@ private:
 
 	BOOL decodeData(const U8* buffer, const LLHost& sender );
 
+	// Where a variable's data lies in mMessageData
+	struct LLMsgVarSlice
+	{
+		S32 mOffset;
+		S32 mSize;
+	};
+
+	const LLMsgVarSlice& getSlice(S32 block_index, S32 blocknum, S32 variable_index) const;
+
 	S32	mReceiveSize;
 	LLMessageTemplate* mCurrentRMessageTemplate;
-	LLMsgData* mCurrentRMessageData;
 	message_template_number_map_t& mMessageNumbers;
+
+	// The message read by decodeData(), in one pass over the template
+	bool mDecoded;
+	std::vector<U8> mMessageData;			// the packet, with zeros added for fields past its end
+	std::vector<LLMsgVarSlice> mVarSlices;	// every variable of every block, in template order
+	std::vector<S32> mBlockFirstSlice;		// per template block, its first variable in mVarSlices
+	std::vector<S32> mBlockCount;			// per template block, how many the message has
 };
 
 #endif // LL_LLTEMPLATEMESSAGEREADER_H
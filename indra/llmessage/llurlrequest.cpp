@@ -533,6 +533,12 @@ size_t LLURLRequest::downCallback(
 		bytes);
 	req->mResponseTransferedBytes += bytes;
 	req->mDetail->mByteAccumulator += bytes;
+	if (req->mCompletionCallback)
+	{
+		LLURLRequestComplete* complete =
+			(LLURLRequestComplete*)req->mCompletionCallback.get();
+		complete->body((const U8*)data, bytes);
+	}
 	return bytes;
 }
 
@@ -325,6 +325,10 @@ public:
 	//     a 3xx for a redirect followed by a "real" status, or more redirects.
 	virtual void httpStatus(U32 status, const std::string& reason) { }
 
+	// Called with each piece of the response body as it is received,
+	// before complete() sees the whole of it.
+	virtual void body(const U8* data, S32 bytes) { }
+
 	virtual void complete(
 		const LLChannelDescriptors& channels,
 		const buffer_ptr_t& buffer);
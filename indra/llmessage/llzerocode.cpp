@@ -0,0 +1,197 @@
+/** 
+ * @file llzerocode.cpp
+ * @brief Zero-coding of message bodies.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llzerocode.h"
+
+#if (LL_GNUC && defined(__SSE2__)) || (LL_MSVC && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define LL_ZEROCODE_SSE2 1
+#include <emmintrin.h>
+#if LL_MSVC
+#include <intrin.h>
+#endif
+#else
+#define LL_ZEROCODE_SSE2 0
+#endif
+
+// Longest run a single 0 [count] pair encodes.
+const S32 MAX_ZERO_RUN = 255;
+
+#if LL_ZEROCODE_SSE2
+static inline S32 lowest_set_bit(U32 mask)
+{
+#if LL_MSVC
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (S32)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Returns the index of the first zero byte in in[i, end), or end.
+static inline S32 find_zero(const U8* in, S32 i, S32 end)
+{
+#if LL_ZEROCODE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for ( ; i + 16 <= end; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(in + i));
+		S32 zeroes = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero));
+		if (zeroes)
+		{
+			return i + lowest_set_bit(zeroes);
+		}
+	}
+#else
+	for ( ; i + 8 <= end; i += 8)
+	{
+		U64 word;
+		memcpy(&word, in + i, sizeof(word));	/* Flawfinder: ignore */
+		if ((word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL)
+		{
+			break;
+		}
+	}
+#endif
+	for ( ; i < end && in[i]; ++i)
+	{
+	}
+	return i;
+}
+
+// Returns the index of the first non-zero byte in in[i, end), or end.
+static inline S32 find_nonzero(const U8* in, S32 i, S32 end)
+{
+#if LL_ZEROCODE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for ( ; i + 16 <= end; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(in + i));
+		S32 nonzero = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)) ^ 0xFFFF;
+		if (nonzero)
+		{
+			return i + lowest_set_bit(nonzero);
+		}
+	}
+#else
+	for ( ; i + 8 <= end; i += 8)
+	{
+		U64 word;
+		memcpy(&word, in + i, sizeof(word));	/* Flawfinder: ignore */
+		if (word)
+		{
+			break;
+		}
+	}
+#endif
+	for ( ; i < end && !in[i]; ++i)
+	{
+	}
+	return i;
+}
+
+S32 ll_zero_code(const U8* in, S32 size, U8* out)
+{
+	S32 i = 0;
+	S32 out_size = 0;
+	while (i < size)
+	{
+		S32 run_start = find_zero(in, i, size);
+		memcpy(out + out_size, in + i, run_start - i);	/* Flawfinder: ignore */
+		out_size += run_start - i;
+		if (run_start == size)
+		{
+			break;
+		}
+
+		i = find_nonzero(in, run_start, size);
+		for (S32 run = i - run_start; run > 0; run -= MAX_ZERO_RUN)
+		{
+			out[out_size++] = 0;
+			out[out_size++] = (U8)llmin(run, MAX_ZERO_RUN);
+		}
+	}
+	return out_size;
+}
+
+S32 ll_zero_code_size(const U8* in, S32 size)
+{
+	S32 i = 0;
+	S32 out_size = 0;
+	while (i < size)
+	{
+		S32 run_start = find_zero(in, i, size);
+		out_size += run_start - i;
+		if (run_start == size)
+		{
+			break;
+		}
+
+		i = find_nonzero(in, run_start, size);
+		out_size += 2 * ((i - run_start + MAX_ZERO_RUN - 1) / MAX_ZERO_RUN);
+	}
+	return out_size;
+}
+
+S32 ll_zero_code_expand(const U8* in, S32 size, U8* out, S32 out_size)
+{
+	S32 i = 0;
+	S32 expanded = 0;
+	while (i < size)
+	{
+		S32 run_start = find_zero(in, i, size);
+		if (run_start - i > out_size - expanded)
+		{
+			return -1;
+		}
+		memcpy(out + expanded, in + i, run_start - i);	/* Flawfinder: ignore */
+		expanded += run_start - i;
+		if (run_start == size)
+		{
+			break;
+		}
+
+		// The first zero is one zero and each one after it wraps
+		// another 256.  The count byte, if the body doesn't end
+		// first, adds count - 1.
+		i = find_nonzero(in, run_start + 1, size);
+		S32 zeroes = 1 + 256 * (i - run_start - 1);
+		if (i < size)
+		{
+			zeroes += in[i++] - 1;
+		}
+		if (zeroes > out_size - expanded)
+		{
+			return -1;
+		}
+		memset(out + expanded, 0, zeroes);
+		expanded += zeroes;
+	}
+	return expanded;
+}
@@ -0,0 +1,47 @@
+/** 
+ * @file llzerocode.h
+ * @brief Zero-coding of message bodies.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLZEROCODE_H
+#define LL_LLZEROCODE_H
+
+// Sequential zero bytes are encoded as 0 [U8 count], with a run longer
+// than 255 split into several.  For compatibility with old encoders the
+// expansion also treats 0 0 [count] as a wrap: every extra zero byte
+// stands for 256 zeroes.  None of these functions touch the packet id
+// field; callers pass the body that follows it.
+
+// Encodes size bytes of in into out, which must have room for
+// 2 * size bytes.  Returns the encoded size.
+S32 ll_zero_code(const U8* in, S32 size, U8* out);
+
+// Returns the size ll_zero_code() would encode size bytes of in to.
+S32 ll_zero_code_size(const U8* in, S32 size);
+
+// Expands size bytes of encoded data from in into out.  Returns the
+// expanded size, or -1 if it would not fit in out_size bytes.
+S32 ll_zero_code_expand(const U8* in, S32 size, U8* out, S32 out_size);
+
+#endif // LL_LLZEROCODE_H
@@ -73,6 +73,7 @@
 #include "lltransfermanager.h"
 #include "lluuid.h"
 #include "llxfermanager.h"
+#include "llzerocode.h"
 #include "timing.h"
 #include "llquaternion.h"
 #include "u64.h"
@@ -318,6 +319,7 @@ LLMessageSystem::LLMessageSystem(const std::string& filename, U32 port,
 	mMaxMessageCounts = 200; // >= 0 means dump warnings
 	mMaxMessageTime   = 1.f;
 
+	mTrueReceiveBuffer = NULL;
 	mTrueReceiveSize = 0;
 
 	mReceiveTime = 0.f;
@@ -551,9 +553,10 @@ BOOL LLMessageSystem::checkMessages( S64 frame_count )
 		S32 acks = 0;
 		S32 true_rcv_size = 0;
 
+		char* packet_data = NULL;
+		mTrueReceiveSize = mPacketRing.receivePacketInPlace(mSocket, &packet_data);
+		mTrueReceiveBuffer = (U8*)packet_data;
 		U8* buffer = mTrueReceiveBuffer;
-		
-		mTrueReceiveSize = mPacketRing.receivePacket(mSocket, (char *)mTrueReceiveBuffer);
 		// If you want to dump all received packets into SecondLife.log, uncomment this
 		//dumpPacketToLog();
 		
@@ -2421,6 +2424,8 @@ void process_deny_trusted_circuit(LLMessageSystem *msg, void **)
 void dump_prehash_files()
 {
 	U32 i;
+	std::vector<const char*> names;
+	LLMessageStringTable::getInstance()->getStrings(names);
 	std::string filename("../../indra/llmessage/message_prehash.h");
 	LLFILE* fp = LLFile::fopen(filename, "w");	/* Flawfinder: ignore */
 	if (fp)
@@ -2442,11 +2447,11 @@ void dump_prehash_files()
 			" */\n",
 			gMessageSystem->mMessageFileVersionNumber);
 		fprintf(fp, "\n\nextern F32 gPrehashVersionNumber;\n\n");
-		for (i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; i++)
+		for (i = 0; i < names.size(); i++)
 		{
-			if (!LLMessageStringTable::getInstance()->mEmpty[i] && LLMessageStringTable::getInstance()->mString[i][0] != '.')
+			if (names[i][0] != '.')
 			{
-				fprintf(fp, "extern char * _PREHASH_%s;\n", LLMessageStringTable::getInstance()->mString[i]);
+				fprintf(fp, "extern char * _PREHASH_%s;\n", names[i]);
 			}
 		}
 		fprintf(fp, "\n\n#endif\n");
@@ -2472,11 +2477,11 @@ void dump_prehash_files()
 		fprintf(fp, "#include \"linden_common.h\"\n");
 		fprintf(fp, "#include \"message.h\"\n\n");
 		fprintf(fp, "\n\nF32 gPrehashVersionNumber = %.3ff;\n\n", gMessageSystem->mMessageFileVersionNumber);
-		for (i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; i++)
+		for (i = 0; i < names.size(); i++)
 		{
-			if (!LLMessageStringTable::getInstance()->mEmpty[i] && LLMessageStringTable::getInstance()->mString[i][0] != '.')
+			if (names[i][0] != '.')
 			{
-				fprintf(fp, "char * _PREHASH_%s = LLMessageStringTable::getInstance()->getString(\"%s\");\n", LLMessageStringTable::getInstance()->mString[i], LLMessageStringTable::getInstance()->mString[i]);
+				fprintf(fp, "char * _PREHASH_%s = LLMessageStringTable::getInstance()->getString(\"%s\");\n", names[i], names[i]);
 			}
 		}
 		fclose(fp);
@@ -2609,6 +2614,9 @@ void LLMessageSystem::summarizeLogs(std::ostream& str)
 	str << buffer << std::endl;
 	buffer = llformat( "Average packet size:       %20.0f bytes", (F32)mTotalBytesIn / (F32)mPacketsIn);
 	str << buffer << std::endl;
+	tmp_str = U64_to_str(mPacketRing.getReceiveCalls());
+	buffer = llformat( "Socket receive calls:      %20s (%5.2f packets per call)", tmp_str.c_str(), ((F32) mPacketRing.getBatchedPacketsIn())/((F32) mPacketRing.getReceiveCalls() + 1));
+	str << buffer << std::endl;
 	tmp_str = U64_to_str(mReliablePacketsIn);
 	buffer = llformat( "Total reliable packets:    %20s (%5.2f%%)", tmp_str.c_str(), 100.f * ((F32) mReliablePacketsIn)/((F32) mPacketsIn + 1));
 	str << buffer << std::endl;
@@ -2809,54 +2817,9 @@ S32 LLMessageSystem::zeroCodeAdjustCurrentSendTotal()
 	// TODO: babbage: remove this horror
 	mMessageBuilder->setBuilt(FALSE);
 
-	S32 count = mSendSize;
-	
-	S32 net_gain = 0;
-	U8 num_zeroes = 0;
-	
-	U8 *inptr = (U8 *)mSendBuffer;
-
-// skip the packet id field
-
-	for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
-	{
-		count--;
-		inptr++;
-	}
-
-// don't actually build, just test
-
-// sequential zero bytes are encoded as 0 [U8 count] 
-// with 0 0 [count] representing wrap (>256 zeroes)
-
-	while (count--)
-	{
-		if (!(*inptr))   // in a zero count
-		{
-			if (num_zeroes)
-			{
-				if (++num_zeroes > 254)
-				{
-					num_zeroes = 0;
-				}
-				net_gain--;   // subseqent zeroes save one
-			}
-			else
-			{
-				net_gain++;  // starting a zero count adds one
-				num_zeroes = 1;
-			}
-			inptr++;
-		}
-		else
-		{
-			if (num_zeroes)
-			{
-				num_zeroes = 0;
-			}
-			inptr++;
-		}
-	}
+	// don't actually build, just test
+	S32 body_size = mSendSize - LL_PACKET_ID_SIZE;
+	S32 net_gain = ll_zero_code_size(mSendBuffer + LL_PACKET_ID_SIZE, body_size) - body_size;
 	if (net_gain < 0)
 	{
 		return net_gain;
@@ -2891,72 +2854,24 @@ S32 LLMessageSystem::zeroCodeExpand(U8** data, S32* data_size)
 	
 	*data[0] &= (~LL_ZERO_CODE_FLAG);
 
-	S32 count = (*data_size);  
-	
-	U8 *inptr = (U8 *)*data;
-	U8 *outptr = (U8 *)mEncodedRecvBuffer;
-
-// skip the packet id field
+	// skip the packet id field
+	S32 header_size = llmin(in_size, (S32)LL_PACKET_ID_SIZE);
+	memcpy(mEncodedRecvBuffer, *data, header_size);	/* Flawfinder: ignore */
 
-	for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
+	S32 expanded_size = ll_zero_code_expand(*data + header_size,
+											in_size - header_size,
+											mEncodedRecvBuffer + header_size,
+											MAX_BUFFER_SIZE - header_size);
+	if (expanded_size < 0)
 	{
-		count--;
-		*outptr++ = *inptr++;
+		LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size" << llendl;
+		callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+		expanded_size = 0;
+		header_size = 0;
 	}
 
-// reconstruct encoded packet, keeping track of net size gain
-
-// sequential zero bytes are encoded as 0 [U8 count] 
-// with 0 0 [count] representing wrap (>256 zeroes)
-
-	while (count--)
-	{
-		if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-1]))
-		{
-			LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << llendl;
-			callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-			outptr = mEncodedRecvBuffer;					
-			break;
-		}
-		if (!((*outptr++ = *inptr++)))
-		{
-			while (((count--)) && (!(*inptr)))
-			{
-				*outptr++ = *inptr++;
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-256]))
-  				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << llendl;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;
-					count = -1;
-					break;
-  				}
-				memset(outptr,0,255);
-				outptr += 255;
-			}
-			
-			if (count < 0)
-			{
-				break;
-			}
-
-			else
-			{
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-(*inptr)]))
-				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << llendl;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;					
-				}
-				memset(outptr,0,(*inptr) - 1);
-				outptr += ((*inptr) - 1);
-				inptr++;
-			}
-		}		
-	}
-	
 	*data = mEncodedRecvBuffer;
-	*data_size = (S32)(outptr - mEncodedRecvBuffer);
+	*data_size = header_size + expanded_size;
 	mUncompressedBytesIn += *data_size;
 
 	return(in_size);
@@ -61,9 +61,6 @@
 
 #include "llstoredmessage.h"
 
-const U32 MESSAGE_MAX_STRINGS_LENGTH = 64;
-const U32 MESSAGE_NUMBER_OF_HASH_BUCKETS = 8192;
-
 const S32 MESSAGE_MAX_PER_FRAME = 400;
 
 class LLMessageStringTable : public LLSingleton<LLMessageStringTable>
@@ -72,11 +69,17 @@ public:
 	LLMessageStringTable();
 	~LLMessageStringTable();
 
+	// Returns the interned copy of str.  Message, block and variable names
+	// are compared by pointer, so use the result rather than str.
 	char *getString(const char *str);
 
-	U32	 mUsed;
-	BOOL mEmpty[MESSAGE_NUMBER_OF_HASH_BUCKETS];
-	char mString[MESSAGE_NUMBER_OF_HASH_BUCKETS][MESSAGE_MAX_STRINGS_LENGTH];	/* Flawfinder: ignore */
+	// All interned names, sorted.
+	void getStrings(std::vector<const char*>& strings);
+
+private:
+	// Shares the open addressed LLStringTable implementation but not the
+	// contents of gStringTable.  Names are never removed.
+	LLStringTable mStrings;
 };
 
 
@@ -776,7 +779,7 @@ private:
 	LLMessagePollInfo						*mPollInfop;
 
 	U8	mEncodedRecvBuffer[MAX_BUFFER_SIZE];
-	U8	mTrueReceiveBuffer[MAX_BUFFER_SIZE];
+	U8*	mTrueReceiveBuffer;	// points into mPacketRing, valid until the next receive
 	S32	mTrueReceiveSize;
 
 	// Must be valid during decode
@@ -115,6 +115,93 @@ U32 get_receiving_interface_ip(void)
 	return gsnReceivingIFAddr;
 }
 
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 count)
+{
+	count = llmin(count, NET_MAX_RECEIVE_BATCH);
+
+#if LL_LINUX && defined(MSG_WAITFORONE)
+	// recvmmsg() needs Linux 2.6.33, fall back to one call per datagram
+	// on older kernels
+	static bool sHaveRecvmmsg = true;
+	if (sHaveRecvmmsg)
+	{
+		struct mmsghdr msgs[NET_MAX_RECEIVE_BATCH];
+		struct iovec iovs[NET_MAX_RECEIVE_BATCH];
+		struct sockaddr_in addrs[NET_MAX_RECEIVE_BATCH];
+		char cmsgs[NET_MAX_RECEIVE_BATCH][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+		memset(msgs, 0, sizeof(msgs[0]) * count);
+		for (S32 i = 0; i < count; i++)
+		{
+			iovs[i].iov_base = packets[i].mData;
+			iovs[i].iov_len = NET_BUFFER_SIZE;
+			msgs[i].msg_hdr.msg_name = &addrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_control = cmsgs[i];
+			msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+		}
+
+		int received = recvmmsg(hSocket, msgs, count, MSG_DONTWAIT, NULL);
+		if (received >= 0)
+		{
+			for (S32 i = 0; i < received; i++)
+			{
+				LLNetPacket& packet = packets[i];
+				packet.mSize = msgs[i].msg_len;
+				packet.mSenderIP = addrs[i].sin_addr.s_addr;
+				packet.mSenderPort = ntohs(addrs[i].sin_port);
+				packet.mReceivingIP = INVALID_HOST_IP_ADDRESS;
+
+				struct msghdr* hdr = &msgs[i].msg_hdr;
+				for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(hdr, cmsgptr))
+				{
+					if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+					{
+						// same choice as recvfrom_destip()
+						packet.mReceivingIP = ((in_pktinfo*) CMSG_DATA(cmsgptr))->ipi_spec_dst.s_addr;
+					}
+				}
+			}
+
+			if (received > 0)
+			{
+				stSrcAddr = addrs[received - 1];
+				gsnReceivingIFAddr = packets[received - 1].mReceivingIP;
+			}
+			return received;
+		}
+
+		if (errno != ENOSYS)
+		{
+			// nothing waiting, or an error receive_packet() would also
+			// have turned into "no packet"
+			return 0;
+		}
+
+		llinfos << "recvmmsg() not available, receiving one packet at a time" << llendl;
+		sHaveRecvmmsg = false;
+	}
+#endif
+
+	S32 received = 0;
+	while (received < count)
+	{
+		LLNetPacket& packet = packets[received];
+		packet.mSize = receive_packet(hSocket, packet.mData);
+		if (packet.mSize <= 0)
+		{
+			break;
+		}
+		packet.mSenderIP = get_sender_ip();
+		packet.mSenderPort = get_sender_port();
+		packet.mReceivingIP = get_receiving_interface_ip();
+		received++;
+	}
+	return received;
+}
+
 const char* u32_to_ip_string(U32 ip)
 {
 	static char buffer[MAXADDRSTR];	 /* Flawfinder: ignore */ 
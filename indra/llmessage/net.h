@@ -43,6 +43,25 @@ void	end_net(S32& socket_out);
 // returns size of packet or -1 in case of error
 S32		receive_packet(int hSocket, char * receiveBuffer);
 
+// A datagram for receive_packets().  The caller points mData at a buffer
+// of NET_BUFFER_SIZE bytes, the rest is filled in.
+struct LLNetPacket
+{
+	char*	mData;
+	S32		mSize;
+	U32		mSenderIP;
+	U32		mSenderPort;
+	U32		mReceivingIP;
+};
+
+const S32 NET_MAX_RECEIVE_BATCH = 64;
+
+// Receives up to count (at most NET_MAX_RECEIVE_BATCH) waiting datagrams
+// straight into their buffers, with a single recvmmsg() call on Linux.
+// Returns how many were received, 0 if none were waiting.  get_sender()
+// and get_receiving_interface() describe the last one.
+S32		receive_packets(int hSocket, LLNetPacket* packets, S32 count);
+
 BOOL	send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);	// Returns TRUE on success.
 
 //void	get_sender(char * tmp);
@@ -0,0 +1,183 @@
+/**
+ * @file llpacketring_test.cpp
+ * @date 2011-08-29
+ * @brief Tests for LLPacketRing's batched receive.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketring.h"
+#include "llmetricbenchmark.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// Sends count packets from the socket to itself, each filled with its index.
+	void send_to_self(S32 socket, S32 port, S32 count, S32 size)
+	{
+		char data[NET_BUFFER_SIZE];		/* Flawfinder : ignore */
+		U32 loopback = ip_string_to_u32("127.0.0.1");
+		for (S32 i = 0; i < count; i++)
+		{
+			memset(data, i & 0xff, size);
+			send_packet(socket, data, size, loopback, port);
+		}
+	}
+
+	// Counts the packets the ring hands back until the socket is empty.
+	S32 drain(LLPacketRing& ring, S32 socket)
+	{
+		S32 received = 0;
+		char* data = NULL;
+		while (ring.receivePacketInPlace(socket, &data) > 0)
+		{
+			received++;
+		}
+		return received;
+	}
+
+	// Receives a sim's worth of small packets, RECEIVE_BATCH_SIZE at a time.
+	class ReceiveBenchmark : public LLMetricBenchmark
+	{
+	public:
+		ReceiveBenchmark(const std::string& name) :
+			LLMetricBenchmark(name, LLPacketRing::RECEIVE_BATCH_SIZE),
+			mSocket(0),
+			mPort(NET_USE_OS_ASSIGNED_PORT)
+		{
+		}
+
+		virtual void setup()
+		{
+			start_net(mSocket, mPort);
+		}
+
+		virtual void run(U32 iterations)
+		{
+			send_to_self(mSocket, mPort, iterations, 200);
+			drain(mRing, mSocket);
+		}
+
+		virtual void teardown()
+		{
+			end_net(mSocket);
+		}
+
+	private:
+		LLPacketRing mRing;
+		S32 mSocket;
+		S32 mPort;
+	};
+
+	LLMetricBenchmark::Registrar<ReceiveBenchmark> sReceiveRegistrar("packet_receive");
+}
+
+namespace tut
+{
+	struct packetring_data
+	{
+		packetring_data() :
+			mSocket(0),
+			mPort(NET_USE_OS_ASSIGNED_PORT)
+		{
+			mStarted = (start_net(mSocket, mPort) == 0);
+		}
+
+		~packetring_data()
+		{
+			if (mStarted)
+			{
+				end_net(mSocket);
+			}
+		}
+
+		S32 mSocket;
+		S32 mPort;
+		bool mStarted;
+	};
+	typedef test_group<packetring_data> packetring_test;
+	typedef packetring_test::object packetring_object;
+	tut::packetring_test packetring_testcase("LLPacketRing");
+
+	// Packets come back in order, intact, and from the right sender.
+	template<> template<>
+	void packetring_object::test<1>()
+	{
+		ensure("socket", mStarted);
+
+		const S32 count = LLPacketRing::RECEIVE_BATCH_SIZE * 3 + 5;
+		send_to_self(mSocket, mPort, count, 100);
+
+		LLPacketRing ring;
+		char* data = NULL;
+		for (S32 i = 0; i < count; i++)
+		{
+			ensure_equals("size", ring.receivePacketInPlace(mSocket, &data), 100);
+			ensure_equals("first byte", (U8)data[0], (U8)i);
+			ensure_equals("last byte", (U8)data[99], (U8)i);
+			ensure_equals("sender port", (S32)ring.getLastSender().getPort(), mPort);
+		}
+		ensure_equals("empty", ring.receivePacketInPlace(mSocket, &data), 0);
+		ensure_equals("counted", ring.getBatchedPacketsIn(), (U64)count);
+#if LL_LINUX
+		ensure("batched", ring.getReceiveCalls() < (U64)count);
+#endif
+	}
+
+	// The copying receive sees the same packets.
+	template<> template<>
+	void packetring_object::test<2>()
+	{
+		ensure("socket", mStarted);
+
+		send_to_self(mSocket, mPort, 3, 40);
+
+		LLPacketRing ring;
+		char data[NET_BUFFER_SIZE];		/* Flawfinder : ignore */
+		for (S32 i = 0; i < 3; i++)
+		{
+			ensure_equals("size", ring.receivePacket(mSocket, data), 40);
+			ensure_equals("contents", (U8)data[39], (U8)i);
+		}
+		ensure_equals("empty", ring.receivePacket(mSocket, data), 0);
+	}
+
+	// Dropped packets are still read off the socket.
+	template<> template<>
+	void packetring_object::test<3>()
+	{
+		ensure("socket", mStarted);
+
+		send_to_self(mSocket, mPort, 4, 10);
+
+		LLPacketRing ring;
+		ring.dropPackets(2);
+		char* data = NULL;
+		ensure_equals("dropped", ring.receivePacketInPlace(mSocket, &data), 0);
+		ensure_equals("dropped", ring.receivePacketInPlace(mSocket, &data), 0);
+		ensure_equals("kept", ring.receivePacketInPlace(mSocket, &data), 10);
+		ensure_equals("kept", (U8)data[0], (U8)2);
+	}
+}
@@ -0,0 +1,419 @@
+/**
+ * @file llzerocode_test.cpp
+ * @date 2011-09-02
+ * @brief Tests for zero-coding of message bodies.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llzerocode.h"
+#include "../net.h"
+#include "llmetricbenchmark.h"
+
+#include "../test/lltut.h"
+
+#include <vector>
+
+namespace
+{
+	typedef std::vector<U8> bytes_t;
+
+	// The byte at a time encoder LLTemplateMessageBuilder used before.
+	S32 bytewise_zero_code(const U8* inptr, S32 count, U8* out)
+	{
+		U8* outptr = out;
+		U8 num_zeroes = 0;
+		while (count--)
+		{
+			if (!(*inptr))
+			{
+				if (num_zeroes)
+				{
+					if (++num_zeroes > 254)
+					{
+						*outptr++ = num_zeroes;
+						num_zeroes = 0;
+					}
+				}
+				else
+				{
+					*outptr++ = 0;
+					num_zeroes = 1;
+				}
+				inptr++;
+			}
+			else
+			{
+				if (num_zeroes)
+				{
+					*outptr++ = num_zeroes;
+					num_zeroes = 0;
+				}
+				*outptr++ = *inptr++;
+			}
+		}
+		if (num_zeroes)
+		{
+			*outptr++ = num_zeroes;
+		}
+		return (S32)(outptr - out);
+	}
+
+	// The byte at a time expansion LLMessageSystem used before, without
+	// its buffer size checks.
+	S32 bytewise_zero_code_expand(const U8* inptr, S32 count, U8* out)
+	{
+		U8* outptr = out;
+		while (count--)
+		{
+			if (!((*outptr++ = *inptr++)))
+			{
+				while ((count--) && (!(*inptr)))
+				{
+					*outptr++ = *inptr++;
+					memset(outptr, 0, 255);
+					outptr += 255;
+				}
+				if (count < 0)
+				{
+					break;
+				}
+				memset(outptr, 0, (*inptr) - 1);
+				outptr += ((*inptr) - 1);
+				inptr++;
+			}
+		}
+		return (S32)(outptr - out);
+	}
+
+	bytes_t bytewise_zero_code(const bytes_t& in)
+	{
+		bytes_t out(2 * in.size() + 1);
+		out.resize(bytewise_zero_code(in.empty() ? NULL : &in[0], (S32)in.size(), &out[0]));
+		return out;
+	}
+
+	bytes_t bytewise_zero_code_expand(const bytes_t& in)
+	{
+		bytes_t out(256 * in.size() + 1);
+		out.resize(bytewise_zero_code_expand(in.empty() ? NULL : &in[0], (S32)in.size(), &out[0]));
+		return out;
+	}
+
+	bytes_t zero_code(const bytes_t& in)
+	{
+		bytes_t out(2 * in.size() + 1);
+		out.resize(ll_zero_code(in.empty() ? NULL : &in[0], (S32)in.size(), &out[0]));
+		return out;
+	}
+
+	bytes_t zero_code_expand(const bytes_t& in, size_t capacity)
+	{
+		bytes_t out(capacity + 1);
+		S32 size = ll_zero_code_expand(in.empty() ? NULL : &in[0], (S32)in.size(), &out[0], (S32)out.size());
+		out.resize(llmax(size, 0));
+		return out;
+	}
+
+	// Appends size bytes of value, or of non-zero noise when value is -1.
+	void append(bytes_t& packet, U32& seed, S32 size, S32 value = -1)
+	{
+		for (S32 i = 0; i < size; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			packet.push_back(value < 0 ? (U8)((seed >> 16) | 1) : (U8)value);
+		}
+	}
+
+	// Builds bodies shaped like the ObjectUpdate packets a busy region
+	// sends: ids and UUIDs of noise, quantized floats with zero bytes
+	// mixed in, and the long zero runs of unused shape, texture and
+	// extra parameter fields.
+	std::vector<bytes_t> object_update_bodies(S32 count)
+	{
+		std::vector<bytes_t> bodies;
+		U32 seed = 1;
+		for (S32 i = 0; i < count; i++)
+		{
+			bytes_t body;
+			append(body, seed, 8);					// RegionHandle
+			append(body, seed, 2, 0xff);			// TimeDilation
+			S32 objects = 1 + i % 4;
+			body.push_back((U8)objects);
+			for (S32 j = 0; j < objects; j++)
+			{
+				append(body, seed, 4);				// ID
+				append(body, seed, 1, 0);			// State
+				append(body, seed, 16);				// FullID
+				append(body, seed, 4);				// CRC
+				append(body, seed, 3, 0);			// PCode, Material, ClickAction
+				append(body, seed, 12);				// Scale
+				body.push_back(60);					// ObjectData
+				append(body, seed, 12);
+				append(body, seed, 36, 0);
+				append(body, seed, 12);
+				append(body, seed, 4, 0);			// ParentID
+				append(body, seed, 4);				// UpdateFlags
+				append(body, seed, 1, 0x10);		// PathCurve
+				append(body, seed, 22, 0);			// Path and profile params
+				body.push_back(0);
+				body.push_back(40);					// TextureEntry
+				append(body, seed, 16);
+				append(body, seed, 22, 0);
+				append(body, seed, 2);
+				append(body, seed, 5, 0);			// TextureAnim, NameValue, Data, Text
+				append(body, seed, 4, 0);			// TextColor
+				append(body, seed, 3, 0);			// MediaURL, PSBlock, ExtraParams
+				append(body, seed, 16, 0);			// Sound
+				append(body, seed, 16);				// OwnerID
+				append(body, seed, 9, 0);			// Gain, Flags, Radius
+				append(body, seed, 1, 0);			// JointType
+				append(body, seed, 24, 0);			// JointPivot, JointAxisOrAnchor
+			}
+			bodies.push_back(body);
+		}
+		return bodies;
+	}
+
+	const S32 BENCHMARK_PACKETS = 256;
+
+	// Expands a region's worth of encoded object updates.
+	class ExpandBenchmark : public LLMetricBenchmark
+	{
+	public:
+		ExpandBenchmark(const std::string& name, bool bytewise = false) :
+			LLMetricBenchmark(name, BENCHMARK_PACKETS),
+			mBytewise(bytewise),
+			mOut(NET_BUFFER_SIZE)
+		{
+		}
+
+		virtual void setup()
+		{
+			std::vector<bytes_t> bodies = object_update_bodies(BENCHMARK_PACKETS);
+			for (size_t i = 0; i < bodies.size(); i++)
+			{
+				mEncoded.push_back(zero_code(bodies[i]));
+			}
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; i++)
+			{
+				const bytes_t& encoded = mEncoded[i % mEncoded.size()];
+				if (mBytewise)
+				{
+					bytewise_zero_code_expand(&encoded[0], (S32)encoded.size(), &mOut[0]);
+				}
+				else
+				{
+					ll_zero_code_expand(&encoded[0], (S32)encoded.size(), &mOut[0], (S32)mOut.size());
+				}
+			}
+		}
+
+	private:
+		bool mBytewise;
+		std::vector<bytes_t> mEncoded;
+		bytes_t mOut;
+	};
+
+	class BytewiseExpandBenchmark : public ExpandBenchmark
+	{
+	public:
+		BytewiseExpandBenchmark(const std::string& name) :
+			ExpandBenchmark(name, true)
+		{
+		}
+	};
+
+	// Encodes the same object updates.
+	class EncodeBenchmark : public LLMetricBenchmark
+	{
+	public:
+		EncodeBenchmark(const std::string& name, bool bytewise = false) :
+			LLMetricBenchmark(name, BENCHMARK_PACKETS),
+			mBytewise(bytewise),
+			mOut(2 * NET_BUFFER_SIZE)
+		{
+		}
+
+		virtual void setup()
+		{
+			mBodies = object_update_bodies(BENCHMARK_PACKETS);
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; i++)
+			{
+				const bytes_t& body = mBodies[i % mBodies.size()];
+				if (mBytewise)
+				{
+					bytewise_zero_code(&body[0], (S32)body.size(), &mOut[0]);
+				}
+				else
+				{
+					ll_zero_code(&body[0], (S32)body.size(), &mOut[0]);
+				}
+			}
+		}
+
+	private:
+		bool mBytewise;
+		std::vector<bytes_t> mBodies;
+		bytes_t mOut;
+	};
+
+	class BytewiseEncodeBenchmark : public EncodeBenchmark
+	{
+	public:
+		BytewiseEncodeBenchmark(const std::string& name) :
+			EncodeBenchmark(name, true)
+		{
+		}
+	};
+
+	LLMetricBenchmark::Registrar<ExpandBenchmark> sExpandRegistrar("zerocode_expand");
+	LLMetricBenchmark::Registrar<BytewiseExpandBenchmark> sBytewiseExpandRegistrar("zerocode_expand_bytewise");
+	LLMetricBenchmark::Registrar<EncodeBenchmark> sEncodeRegistrar("zerocode_encode");
+	LLMetricBenchmark::Registrar<BytewiseEncodeBenchmark> sBytewiseEncodeRegistrar("zerocode_encode_bytewise");
+}
+
+namespace tut
+{
+	struct zerocode_data
+	{
+		// Checks in against the byte at a time versions, and that it
+		// survives the round trip.
+		void check_round_trip(const bytes_t& in)
+		{
+			bytes_t encoded = zero_code(in);
+			ensure("encoding", encoded == bytewise_zero_code(in));
+			ensure_equals("encoded size", ll_zero_code_size(in.empty() ? NULL : &in[0], (S32)in.size()),
+						  (S32)encoded.size());
+			ensure("expansion", zero_code_expand(encoded, in.size()) == in);
+		}
+	};
+	typedef test_group<zerocode_data> zerocode_test;
+	typedef zerocode_test::object zerocode_object;
+	tut::zerocode_test zerocode_testcase("LLZeroCode");
+
+	// Every pattern of zero and non-zero bytes up to 16 long, which
+	// covers each way a zero can fall across an SSE block.
+	template<> template<>
+	void zerocode_object::test<1>()
+	{
+		for (S32 size = 0; size <= 16; size++)
+		{
+			for (U32 pattern = 0; pattern < (1U << size); pattern++)
+			{
+				bytes_t in(size);
+				for (S32 i = 0; i < size; i++)
+				{
+					in[i] = (pattern & (1U << i)) ? (U8)(i * 37 + 1) : 0;
+				}
+				check_round_trip(in);
+			}
+		}
+	}
+
+	// Zero runs of every length up to well past the 255 split, at
+	// every offset into a block, between runs of non-zero bytes.
+	template<> template<>
+	void zerocode_object::test<2>()
+	{
+		for (S32 offset = 0; offset < 33; offset++)
+		{
+			for (S32 run = 0; run <= 1100; run++)
+			{
+				bytes_t in(offset, 0xff);
+				in.insert(in.end(), run, 0);
+				in.insert(in.end(), 17, 0x80);
+				check_round_trip(in);
+				in.resize(offset + run);
+				check_round_trip(in);
+			}
+		}
+	}
+
+	// Every two byte encoded input, and every four byte one built
+	// from the values that matter, expand the same as before.  This
+	// covers the 0 0 [count] wrap, which the encoder never produces.
+	template<> template<>
+	void zerocode_object::test<3>()
+	{
+		for (U32 a = 0; a < 256; a++)
+		{
+			for (U32 b = 0; b < 256; b++)
+			{
+				bytes_t in;
+				in.push_back((U8)a);
+				in.push_back((U8)b);
+				ensure("two bytes", zero_code_expand(in, 256 * in.size()) == bytewise_zero_code_expand(in));
+			}
+		}
+
+		const U8 values[] = { 0, 1, 2, 127, 254, 255 };
+		const S32 count = LL_ARRAY_SIZE(values);
+		for (S32 a = 0; a < count; a++)
+		{
+			for (S32 b = 0; b < count; b++)
+			{
+				for (S32 c = 0; c < count; c++)
+				{
+					for (S32 d = 0; d < count; d++)
+					{
+						bytes_t in;
+						in.push_back(values[a]);
+						in.push_back(values[b]);
+						in.push_back(values[c]);
+						in.push_back(values[d]);
+						ensure("four bytes", zero_code_expand(in, 256 * in.size()) == bytewise_zero_code_expand(in));
+					}
+				}
+			}
+		}
+	}
+
+	// Object updates round trip, and expansion stops rather than
+	// writing past the end of the buffer.
+	template<> template<>
+	void zerocode_object::test<4>()
+	{
+		std::vector<bytes_t> bodies = object_update_bodies(64);
+		for (size_t i = 0; i < bodies.size(); i++)
+		{
+			check_round_trip(bodies[i]);
+
+			bytes_t encoded = zero_code(bodies[i]);
+			bytes_t out(bodies[i].size());
+			ensure_equals("exact fit", ll_zero_code_expand(&encoded[0], (S32)encoded.size(), &out[0], (S32)out.size()),
+						  (S32)out.size());
+			ensure_equals("one short", ll_zero_code_expand(&encoded[0], (S32)encoded.size(), &out[0], (S32)out.size() - 1),
+						  -1);
+		}
+	}
+}
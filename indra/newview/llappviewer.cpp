@@ -648,6 +648,7 @@ bool LLAppViewer::init()
 	}
 
     mAlloc.setProfilingEnabled(gSavedSettings.getBOOL("MemProfiling"));
+	LLAllocatorSampler::setSampleInterval(gSavedSettings.getU32("MemSampleInterval"));
 
     // *NOTE:Mani - LLCurl::initClass is not thread safe. 
     // Called before threads are created.
@@ -1010,6 +1011,9 @@ bool LLAppViewer::mainLoop()
 	{
 		LLFastTimer::nextFrame(); // Should be outside of any timer instances
 
+		// Nothing allocated from the frame arena survives the frame
+		gFrameArena.reset();
+
 		//clear call stack records
 		llclearcallstacks;
 
@@ -1736,6 +1740,9 @@ bool LLAppViewer::cleanup()
 
     llinfos << "Goodbye!" << llendflush;
 
+	// Write out anything still queued while APR is still around.
+	LLError::setAsyncLogging(false);
+
 	// return 0;
 	return true;
 }
@@ -1771,11 +1778,19 @@ bool LLAppViewer::initThreads()
 	LLLFSThread::initClass(enable_threads && false);
 
 	// Image decoding
-	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
+	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true,
+															  llclamp(gSavedSettings.getU32("ImageDecodeThreads"), (U32)1, (U32)16));
 	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
 	LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(), sImageDecodeThread, enable_threads && true);
 	LLImage::initClass();
 
+	// Volume generation on LOD changes
+	U32 volume_build_threads = llmin(gSavedSettings.getU32("VolumeBuildThreads"), (U32)16);
+	if (enable_threads && volume_build_threads)
+	{
+		LLPrimitive::getVolumeManager()->startBuildThread(volume_build_threads);
+	}
+
 	if (LLFastTimer::sLog || LLFastTimer::sMetricLog)
 	{
 		LLFastTimer::sLogLock = new LLMutex(NULL);
@@ -1822,6 +1837,9 @@ bool LLAppViewer::initLogging()
 
 	LLError::logToFile(log_file);
 
+	// Keep file and console output off the main and worker threads.
+	LLError::setAsyncLogging(true);
+
 	// *FIX:Mani no error handling here!
 	return true;
 }
@@ -2294,6 +2312,7 @@ bool LLAppViewer::initConfiguration()
 	//LLVolumeMgr::initClass();
 	LLVolumeMgr* volume_manager = new LLVolumeMgr();
 	volume_manager->useMutex();	// LLApp and LLMutex magic must be manually enabled
+	volume_manager->setCacheBudget(llmin(gSavedSettings.getU32("VolumeCacheMemory"), VOLUME_CACHE_MAX_MB) << 20);
 	LLPrimitive::setVolumeManager(volume_manager);
 
 	// Note: this is where we used to initialize gFeatureManagerp.
@@ -2713,6 +2732,7 @@ void LLAppViewer::handleViewerCrash()
 
 	//print out recorded call stacks if there are any.
 	LLError::LLCallStacks::print();
+	LLError::flushAsyncLog();
 
 	LLAppViewer* pApp = LLAppViewer::instance();
 	if (pApp->beingDebugged())
@@ -30,6 +30,7 @@
 
 // Library includes
 #include "llerror.h"
+#include "llframetimer.h"
 
 
 //
@@ -48,6 +49,7 @@ LLCallbackList::LLCallbackList()
 
 LLCallbackList::~LLCallbackList()
 {
+	deleteAllFunctions();
 }
 
 
@@ -62,18 +64,43 @@ void LLCallbackList::addFunction( callback_t func, void *data)
 	// only add one callback per func/data pair
 	callback_pair_t t(func, data);
 	callback_list_t::iterator iter = std::find(mCallbackList.begin(), mCallbackList.end(), t);
-	if (iter == mCallbackList.end())
+	if (iter == mCallbackList.end() && mPeriodicCallbacks.find(t) == mPeriodicCallbacks.end())
 	{
 		mCallbackList.push_back(t);
 	}
 }
 
 
+void LLCallbackList::addFunction( callback_t func, void *data, F32 period)
+{
+	if (period <= 0.f)
+	{
+		addFunction(func, data);
+		return;
+	}
+	if (!func)
+	{
+		llerrs << "LLCallbackList::addFunction - function is NULL" << llendl;
+		return;
+	}
+
+	// only add one callback per func/data pair
+	if (containsFunction(func, data))
+	{
+		return;
+	}
+	callback_pair_t t(func, data);
+	PeriodicCallback* callback = new PeriodicCallback(t, llmax((U64)(period * 1000.f), (U64)1));
+	mPeriodicCallbacks[t] = callback;
+	mPeriodicWheel.schedule(callback, getCurrentTick() + callback->mPeriod);
+}
+
+
 BOOL LLCallbackList::containsFunction( callback_t func, void *data)
 {
 	callback_pair_t t(func, data);
 	callback_list_t::iterator iter = std::find(mCallbackList.begin(), mCallbackList.end(), t);
-	if (iter != mCallbackList.end())
+	if (iter != mCallbackList.end() || mPeriodicCallbacks.find(t) != mPeriodicCallbacks.end())
 	{
 		return TRUE;
 	}
@@ -93,6 +120,15 @@ BOOL LLCallbackList::deleteFunction( callback_t func, void *data)
 		mCallbackList.erase(iter);
 		return TRUE;
 	}
+
+	periodic_map_t::iterator periodic_iter = mPeriodicCallbacks.find(t);
+	if (periodic_iter != mPeriodicCallbacks.end())
+	{
+		// also takes it out of the wheel, or out of callFunctions()' expired list
+		delete periodic_iter->second;
+		mPeriodicCallbacks.erase(periodic_iter);
+		return TRUE;
+	}
 	else
 	{
 		return FALSE;
@@ -103,6 +139,8 @@ BOOL LLCallbackList::deleteFunction( callback_t func, void *data)
 void LLCallbackList::deleteAllFunctions()
 {
 	mCallbackList.clear();
+	std::for_each(mPeriodicCallbacks.begin(), mPeriodicCallbacks.end(), DeletePairedPointer());
+	mPeriodicCallbacks.clear();
 }
 
 
@@ -113,6 +151,24 @@ void LLCallbackList::callFunctions()
 		callback_list_t::iterator curiter = iter++;
 		curiter->first(curiter->second);
 	}
+
+	LLTimingWheel::EntryList expired;
+	mPeriodicWheel.advance(getCurrentTick(), expired);
+	while (!expired.empty())
+	{
+		PeriodicCallback* callback = static_cast<PeriodicCallback*>(expired.popFront());
+		// reschedule first, the callback may delete itself
+		mPeriodicWheel.schedule(callback, mPeriodicWheel.getCurrentTick() + callback->mPeriod);
+		callback_pair_t t = callback->mCallback;
+		t.first(t.second);
+	}
+}
+
+//static
+U64 LLCallbackList::getCurrentTick()
+{
+	// milliseconds of frame time, so a callback keeps its cadence within a frame
+	return (U64)(LLFrameTimer::getElapsedSeconds() * 1000.0);
 }
 
 #ifdef _DEBUG
@@ -28,6 +28,7 @@
 #define LL_LLCALLBACKLIST_H
 
 #include "llstl.h"
+#include "lltimingwheel.h"
 
 class LLCallbackList
 {
@@ -38,6 +39,7 @@ public:
 	~LLCallbackList();
 
 	void addFunction( callback_t func, void *data = NULL );		// register a callback, which will be called as func(data)
+	void addFunction( callback_t func, void *data, F32 period );	// as above, but only called about every period seconds
 	BOOL containsFunction( callback_t func, void *data = NULL );	// true if list already contains the function/data pair
 	BOOL deleteFunction( callback_t func, void *data = NULL );		// removes the first instance of this function/data pair from the list, false if not found
 	void callFunctions();												// calls all functions
@@ -50,6 +52,22 @@ protected:
 	typedef std::pair<callback_t,void*> callback_pair_t;
 	typedef std::list<callback_pair_t > callback_list_t;
 	callback_list_t	mCallbackList;
+
+	// Callbacks with a period wait in a timing wheel until they are due, so
+	// callFunctions() does not touch the ones that are not.
+	class PeriodicCallback : public LLTimingWheel::Entry
+	{
+	public:
+		PeriodicCallback(const callback_pair_t& callback, U64 period)
+			: mCallback(callback), mPeriod(period) {}
+		callback_pair_t mCallback;
+		U64 mPeriod;	// milliseconds
+	};
+	typedef std::map<callback_pair_t, PeriodicCallback*> periodic_map_t;
+	periodic_map_t mPeriodicCallbacks;
+	LLTimingWheel mPeriodicWheel;
+
+	static U64 getCurrentTick();
 };
 
 extern LLCallbackList gIdleCallbacks;
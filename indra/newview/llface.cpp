@@ -32,6 +32,7 @@
 
 #include "llviewercontrol.h"
 #include "llvolume.h"
+#include "llmatrix4a.h"
 #include "m3math.h"
 #include "v3color.h"
 
@@ -755,8 +756,8 @@ void LLFace::getPlanarProjectedParams(LLQuaternion* face_rot, LLVector3* face_po
 {
 	const LLMatrix4& vol_mat = getWorldMatrix();
 	const LLVolumeFace& vf = getViewerObject()->getVolume()->getVolumeFace(mTEOffset);
-	LLVector3 normal = vf.mVertices[0].mNormal;
-	LLVector3 binormal = vf.mVertices[0].mBinormal;
+	LLVector3 normal = vf.mNormals[0].getVector3();
+	LLVector3 binormal = vf.mBinormals[0].getVector3();
 	LLVector2 projected_binormal;
 	planarProjection(projected_binormal, normal, vf.mCenter, binormal);
 	projected_binormal -= LLVector2(0.5f, 0.5f); // this normally happens in xform()
@@ -874,7 +875,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 {
 	LLFastTimer t(FTM_FACE_GET_GEOM);
 	const LLVolumeFace &vf = volume.getVolumeFace(f);
-	S32 num_vertices = (S32)vf.mVertices.size();
+	S32 num_vertices = vf.mNumVertices;
 	S32 num_indices = LLPipeline::sUseTriStrips ? (S32)vf.mTriStrip.size() : (S32) vf.mIndices.size();
 	
 	if (mVertexBuffer.notNull())
@@ -1150,28 +1151,29 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		mVObjp->getVolume()->genBinormals(f);
 	}
 
-	for (S32 i = 0; i < num_vertices; i++)
+	if (rebuild_tcoord)
 	{
-		if (rebuild_tcoord)
+		for (S32 i = 0; i < num_vertices; i++)
 		{
-			LLVector2 tc = vf.mVertices[i].mTexCoord;
+			LLVector2 tc = vf.mTexCoords[i];
 		
 			if (texgen != LLTextureEntry::TEX_GEN_DEFAULT)
 			{
-				LLVector3 vec = vf.mVertices[i].mPosition; 
+				LLVector3 vec = vf.mPositions[i].getVector3(); 
+				LLVector3 normal = vf.mNormals[i].getVector3();
 			
 				vec.scaleVec(scale);
 
 				switch (texgen)
 				{
 					case LLTextureEntry::TEX_GEN_PLANAR:
-						planarProjection(tc, vf.mVertices[i].mNormal, vf.mCenter, vec);
+						planarProjection(tc, normal, vf.mCenter, vec);
 						break;
 					case LLTextureEntry::TEX_GEN_SPHERICAL:
-						sphericalProjection(tc, vf.mVertices[i].mNormal, vf.mCenter, vec);
+						sphericalProjection(tc, normal, vf.mCenter, vec);
 						break;
 					case LLTextureEntry::TEX_GEN_CYLINDRICAL:
-						cylindricalProjection(tc, vf.mVertices[i].mNormal, vf.mCenter, vec);
+						cylindricalProjection(tc, normal, vf.mCenter, vec);
 						break;
 					default:
 						break;
@@ -1281,10 +1283,12 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		
 			if (bump_code && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1))
 			{
-				LLVector3 tangent = vf.mVertices[i].mBinormal % vf.mVertices[i].mNormal;
+				LLVector3 vf_binormal = vf.mBinormals[i].getVector3();
+				LLVector3 vf_normal = vf.mNormals[i].getVector3();
+				LLVector3 tangent = vf_binormal % vf_normal;
 
 				LLMatrix3 tangent_to_object;
-				tangent_to_object.setRows(tangent, vf.mVertices[i].mBinormal, vf.mVertices[i].mNormal);
+				tangent_to_object.setRows(tangent, vf_binormal, vf_normal);
 				LLVector3 binormal = binormal_dir * tangent_to_object;
 				binormal = binormal * mat_normal;
 				
@@ -1299,30 +1303,35 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				*tex_coords2++ = tc;
 			}	
 		}
-			
-		if (rebuild_pos)
-		{
-			*vertices++ = vf.mVertices[i].mPosition * mat_vert;
-		}
-		
+	}
+
+	// positions, normals and binormals are separate aligned arrays, so they
+	// go through the batch transforms straight into the strided buffer
+	if (rebuild_pos)
+	{
+		LLMatrix4a mat_vert_a(mat_vert);
+		mat_vert_a.affineTransform(vf.mPositions, vertices.get()->mV, vertices.getSkip(), num_vertices);
+	}
+
+	if (rebuild_normal || rebuild_binormal)
+	{
+		LLMatrix4a mat_normal_a;
+		mat_normal_a.loadu(mat_normal);
 		if (rebuild_normal)
 		{
-			LLVector3 normal = vf.mVertices[i].mNormal * mat_normal;
-			normal.normVec();
-			
-			*normals++ = normal;
+			mat_normal_a.rotateNormals(vf.mNormals, normals.get()->mV, normals.getSkip(), num_vertices);
 		}
-		
 		if (rebuild_binormal)
 		{
-			LLVector3 binormal = vf.mVertices[i].mBinormal * mat_normal;
-			binormal.normVec();
-			*binormals++ = binormal;
+			mat_normal_a.rotateNormals(vf.mBinormals, binormals.get()->mV, binormals.getSkip(), num_vertices);
 		}
-		
-		if (rebuild_color)
+	}
+
+	if (rebuild_color)
+	{
+		for (S32 i = 0; i < num_vertices; i++)
 		{
-			*colors++ = color;		
+			*colors++ = color;
 		}
 	}
 
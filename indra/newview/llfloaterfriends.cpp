@@ -128,7 +128,7 @@ LLPanelFriends::~LLPanelFriends()
 BOOL LLPanelFriends::tick()
 {
 	mEventTimer.stop();
-	mPeriod = DEFAULT_PERIOD;
+	setPeriod(DEFAULT_PERIOD);
 	mAllowRightsChange = TRUE;
 	updateFriends(LLFriendObserver::ADD);
 	return FALSE;
@@ -156,7 +156,7 @@ void LLPanelFriends::updateFriends(U32 changed_mask)
 		--mNumRightsChanged;
 		if(mNumRightsChanged > 0)
 		{
-			mPeriod = RIGHTS_CHANGE_TIMEOUT;	
+			setPeriod(RIGHTS_CHANGE_TIMEOUT);
 			mEventTimer.start();
 			mAllowRightsChange = FALSE;
 		}
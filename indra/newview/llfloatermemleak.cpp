@@ -34,6 +34,7 @@
 #include "llresmgr.h"
 
 #include "llmath.h"
+#include "llmemoryview.h"
 #include "llviewerwindow.h"
 
 U32 LLFloaterMemLeak::sMemLeakingSpeed = 0 ; //bytes leaked per frame
@@ -52,6 +53,8 @@ LLFloaterMemLeak::LLFloaterMemLeak(const LLSD& key)
 	mCommitCallbackRegistrar.add("MemLeak.Stop",	boost::bind(&LLFloaterMemLeak::onClickStop, this));
 	mCommitCallbackRegistrar.add("MemLeak.Release",	boost::bind(&LLFloaterMemLeak::onClickRelease, this));
 	mCommitCallbackRegistrar.add("MemLeak.Close",	boost::bind(&LLFloaterMemLeak::onClickClose, this));
+	mCommitCallbackRegistrar.add("MemLeak.HeapBaseline",	boost::bind(&LLFloaterMemLeak::onClickHeapBaseline, this));
+	mCommitCallbackRegistrar.add("MemLeak.HeapSnapshot",	boost::bind(&LLFloaterMemLeak::onClickHeapSnapshot, this));
 }
 //----------------------------------------------
 
@@ -193,6 +196,21 @@ void LLFloaterMemLeak::onClickClose()
 	setVisible(FALSE);
 }
 
+void LLFloaterMemLeak::onClickHeapBaseline()
+{
+	LLAllocatorSampler::markBaseline();
+	mHeapSampleTimer.setTimerExpirySec(0.f);
+}
+
+void LLFloaterMemLeak::onClickHeapSnapshot()
+{
+	std::string filename = LLMemoryView::writeHeapSamples();
+	if (!filename.empty())
+	{
+		llinfos << "Heap samples written to " << filename << llendl;
+	}
+}
+
 void LLFloaterMemLeak::draw()
 {
 	//show total memory leaked
@@ -218,5 +236,27 @@ void LLFloaterMemLeak::draw()
 		getChild<LLUICtrl>("note_label_2")->setTextArg("[NOTE2]", LLStringExplicit(""));
 	}
 
+	// symbolizing the top site isn't free, so only once a second
+	if (mHeapSampleTimer.hasExpired())
+	{
+		mHeapSampleTimer.reset();
+		mHeapSampleTimer.setTimerExpirySec(1.f);
+
+		std::string live = "-";
+		std::string top_site = LLAllocatorSampler::isSampling() ? "none" : "sampling is off (MemSampleInterval)";
+		if (LLAllocatorSampler::isSampling())
+		{
+			LLAllocatorSampler::sites_t sites;
+			LLAllocatorSampler::getSites(sites, 1);
+			live = llformat("%llu", (unsigned long long)(LLAllocatorSampler::getLiveSize() >> 20));
+			if (!sites.empty() && sites[0].mGrowth > 0)
+			{
+				top_site = LLMemoryView::getHeapSiteDescription(sites[0]);
+			}
+		}
+		getChild<LLUICtrl>("heap_sample_label")->setTextArg("[LIVE]", live);
+		getChild<LLUICtrl>("heap_sample_label")->setTextArg("[SITE]", top_site);
+	}
+
 	LLFloater::draw();
 }
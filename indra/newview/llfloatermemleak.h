@@ -28,6 +28,7 @@
 #define LL_LLFLOATERMEMLEAK_H
 
 #include "llfloater.h"
+#include "llframetimer.h"
 
 class LLFloaterMemLeak : public LLFloater
 {
@@ -44,6 +45,8 @@ public:
 	void onClickStop();
 	void onClickRelease();
 	void onClickClose();
+	void onClickHeapBaseline();
+	void onClickHeapSnapshot();
 
 public:
 	void idle() ;
@@ -70,6 +73,7 @@ private:
 	static BOOL sbAllocationFailed ;
 
 	std::vector<char*> mLeakedMem ;	
+	LLFrameTimer mHeapSampleTimer;
 };
 
 #endif // LL_LLFLOATERMEMLEAK_H
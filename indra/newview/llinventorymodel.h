@@ -33,6 +33,7 @@
 #include "llframetimer.h"
 #include "llhttpclient.h"
 #include "lluuid.h"
+#include "lluuidflatmap.h"
 #include "llpermissionsflags.h"
 #include "llstring.h"
 #include "llmd5.h"
@@ -145,8 +146,8 @@ private:
 	// the inventory using several different identifiers.
 	// mInventory member data is the 'master' list of inventory, and
 	// mCategoryMap and mItemMap store uuid->object mappings. 
-	typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
-	typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+	typedef LLUUIDFlatMap<LLPointer<LLViewerInventoryCategory> > cat_map_t;
+	typedef LLUUIDFlatMap<LLPointer<LLViewerInventoryItem> > item_map_t;
 	cat_map_t mCategoryMap;
 	item_map_t mItemMap;
 	// This last set of indices is used to map parents to children.
@@ -331,6 +331,8 @@ public:
 	//LLInventoryModelFetchDescendentsResponder() {};
 	void result(const LLSD& content);
 	void error(U32 status, const std::string& reason);
+	// Large replies: parse while downloading instead of in one frame.
+	bool streamLLSD() const { return true; }
 protected:
 	BOOL getIsRecursive(const LLUUID& cat_id) const;
 private:
@@ -30,7 +30,11 @@
 
 #include "llappviewer.h"
 #include "llallocator_heap_profile.h"
+#include "llallocator_sampler.h"
+#include "lldir.h"
 #include "llgl.h"						// LLGLSUIDefault
+#include "llprimitive.h"
+#include "llvolumemgr.h"
 #include "llviewerwindow.h"
 #include "llviewercontrol.h"
 
@@ -53,9 +57,12 @@ BOOL LLMemoryView::handleMouseDown(S32 x, S32 y, MASK mask)
 {
 	if (mask & MASK_SHIFT)
 	{
+		writeHeapSamples();
 	}
 	else if (mask & MASK_CONTROL)
 	{
+		LLAllocatorSampler::markBaseline();
+		refreshProfile();
 	}
 	else
 	{
@@ -74,6 +81,45 @@ BOOL LLMemoryView::handleHover(S32 x, S32 y, MASK mask)
 	return FALSE;
 }
 
+// static
+std::string LLMemoryView::writeHeapSamples()
+{
+	static S32 snapshot = 0;
+	if (!LLAllocatorSampler::isSampling())
+	{
+		return std::string();
+	}
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, llformat("heap_samples_%d.txt", ++snapshot));
+	return LLAllocatorSampler::writeSnapshot(filename) ? filename : std::string();
+}
+
+// static
+std::string LLMemoryView::getHeapSiteDescription(const LLAllocatorSampler::site& site)
+{
+	const U32 MAX_SHOWN_FRAMES = 3;
+
+	std::string desc = llformat("%+8lld KB %8llu KB  %s ", (long long)(site.mGrowth >> 10),
+								(unsigned long long)(site.mLiveSize >> 10),
+								site.mMemType < 0 ? "Unknown" : LLMemType::getNameFromID(site.mMemType));
+
+	// the innermost frames are the allocator itself
+	U32 shown = 0;
+	for (size_t i = 0; i < site.mTrace.size() && shown < MAX_SHOWN_FRAMES; ++i)
+	{
+		const std::string& frame = site.mTrace[i];
+		if (!shown && (frame.find("operator new") != std::string::npos
+					   || frame.find("_Znwm") != std::string::npos
+					   || frame.find("_Znam") != std::string::npos
+					   || frame.find("sampled_new") != std::string::npos))
+		{
+			continue;
+		}
+		desc += shown++ ? " < " : " ";
+		desc += frame;
+	}
+	return desc;
+}
+
 void LLMemoryView::refreshProfile()
 {
 	/*
@@ -92,6 +138,14 @@ void LLMemoryView::refreshProfile()
 
 	mLines.clear();
 
+	LLVolumeMgr* volume_manager = LLPrimitive::getVolumeManager();
+	if (volume_manager)
+	{
+		mLines.push_back(utf8string_to_wstring(llformat("Volume cache: %u KB of %u KB in %u volumes, %u hits, %u misses, %u evictions",
+			volume_manager->getCacheBytes() >> 10, volume_manager->getCacheBudget() >> 10, volume_manager->getCacheCount(),
+			volume_manager->getCacheHits(), volume_manager->getCacheMisses(), volume_manager->getCacheEvictions())));
+	}
+
  	if(mAlloc->isProfiling()) 
 	{
 		const LLAllocatorHeapProfile &prof = mAlloc->getProfile();
@@ -106,6 +160,23 @@ void LLMemoryView::refreshProfile()
 			mLines.push_back(utf8string_to_wstring(ss.str()));
 		}
 	}
+
+	if (LLAllocatorSampler::isSampling())
+	{
+		const U32 MAX_SITES = 40;
+
+		mLines.push_back(utf8string_to_wstring(llformat("Heap samples: %llu MB live in %u sites, one sample per %u KB (ctrl-click: new baseline, shift-click: snapshot)",
+			(unsigned long long)(LLAllocatorSampler::getLiveSize() >> 20), LLAllocatorSampler::getSiteCount(),
+			LLAllocatorSampler::getSampleInterval() >> 10)));
+		mLines.push_back(utf8string_to_wstring(std::string("  Growth     Live     Type  Stack")));
+
+		LLAllocatorSampler::sites_t sites;
+		LLAllocatorSampler::getSites(sites, MAX_SITES);
+		for (size_t i = 0; i < sites.size(); ++i)
+		{
+			mLines.push_back(utf8string_to_wstring(getHeapSiteDescription(sites[i])));
+		}
+	}
 }
 
 void LLMemoryView::draw()
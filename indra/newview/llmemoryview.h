@@ -28,6 +28,7 @@
 #define LL_LLMEMORYVIEW_H
 
 #include "llview.h"
+#include "llallocator_sampler.h"
 
 class LLAllocator;
 
@@ -52,6 +53,11 @@ public:
 
 	void refreshProfile();
 
+	// Writes the heap sampler's sites to a numbered file in the log
+	// directory, returning its name, or an empty string on failure.
+	static std::string writeHeapSamples();
+	static std::string getHeapSiteDescription(const LLAllocatorSampler::site& site);
+
 private:
     std::vector<LLWString> mLines;
 	LLAllocator* mAlloc;
@@ -54,6 +54,9 @@
 
 static LLRegisterPanelClassWrapper<LLPanelPlaceProfile> t_place_profile("panel_place_profile");
 
+// Seconds between checks whether the agent is still at the selected place
+const F32 YOU_ARE_HERE_UPDATE_PERIOD = 0.5f;
+
 // Statics for textures filenames
 static std::string icon_pg;
 static std::string icon_m;
@@ -92,7 +95,7 @@ BOOL LLPanelPlaceProfile::postBuild()
 
 	mForSalePanel = getChild<LLPanel>("for_sale_panel");
 	mYouAreHerePanel = getChild<LLPanel>("here_panel");
-	gIdleCallbacks.addFunction(&LLPanelPlaceProfile::updateYouAreHereBanner, this);
+	gIdleCallbacks.addFunction(&LLPanelPlaceProfile::updateYouAreHereBanner, this, YOU_ARE_HERE_UPDATE_PERIOD);
 
 	//Icon value should contain sale price of last selected parcel.
 	mForSalePanel->getChild<LLIconCtrl>("icon_for_sale")->
@@ -37,6 +37,7 @@
 #include "llviewercontrol.h"
 #include "llviewerregion.h"
 #include "llcamera.h"
+#include "llvector4a.h"
 #include "pipeline.h"
 #include "llrender.h"
 #include "lloctree.h"
@@ -1791,7 +1792,7 @@ public:
 		if (mRes == 2 || 
 			(mRes && group->isState(LLSpatialGroup::SKIP_FRUSTUM_CHECK)))
 		{	//fully in, just add everything
-			LLSpatialGroup::OctreeTraveler::traverse(n);
+			traverseChildren(n);
 		}
 		else
 		{
@@ -1799,12 +1800,57 @@ public:
 				
 			if (mRes)
 			{ //at least partially in, run on down
-				LLSpatialGroup::OctreeTraveler::traverse(n);
+				traverseChildren(n);
 			}
 
 			mRes = 0;
 		}
 	}
+
+	//visit n, then cull its children, testing all of them against the frustum 
+	//in one batch when n is only partially in
+	void traverseChildren(const LLSpatialGroup::OctreeNode* n)
+	{
+		n->accept(this);
+
+		U32 count = n->getChildCount();
+		if (mRes != 1 || count == 0 || !LLPipeline::sBatchFrustumCull)
+		{
+			for (U32 i = 0; i < count; i++)
+			{
+				traverse(n->getChild(i));
+			}
+			return;
+		}
+
+		const LLSpatialGroup* groups[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		S32 res[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		for (U32 i = 0; i < count; i++)
+		{
+			groups[i] = (LLSpatialGroup*) n->getChild(i)->getListener(0);
+		}
+		frustumCheck(groups, count, res);
+
+		for (U32 i = 0; i < count; i++)
+		{
+			const LLSpatialGroup::OctreeNode* child = n->getChild(i);
+			LLSpatialGroup* group = (LLSpatialGroup*) child->getListener(0);
+
+			if (earlyFail(group))
+			{
+				continue;
+			}
+
+			//a child that shares our bounds is partially in as well
+			mRes = group->isState(LLSpatialGroup::SKIP_FRUSTUM_CHECK) ? 1 : res[i];
+			if (mRes)
+			{
+				traverseChildren(child);
+			}
+		}
+
+		mRes = 1;
+	}
 	
 	virtual S32 frustumCheck(const LLSpatialGroup* group)
 	{
@@ -1816,6 +1862,31 @@ public:
 		return res;
 	}
 
+	//frustumCheck() for count sibling groups at once
+	virtual void frustumCheck(const LLSpatialGroup** groups, U32 count, S32* res)
+	{
+		LLVector4a center[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		LLVector4a radius[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		loadBounds(groups, count, center, radius);
+		mCamera->AABBInFrustumNoFarClipBatch(center, radius, count, res);
+		for (U32 i = 0; i < count; i++)
+		{
+			if (res[i] != 0)
+			{
+				res[i] = llmin(res[i], AABBSphereIntersect(groups[i]->mExtents[0], groups[i]->mExtents[1], mCamera->getOrigin(), mCamera->mFrustumCornerDist));
+			}
+		}
+	}
+
+	static void loadBounds(const LLSpatialGroup** groups, U32 count, LLVector4a* center, LLVector4a* radius)
+	{
+		for (U32 i = 0; i < count; i++)
+		{
+			center[i].load3(groups[i]->mBounds[0].mV);
+			radius[i].load3(groups[i]->mBounds[1].mV);
+		}
+	}
+
 	virtual S32 frustumCheckObjects(const LLSpatialGroup* group)
 	{
 		S32 res = mCamera->AABBInFrustumNoFarClip(group->mObjectBounds[0], group->mObjectBounds[1]);
@@ -1886,6 +1957,14 @@ public:
 		return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
 	}
 
+	virtual void frustumCheck(const LLSpatialGroup** groups, U32 count, S32* res)
+	{
+		LLVector4a center[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		LLVector4a radius[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		loadBounds(groups, count, center, radius);
+		mCamera->AABBInFrustumNoFarClipBatch(center, radius, count, res);
+	}
+
 	virtual S32 frustumCheckObjects(const LLSpatialGroup* group)
 	{
 		S32 res = mCamera->AABBInFrustumNoFarClip(group->mObjectBounds[0], group->mObjectBounds[1]);
@@ -1904,6 +1983,14 @@ public:
 		return mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
 	}
 
+	virtual void frustumCheck(const LLSpatialGroup** groups, U32 count, S32* res)
+	{
+		LLVector4a center[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		LLVector4a radius[LLSpatialGroup::OctreeNode::MAX_CHILDREN];
+		loadBounds(groups, count, center, radius);
+		mCamera->AABBInFrustumBatch(center, radius, count, res);
+	}
+
 	virtual S32 frustumCheckObjects(const LLSpatialGroup* group)
 	{
 		return mCamera->AABBInFrustum(group->mObjectBounds[0], group->mObjectBounds[1]);
@@ -1928,33 +2015,6 @@ public:
 		return false;
 	}
 
-	virtual void traverse(const LLSpatialGroup::OctreeNode* n)
-	{
-		LLSpatialGroup* group = (LLSpatialGroup*) n->getListener(0);
-
-		if (earlyFail(group))
-		{
-			return;
-		}
-		
-		if ((mRes && group->isState(LLSpatialGroup::SKIP_FRUSTUM_CHECK)) ||
-			mRes == 2)
-		{	//don't need to do frustum check
-			LLSpatialGroup::OctreeTraveler::traverse(n);
-		}
-		else
-		{  
-			mRes = frustumCheck(group);
-				
-			if (mRes)
-			{ //at least partially in, run on down
-				LLSpatialGroup::OctreeTraveler::traverse(n);
-			}
-
-			mRes = 0;
-		}
-	}
-
 	virtual void processGroup(LLSpatialGroup* group)
 	{
 		if (group->isState(LLSpatialGroup::DIRTY) || group->getData().empty())
@@ -3252,6 +3312,8 @@ public:
 	LLVector3 *mBinormal;
 	LLDrawable* mHit;
 	BOOL mPickTransparent;
+	LLSpatialBridge* mBridge;		//bridge whose inverse render matrix is in mBridgeMatrix
+	LLMatrix4 mBridgeMatrix;
 
 	LLOctreeIntersect(LLVector3 start, LLVector3 end, BOOL pick_transparent,
 					  S32* face_hit, LLVector3* intersection, LLVector2* tex_coord, LLVector3* normal, LLVector3* binormal)
@@ -3263,7 +3325,8 @@ public:
 		  mNormal(normal),
 		  mBinormal(binormal),
 		  mHit(NULL),
-		  mPickTransparent(pick_transparent)
+		  mPickTransparent(pick_transparent),
+		  mBridge(NULL)
 	{
 	}
 	
@@ -3297,11 +3360,17 @@ public:
 
 			if (group->mSpatialPartition->isBridge())
 			{
-				LLMatrix4 local_matrix = group->mSpatialPartition->asBridge()->mDrawable->getRenderMatrix();
-				local_matrix.invert();
+				//invert once per bridge rather than for every group in it
+				LLSpatialBridge* bridge = group->mSpatialPartition->asBridge();
+				if (bridge != mBridge)
+				{
+					mBridge = bridge;
+					mBridgeMatrix = bridge->mDrawable->getRenderMatrix();
+					mBridgeMatrix.invert();
+				}
 				
-				local_start = mStart * local_matrix;
-				local_end   = mEnd   * local_matrix;
+				local_start = mStart * mBridgeMatrix;
+				local_end   = mEnd   * mBridgeMatrix;
 			}
 
 			if (LLLineSegmentBoxIntersect(local_start, local_end, center, size))
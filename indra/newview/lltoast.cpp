@@ -74,7 +74,7 @@ BOOL LLToastLifeTimer::getStarted()
 
 void LLToastLifeTimer::setPeriod(F32 period)
 {
-	mPeriod = period;
+	LLEventTimer::setPeriod(period);
 }
 
 F32 LLToastLifeTimer::getRemainingTimeF32()
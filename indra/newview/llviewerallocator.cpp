@@ -0,0 +1,124 @@
+/**
+ * @file llviewerallocator.cpp
+ * @brief Global operator new and delete, hooked up to LLAllocatorSampler.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llallocator_sampler.h"
+
+#include <new>
+
+// tcmalloc brings its own operator new and delete
+#if !LL_USE_TCMALLOC
+
+// These go straight to malloc() and free(), like the runtime's own, so
+// memory may still be freed across module boundaries.  On Windows they only
+// cover allocations made by the viewer executable itself.
+
+static void* sampled_new(size_t size)
+{
+	if (!size)
+	{
+		size = 1;
+	}
+	void* ptr;
+	while (!(ptr = malloc(size)))
+	{
+		std::new_handler handler = std::set_new_handler(NULL);
+		std::set_new_handler(handler);
+		if (!handler)
+		{
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+	LLAllocatorSampler::recordAlloc(ptr, size);
+	return ptr;
+}
+
+static void sampled_delete(void* ptr)
+{
+	if (ptr)
+	{
+		LLAllocatorSampler::recordFree(ptr);
+		free(ptr);
+	}
+}
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+	return sampled_new(size);
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+	return sampled_new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw()
+{
+	try
+	{
+		return sampled_new(size);
+	}
+	catch (std::bad_alloc&)
+	{
+		return NULL;
+	}
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) throw()
+{
+	try
+	{
+		return sampled_new(size);
+	}
+	catch (std::bad_alloc&)
+	{
+		return NULL;
+	}
+}
+
+void operator delete(void* ptr) throw()
+{
+	sampled_delete(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+	sampled_delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) throw()
+{
+	sampled_delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) throw()
+{
+	sampled_delete(ptr);
+}
+
+#endif // !LL_USE_TCMALLOC
@@ -33,6 +33,7 @@
 #include "llwindow.h"	// getGamma()
 
 // For Listeners
+#include "llallocator_sampler.h"
 #include "llaudioengine.h"
 #include "llagent.h"
 #include "llagentcamera.h"
@@ -54,6 +55,7 @@
 #include "llvosky.h"
 #include "llvotree.h"
 #include "llvovolume.h"
+#include "llvolumemgr.h"
 #include "llworld.h"
 #include "pipeline.h"
 #include "llviewerjoystick.h"
@@ -233,6 +235,19 @@ static bool handleVideoMemoryChanged(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleVolumeCacheMemoryChanged(const LLSD& newvalue)
+{
+	U32 megabytes = (U32)llclamp(newvalue.asInteger(), 0, (S32)VOLUME_CACHE_MAX_MB);
+	LLPrimitive::getVolumeManager()->setCacheBudget(megabytes << 20);
+	return true;
+}
+
+static bool handleMemSampleIntervalChanged(const LLSD& newvalue)
+{
+	LLAllocatorSampler::setSampleInterval((U32)newvalue.asInteger());
+	return true;
+}
+
 static bool handleBandwidthChanged(const LLSD& newvalue)
 {
 	gViewerThrottle.setMaxBandwidth((F32) newvalue.asReal());
@@ -451,6 +466,14 @@ bool handleVelocityInterpolate(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleFastTimerTraceChanged(const LLSD& newvalue)
+{
+	LLFastTimer::sTraceFileName = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "fasttimer_trace");
+	LLFastTimer::sTraceSlowFrameMS = gSavedSettings.getF32("FastTimerTraceSlowFrameMS");
+	LLFastTimer::setTraceCapture(gSavedSettings.getBOOL("FastTimerTraceCapture"));
+	return true;
+}
+
 bool handleForceShowGrid(const LLSD& newvalue)
 {
 	LLPanelLogin::updateServer( );
@@ -569,6 +592,8 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("RenderDeferredGI")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
 	gSavedSettings.getControl("TextureMemory")->getSignal()->connect(boost::bind(&handleVideoMemoryChanged, _2));
 	gSavedSettings.getControl("AuditTexture")->getSignal()->connect(boost::bind(&handleAuditTextureChanged, _2));
+	gSavedSettings.getControl("VolumeCacheMemory")->getSignal()->connect(boost::bind(&handleVolumeCacheMemoryChanged, _2));
+	gSavedSettings.getControl("MemSampleInterval")->getSignal()->connect(boost::bind(&handleMemSampleIntervalChanged, _2));
 	gSavedSettings.getControl("ChatFontSize")->getSignal()->connect(boost::bind(&handleChatFontSizeChanged, _2));
 	gSavedSettings.getControl("ChatPersistTime")->getSignal()->connect(boost::bind(&handleChatPersistTimeChanged, _2));
 	gSavedSettings.getControl("ConsoleMaxLines")->getSignal()->connect(boost::bind(&handleConsoleMaxLinesChanged, _2));
@@ -668,6 +693,9 @@ void settings_setup_listeners()
 #endif
 	gSavedSettings.getControl("ForceShowGrid")->getSignal()->connect(boost::bind(&handleForceShowGrid, _2));
 	gSavedSettings.getControl("RenderTransparentWater")->getSignal()->connect(boost::bind(&handleRenderTransparentWaterChanged, _2));
+	gSavedSettings.getControl("FastTimerTraceCapture")->getSignal()->connect(boost::bind(&handleFastTimerTraceChanged, _2));
+	gSavedSettings.getControl("FastTimerTraceSlowFrameMS")->getSignal()->connect(boost::bind(&handleFastTimerTraceChanged, _2));
+	handleFastTimerTraceChanged(LLSD());
 }
 
 #if TEST_CACHED_CONTROL
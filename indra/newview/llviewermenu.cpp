@@ -7088,6 +7088,11 @@ void handle_dump_timers()
 	LLFastTimer::dumpCurTimes();
 }
 
+void handle_write_timer_trace()
+{
+	LLFastTimer::writeTrace(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "fasttimer_trace.json"));
+}
+
 void handle_debug_avatar_textures(void*)
 {
 	LLViewerObject* objectp = LLSelectMgr::getInstance()->getSelection()->getPrimaryObject();
@@ -8080,6 +8085,7 @@ void initialize_menus()
 	view_listener_t::addMenu(new LLAdvancedDumpSelectMgr(), "Advanced.DumpSelectMgr");
 	view_listener_t::addMenu(new LLAdvancedDumpInventory(), "Advanced.DumpInventory");
 	commit.add("Advanced.DumpTimers", boost::bind(&handle_dump_timers) );
+	commit.add("Advanced.WriteTimerTrace", boost::bind(&handle_write_timer_trace) );
 	commit.add("Advanced.DumpFocusHolder", boost::bind(&handle_dump_focus) );
 	view_listener_t::addMenu(new LLAdvancedPrintSelectedObjectInfo(), "Advanced.PrintSelectedObjectInfo");
 	view_listener_t::addMenu(new LLAdvancedPrintAgentInfo(), "Advanced.PrintAgentInfo");
@@ -33,6 +33,7 @@
 // common includes
 #include "llstat.h"
 #include "llstring.h"
+#include "lluuidflatmap.h"
 
 // project includes
 #include "llviewerobject.h"
@@ -183,7 +184,8 @@ protected:
 	typedef std::map<LLUUID, LLPointer<LLViewerObject> > vo_map;
 	vo_map mDeadObjects;	// Need to keep multiple entries per UUID
 
-	std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
+	typedef LLUUIDFlatMap<LLPointer<LLViewerObject> > uuid_object_map_t;
+	uuid_object_map_t mUUIDObjectMap;
 
 	std::vector<LLDebugBeacon> mDebugBeacons;
 
@@ -231,7 +233,7 @@ extern LLViewerObjectList gObjectList;
  */
 inline LLViewerObject *LLViewerObjectList::findObject(const LLUUID &id)
 {
-	std::map<LLUUID, LLPointer<LLViewerObject> >::iterator iter = mUUIDObjectMap.find(id);
+	uuid_object_map_t::iterator iter = mUUIDObjectMap.find(id);
 	if(iter != mUUIDObjectMap.end())
 	{
 		return iter->second;
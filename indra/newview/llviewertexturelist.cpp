@@ -82,7 +82,9 @@ LLViewerTextureList::LLViewerTextureList()
 	: mForceResetTextureStats(FALSE),
 	mUpdateStats(FALSE),
 	mMaxResidentTexMemInMegaBytes(0),
-	mMaxTotalTextureMemInMegaBytes(0)
+	mMaxTotalTextureMemInMegaBytes(0),
+	mNextUpdateSlot(0),
+	mNextFetchSlot(0)
 {
 }
 
@@ -625,16 +627,17 @@ void LLViewerTextureList::updateImagesDecodePriorities()
 	{
 		const size_t max_update_count = llmin((S32) (1024*gFrameIntervalSeconds) + 1, 32); //target 1024 textures per second
 		S32 update_counter = llmin(max_update_count, mUUIDMap.size()/10);
-		uuid_map_t::iterator iter = mUUIDMap.upper_bound(mLastUpdateUUID);
 		while(update_counter > 0 && !mUUIDMap.empty())
 		{
+			// look the slot up again each time, deleting images below may
+			// change the map
+			uuid_map_t::iterator iter = mUUIDMap.beginAt(mNextUpdateSlot);
 			if (iter == mUUIDMap.end())
 			{
 				iter = mUUIDMap.begin();
 			}
-			mLastUpdateUUID = iter->first;
+			mNextUpdateSlot = iter.getSlot() + 1;
 			LLPointer<LLViewerFetchedTexture> imagep = iter->second;
-			++iter; // safe to incrament now
 
 			//
 			// Flush formatted images using a lazy flush
@@ -813,8 +816,7 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
 	update_counter = llmin(max_update_count, mUUIDMap.size());	
 	if(update_counter > 0)
 	{
-		uuid_map_t::iterator iter2 = mUUIDMap.upper_bound(mLastFetchUUID);
-		uuid_map_t::iterator iter2p = iter2;
+		uuid_map_t::iterator iter2 = mUUIDMap.beginAt(mNextFetchSlot);
 		while(update_counter > 0)
 		{
 			if (iter2 == mUUIDMap.end())
@@ -822,11 +824,10 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
 				iter2 = mUUIDMap.begin();
 			}
 			entries.push_back(iter2->second);
-			iter2p = iter2++;
+			mNextFetchSlot = iter2.getSlot() + 1;
+			++iter2;
 			update_counter--;
 		}
-
-		mLastFetchUUID = iter2p->first;
 	}
 	
 	S32 fetch_count = 0;
@@ -28,6 +28,7 @@
 #define LL_LLVIEWERTEXTURELIST_H
 
 #include "lluuid.h"
+#include "lluuidflatmap.h"
 //#include "message.h"
 #include "llgl.h"
 #include "llstat.h"
@@ -176,10 +177,11 @@ public:
 	BOOL mForceResetTextureStats;
     
 private:
-	typedef std::map< LLUUID, LLPointer<LLViewerFetchedTexture> > uuid_map_t;
+	typedef LLUUIDFlatMap< LLPointer<LLViewerFetchedTexture> > uuid_map_t;
 	uuid_map_t mUUIDMap;
-	LLUUID mLastUpdateUUID;
-	LLUUID mLastFetchUUID;
+	// where the round robin decode priority and fetch updates resume
+	U32 mNextUpdateSlot;
+	U32 mNextFetchSlot;
 	
 	typedef std::set<LLPointer<LLViewerFetchedTexture>, LLViewerFetchedTexture::Compare> image_priority_list_t;	
 	image_priority_list_t mImageList;
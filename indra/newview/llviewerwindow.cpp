@@ -473,6 +473,11 @@ public:
 			addText(xpos, ypos, llformat("%d Texture Matrix Ops", gPipeline.mTextureMatrixOps));
 			ypos += y_inc;
 
+			addText(xpos, ypos, llformat("Frame arena: %d allocs, %d KB of %d KB, %d heap allocs",
+				gFrameArena.getLastAllocationCount(), gFrameArena.getLastBytesUsed()/1024,
+				gFrameArena.getReservedBytes()/1024, gFrameArena.getLastHeapAllocationCount()));
+			ypos += y_inc;
+
 			gPipeline.mTextureMatrixOps = 0;
 			gPipeline.mMatrixOpCount = 0;
 
@@ -1462,6 +1462,14 @@ BOOL LLVOVolume::updateGeometry(LLDrawable *drawable)
 	}
 	else if ((mLODChanged) || (mSculptChanged))
 	{
+		if (!mSculptChanged && !isSculpted() &&
+			!LLPrimitive::getVolumeManager()->requestVolume(getVolume()->getParams(), mLOD))
+		{
+			// keep drawing the current LOD, and stay in the build queue
+			// until the new one has been generated in the background
+			return FALSE;
+		}
+
 		LLVolume *old_volumep, *new_volumep;
 		F32 old_lod, new_lod;
 		S32 old_num_faces, new_num_faces ;
@@ -1536,11 +1544,11 @@ void LLVOVolume::updateFaceSize(S32 idx)
 		const LLVolumeFace& vol_face = getVolume()->getVolumeFace(idx);
 		if (LLPipeline::sUseTriStrips)
 		{
-			facep->setSize(vol_face.mVertices.size(), vol_face.mTriStrip.size());
+			facep->setSize(vol_face.mNumVertices, vol_face.mTriStrip.size());
 		}
 		else
 		{
-			facep->setSize(vol_face.mVertices.size(), vol_face.mIndices.size());
+			facep->setSize(vol_face.mNumVertices, vol_face.mIndices.size());
 		}
 	}
 }
@@ -1801,10 +1809,13 @@ LLVector3 LLVOVolume::getApproximateFaceNormal(U8 face_id)
 	if (volume && face_id < volume->getNumVolumeFaces())
 	{
 		const LLVolumeFace& face = volume->getVolumeFace(face_id);
-		for (S32 i = 0; i < (S32)face.mVertices.size(); ++i)
+		LLVector4a sum;
+		sum.clear();
+		for (S32 i = 0; i < face.mNumVertices; ++i)
 		{
-			result += face.mVertices[i].mNormal;
+			sum.add(face.mNormals[i]);
 		}
+		result = sum.getVector3();
 
 		result = volumeDirectionToAgent(result);
 		result.normVec();
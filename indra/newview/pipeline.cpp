@@ -269,6 +269,7 @@ BOOL	LLPipeline::sDisableShaders = FALSE;
 BOOL	LLPipeline::sRenderBump = TRUE;
 BOOL	LLPipeline::sUseTriStrips = TRUE;
 BOOL	LLPipeline::sUseFarClip = TRUE;
+BOOL	LLPipeline::sBatchFrustumCull = TRUE;
 BOOL	LLPipeline::sShadowRender = FALSE;
 BOOL	LLPipeline::sWaterReflections = FALSE;
 BOOL	LLPipeline::sRenderGlow = FALSE;
@@ -6482,16 +6483,19 @@ void LLPipeline::renderDeferredLighting()
 		if (render_local || render_fullscreen)
 		{
 			gGL.setSceneBlendType(LLRender::BT_ADD);
-			std::list<LLVector4> fullscreen_lights;
-			LLDrawable::drawable_list_t spot_lights;
-			LLDrawable::drawable_list_t fullscreen_spot_lights;
+			// per-frame scratch lists, allocated from gFrameArena
+			typedef std::list<LLVector4, LLFrameAllocator<LLVector4> > light_list_t;
+			typedef std::list<LLPointer<LLDrawable>, LLFrameAllocator<LLPointer<LLDrawable> > > frame_drawable_list_t;
+			light_list_t fullscreen_lights;
+			frame_drawable_list_t spot_lights;
+			frame_drawable_list_t fullscreen_spot_lights;
 
 			for (U32 i = 0; i < 2; i++)
 			{
 				mTargetShadowSpotLight[i] = NULL;
 			}
 
-			std::list<LLVector4> light_colors;
+			light_list_t light_colors;
 
 			F32 v[24];
 			glVertexPointer(3, GL_FLOAT, 0, v);
@@ -6607,7 +6611,7 @@ void LLPipeline::renderDeferredLighting()
 
 				gDeferredSpotLightProgram.enableTexture(LLViewerShaderMgr::DEFERRED_PROJECTION);
 
-				for (LLDrawable::drawable_list_t::iterator iter = spot_lights.begin(); iter != spot_lights.end(); ++iter)
+				for (frame_drawable_list_t::iterator iter = spot_lights.begin(); iter != spot_lights.end(); ++iter)
 				{
 					LLFastTimer ftm(FTM_PROJECTORS);
 					LLDrawable* drawablep = *iter;
@@ -6704,7 +6708,7 @@ void LLPipeline::renderDeferredLighting()
 
 				gDeferredMultiSpotLightProgram.enableTexture(LLViewerShaderMgr::DEFERRED_PROJECTION);
 
-				for (LLDrawable::drawable_list_t::iterator iter = fullscreen_spot_lights.begin(); iter != fullscreen_spot_lights.end(); ++iter)
+				for (frame_drawable_list_t::iterator iter = fullscreen_spot_lights.begin(); iter != fullscreen_spot_lights.end(); ++iter)
 				{
 					LLFastTimer ftm(FTM_PROJECTORS);
 					LLDrawable* drawablep = *iter;
@@ -7456,7 +7460,7 @@ void LLPipeline::renderShadow(glh::matrix4f& view, glh::matrix4f& proj, LLCamera
 }
 
 static LLFastTimer::DeclareTimer FTM_VISIBLE_CLOUD("Visible Cloud");
-BOOL LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector3& max, std::vector<LLVector3>& fp, LLVector3 light_dir)
+BOOL LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector3& max, frame_point_list_t& fp, LLVector3 light_dir)
 {
 	LLFastTimer t(FTM_VISIBLE_CLOUD);
 	//get point cloud of intersection of frust and min, max
@@ -7467,7 +7471,7 @@ BOOL LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector
 	}
 
 	//get set of planes on bounding box
-	std::vector<LLPlane> bp;
+	std::vector<LLPlane, LLFrameAllocator<LLPlane> > bp;
 		
 	bp.push_back(LLPlane(min, LLVector3(-1,0,0)));
 	bp.push_back(LLPlane(min, LLVector3(0,-1,0)));
@@ -7477,7 +7481,7 @@ BOOL LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector
 	bp.push_back(LLPlane(max, LLVector3(0,0,1)));
 	
 	//potential points
-	std::vector<LLVector3> pp;
+	frame_point_list_t pp;
 
 	//add corners of AABB
 	pp.push_back(LLVector3(min.mV[0], min.mV[1], min.mV[2]));
@@ -7629,7 +7633,7 @@ BOOL LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector
 	return TRUE;
 }
 
-void LLPipeline::generateGI(LLCamera& camera, LLVector3& lightDir, std::vector<LLVector3>& vpc)
+void LLPipeline::generateGI(LLCamera& camera, LLVector3& lightDir, frame_point_list_t& vpc)
 {
 	if (LLViewerShaderMgr::instance()->getVertexShaderLevel(LLViewerShaderMgr::SHADER_DEFERRED) < 3)
 	{
@@ -7975,7 +7979,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 	F32 near_clip = 0.f;
 	{
 		//get visible point cloud
-		std::vector<LLVector3> fp;
+		frame_point_list_t fp;
 
 		main_camera.calcAgentFrustumPlanes(main_camera.mAgentFrustum);
 		
@@ -8096,7 +8100,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 			mShadowCamera[j] = shadow_cam;
 		}
 
-		std::vector<LLVector3> fp;
+		frame_point_list_t fp;
 
 		if (!gPipeline.getVisiblePointCloud(shadow_cam, min, max, fp, lightDir))
 		{
@@ -8125,7 +8129,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 		{
 			mShadowExtents[j][0] = min;
 			mShadowExtents[j][1] = max;
-			mShadowFrustPoints[j] = fp;
+			mShadowFrustPoints[j].assign(fp.begin(), fp.end());
 		}
 				
 
@@ -8135,7 +8139,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 		//get a temporary view projection
 		view[j] = look(camera.getOrigin(), lightDir, -up);
 
-		std::vector<LLVector3> wpf;
+		frame_point_list_t wpf;
 
 		for (U32 i = 0; i < fp.size(); i++)
 		{
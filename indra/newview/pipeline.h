@@ -39,6 +39,7 @@
 #include "llgl.h"
 #include "lldrawable.h"
 #include "llrendertarget.h"
+#include "llmemory.h"
 
 #include <stack>
 
@@ -199,7 +200,10 @@ public:
 	void updateMove();
 	BOOL visibleObjectsInFrustum(LLCamera& camera);
 	BOOL getVisibleExtents(LLCamera& camera, LLVector3 &min, LLVector3& max);
-	BOOL getVisiblePointCloud(LLCamera& camera, LLVector3 &min, LLVector3& max, std::vector<LLVector3>& fp, LLVector3 light_dir = LLVector3(0,0,0));
+	// Scratch point lists for shadow setup, only valid for the current frame
+	typedef std::vector<LLVector3, LLFrameAllocator<LLVector3> > frame_point_list_t;
+
+	BOOL getVisiblePointCloud(LLCamera& camera, LLVector3 &min, LLVector3& max, frame_point_list_t& fp, LLVector3 light_dir = LLVector3(0,0,0));
 	void updateCull(LLCamera& camera, LLCullResult& result, S32 water_clip = 0);  //if water_clip is 0, ignore water plane, 1, cull to above plane, -1, cull to below plane
 	void createObjects(F32 max_dtime);
 	void createObject(LLViewerObject* vobj);
@@ -241,7 +245,7 @@ public:
 
 
 	void renderShadow(glh::matrix4f& view, glh::matrix4f& proj, LLCamera& camera, LLCullResult& result, BOOL use_shader = TRUE, BOOL use_occlusion = TRUE);
-	void generateGI(LLCamera& camera, LLVector3& lightDir, std::vector<LLVector3>& vpc);
+	void generateGI(LLCamera& camera, LLVector3& lightDir, frame_point_list_t& vpc);
 	void renderHighlights();
 	void renderDebug();
 
@@ -463,6 +467,7 @@ public:
 	static BOOL				sRenderBump;
 	static BOOL				sUseTriStrips;
 	static BOOL				sUseFarClip;
+	static BOOL				sBatchFrustumCull; // test sibling spatial groups against the frustum together
 	static BOOL				sShadowRender;
 	static BOOL				sWaterReflections;
 	static BOOL				sDynamicLOD;
@@ -0,0 +1,657 @@
+/**
+ * @file llmessagelayout_tut.cpp
+ * @date 2011-08-30
+ * @brief Tests for decoding template messages into structs.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+#include "linden_common.h"
+#include "lltut.h"
+
+#include "llapr.h"
+#include "llmessagelayout.h"
+#include "llmessagetemplate.h"
+#include "llmessagetemplateparser.h"
+#include "llmetricbenchmark.h"
+#include "lltemplatemessagebuilder.h"
+#include "lltemplatemessagereader.h"
+#include "llversionserver.h"
+#include "message.h"
+#include "message_prehash.h"
+#include "v3math.h"
+
+namespace
+{
+	// The two object update messages, as in message_template.msg
+	const char* OBJECT_UPDATE_TEMPLATES =
+		"version 2.0\n"
+		"{\n"
+		"	ObjectUpdate High 12 Trusted Zerocoded\n"
+		"	{\n"
+		"		RegionData Single\n"
+		"		{ RegionHandle U64 }\n"
+		"		{ TimeDilation U16 }\n"
+		"	}\n"
+		"	{\n"
+		"		ObjectData Variable\n"
+		"		{ ID U32 } { State U8 } { FullID LLUUID } { CRC U32 }\n"
+		"		{ PCode U8 } { Material U8 } { ClickAction U8 } { Scale LLVector3 }\n"
+		"		{ ObjectData Variable 1 } { ParentID U32 } { UpdateFlags U32 }\n"
+		"		{ PathCurve U8 } { ProfileCurve U8 } { PathBegin U16 } { PathEnd U16 }\n"
+		"		{ PathScaleX U8 } { PathScaleY U8 } { PathShearX U8 } { PathShearY U8 }\n"
+		"		{ PathTwist S8 } { PathTwistBegin S8 } { PathRadiusOffset S8 }\n"
+		"		{ PathTaperX S8 } { PathTaperY S8 } { PathRevolutions U8 } { PathSkew S8 }\n"
+		"		{ ProfileBegin U16 } { ProfileEnd U16 } { ProfileHollow U16 }\n"
+		"		{ TextureEntry Variable 2 } { TextureAnim Variable 1 }\n"
+		"		{ NameValue Variable 2 } { Data Variable 2 } { Text Variable 1 }\n"
+		"		{ TextColor Fixed 4 } { MediaURL Variable 1 } { PSBlock Variable 1 }\n"
+		"		{ ExtraParams Variable 1 } { Sound LLUUID } { OwnerID LLUUID }\n"
+		"		{ Gain F32 } { Flags U8 } { Radius F32 } { JointType U8 }\n"
+		"		{ JointPivot LLVector3 } { JointAxisOrAnchor LLVector3 }\n"
+		"	}\n"
+		"}\n"
+		"{\n"
+		"	ImprovedTerseObjectUpdate High 15 Trusted Unencoded\n"
+		"	{\n"
+		"		RegionData Single\n"
+		"		{ RegionHandle U64 }\n"
+		"		{ TimeDilation U16 }\n"
+		"	}\n"
+		"	{\n"
+		"		ObjectData Variable\n"
+		"		{ Data Variable 1 }\n"
+		"		{ TextureEntry Variable 2 }\n"
+		"	}\n"
+		"}\n";
+
+	LLTemplateMessageBuilder::message_template_name_map_t sNameMap;
+	LLTemplateMessageReader::message_template_number_map_t sNumberMap;
+
+	void no_handler(LLMessageSystem*, void**)
+	{
+	}
+
+	// Starts the message system the reader reports to and loads the
+	// templates, once.
+	void init_object_update_templates()
+	{
+		static bool init = false;
+		if (!init)
+		{
+			ll_init_apr();
+			LLTemplateTokenizer tokens(OBJECT_UPDATE_TEMPLATES);
+			LLTemplateParser parsed(tokens);
+			for (LLTemplateParser::message_iterator iter = parsed.getMessagesBegin();
+				 iter != parsed.getMessagesEnd(); ++iter)
+			{
+				(*iter)->setHandlerFunc(no_handler, NULL);
+				sNameMap[(*iter)->mName] = *iter;
+				sNumberMap[(*iter)->mMessageNumber] = *iter;
+			}
+			init = true;
+		}
+
+		if (!gMessageSystem)
+		{
+			const F32 circuit_heartbeat_interval=5;
+			const F32 circuit_timeout=100;
+			start_messaging_system("notafile", 13035,
+								   LL_VERSION_MAJOR,
+								   LL_VERSION_MINOR,
+								   LL_VERSION_PATCH,
+								   FALSE,
+								   "notasharedsecret",
+								   NULL,
+								   false,
+								   circuit_heartbeat_interval,
+								   circuit_timeout);
+		}
+	}
+
+	struct TerseRegionData
+	{
+		U64 mRegionHandle;
+		U16 mTimeDilation;
+	};
+
+	struct TerseObjectData
+	{
+		LLMessageBytes mData;
+		LLMessageBytes mTextureEntry;
+	};
+
+	const LLMessageField TERSE_REGION_FIELDS[] =
+	{
+		LL_MESSAGE_FIELD(TerseRegionData, mRegionHandle, "RegionHandle"),
+		LL_MESSAGE_FIELD(TerseRegionData, mTimeDilation, "TimeDilation"),
+	};
+
+	const LLMessageField TERSE_OBJECT_FIELDS[] =
+	{
+		LL_MESSAGE_FIELD(TerseObjectData, mData, "Data"),
+		LL_MESSAGE_FIELD(TerseObjectData, mTextureEntry, "TextureEntry"),
+	};
+
+	LLMessageLayout sTerseRegionLayout("ImprovedTerseObjectUpdate", "RegionData",
+									   TERSE_REGION_FIELDS, LL_ARRAY_SIZE(TERSE_REGION_FIELDS));
+	LLMessageLayout sTerseObjectLayout("ImprovedTerseObjectUpdate", "ObjectData",
+									   TERSE_OBJECT_FIELDS, LL_ARRAY_SIZE(TERSE_OBJECT_FIELDS));
+
+	// What LLViewerObjectList reads of a full update before handing the
+	// rest to the object
+	struct FullObjectData
+	{
+		U32 mID;
+		LLUUID mFullID;
+		U32 mCRC;
+		U8 mPCode;
+		LLVector3 mScale;
+		LLMessageBytes mObjectData;
+		U32 mParentID;
+		U32 mUpdateFlags;
+		U16 mProfileHollow;
+		LLMessageBytes mTextureEntry;
+		LLMessageBytes mNameValue;
+		LLMessageBytes mText;
+		U8 mTextColor[4];
+		F32 mGain;
+		LLVector3 mJointAxisOrAnchor;
+	};
+
+	const LLMessageField FULL_OBJECT_FIELDS[] =
+	{
+		LL_MESSAGE_FIELD(FullObjectData, mID, "ID"),
+		LL_MESSAGE_FIELD(FullObjectData, mFullID, "FullID"),
+		LL_MESSAGE_FIELD(FullObjectData, mCRC, "CRC"),
+		LL_MESSAGE_FIELD(FullObjectData, mPCode, "PCode"),
+		LL_MESSAGE_FIELD(FullObjectData, mScale, "Scale"),
+		LL_MESSAGE_FIELD(FullObjectData, mObjectData, "ObjectData"),
+		LL_MESSAGE_FIELD(FullObjectData, mParentID, "ParentID"),
+		LL_MESSAGE_FIELD(FullObjectData, mUpdateFlags, "UpdateFlags"),
+		LL_MESSAGE_FIELD(FullObjectData, mProfileHollow, "ProfileHollow"),
+		LL_MESSAGE_FIELD(FullObjectData, mTextureEntry, "TextureEntry"),
+		LL_MESSAGE_FIELD(FullObjectData, mNameValue, "NameValue"),
+		LL_MESSAGE_FIELD(FullObjectData, mText, "Text"),
+		LL_MESSAGE_FIELD(FullObjectData, mTextColor, "TextColor"),
+		LL_MESSAGE_FIELD(FullObjectData, mGain, "Gain"),
+		LL_MESSAGE_FIELD(FullObjectData, mJointAxisOrAnchor, "JointAxisOrAnchor"),
+	};
+
+	LLMessageLayout sFullObjectLayout("ObjectUpdate", "ObjectData",
+									  FULL_OBJECT_FIELDS, LL_ARRAY_SIZE(FULL_OBJECT_FIELDS));
+
+	const U64 REGION_HANDLE = 0x0003e80000041a00ULL;
+	const U16 TIME_DILATION = 0xfff0;
+
+	// Builds an ImprovedTerseObjectUpdate with objects blocks into buffer,
+	// returns its size.
+	U32 build_terse_update(U8* buffer, U32 buffer_size, S32 objects)
+	{
+		LLTemplateMessageBuilder builder(sNameMap);
+		builder.newMessage(_PREHASH_ImprovedTerseObjectUpdate);
+		builder.nextBlock(_PREHASH_RegionData);
+		builder.addU64(_PREHASH_RegionHandle, REGION_HANDLE);
+		builder.addU16(_PREHASH_TimeDilation, TIME_DILATION);
+
+		U8 data[60];
+		U8 texture_entry[40];
+		for (S32 i = 0; i < objects; i++)
+		{
+			memset(data, i, sizeof(data));
+			memset(texture_entry, 0x80 + i, sizeof(texture_entry));
+			builder.nextBlock(_PREHASH_ObjectData);
+			builder.addBinaryData(_PREHASH_Data, data, sizeof(data));
+			// only every other object sends its faces
+			builder.addBinaryData(_PREHASH_TextureEntry, texture_entry, (i & 1) ? sizeof(texture_entry) : 0);
+		}
+
+		memset(buffer, 0, LL_PACKET_ID_SIZE);
+		return builder.buildMessage(buffer, buffer_size, 0);
+	}
+
+	// Builds an ObjectUpdate with objects blocks into buffer, returns its size.
+	U32 build_object_update(U8* buffer, U32 buffer_size, S32 objects)
+	{
+		LLTemplateMessageBuilder builder(sNameMap);
+		builder.newMessage(_PREHASH_ObjectUpdate);
+		builder.nextBlock(_PREHASH_RegionData);
+		builder.addU64(_PREHASH_RegionHandle, REGION_HANDLE);
+		builder.addU16(_PREHASH_TimeDilation, TIME_DILATION);
+
+		U8 object_data[60];
+		U8 texture_entry[80];
+		U8 text_color[4] = { 1, 2, 3, 4 };
+		memset(object_data, 0x11, sizeof(object_data));
+		memset(texture_entry, 0x22, sizeof(texture_entry));
+		for (S32 i = 0; i < objects; i++)
+		{
+			LLUUID full_id;
+			full_id.mData[0] = i;
+			full_id.mData[15] = 0x5a;
+
+			builder.nextBlock(_PREHASH_ObjectData);
+			builder.addU32(_PREHASH_ID, 1000 + i);
+			builder.addU8(_PREHASH_State, 0);
+			builder.addUUID(_PREHASH_FullID, full_id);
+			builder.addU32(_PREHASH_CRC, 0xc0ffee00 + i);
+			builder.addU8(_PREHASH_PCode, 9);
+			builder.addU8(_PREHASH_Material, 3);
+			builder.addU8(_PREHASH_ClickAction, 0);
+			builder.addVector3(_PREHASH_Scale, LLVector3(0.5f, 1.f, 2.f + i));
+			builder.addBinaryData(_PREHASH_ObjectData, object_data, sizeof(object_data));
+			builder.addU32(_PREHASH_ParentID, i ? 1000 : 0);
+			builder.addU32(_PREHASH_UpdateFlags, 0x10000 | i);
+			builder.addU8(_PREHASH_PathCurve, 16);
+			builder.addU8(_PREHASH_ProfileCurve, 1);
+			builder.addU16(_PREHASH_PathBegin, 0);
+			builder.addU16(_PREHASH_PathEnd, 0);
+			builder.addU8(_PREHASH_PathScaleX, 100);
+			builder.addU8(_PREHASH_PathScaleY, 100);
+			builder.addU8(_PREHASH_PathShearX, 0);
+			builder.addU8(_PREHASH_PathShearY, 0);
+			builder.addS8(_PREHASH_PathTwist, 0);
+			builder.addS8(_PREHASH_PathTwistBegin, 0);
+			builder.addS8(_PREHASH_PathRadiusOffset, 0);
+			builder.addS8(_PREHASH_PathTaperX, 0);
+			builder.addS8(_PREHASH_PathTaperY, 0);
+			builder.addU8(_PREHASH_PathRevolutions, 0);
+			builder.addS8(_PREHASH_PathSkew, 0);
+			builder.addU16(_PREHASH_ProfileBegin, 0);
+			builder.addU16(_PREHASH_ProfileEnd, 0);
+			builder.addU16(_PREHASH_ProfileHollow, 5000 + i);
+			builder.addBinaryData(_PREHASH_TextureEntry, texture_entry, sizeof(texture_entry));
+			builder.addBinaryData(_PREHASH_TextureAnim, NULL, 0);
+			builder.addString(_PREHASH_NameValue, i ? "" : "AttachItemID STRING RW SV 0");
+			builder.addBinaryData(_PREHASH_Data, NULL, 0);
+			builder.addString(_PREHASH_Text, "hover text");
+			builder.addBinaryData(_PREHASH_TextColor, text_color, sizeof(text_color));
+			builder.addBinaryData(_PREHASH_MediaURL, NULL, 0);
+			builder.addBinaryData(_PREHASH_PSBlock, NULL, 0);
+			builder.addBinaryData(_PREHASH_ExtraParams, NULL, 0);
+			builder.addUUID(_PREHASH_Sound, LLUUID::null);
+			builder.addUUID(_PREHASH_OwnerID, LLUUID::null);
+			builder.addF32(_PREHASH_Gain, 0.25f * i);
+			builder.addU8(_PREHASH_Flags, 0);
+			builder.addF32(_PREHASH_Radius, 0.f);
+			builder.addU8(_PREHASH_JointType, 0);
+			builder.addVector3(_PREHASH_JointPivot, LLVector3::zero);
+			builder.addVector3(_PREHASH_JointAxisOrAnchor, LLVector3(0.f, 0.f, (F32)i));
+		}
+
+		memset(buffer, 0, LL_PACKET_ID_SIZE);
+		return builder.buildMessage(buffer, buffer_size, 0);
+	}
+
+	// Reads an update off buffer, the way the viewer's handlers did
+	// before LLMessageLayout.
+	class UpdateReader
+	{
+	public:
+		UpdateReader() : mReader(sNumberMap), mSum(0) {}
+
+		void read(const U8* buffer, U32 size)
+		{
+			mReader.clearMessage();
+			mReader.validateMessage(buffer, size, LLHost());
+			mReader.readMessage(buffer, LLHost());
+		}
+
+		void getTerseByName()
+		{
+			U64 region_handle;
+			U16 time_dilation;
+			mReader.getU64(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+			mReader.getU16(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation);
+			mSum += region_handle + time_dilation;
+
+			U8 data[MTUBYTES];
+			S32 count = mReader.getNumberOfBlocks(_PREHASH_ObjectData);
+			for (S32 i = 0; i < count; i++)
+			{
+				S32 size = mReader.getSize(_PREHASH_ObjectData, i, _PREHASH_Data);
+				mReader.getBinaryData(_PREHASH_ObjectData, _PREHASH_Data, data, size, i);
+				S32 te_size = mReader.getSize(_PREHASH_ObjectData, i, _PREHASH_TextureEntry);
+				if (te_size)
+				{
+					mReader.getBinaryData(_PREHASH_ObjectData, _PREHASH_TextureEntry, data, te_size, i);
+				}
+				mSum += size + te_size + data[0];
+			}
+		}
+
+		void getTerseByLayout()
+		{
+			TerseRegionData region;
+			sTerseRegionLayout.decode(mReader, &region);
+			mSum += region.mRegionHandle + region.mTimeDilation;
+
+			TerseObjectData object;
+			S32 count = sTerseObjectLayout.getNumberOfBlocks(mReader);
+			for (S32 i = 0; i < count; i++)
+			{
+				sTerseObjectLayout.decode(mReader, &object, i);
+				mSum += object.mData.mSize + object.mTextureEntry.mSize + object.mData.mData[0];
+			}
+		}
+
+		void getFullByName()
+		{
+			U8 data[MTUBYTES];
+			FullObjectData object;
+			S32 count = mReader.getNumberOfBlocks(_PREHASH_ObjectData);
+			for (S32 i = 0; i < count; i++)
+			{
+				mReader.getU32(_PREHASH_ObjectData, _PREHASH_ID, object.mID, i);
+				mReader.getUUID(_PREHASH_ObjectData, _PREHASH_FullID, object.mFullID, i);
+				mReader.getU32(_PREHASH_ObjectData, _PREHASH_CRC, object.mCRC, i);
+				mReader.getU8(_PREHASH_ObjectData, _PREHASH_PCode, object.mPCode, i);
+				mReader.getVector3(_PREHASH_ObjectData, _PREHASH_Scale, object.mScale, i);
+				S32 size = mReader.getSize(_PREHASH_ObjectData, i, _PREHASH_ObjectData);
+				mReader.getBinaryData(_PREHASH_ObjectData, _PREHASH_ObjectData, data, size, i);
+				mReader.getU32(_PREHASH_ObjectData, _PREHASH_ParentID, object.mParentID, i);
+				mReader.getU32(_PREHASH_ObjectData, _PREHASH_UpdateFlags, object.mUpdateFlags, i);
+				mReader.getU16(_PREHASH_ObjectData, _PREHASH_ProfileHollow, object.mProfileHollow, i);
+				size = mReader.getSize(_PREHASH_ObjectData, i, _PREHASH_TextureEntry);
+				mReader.getBinaryData(_PREHASH_ObjectData, _PREHASH_TextureEntry, data, size, i);
+				std::string name_value, text;
+				mReader.getString(_PREHASH_ObjectData, _PREHASH_NameValue, name_value, i);
+				mReader.getString(_PREHASH_ObjectData, _PREHASH_Text, text, i);
+				mReader.getBinaryData(_PREHASH_ObjectData, _PREHASH_TextColor, object.mTextColor, 4, i);
+				mReader.getF32(_PREHASH_ObjectData, _PREHASH_Gain, object.mGain, i);
+				mReader.getVector3(_PREHASH_ObjectData, _PREHASH_JointAxisOrAnchor, object.mJointAxisOrAnchor, i);
+				mSum += object.mID + object.mCRC + object.mParentID + size + text.size();
+			}
+		}
+
+		void getFullByLayout()
+		{
+			FullObjectData object;
+			S32 count = sFullObjectLayout.getNumberOfBlocks(mReader);
+			for (S32 i = 0; i < count; i++)
+			{
+				sFullObjectLayout.decode(mReader, &object, i);
+				mSum += object.mID + object.mCRC + object.mParentID + object.mTextureEntry.mSize + object.mText.mSize;
+			}
+		}
+
+		LLTemplateMessageReader mReader;
+		U64 mSum;
+	};
+
+	// Reads a packet's worth of updates, by name or through layouts.
+	class UpdateBenchmark : public LLMetricBenchmark
+	{
+	public:
+		UpdateBenchmark(const std::string& name, bool terse, bool layout) :
+			LLMetricBenchmark(name, 1000),
+			mTerse(terse),
+			mLayout(layout),
+			mSize(0)
+		{
+		}
+
+		virtual void setup()
+		{
+			init_object_update_templates();
+			// about what fits in one packet
+			mSize = mTerse ? build_terse_update(mBuffer, sizeof(mBuffer), 10)
+						   : build_object_update(mBuffer, sizeof(mBuffer), 4);
+		}
+
+		virtual void run(U32 iterations)
+		{
+			for (U32 i = 0; i < iterations; i++)
+			{
+				mReader.read(mBuffer, mSize);
+				if (mTerse)
+				{
+					mLayout ? mReader.getTerseByLayout() : mReader.getTerseByName();
+				}
+				else
+				{
+					mLayout ? mReader.getFullByLayout() : mReader.getFullByName();
+				}
+			}
+		}
+
+	private:
+		UpdateReader mReader;
+		bool mTerse;
+		bool mLayout;
+		U8 mBuffer[MAX_BUFFER_SIZE];
+		U32 mSize;
+	};
+
+	class TerseByNameBenchmark : public UpdateBenchmark
+	{
+	public:
+		TerseByNameBenchmark(const std::string& name) : UpdateBenchmark(name, true, false) { }
+	};
+
+	class TerseByLayoutBenchmark : public UpdateBenchmark
+	{
+	public:
+		TerseByLayoutBenchmark(const std::string& name) : UpdateBenchmark(name, true, true) { }
+	};
+
+	class FullByNameBenchmark : public UpdateBenchmark
+	{
+	public:
+		FullByNameBenchmark(const std::string& name) : UpdateBenchmark(name, false, false) { }
+	};
+
+	class FullByLayoutBenchmark : public UpdateBenchmark
+	{
+	public:
+		FullByLayoutBenchmark(const std::string& name) : UpdateBenchmark(name, false, true) { }
+	};
+
+	LLMetricBenchmark::Registrar<TerseByNameBenchmark> sTerseByNameRegistrar("terse_update_by_name");
+	LLMetricBenchmark::Registrar<TerseByLayoutBenchmark> sTerseByLayoutRegistrar("terse_update_by_layout");
+	LLMetricBenchmark::Registrar<FullByNameBenchmark> sFullByNameRegistrar("object_update_by_name");
+	LLMetricBenchmark::Registrar<FullByLayoutBenchmark> sFullByLayoutRegistrar("object_update_by_layout");
+}
+
+namespace tut
+{
+	struct LLMessageLayoutTestData
+	{
+		LLMessageLayoutTestData()
+		{
+			init_object_update_templates();
+		}
+
+		U8 mBuffer[MAX_BUFFER_SIZE];
+	};
+
+	typedef test_group<LLMessageLayoutTestData>	LLMessageLayoutTestGroup;
+	typedef LLMessageLayoutTestGroup::object		LLMessageLayoutTestObject;
+	LLMessageLayoutTestGroup messageLayoutTestGroup("LLMessageLayout");
+
+	template<> template<>
+	void LLMessageLayoutTestObject::test<1>()
+		// terse update, layout against the named getters
+	{
+		U32 size = build_terse_update(mBuffer, sizeof(mBuffer), 5);
+		UpdateReader reader;
+		reader.read(mBuffer, size);
+
+		TerseRegionData region;
+		ensure("decoded region", sTerseRegionLayout.decode(reader.mReader, &region));
+		ensure_equals("region handle", region.mRegionHandle, REGION_HANDLE);
+		ensure_equals("time dilation", region.mTimeDilation, TIME_DILATION);
+
+		ensure_equals("objects", sTerseObjectLayout.getNumberOfBlocks(reader.mReader), 5);
+		for (S32 i = 0; i < 5; i++)
+		{
+			TerseObjectData object;
+			ensure("decoded object", sTerseObjectLayout.decode(reader.mReader, &object, i));
+			ensure_equals("data size", object.mData.mSize, 60);
+			ensure_equals("data", object.mData.mData[59], (U8)i);
+			ensure_equals("texture entry size", object.mTextureEntry.mSize, (i & 1) ? 40 : 0);
+			if (object.mTextureEntry.mSize)
+			{
+				ensure_equals("texture entry", object.mTextureEntry.mData[0], (U8)(0x80 + i));
+			}
+
+			U8 data[60];
+			reader.mReader.getBinaryData(_PREHASH_ObjectData, _PREHASH_Data, data, 60, i);
+			ensure("same data", !memcmp(data, object.mData.mData, 60));
+		}
+
+		TerseObjectData object;
+		ensure("past the last object", !sTerseObjectLayout.decode(reader.mReader, &object, 5));
+	}
+
+	template<> template<>
+	void LLMessageLayoutTestObject::test<2>()
+		// full update, layout against the named getters
+	{
+		U32 size = build_object_update(mBuffer, sizeof(mBuffer), 3);
+		UpdateReader reader;
+		reader.read(mBuffer, size);
+
+		for (S32 i = 0; i < 3; i++)
+		{
+			FullObjectData object;
+			ensure("decoded object", sFullObjectLayout.decode(reader.mReader, &object, i));
+
+			U32 id, crc, parent_id, update_flags;
+			LLUUID full_id;
+			LLVector3 scale, axis;
+			U16 hollow;
+			F32 gain;
+			std::string text;
+			reader.mReader.getU32(_PREHASH_ObjectData, _PREHASH_ID, id, i);
+			reader.mReader.getUUID(_PREHASH_ObjectData, _PREHASH_FullID, full_id, i);
+			reader.mReader.getU32(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
+			reader.mReader.getVector3(_PREHASH_ObjectData, _PREHASH_Scale, scale, i);
+			reader.mReader.getU32(_PREHASH_ObjectData, _PREHASH_ParentID, parent_id, i);
+			reader.mReader.getU32(_PREHASH_ObjectData, _PREHASH_UpdateFlags, update_flags, i);
+			reader.mReader.getU16(_PREHASH_ObjectData, _PREHASH_ProfileHollow, hollow, i);
+			reader.mReader.getF32(_PREHASH_ObjectData, _PREHASH_Gain, gain, i);
+			reader.mReader.getVector3(_PREHASH_ObjectData, _PREHASH_JointAxisOrAnchor, axis, i);
+			reader.mReader.getString(_PREHASH_ObjectData, _PREHASH_Text, text, i);
+
+			ensure_equals("id", object.mID, id);
+			ensure_equals("id value", object.mID, (U32)(1000 + i));
+			ensure_equals("full id", object.mFullID, full_id);
+			ensure_equals("crc", object.mCRC, crc);
+			ensure_equals("pcode", object.mPCode, (U8)9);
+			ensure_equals("scale", object.mScale, scale);
+			ensure_equals("scale value", object.mScale.mV[VZ], 2.f + i);
+			ensure_equals("object data", object.mObjectData.mSize, 60);
+			ensure_equals("parent", object.mParentID, parent_id);
+			ensure_equals("flags", object.mUpdateFlags, update_flags);
+			ensure_equals("hollow", object.mProfileHollow, hollow);
+			ensure_equals("texture entry", object.mTextureEntry.mSize, 80);
+			ensure_equals("name value", object.mNameValue.mSize, i ? 1 : 28);
+			ensure_equals("text", std::string((const char*)object.mText.mData), text);
+			ensure_equals("text color", object.mTextColor[3], (U8)4);
+			ensure_equals("gain", object.mGain, gain);
+			ensure_equals("axis", object.mJointAxisOrAnchor, axis);
+		}
+	}
+
+	template<> template<>
+	void LLMessageLayoutTestObject::test<3>()
+		// a layout only decodes its own message
+	{
+		U32 size = build_object_update(mBuffer, sizeof(mBuffer), 1);
+		UpdateReader reader;
+		reader.read(mBuffer, size);
+
+		TerseRegionData region;
+		region.mRegionHandle = 0;
+		ensure("other message", !sTerseRegionLayout.decode(reader.mReader, &region));
+		ensure_equals("left alone", region.mRegionHandle, (U64)0);
+		ensure_equals("no blocks", sTerseObjectLayout.getNumberOfBlocks(reader.mReader), 0);
+
+		size = build_terse_update(mBuffer, sizeof(mBuffer), 1);
+		reader.read(mBuffer, size);
+		ensure("own message", sTerseRegionLayout.decode(reader.mReader, &region));
+		ensure_equals("decoded", region.mRegionHandle, REGION_HANDLE);
+	}
+
+	template<> template<>
+	void LLMessageLayoutTestObject::test<4>()
+		// members have to match the template
+	{
+		struct WrongSize
+		{
+			U32 mTimeDilation;
+		};
+		const LLMessageField fields[] =
+		{
+			LL_MESSAGE_FIELD(WrongSize, mTimeDilation, "TimeDilation"),
+		};
+		LLMessageLayout layout("ImprovedTerseObjectUpdate", "RegionData", fields, LL_ARRAY_SIZE(fields));
+
+		U32 size = build_terse_update(mBuffer, sizeof(mBuffer), 1);
+		UpdateReader reader;
+		reader.read(mBuffer, size);
+
+		WrongSize out;
+		ensure("wrong size", !layout.decode(reader.mReader, &out));
+	}
+
+	template<> template<>
+	void LLMessageLayoutTestObject::test<5>()
+		// fields past the end of a short packet read as zeros
+	{
+		build_terse_update(mBuffer, sizeof(mBuffer), 1);
+		UpdateReader reader;
+		// stop one byte into the time dilation
+		reader.read(mBuffer, LL_PACKET_ID_SIZE + 1 + 8 + 1);
+
+		TerseRegionData region;
+		ensure("decoded region", sTerseRegionLayout.decode(reader.mReader, &region));
+		ensure_equals("region handle", region.mRegionHandle, REGION_HANDLE);
+		ensure_equals("time dilation", region.mTimeDilation, (U16)0);
+		ensure_equals("no objects", sTerseObjectLayout.getNumberOfBlocks(reader.mReader), 0);
+
+		U16 time_dilation = 1;
+		reader.mReader.getU16(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation);
+		ensure_equals("getter agrees", time_dilation, (U16)0);
+	}
+
+	template<> template<>
+	void LLMessageLayoutTestObject::test<6>()
+		// copying a read message to a builder gives the same packet
+	{
+		U32 size = build_object_update(mBuffer, sizeof(mBuffer), 2);
+		UpdateReader reader;
+		reader.read(mBuffer, size);
+
+		LLTemplateMessageBuilder builder(sNameMap);
+		builder.newMessage(_PREHASH_ObjectUpdate);
+		reader.mReader.copyToBuilder(builder);
+
+		U8 copy[MAX_BUFFER_SIZE];
+		memset(copy, 0, LL_PACKET_ID_SIZE);
+		U32 copy_size = builder.buildMessage(copy, sizeof(copy), 0);
+		ensure_equals("size", copy_size, size);
+		ensure("contents", !memcmp(copy, mBuffer, size));
+	}
+}
@@ -717,28 +717,48 @@ namespace tut
 		}
 		
 		{
-			SDAllocationCheck check("assign integer value", 1);
+			SDAllocationCheck check("assign integer value", 0);
 			LLSD v = 45;
 			v = 33;
 			v = 0;
 		}
 
 		{
-			SDAllocationCheck check("copy construct integer", 1);
+			SDAllocationCheck check("copy construct integer", 0);
 			LLSD v = 45;
 			LLSD w = v;
 		}
 
 		{
-			SDAllocationCheck check("assign integer", 1);
+			SDAllocationCheck check("assign integer", 0);
 			LLSD v = 45;
 			LLSD w;
 			w = v;
 		}
+
+		{
+			SDAllocationCheck check("assign string value", 1);
+			LLSD v = "hello";
+			v = "there";
+			v = "";
+		}
+
+		{
+			SDAllocationCheck check("copy construct string", 1);
+			LLSD v = "hello";
+			LLSD w = v;
+		}
+
+		{
+			SDAllocationCheck check("assign string", 1);
+			LLSD v = "hello";
+			LLSD w;
+			w = v;
+		}
 		
 		{
 			SDAllocationCheck check("avoids extra clone", 2);
-			LLSD v = 45;
+			LLSD v = "hello";
 			LLSD w = v;
 			w = "nice day";
 		}
@@ -36,6 +36,7 @@
 
 #include "linden_common.h"
 #include "llerrorcontrol.h"
+#include "llmetricbenchmark.h"
 #include "lltut.h"
 
 #include "apr_pools.h"
@@ -285,6 +286,13 @@ static const apr_getopt_option_t TEST_CL_OPTIONS[] =
 	{"wait", 'w', 0, "Wait for input before exit."},
 	{"debug", 'd', 0, "Emit full debug logs."},
 	{"suitename", 'x', 1, "Run tests using this suitename"},
+	{"benchmark", 'b', 0, "Run the registered benchmarks instead of the tests."},
+	{"filter", 'f', 1, "Only run the benchmarks whose names contain the option argument."},
+	{"warmups", 'u', 1, "Untimed runs of each benchmark before timing, 2 by default."},
+	{"repetitions", 'r', 1, "Timed runs of each benchmark, 10 by default."},
+	{"results", 'e', 1, "Write the benchmark results to the named file."},
+	{"baseline", 'a', 1, "Fail on benchmarks slower than in the named results file."},
+	{"tolerance", 'p', 1, "Percent slowdown from the baseline allowed, 10 by default."},
 	{0, 0, 0, 0}
 };
 
@@ -313,6 +321,8 @@ void stream_usage(std::ostream& s, const char* app)
 	s << "\tList all available test groups." << std::endl;
 	s << "  " << app << " --group=uuid" << std::endl;
 	s << "\tRun the test group 'uuid'." << std::endl;
+	s << "  " << app << " --benchmark --results=new.xml --baseline=old.xml" << std::endl;
+	s << "\tRun all the benchmarks, save the results and compare them to an earlier run." << std::endl;
 }
 
 void stream_groups(std::ostream& s, const char* app)
@@ -327,6 +337,50 @@ void stream_groups(std::ostream& s, const char* app)
 	}
 }
 
+// Returns the number of regressions, or -1 if the baseline couldn't be read.
+int run_benchmarks(const std::string& filter, U32 warmups, U32 repetitions,
+				   const char* results_file, const char* baseline_file, F64 tolerance)
+{
+	LLSD results = LLSD::emptyMap();
+	S32 count = LLMetricBenchmark::runBenchmarks(filter, warmups, repetitions, results);
+
+	S32 regressions = 0;
+	if (baseline_file)
+	{
+		LLSD baseline;
+		if (!LLMetricBenchmark::loadResults(baseline_file, baseline))
+		{
+			std::cerr << "Unable to read benchmark baseline " << baseline_file << std::endl;
+			return -1;
+		}
+		regressions = LLMetricBenchmark::compareToBaseline(baseline, results, tolerance);
+	}
+
+	for (LLSD::map_const_iterator iter = results.beginMap(); iter != results.endMap(); ++iter)
+	{
+		const LLSD& result = iter->second;
+		std::cout << iter->first << ": median " << result["MedianTime"].asReal()
+				  << " usec, min " << result["MinTime"].asReal()
+				  << " usec, std dev " << result["StdDevTime"].asReal() << " usec";
+		if (result.has("BaselineMedianTime"))
+		{
+			std::cout << ", baseline " << result["BaselineMedianTime"].asReal() << " usec";
+			if (result["Regression"].asBoolean())
+			{
+				std::cout << " REGRESSION";
+			}
+		}
+		std::cout << std::endl;
+	}
+	std::cout << count << " benchmarks, " << regressions << " regressions" << std::endl;
+
+	if (results_file)
+	{
+		LLMetricBenchmark::saveResults(results_file, results);
+	}
+	return regressions;
+}
+
 void wouldHaveCrashed(const std::string& message)
 {
 	tut::fail("llerrs message: " + message);
@@ -376,6 +430,15 @@ int main(int argc, char **argv)
 	std::ofstream *output = NULL;
 	const char *touch = NULL;
 
+	// values used for benchmarking
+	bool benchmark_mode = false;
+	std::string benchmark_filter;
+	U32 warmups = 2;
+	U32 repetitions = 10;
+	const char* results_file = NULL;
+	const char* baseline_file = NULL;
+	F64 tolerance = 0.1;
+
 	while(true)
 	{
 		apr_err = apr_getopt_long(os, TEST_CL_OPTIONS, &opt_id, &opt_arg);
@@ -425,6 +488,27 @@ int main(int argc, char **argv)
 			case 'x':
 				suite_name.assign(opt_arg);
 				break;
+			case 'b':
+				benchmark_mode = true;
+				break;
+			case 'f':
+				benchmark_filter.assign(opt_arg);
+				break;
+			case 'u':
+				warmups = atoi(opt_arg);
+				break;
+			case 'r':
+				repetitions = atoi(opt_arg);
+				break;
+			case 'e':
+				results_file = opt_arg;
+				break;
+			case 'a':
+				baseline_file = opt_arg;
+				break;
+			case 'p':
+				tolerance = atof(opt_arg) / 100.0;
+				break;
 			default:
 				stream_usage(std::cerr, argv[0]);
 				return 1;
@@ -432,6 +516,21 @@ int main(int argc, char **argv)
 		}
 	}
 
+	if (benchmark_mode)
+	{
+		int regressions = run_benchmarks(benchmark_filter, warmups, repetitions,
+										 results_file, baseline_file, tolerance);
+		if (touch && !regressions)
+		{
+			std::ofstream s;
+			s.open(touch);
+			s << "ok" << std::endl;
+			s.close();
+		}
+		apr_terminate();
+		return regressions ? 1 : 0;
+	}
+
 	// run the tests
 
 	LLTestCallback* mycallback;